@@ -32,7 +32,6 @@
 #include <atomic>
 #include <chrono>
 #include <climits>
-#include <thread>
 
 #include "c3d_render_raytracing.h"
 #include "mortoncodes.h"
@@ -41,6 +40,7 @@
 #include "3d_math.h"
 #include "../common_ogl/ogl_utils.h"
 #include <profile.h>        // To use GetRunningMicroSecs or another profiling utility
+#include <thread_pool.h>
 
 // This should be used in future for the function
 // convertLinearToSRGB
@@ -366,18 +366,16 @@ void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte *ptrPBO ,
     m_isPreview = false;
 
     auto startTime = std::chrono::steady_clock::now();
-    bool breakLoop = false;
+    std::atomic<bool> breakLoop( false );
 
     std::atomic<size_t> numBlocksRendered( 0 );
     std::atomic<size_t> currentBlock( 0 );
-    std::atomic<size_t> threadsFinished( 0 );
 
-    size_t parallelThreadCount = std::min<size_t>(
-            std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
-            m_blockPositions.size() );
-    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-    {
-        std::thread t = std::thread( [&]()
+    size_t parallelThreadCount = std::min<size_t>( GetKiCadThreadPool().GetWorkerCount(),
+                                                   m_blockPositions.size() );
+
+    GetKiCadThreadPool().ParallelFor( parallelThreadCount,
+        [&]( size_t )
         {
             for( size_t iBlock = currentBlock.fetch_add( 1 );
                         iBlock < m_blockPositions.size() && !breakLoop;
@@ -396,16 +394,8 @@ void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte *ptrPBO ,
                         breakLoop = true;
                 }
             }
-
-            threadsFinished++;
         } );
 
-        t.detach();
-    }
-
-    while( threadsFinished < parallelThreadCount )
-        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
-
     m_nrBlocksRenderProgress += numBlocksRendered;
 
     if( aStatusTextReporter )
@@ -923,12 +913,11 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_shade( GLubyte *ptrPBO,
             aStatusTextReporter->Report( _("Rendering: Post processing shader") );
 
         std::atomic<size_t> nextBlock( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
 
-        size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-        {
-            std::thread t = std::thread( [&]()
+        size_t parallelThreadCount = GetKiCadThreadPool().GetWorkerCount();
+
+        GetKiCadThreadPool().ParallelFor( parallelThreadCount,
+            [&]( size_t )
             {
                 for( size_t y = nextBlock.fetch_add( 1 );
                             y < m_realBufferSize.y;
@@ -942,16 +931,8 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_shade( GLubyte *ptrPBO,
                         ptr++;
                     }
                 }
-
-                threadsFinished++;
             } );
 
-            t.detach();
-        }
-
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
-
         // Set next state
         m_rt_render_state = RT_RENDER_STATE_POST_PROCESS_BLUR_AND_FINISH;
     }
@@ -972,12 +953,11 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_blur_finish( GLubyte *ptrPBO,
     {
         // Now blurs the shader result and compute the final color
         std::atomic<size_t> nextBlock( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
 
-        size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-        {
-            std::thread t = std::thread( [&]()
+        size_t parallelThreadCount = GetKiCadThreadPool().GetWorkerCount();
+
+        GetKiCadThreadPool().ParallelFor( parallelThreadCount,
+            [&]( size_t )
             {
                 for( size_t y = nextBlock.fetch_add( 1 );
                             y < m_realBufferSize.y;
@@ -1062,16 +1042,8 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_blur_finish( GLubyte *ptrPBO,
                         ptr += 4;
                     }
                 }
-
-                threadsFinished++;
             } );
 
-            t.detach();
-        }
-
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
-
 
         // Debug code
         //m_postshader_ssao.DebugBuffersOutputAsImages();
@@ -1087,14 +1059,12 @@ void C3D_RENDER_RAYTRACING::render_preview( GLubyte *ptrPBO )
     m_isPreview = true;
 
     std::atomic<size_t> nextBlock( 0 );
-    std::atomic<size_t> threadsFinished( 0 );
 
-    size_t parallelThreadCount = std::min<size_t>(
-            std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
-            m_blockPositions.size() );
-    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-    {
-        std::thread t = std::thread( [&]()
+    size_t parallelThreadCount = std::min<size_t>( GetKiCadThreadPool().GetWorkerCount(),
+                                                   m_blockPositions.size() );
+
+    GetKiCadThreadPool().ParallelFor( parallelThreadCount,
+        [&]( size_t )
         {
             for( size_t iBlock = nextBlock.fetch_add( 1 );
                         iBlock < m_blockPositionsFast.size();
@@ -1700,15 +1670,7 @@ void C3D_RENDER_RAYTRACING::render_preview( GLubyte *ptrPBO )
                     }
                 }
             }
-
-            threadsFinished++;
         } );
-
-        t.detach();
-    }
-
-    while( threadsFinished < parallelThreadCount )
-        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
 }
 
 
@@ -110,4 +110,7 @@ macro( perform_feature_checks )
     # getc() on platforms where getc_unlocked() doesn't exist.
     check_symbol_exists( getc_unlocked "stdio.h" HAVE_FGETC_NOLOCK )
 
+    # Check for Posix mmap(), used to read large files without copying them line by line.
+    check_symbol_exists( mmap "sys/mman.h" HAVE_MMAP )
+
 endmacro( perform_feature_checks )
@@ -199,6 +199,144 @@ if( NOT ( tokensBefore EQUAL tokensAfter ) )
     message( FATAL_ERROR "Duplicate tokens found in file <${inputFile}>." )
 endif()
 
+# Build a perfect hash of the tokens, used by DSNLEXER::findToken() through the
+# KEYWORD_HASH of the lexer.  The hash of a token is computed as in KEYWORD_HASH::Lookup():
+#
+#     h = seed, then for each character c: h = ( ( h * 33 ) ^ c ) & 0xFFFFFF
+#     h = h ^ ( h >> 12 )
+#
+# and the token is stored at slot ( ( h >> 4 ) + d * ( ( h >> 12 ) | 1 ) ) & slotMask, where
+# d is the displacement of its bucket h & bucketMask.  The buckets are placed from the
+# largest one, each with the first displacement which puts all its tokens in free slots.
+# All the values stay below 2^31, for the math() of any CMake version.
+
+set( slotCount 4 )
+math( EXPR minSlotCount "${tokensAfter} * 2" )
+
+while( slotCount LESS minSlotCount )
+    math( EXPR slotCount "${slotCount} * 2" )
+endwhile()
+
+math( EXPR slotMask "${slotCount} - 1" )
+math( EXPR bucketCount "${slotCount} / 4" )
+math( EXPR bucketMask "${bucketCount} - 1" )
+
+set( lowerChars "abcdefghijklmnopqrstuvwxyz" )
+set( digitChars "0123456789" )
+
+set( seed 5381 )
+set( hashFound FALSE )
+
+while( NOT hashFound AND seed LESS 5413 )
+    set( hashFound TRUE )
+    set( maxBucketSize 0 )
+
+    foreach( bucket RANGE ${bucketMask} )
+        set( bucket_${bucket} "" )
+        set( displacement_${bucket} 0 )
+    endforeach()
+
+    foreach( slot RANGE ${slotMask} )
+        set( slot_${slot} -1 )
+    endforeach()
+
+    set( index 0 )
+
+    foreach( token ${tokens} )
+        set( hash ${seed} )
+        string( LENGTH "${token}" tokenLength )
+        math( EXPR lastChar "${tokenLength} - 1" )
+
+        foreach( charIndex RANGE ${lastChar} )
+            string( SUBSTRING "${token}" ${charIndex} 1 char )
+            string( FIND "${lowerChars}" "${char}" code )
+
+            if( code GREATER -1 )
+                math( EXPR code "${code} + 97" )
+            else()
+                string( FIND "${digitChars}" "${char}" code )
+
+                if( code GREATER -1 )
+                    math( EXPR code "${code} + 48" )
+                else()
+                    set( code 95 )      # '_'
+                endif()
+            endif()
+
+            math( EXPR hash "( ( ${hash} * 33 ) ^ ${code} ) & 16777215" )
+        endforeach()
+
+        math( EXPR hash "${hash} ^ ( ${hash} >> 12 )" )
+        math( EXPR bucket "${hash} & ${bucketMask}" )
+        set( hash_${index} ${hash} )
+        list( APPEND bucket_${bucket} ${index} )
+        list( LENGTH bucket_${bucket} bucketSize )
+
+        if( bucketSize GREATER maxBucketSize )
+            set( maxBucketSize ${bucketSize} )
+        endif()
+
+        math( EXPR index "${index} + 1" )
+    endforeach()
+
+    set( bucketSize ${maxBucketSize} )
+
+    while( hashFound AND bucketSize GREATER 0 )
+        foreach( bucket RANGE ${bucketMask} )
+            list( LENGTH bucket_${bucket} size )
+
+            if( hashFound AND size EQUAL bucketSize )
+                set( placed FALSE )
+                set( displacement 0 )
+
+                while( NOT placed AND displacement LESS slotCount )
+                    set( placed TRUE )
+                    set( bucketSlots "" )
+
+                    foreach( index ${bucket_${bucket}} )
+                        set( hash ${hash_${index}} )
+                        math( EXPR slot
+                              "( ( ${hash} >> 4 ) + ${displacement} * ( ( ${hash} >> 12 ) | 1 ) ) & ${slotMask}" )
+                        list( FIND bucketSlots ${slot} sameSlot )
+
+                        if( NOT slot_${slot} EQUAL -1 OR sameSlot GREATER -1 )
+                            set( placed FALSE )
+                        endif()
+
+                        list( APPEND bucketSlots ${slot} )
+                    endforeach()
+
+                    if( placed )
+                        set( displacement_${bucket} ${displacement} )
+
+                        foreach( index ${bucket_${bucket}} )
+                            list( GET bucketSlots 0 slot )
+                            list( REMOVE_AT bucketSlots 0 )
+                            set( slot_${slot} ${index} )
+                        endforeach()
+                    else()
+                        math( EXPR displacement "${displacement} + 1" )
+                    endif()
+                endwhile()
+
+                if( NOT placed )
+                    set( hashFound FALSE )
+                endif()
+            endif()
+        endforeach()
+
+        math( EXPR bucketSize "${bucketSize} - 1" )
+    endwhile()
+
+    if( NOT hashFound )
+        math( EXPR seed "${seed} + 1" )
+    endif()
+endwhile()
+
+if( NOT hashFound )
+    message( FATAL_ERROR "${dsnErrorMsg} no perfect hash found for the tokens in file <${inputFile}>." )
+endif()
+
 file( WRITE "${outHeaderFile}" "${includeFileHeader}" )
 file( WRITE "${outCppFile}" "${sourceFileHeader}" )
 
@@ -240,6 +378,9 @@ class ${LEXERCLASS} : public DSNLEXER
     static const KEYWORD  keywords[];
     static const unsigned keyword_count;
 
+    /// Auto generated perfect hash of the keywords table
+    static const KEYWORD_HASH keywords_hash;
+
 public:
     /**
      * Constructor ( const std::string&, const wxString& )
@@ -248,7 +389,7 @@ public:
      *   If left empty, then _(\"clipboard\") is used.
      */
     ${LEXERCLASS}( const std::string& aSExpression, const wxString& aSource = wxEmptyString ) :
-        DSNLEXER( keywords, keyword_count, aSExpression, aSource )
+        DSNLEXER( keywords, keyword_count, aSExpression, aSource, &keywords_hash )
     {
     }
 
@@ -262,7 +403,7 @@ public:
      * @param aFilename is the name of the opened file, needed for error reporting.
      */
     ${LEXERCLASS}( FILE* aFile, const wxString& aFilename ) :
-        DSNLEXER( keywords, keyword_count, aFile, aFilename )
+        DSNLEXER( keywords, keyword_count, aFile, aFilename, &keywords_hash )
     {
     }
 
@@ -278,7 +419,7 @@ public:
      *  STRING_LINE_READER or FILE_LINE_READER.  No ownership is taken of aLineReader.
      */
     ${LEXERCLASS}( LINE_READER* aLineReader ) :
-        DSNLEXER( keywords, keyword_count, aLineReader )
+        DSNLEXER( keywords, keyword_count, aLineReader, &keywords_hash )
     {
     }
 
@@ -364,11 +505,43 @@ class ${PARSERCLASS} : public ${LEXERCLASS}
 "
 )
 
+set( hashTables "static const short keyword_slots[] = {" )
+
+foreach( slot RANGE ${slotMask} )
+    math( EXPR column "${slot} % 16" )
+
+    if( column EQUAL 0 )
+        set( hashTables "${hashTables}\n   " )
+    endif()
+
+    set( hashTables "${hashTables} ${slot_${slot}}," )
+endforeach()
+
+set( hashTables "${hashTables}\n};\n\nstatic const unsigned short keyword_displacements[] = {" )
+
+foreach( bucket RANGE ${bucketMask} )
+    math( EXPR column "${bucket} % 16" )
+
+    if( column EQUAL 0 )
+        set( hashTables "${hashTables}\n   " )
+    endif()
+
+    set( hashTables "${hashTables} ${displacement_${bucket}}," )
+endforeach()
+
+set( hashTables "${hashTables}\n};\n" )
+
 file( APPEND "${outCppFile}"
 "};
 
 const unsigned ${LEXERCLASS}::keyword_count = unsigned( sizeof( ${LEXERCLASS}::keywords )/sizeof( ${LEXERCLASS}::keywords[0] ) );
 
+${hashTables}
+const KEYWORD_HASH ${LEXERCLASS}::keywords_hash =
+{
+    ${seed}, ${bucketMask}, keyword_displacements, ${slotMask}, keyword_slots
+};
+
 
 const char* ${LEXERCLASS}::TokenName( T aTok )
 {
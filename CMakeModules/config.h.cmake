@@ -50,6 +50,9 @@
 // Use Posix getc_unlocked() instead of getc() when it's available.
 #cmakedefine HAVE_FGETC_NOLOCK
 
+// Map large files in memory with Posix mmap() when it's available.
+#cmakedefine HAVE_MMAP
+
 // Warning!!!  Using wxGraphicContext for rendering is experimental.
 #cmakedefine USE_WX_GRAPHICS_CONTEXT    1
 
@@ -88,6 +88,31 @@ static const wxChar AllowLegacyCanvasInGtk3[] = wxT( "AllowLegacyCanvasInGtk3" )
  */
 static const wxChar CoroutineStackSize[] = wxT( "CoroutineStackSize" );
 
+/**
+ * Number of worker threads shared by the parallel algorithms (zone filling, connectivity,
+ * DRC, raytracing...).  0 means one per hardware thread.  Setting it to 1 runs them all on
+ * one worker, which can help debugging.
+ */
+static const wxChar ThreadPoolSize[] = wxT( "ThreadPoolSize" );
+
+/**
+ * Parse the items of the board files on several threads.  Setting it to false parses them
+ * one after another, as when loading footprints.
+ */
+static const wxChar ParallelBoardLoad[] = wxT( "ParallelBoardLoad" );
+
+/**
+ * Parse the sheet files of the schematics on several threads, one level of the hierarchy
+ * after another.  Setting it to false loads them one after another.
+ */
+static const wxChar ParallelSchematicLoad[] = wxT( "ParallelSchematicLoad" );
+
+/**
+ * Keep a binary snapshot of each board next to its file, which opens it again quickly as
+ * long as the board file is unchanged.
+ */
+static const wxChar BoardSnapshots[] = wxT( "BoardSnapshots" );
+
 } // namespace KEYS
 
 
@@ -169,6 +194,10 @@ ADVANCED_CFG::ADVANCED_CFG()
     m_allowLegacyCanvasInGtk3 = false;
     m_realTimeConnectivity = true;
     m_coroutineStackSize = AC_STACK::default_stack;
+    m_threadPoolSize = 0;
+    m_parallelBoardLoad = true;
+    m_parallelSchematicLoad = true;
+    m_boardSnapshots = true;
 
     loadFromConfigFile();
 }
@@ -215,6 +244,18 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
             new PARAM_CFG_INT( true, AC_KEYS::CoroutineStackSize, &m_coroutineStackSize,
                     AC_STACK::default_stack, AC_STACK::min_stack, AC_STACK::max_stack ) );
 
+    configParams.push_back(
+            new PARAM_CFG_INT( true, AC_KEYS::ThreadPoolSize, &m_threadPoolSize, 0, 0, 256 ) );
+
+    configParams.push_back(
+            new PARAM_CFG_BOOL( true, AC_KEYS::ParallelBoardLoad, &m_parallelBoardLoad, true ) );
+
+    configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::ParallelSchematicLoad,
+                                                &m_parallelSchematicLoad, true ) );
+
+    configParams.push_back(
+            new PARAM_CFG_BOOL( true, AC_KEYS::BoardSnapshots, &m_boardSnapshots, true ) );
+
     wxConfigLoadSetups( &aCfg, configParams );
 
     dumpCfg( configParams );
@@ -34,11 +34,14 @@
  *       depending on the application.
  */
 
+#include <cmath>
+
 #include <macros.h>
 #include <base_struct.h>
 #include <title_block.h>
 #include <common.h>
 #include <base_units.h>
+#include <number_io.h>
 #include "libeval/numeric_evaluator.h"
 
 
@@ -69,7 +72,7 @@ std::string Double2Str( double aValue )
     {
         // For these small values, %f works fine,
         // and %g gives an exponent
-        len = sprintf( buf,  "%.16f", aValue );
+        len = FormatDouble( buf, sizeof( buf ), "%.16f", aValue );
 
         while( --len > 0 && buf[len] == '0' )
             buf[len] = '\0';
@@ -83,7 +86,7 @@ std::string Double2Str( double aValue )
     {
         // For these values, %g works fine, and sometimes %f
         // gives a bad value (try aValue = 1.222222222222, with %.16f format!)
-        len = sprintf( buf, "%.16g", aValue );
+        len = FormatDouble( buf, sizeof( buf ), "%.16g", aValue );
     }
 
     return std::string( buf, len );
@@ -475,34 +478,68 @@ wxString GetAbbreviatedUnitsLabel( EDA_UNITS_T aUnit, bool aUseMils )
 }
 
 
-std::string FormatInternalUnits( int aValue )
+#ifndef EESCHEMA
+/**
+ * Number of fractional digits of a length in mm written with the full internal units
+ * resolution: IU_PER_MM is a power of ten.
+ */
+static constexpr int iuDecimals()
 {
-    char    buf[50];
-    double  engUnits = aValue;
-    int     len;
+    int decimals = 0;
 
-#ifndef EESCHEMA
-    engUnits /= IU_PER_MM;
-#endif
+    for( double scale = IU_PER_MM; scale > 1.0; scale /= 10.0 )
+        decimals++;
 
-    if( engUnits != 0.0 && fabs( engUnits ) <= 0.0001 )
-    {
-        len = snprintf( buf, sizeof(buf), "%.10f", engUnits );
+    return decimals;
+}
 
-        while( --len > 0 && buf[len] == '0' )
-            buf[len] = '\0';
 
-#ifndef EESCHEMA
-        if( buf[len] == '.' )
-            buf[len] = '\0';
-        else
+static constexpr double powerOfTen( int aExponent )
+{
+    return aExponent > 0 ? 10.0 * powerOfTen( aExponent - 1 ) : 1.0;
+}
+
+
+static_assert( powerOfTen( iuDecimals() ) == IU_PER_MM,
+               "FormatInternalUnits() needs IU_PER_MM to be a power of ten" );
 #endif
-            ++len;
-    }
-    else
-    {
-        len = snprintf( buf, sizeof(buf), "%.10g", engUnits );
-    }
+
+
+/**
+ * Writes aValue in mm in aBuffer, which has to hold at least 24 + 18 characters.
+ * @return the length of the text.
+ */
+static int formatInternalUnits( char* aBuffer, int aValue )
+{
+    // An int has at most 10 digits, so this is exactly what "%.10g" (or "%.10f" for the
+    // small values) gives once the trailing zeros are removed, without the double division
+#ifdef EESCHEMA
+    return FormatFixedPoint( aBuffer, aValue, 0 );
+#else
+    return FormatFixedPoint( aBuffer, aValue, iuDecimals() );
+#endif
+}
+
+
+/**
+ * Writes the pair aX aY in aBuffer, which has to hold at least 2 * ( 24 + 18 ) + 1
+ * characters.
+ * @return the length of the text.
+ */
+static int formatInternalUnits( char* aBuffer, int aX, int aY )
+{
+    int len = formatInternalUnits( aBuffer, aX );
+
+    aBuffer[len++] = ' ';
+
+    return len + formatInternalUnits( aBuffer + len, aY );
+}
+
+
+std::string FormatInternalUnits( int aValue )
+{
+    char    buf[50];
+    int     len = formatInternalUnits( buf, aValue );
 
     return std::string( buf, len );
 }
@@ -513,7 +550,13 @@ std::string FormatAngle( double aAngle )
     char temp[50];
     int len;
 
-    len = snprintf( temp, sizeof(temp), "%.10g", aAngle / 10.0 );
+    // The angles are nearly always a whole number of tenths of degree, which "%.10g" prints
+    // exactly
+    if( aAngle == std::trunc( aAngle ) && std::fabs( aAngle ) < 1e9
+            && ( aAngle != 0.0 || !std::signbit( aAngle ) ) )
+        len = FormatFixedPoint( temp, (long long) aAngle, 1 );
+    else
+        len = FormatDouble( temp, sizeof(temp), "%.10g", aAngle / 10.0 );
 
     return std::string( temp, len );
 }
@@ -521,18 +564,42 @@ std::string FormatAngle( double aAngle )
 
 std::string FormatInternalUnits( const wxPoint& aPoint )
 {
-    return FormatInternalUnits( aPoint.x ) + " " + FormatInternalUnits( aPoint.y );
+    return FMT_IU( aPoint ).c_str();
 }
 
 
 std::string FormatInternalUnits( const VECTOR2I& aPoint )
 {
-    return FormatInternalUnits( aPoint.x ) + " " + FormatInternalUnits( aPoint.y );
+    return FMT_IU( aPoint ).c_str();
 }
 
 
 std::string FormatInternalUnits( const wxSize& aSize )
 {
-    return FormatInternalUnits( aSize.GetWidth() ) + " " + FormatInternalUnits( aSize.GetHeight() );
+    return FMT_IU( aSize ).c_str();
+}
+
+
+FMT_IU::FMT_IU( int aValue )
+{
+    m_length = formatInternalUnits( m_text, aValue );
+}
+
+
+FMT_IU::FMT_IU( const wxPoint& aPoint )
+{
+    m_length = formatInternalUnits( m_text, aPoint.x, aPoint.y );
+}
+
+
+FMT_IU::FMT_IU( const wxSize& aSize )
+{
+    m_length = formatInternalUnits( m_text, aSize.GetWidth(), aSize.GetHeight() );
+}
+
+
+FMT_IU::FMT_IU( const VECTOR2I& aPoint )
+{
+    m_length = formatInternalUnits( m_text, aPoint.x, aPoint.y );
 }
 
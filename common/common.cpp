@@ -34,6 +34,7 @@
 #include <macros.h>
 #include <base_units.h>
 #include <reporter.h>
+#include <atomic>
 #include <mutex>
 
 #include <wx/process.h>
@@ -216,15 +217,18 @@ int ProcessExecute( const wxString& aCommandLine, int aFlags, wxProcess *callbac
 
 timestamp_t GetNewTimeStamp()
 {
-    static timestamp_t oldTimeStamp;
-    timestamp_t newTimeStamp;
-
-    newTimeStamp = time( NULL );
+    // Items are also created while parsing boards and schematics on worker threads, so the
+    // last stamp is claimed atomically
+    static std::atomic<timestamp_t> oldTimeStamp( 0 );
 
-    if( newTimeStamp <= oldTimeStamp )
-        newTimeStamp = oldTimeStamp + 1;
+    timestamp_t now = time( NULL );
+    timestamp_t last = oldTimeStamp.load();
+    timestamp_t newTimeStamp;
 
-    oldTimeStamp = newTimeStamp;
+    do
+    {
+        newTimeStamp = ( now <= last ) ? last + 1 : now;
+    } while( !oldTimeStamp.compare_exchange_weak( last, newTimeStamp ) );
 
     return newTimeStamp;
 }
@@ -54,6 +54,10 @@ void DSNLEXER::init()
 
     curOffset = 0;
 
+    // The perfect hash of the generated lexers spares building the hashtable for each lexer.
+    if( keywordHash )
+        return;
+
 #if 1
     if( keywordCount > 11 )
     {
@@ -74,14 +78,16 @@ void DSNLEXER::init()
 
 
 DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-                    FILE* aFile, const wxString& aFilename ) :
+                    FILE* aFile, const wxString& aFilename,
+                    const KEYWORD_HASH* aKeywordHash ) :
     iOwnReaders( true ),
     start( NULL ),
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
     keywords( aKeywordTable ),
-    keywordCount( aKeywordCount )
+    keywordCount( aKeywordCount ),
+    keywordHash( aKeywordHash )
 {
     FILE_LINE_READER* fileReader = new FILE_LINE_READER( aFile, aFilename );
     PushReader( fileReader );
@@ -90,14 +96,16 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
 
 
 DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-                    const std::string& aClipboardTxt, const wxString& aSource ) :
+                    const std::string& aClipboardTxt, const wxString& aSource,
+                    const KEYWORD_HASH* aKeywordHash ) :
     iOwnReaders( true ),
     start( NULL ),
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
     keywords( aKeywordTable ),
-    keywordCount( aKeywordCount )
+    keywordCount( aKeywordCount ),
+    keywordHash( aKeywordHash )
 {
     STRING_LINE_READER* stringReader = new STRING_LINE_READER( aClipboardTxt, aSource.IsEmpty() ?
                                         wxString( FMT_CLIPBOARD ) : aSource );
@@ -107,14 +115,15 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
 
 
 DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-                    LINE_READER* aLineReader ) :
+                    LINE_READER* aLineReader, const KEYWORD_HASH* aKeywordHash ) :
     iOwnReaders( false ),
     start( NULL ),
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
     keywords( aKeywordTable ),
-    keywordCount( aKeywordCount )
+    keywordCount( aKeywordCount ),
+    keywordHash( aKeywordHash )
 {
     if( aLineReader )
         PushReader( aLineReader );
@@ -131,7 +140,8 @@ DSNLEXER::DSNLEXER( const std::string& aSExpression, const wxString& aSource ) :
     limit( NULL ),
     reader( NULL ),
     keywords( empty_keywords ),
-    keywordCount( 0 )
+    keywordCount( 0 ),
+    keywordHash( NULL )
 {
     STRING_LINE_READER* stringReader = new STRING_LINE_READER( aSExpression, aSource.IsEmpty() ?
                                         wxString( FMT_CLIPBOARD ) : aSource );
@@ -259,6 +269,16 @@ int DSNLEXER::findToken( const std::string& tok )
 
 inline int DSNLEXER::findToken( const std::string& tok )
 {
+    if( keywordHash )
+    {
+        int index = keywordHash->Lookup( tok.data(), tok.size() );
+
+        if( index >= 0 && tok == keywords[index].name )
+            return keywords[index].token;
+
+        return DSN_SYMBOL;
+    }
+
     KEYWORD_MAP::const_iterator it = keyword_hash.find( tok.c_str() );
     if( it != keyword_hash.end() )
         return it->second;
@@ -777,11 +797,11 @@ L_read:
     }           // specctraMode
 
     // non-quoted token, read it into curText.
-    curText.clear();
-
     head = cur;
     while( head<limit && !isSep( *head ) )
-        curText += *head++;
+        ++head;
+
+    curText.assign( cur, head );
 
     if( isNumber( curText.c_str(), curText.c_str() + curText.size() ) )
     {
@@ -0,0 +1,341 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <geometry/seg_batch.h>
+
+#if defined( __AVX__ )
+#include <immintrin.h>
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#include <emmintrin.h>
+#define SEG_BATCH_SSE2
+#endif
+
+
+const int SEG_BATCH::CHUNK_SIZE;
+constexpr double SEG_BATCH::NEAREST_POINT_TOLERANCE;
+
+
+namespace
+{
+
+/**
+ * The operations of the kernels on one segment at a time, for the targets without SIMD and
+ * for the last segments of the ranges.
+ */
+struct SCALAR_LANES
+{
+    typedef double VEC;
+
+    static const int WIDTH = 1;
+
+    static VEC  Load( const double* aPtr )          { return *aPtr; }
+    static VEC  Set( double aValue )                { return aValue; }
+    static void Store( double* aPtr, VEC aValue )   { *aPtr = aValue; }
+    static VEC  Add( VEC aA, VEC aB )               { return aA + aB; }
+    static VEC  Sub( VEC aA, VEC aB )               { return aA - aB; }
+    static VEC  Mul( VEC aA, VEC aB )               { return aA * aB; }
+    static VEC  Min( VEC aA, VEC aB )               { return aA < aB ? aA : aB; }
+    static VEC  Max( VEC aA, VEC aB )               { return aA > aB ? aA : aB; }
+
+    /// @return aValue where aCond > 0, 0 elsewhere
+    static VEC  ZeroUnlessPositive( VEC aCond, VEC aValue )
+    {
+        return aCond > 0.0 ? aValue : 0.0;
+    }
+};
+
+
+#if defined( __AVX__ )
+
+struct SIMD_LANES
+{
+    typedef __m256d VEC;
+
+    static const int WIDTH = 4;
+
+    static VEC  Load( const double* aPtr )          { return _mm256_loadu_pd( aPtr ); }
+    static VEC  Set( double aValue )                { return _mm256_set1_pd( aValue ); }
+    static void Store( double* aPtr, VEC aValue )   { _mm256_storeu_pd( aPtr, aValue ); }
+    static VEC  Add( VEC aA, VEC aB )               { return _mm256_add_pd( aA, aB ); }
+    static VEC  Sub( VEC aA, VEC aB )               { return _mm256_sub_pd( aA, aB ); }
+    static VEC  Mul( VEC aA, VEC aB )               { return _mm256_mul_pd( aA, aB ); }
+    static VEC  Min( VEC aA, VEC aB )               { return _mm256_min_pd( aA, aB ); }
+    static VEC  Max( VEC aA, VEC aB )               { return _mm256_max_pd( aA, aB ); }
+
+    static VEC  ZeroUnlessPositive( VEC aCond, VEC aValue )
+    {
+        return _mm256_and_pd( _mm256_cmp_pd( aCond, _mm256_setzero_pd(), _CMP_GT_OQ ), aValue );
+    }
+};
+
+#elif defined( SEG_BATCH_SSE2 )
+
+struct SIMD_LANES
+{
+    typedef __m128d VEC;
+
+    static const int WIDTH = 2;
+
+    static VEC  Load( const double* aPtr )          { return _mm_loadu_pd( aPtr ); }
+    static VEC  Set( double aValue )                { return _mm_set1_pd( aValue ); }
+    static void Store( double* aPtr, VEC aValue )   { _mm_storeu_pd( aPtr, aValue ); }
+    static VEC  Add( VEC aA, VEC aB )               { return _mm_add_pd( aA, aB ); }
+    static VEC  Sub( VEC aA, VEC aB )               { return _mm_sub_pd( aA, aB ); }
+    static VEC  Mul( VEC aA, VEC aB )               { return _mm_mul_pd( aA, aB ); }
+    static VEC  Min( VEC aA, VEC aB )               { return _mm_min_pd( aA, aB ); }
+    static VEC  Max( VEC aA, VEC aB )               { return _mm_max_pd( aA, aB ); }
+
+    static VEC  ZeroUnlessPositive( VEC aCond, VEC aValue )
+    {
+        return _mm_and_pd( _mm_cmpgt_pd( aCond, _mm_setzero_pd() ), aValue );
+    }
+};
+
+#else
+
+typedef SCALAR_LANES SIMD_LANES;
+
+#endif
+
+
+/**
+ * Cross products of coordinates up to 2^32 are rounded by less than this
+ */
+const double CROSS_PRODUCT_TOLERANCE = 1.0e5;
+
+
+struct SEG_ARRAYS
+{
+    const double* m_ax;
+    const double* m_ay;
+    const double* m_dx;
+    const double* m_dy;
+    const double* m_invLengthSq;
+};
+
+
+/**
+ * @return the squared distances between the segments ( 0, aD ) and the points aV
+ */
+template <typename L>
+inline typename L::VEC pointSegment( typename L::VEC aVx, typename L::VEC aVy,
+                                     typename L::VEC aDx, typename L::VEC aDy,
+                                     typename L::VEC aInvLengthSq )
+{
+    typename L::VEC t = L::Add( L::Mul( aVx, aDx ), L::Mul( aVy, aDy ) );
+    typename L::VEC u = L::Min( L::Max( L::Mul( t, aInvLengthSq ), L::Set( 0.0 ) ),
+                                L::Set( 1.0 ) );
+
+    typename L::VEC ex = L::Sub( aVx, L::Mul( u, aDx ) );
+    typename L::VEC ey = L::Sub( aVy, L::Mul( u, aDy ) );
+
+    return L::Add( L::Mul( ex, ex ), L::Mul( ey, ey ) );
+}
+
+
+/**
+ * @return a value <= 0 if the cross products aC1 and aC2 may have different signs
+ */
+template <typename L>
+inline typename L::VEC straddle( typename L::VEC aC1, typename L::VEC aC2 )
+{
+    const typename L::VEC tol = L::Set( CROSS_PRODUCT_TOLERANCE );
+
+    return L::Max( L::Sub( L::Min( aC1, aC2 ), tol ),
+                   L::Sub( L::Sub( L::Set( 0.0 ), L::Max( aC1, aC2 ) ), tol ) );
+}
+
+
+/**
+ * Measures the segments aFirst to aEnd - 1 from aP, as many as the lanes of L can.
+ * @return the index of the first segment left.
+ */
+template <typename L>
+int pointDistances( const SEG_ARRAYS& aSegs, const VECTOR2I& aP, int aFirst, int aEnd,
+                    double* aDist )
+{
+    const typename L::VEC px = L::Set( aP.x );
+    const typename L::VEC py = L::Set( aP.y );
+
+    int i = aFirst;
+
+    for( ; i + L::WIDTH <= aEnd; i += L::WIDTH )
+    {
+        typename L::VEC vx = L::Sub( px, L::Load( aSegs.m_ax + i ) );
+        typename L::VEC vy = L::Sub( py, L::Load( aSegs.m_ay + i ) );
+
+        L::Store( aDist + i - aFirst,
+                  pointSegment<L>( vx, vy, L::Load( aSegs.m_dx + i ), L::Load( aSegs.m_dy + i ),
+                                   L::Load( aSegs.m_invLengthSq + i ) ) );
+    }
+
+    return i;
+}
+
+
+/**
+ * Measures the segments aFirst to aEnd - 1 from aSeg, as many as the lanes of L can.
+ * @return the index of the first segment left.
+ */
+template <typename L>
+int segmentDistances( const SEG_ARRAYS& aSegs, const SEG& aSeg, int aFirst, int aEnd,
+                      double* aDist )
+{
+    const VECTOR2I e = aSeg.B - aSeg.A;
+    const double   lengthSq = (double) e.x * e.x + (double) e.y * e.y;
+
+    const typename L::VEC cx = L::Set( aSeg.A.x );
+    const typename L::VEC cy = L::Set( aSeg.A.y );
+    const typename L::VEC ex = L::Set( e.x );
+    const typename L::VEC ey = L::Set( e.y );
+    const typename L::VEC invLengthSq = L::Set( lengthSq > 0.0 ? 1.0 / lengthSq : 0.0 );
+
+    int i = aFirst;
+
+    for( ; i + L::WIDTH <= aEnd; i += L::WIDTH )
+    {
+        typename L::VEC dx = L::Load( aSegs.m_dx + i );
+        typename L::VEC dy = L::Load( aSegs.m_dy + i );
+
+        // the ends of aSeg from the start of the segment, and the other way
+        typename L::VEC v0x = L::Sub( cx, L::Load( aSegs.m_ax + i ) );
+        typename L::VEC v0y = L::Sub( cy, L::Load( aSegs.m_ay + i ) );
+        typename L::VEC v1x = L::Add( v0x, ex );
+        typename L::VEC v1y = L::Add( v0y, ey );
+        typename L::VEC w0x = L::Sub( L::Set( 0.0 ), v0x );
+        typename L::VEC w0y = L::Sub( L::Set( 0.0 ), v0y );
+        typename L::VEC w1x = L::Add( w0x, dx );
+        typename L::VEC w1y = L::Add( w0y, dy );
+
+        typename L::VEC invSq = L::Load( aSegs.m_invLengthSq + i );
+
+        typename L::VEC dist = L::Min(
+                L::Min( pointSegment<L>( v0x, v0y, dx, dy, invSq ),
+                        pointSegment<L>( v1x, v1y, dx, dy, invSq ) ),
+                L::Min( pointSegment<L>( w0x, w0y, ex, ey, invLengthSq ),
+                        pointSegment<L>( w1x, w1y, ex, ey, invLengthSq ) ) );
+
+        // The segments crossing each other have their ends on both sides of the other one
+        typename L::VEC c0 = L::Sub( L::Mul( dx, v0y ), L::Mul( dy, v0x ) );
+        typename L::VEC c1 = L::Sub( L::Mul( dx, v1y ), L::Mul( dy, v1x ) );
+        typename L::VEC c2 = L::Sub( L::Mul( ex, w0y ), L::Mul( ey, w0x ) );
+        typename L::VEC c3 = L::Sub( L::Mul( ex, w1y ), L::Mul( ey, w1x ) );
+
+        typename L::VEC apart = L::Max( straddle<L>( c0, c1 ), straddle<L>( c2, c3 ) );
+
+        L::Store( aDist + i - aFirst, L::ZeroUnlessPositive( apart, dist ) );
+    }
+
+    return i;
+}
+
+}
+
+
+void SEG_BATCH::Reserve( int aCount )
+{
+    m_ax.reserve( aCount );
+    m_ay.reserve( aCount );
+    m_dx.reserve( aCount );
+    m_dy.reserve( aCount );
+    m_invLengthSq.reserve( aCount );
+    m_approximated.reserve( aCount );
+    m_segs.reserve( aCount );
+}
+
+
+void SEG_BATCH::Add( const SEG& aSeg )
+{
+    const VECTOR2I d = aSeg.B - aSeg.A;
+    const double   lengthSq = (double) d.x * d.x + (double) d.y * d.y;
+
+    m_ax.push_back( aSeg.A.x );
+    m_ay.push_back( aSeg.A.y );
+    m_dx.push_back( d.x );
+    m_dy.push_back( d.y );
+    m_invLengthSq.push_back( lengthSq > 0.0 ? 1.0 / lengthSq : 0.0 );
+    m_approximated.push_back( isApproximated( d ) );
+    m_segs.push_back( aSeg );
+}
+
+
+void SEG_BATCH::Clear()
+{
+    m_ax.clear();
+    m_ay.clear();
+    m_dx.clear();
+    m_dy.clear();
+    m_invLengthSq.clear();
+    m_approximated.clear();
+    m_segs.clear();
+}
+
+
+void SEG_BATCH::SquaredDistances( const VECTOR2I& aP, int aFirst, int aEnd,
+                                  double* aDist ) const
+{
+    const SEG_ARRAYS segs = { m_ax.data(), m_ay.data(), m_dx.data(), m_dy.data(),
+                              m_invLengthSq.data() };
+
+    int i = pointDistances<SIMD_LANES>( segs, aP, aFirst, aEnd, aDist );
+
+    pointDistances<SCALAR_LANES>( segs, aP, i, aEnd, aDist + i - aFirst );
+}
+
+
+void SEG_BATCH::SquaredDistances( const SEG& aSeg, int aFirst, int aEnd, double* aDist ) const
+{
+    const SEG_ARRAYS segs = { m_ax.data(), m_ay.data(), m_dx.data(), m_dy.data(),
+                              m_invLengthSq.data() };
+
+    int i = segmentDistances<SIMD_LANES>( segs, aSeg, aFirst, aEnd, aDist );
+
+    segmentDistances<SCALAR_LANES>( segs, aSeg, i, aEnd, aDist + i - aFirst );
+}
+
+
+SEG::ecoord SEG_BATCH::SquaredDistance( const VECTOR2I& aP, int aFirst, int aEnd ) const
+{
+    SEG::ecoord best = VECTOR2I::ECOORD_MAX;
+    double      dist[CHUNK_SIZE];
+
+    for( int first = aFirst; first < aEnd; first += CHUNK_SIZE )
+    {
+        int end = std::min( first + CHUNK_SIZE, aEnd );
+
+        SquaredDistances( aP, first, end, dist );
+
+        // The nearest segment for SEG may be farther than the nearest one here, by the
+        // rounding of both their nearest points
+        double nearest = *std::min_element( dist, dist + end - first );
+        double limit = std::sqrt( nearest ) + 2 * NEAREST_POINT_TOLERANCE;
+
+        for( int i = first; i < end; i++ )
+        {
+            if( dist[i - first] <= limit * limit )
+                best = std::min( best, m_segs[i].SquaredDistance( aP ) );
+        }
+    }
+
+    return best;
+}
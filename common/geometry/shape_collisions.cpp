@@ -150,16 +150,11 @@ static VECTOR2I pushoutForce( const SHAPE_CIRCLE& aA, const SEG& aB, int aCleara
 static inline bool Collide( const SHAPE_CIRCLE& aA, const SHAPE_LINE_CHAIN& aB, int aClearance,
                             bool aNeedMTV, VECTOR2I& aMTV )
 {
-    bool found = false;
-
-    for( int s = 0; s < aB.SegmentCount(); s++ )
-    {
-        if( aA.Collide( aB.CSegment( s ), aClearance ) )
-        {
-            found = true;
-            break;
-        }
-    }
+    bool found = aB.QuerySegments( aA.BBox( std::abs( aClearance ) ),
+                                   [&]( int s )
+                                   {
+                                       return aA.Collide( aB.CSegment( s ), aClearance );
+                                   } );
 
     if( !aNeedMTV || !found )
         return found;
@@ -221,11 +216,12 @@ static inline bool Collide( const SHAPE_CIRCLE& aA, const SHAPE_SEGMENT& aSeg, i
 static inline bool Collide( const SHAPE_LINE_CHAIN& aA, const SHAPE_LINE_CHAIN& aB, int aClearance,
                             bool aNeedMTV, VECTOR2I& aMTV )
 {
-    for( int i = 0; i < aB.SegmentCount(); i++ )
-        if( aA.Collide( aB.CSegment( i ), aClearance ) )
-            return true;
-
-    return false;
+    // only the segments of aB near aA can collide with it
+    return aB.QuerySegments( aA.BBox( std::abs( aClearance ) ),
+                             [&]( int i )
+                             {
+                                 return aA.Collide( aB.CSegment( i ), aClearance );
+                             } );
 }
 
 
@@ -246,15 +242,13 @@ static inline bool Collide( const SHAPE_SIMPLE& aA, const SHAPE_SIMPLE& aB, int
 static inline bool Collide( const SHAPE_RECT& aA, const SHAPE_LINE_CHAIN& aB, int aClearance,
                             bool aNeedMTV, VECTOR2I& aMTV )
 {
-    for( int s = 0; s < aB.SegmentCount(); s++ )
-    {
-        SEG seg = aB.CSegment( s );
+    return aB.QuerySegments( aA.BBox( std::abs( aClearance ) ),
+                             [&]( int s )
+                             {
+                                 SEG seg = aB.CSegment( s );
 
-        if( aA.Collide( seg, aClearance ) )
-            return true;
-    }
-
-    return false;
+                                 return aA.Collide( seg, aClearance );
+                             } );
 }
 
 
@@ -30,6 +30,79 @@
 #include "clipper.hpp"
 
 
+const int SEGMENT_BVH::LEAF_SIZE;
+const int SEGMENT_BVH::MIN_SEGMENTS;
+
+
+SEGMENT_BVH::SEGMENT_BVH( const SHAPE_LINE_CHAIN& aChain ) :
+    m_segmentCount( aChain.SegmentCount() )
+{
+    std::vector<BOX2I> leaves;
+
+    leaves.reserve( ( m_segmentCount + LEAF_SIZE - 1 ) / LEAF_SIZE );
+    m_batch.Reserve( m_segmentCount );
+
+    for( int i = 0; i < m_segmentCount; i++ )
+        m_batch.Add( aChain.CSegment( i ) );
+
+    for( int first = 0; first < m_segmentCount; first += LEAF_SIZE )
+    {
+        int end = std::min( first + LEAF_SIZE, m_segmentCount );
+        BOX2I box( aChain.CPoint( first ), VECTOR2I( 0, 0 ) );
+
+        // CPoint() wraps around to the first point for the closing segment
+        for( int i = first + 1; i <= end; i++ )
+            box.Merge( aChain.CPoint( i ) );
+
+        leaves.push_back( box );
+    }
+
+    m_levels.push_back( std::move( leaves ) );
+
+    while( m_levels.back().size() > 1 )
+    {
+        const std::vector<BOX2I>& below = m_levels.back();
+        std::vector<BOX2I> level;
+
+        level.reserve( ( below.size() + 1 ) / 2 );
+
+        for( size_t i = 0; i < below.size(); i += 2 )
+        {
+            BOX2I box = below[i];
+
+            if( i + 1 < below.size() )
+                box.Merge( below[i + 1] );
+
+            level.push_back( box );
+        }
+
+        m_levels.push_back( std::move( level ) );
+    }
+}
+
+
+std::shared_ptr<const SEGMENT_BVH> SHAPE_LINE_CHAIN::segmentBVH() const
+{
+    if( SegmentCount() < SEGMENT_BVH::MIN_SEGMENTS )
+        return nullptr;
+
+    std::shared_ptr<const SEGMENT_BVH> bvh = std::atomic_load( &m_bvh );
+
+    if( !bvh )
+    {
+        // Threads querying the chain at once may all build it, the first one stored is kept.
+        std::shared_ptr<const SEGMENT_BVH> stored;
+
+        bvh = std::make_shared<SEGMENT_BVH>( *this );
+
+        if( !std::atomic_compare_exchange_strong( &m_bvh, &stored, bvh ) )
+            bvh = stored;
+    }
+
+    return bvh;
+}
+
+
 ClipperLib::Path SHAPE_LINE_CHAIN::convertToClipper( bool aRequiredOrientation ) const
 {
     ClipperLib::Path c_path;
@@ -63,6 +136,8 @@ void SHAPE_LINE_CHAIN::Rotate( double aAngle, const VECTOR2I& aCenter )
         (*i) = (*i).Rotate( aAngle );
         (*i) += aCenter;
     }
+
+    m_bvh.reset();
 }
 
 
@@ -71,21 +146,25 @@ bool SHAPE_LINE_CHAIN::Collide( const SEG& aSeg, int aClearance ) const
     BOX2I box_a( aSeg.A, aSeg.B - aSeg.A );
     BOX2I::ecoord_type dist_sq = (BOX2I::ecoord_type) aClearance * aClearance;
 
-    for( int i = 0; i < SegmentCount(); i++ )
-    {
-        const SEG& s = CSegment( i );
-        BOX2I box_b( s.A, s.B - s.A );
+    BOX2I seg_box( box_a );
+    seg_box.Normalize();
 
-        BOX2I::ecoord_type d = box_a.SquaredDistance( box_b );
+    auto prune = [&]( const BOX2I& aNode )
+                 {
+                     return aNode.SquaredDistance( seg_box ) >= dist_sq;
+                 };
 
-        if( d < dist_sq )
-        {
-            if( s.Collide( aSeg, aClearance ) )
-                return true;
-        }
-    }
+    auto collide = [&]( int i )
+                   {
+                       const SEG& s = CSegment( i );
+                       BOX2I box_b( s.A, s.B - s.A );
+
+                       BOX2I::ecoord_type d = box_a.SquaredDistance( box_b );
 
-    return false;
+                       return d < dist_sq && s.Collide( aSeg, aClearance );
+                   };
+
+    return walkSegmentsColliding( aSeg, aClearance, prune, collide );
 }
 
 
@@ -95,6 +174,7 @@ const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Reverse() const
 
     reverse( a.m_points.begin(), a.m_points.end() );
     a.m_closed = m_closed;
+    a.m_bvh.reset();
 
     return a;
 }
@@ -126,6 +206,8 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const VECTOR2I&
         m_points.erase( m_points.begin() + aStartIndex + 1, m_points.begin() + aEndIndex + 1 );
         m_points[aStartIndex] = aP;
     }
+
+    m_bvh.reset();
 }
 
 
@@ -139,6 +221,7 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const SHAPE_LINE
 
     m_points.erase( m_points.begin() + aStartIndex, m_points.begin() + aEndIndex + 1 );
     m_points.insert( m_points.begin() + aStartIndex, aLine.m_points.begin(), aLine.m_points.end() );
+    m_bvh.reset();
 }
 
 
@@ -151,6 +234,7 @@ void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
         aStartIndex += PointCount();
 
     m_points.erase( m_points.begin() + aStartIndex, m_points.begin() + aEndIndex + 1 );
+    m_bvh.reset();
 }
 
 
@@ -161,8 +245,30 @@ int SHAPE_LINE_CHAIN::Distance( const VECTOR2I& aP, bool aOutlineOnly ) const
     if( IsClosed() && PointInside( aP ) && !aOutlineOnly )
         return 0;
 
-    for( int s = 0; s < SegmentCount(); s++ )
-        d = std::min( d, CSegment( s ).Distance( aP ) );
+    // SEG rounds the nearest points, it finds the segments up to sqrt( 2 ) nearer than they are
+    const BOX2I point_box( aP, VECTOR2I( 0, 0 ) );
+
+    auto prune = [&]( const BOX2I& aNode )
+                 {
+                     BOX2I::ecoord_type limit = (BOX2I::ecoord_type) d + 2;
+
+                     return aNode.SquaredDistance( point_box ) >= limit * limit;
+                 };
+
+    auto distance = [&]( const SEG_BATCH* aBatch, int aFirst, int aEnd )
+                    {
+                        if( aBatch )
+                            d = std::min( d, aBatch->Distance( aP, aFirst, aEnd ) );
+                        else
+                        {
+                            for( int s = aFirst; s < aEnd; s++ )
+                                d = std::min( d, CSegment( s ).Distance( aP ) );
+                        }
+
+                        return false;
+                    };
+
+    walkSegmentRuns( prune, distance );
 
     return d;
 }
@@ -198,6 +304,7 @@ int SHAPE_LINE_CHAIN::Split( const VECTOR2I& aP )
     if( ii >= 0 )
     {
         m_points.insert( m_points.begin() + ii + 1, aP );
+        m_bvh.reset();
 
         return ii + 1;
     }
@@ -260,19 +367,22 @@ struct compareOriginDistance
 
 int SHAPE_LINE_CHAIN::Intersect( const SEG& aSeg, INTERSECTIONS& aIp ) const
 {
-    for( int s = 0; s < SegmentCount(); s++ )
-    {
-        OPT_VECTOR2I p = CSegment( s ).Intersect( aSeg );
+    QuerySegments( BOX2I( aSeg.A, aSeg.B - aSeg.A ),
+                   [&]( int s )
+                   {
+                       OPT_VECTOR2I p = CSegment( s ).Intersect( aSeg );
 
-        if( p )
-        {
-            INTERSECTION is;
-            is.our = CSegment( s );
-            is.their = aSeg;
-            is.p = *p;
-            aIp.push_back( is );
-        }
-    }
+                       if( p )
+                       {
+                           INTERSECTION is;
+                           is.our = CSegment( s );
+                           is.their = aSeg;
+                           is.p = *p;
+                           aIp.push_back( is );
+                       }
+
+                       return false;
+                   } );
 
     compareOriginDistance comp( aSeg.A );
     sort( aIp.begin(), aIp.end(), comp );
@@ -285,43 +395,56 @@ int SHAPE_LINE_CHAIN::Intersect( const SHAPE_LINE_CHAIN& aChain, INTERSECTIONS&
 {
     BOX2I bb_other = aChain.BBox();
 
-    for( int s1 = 0; s1 < SegmentCount(); s1++ )
-    {
-        const SEG& a = CSegment( s1 );
-        const BOX2I bb_cur( a.A, a.B - a.A );
-
-        if( !bb_other.Intersects( bb_cur ) )
-            continue;
-
-        for( int s2 = 0; s2 < aChain.SegmentCount(); s2++ )
-        {
-            const SEG& b = aChain.CSegment( s2 );
-            INTERSECTION is;
-
-            if( a.Collinear( b ) )
-            {
-                is.our = a;
-                is.their = b;
-
-                if( a.Contains( b.A ) ) { is.p = b.A; aIp.push_back( is ); }
-                if( a.Contains( b.B ) ) { is.p = b.B; aIp.push_back( is ); }
-                if( b.Contains( a.A ) ) { is.p = a.A; aIp.push_back( is ); }
-                if( b.Contains( a.B ) ) { is.p = a.B; aIp.push_back( is ); }
-            }
-            else
-            {
-                OPT_VECTOR2I p = a.Intersect( b );
-
-                if( p )
-                {
-                    is.p = *p;
-                    is.our = a;
-                    is.their = b;
-                    aIp.push_back( is );
-                }
-            }
-        }
-    }
+    auto prune = [&]( const BOX2I& aNode )
+                 {
+                     return !bb_other.Intersects( aNode );
+                 };
+
+    auto intersect = [&]( int s1 )
+                     {
+                         const SEG& a = CSegment( s1 );
+                         BOX2I bb_cur( a.A, a.B - a.A );
+
+                         bb_cur.Normalize();
+
+                         if( !bb_other.Intersects( bb_cur ) )
+                             return false;
+
+                         aChain.QuerySegments( bb_cur, [&]( int s2 )
+                         {
+                             const SEG& b = aChain.CSegment( s2 );
+                             INTERSECTION is;
+
+                             if( a.Collinear( b ) )
+                             {
+                                 is.our = a;
+                                 is.their = b;
+
+                                 if( a.Contains( b.A ) ) { is.p = b.A; aIp.push_back( is ); }
+                                 if( a.Contains( b.B ) ) { is.p = b.B; aIp.push_back( is ); }
+                                 if( b.Contains( a.A ) ) { is.p = a.A; aIp.push_back( is ); }
+                                 if( b.Contains( a.B ) ) { is.p = a.B; aIp.push_back( is ); }
+                             }
+                             else
+                             {
+                                 OPT_VECTOR2I p = a.Intersect( b );
+
+                                 if( p )
+                                 {
+                                     is.p = *p;
+                                     is.our = a;
+                                     is.their = b;
+                                     aIp.push_back( is );
+                                 }
+                             }
+
+                             return false;
+                         } );
+
+                         return false;
+                     };
+
+    walkSegments( prune, intersect );
 
     return aIp.size();
 }
@@ -421,18 +544,33 @@ int SHAPE_LINE_CHAIN::EdgeContainingPoint( const VECTOR2I& aPt, int aAccuracy )
 	    return ( hypot( dist.x, dist.y ) <= aAccuracy + 1 ) ? 0 : -1;
     }
 
-    for( int i = 0; i < SegmentCount(); i++ )
-    {
-        const SEG s = CSegment( i );
+    // Distance() truncates and SEG rounds the nearest points, the edges up to aAccuracy + 4
+    // away may still contain the point
+    const BOX2I point_box( aPt, VECTOR2I( 0, 0 ) );
+    const BOX2I::ecoord_type limit = std::max( aAccuracy + 4, 1 );
+    int edge = -1;
 
-        if( s.A == aPt || s.B == aPt )
-            return i;
+    auto prune = [&]( const BOX2I& aNode )
+                 {
+                     return aNode.SquaredDistance( point_box ) >= limit * limit;
+                 };
 
-        if( s.Distance( aPt ) <= aAccuracy + 1 )
-            return i;
-    }
+    auto contains = [&]( int i )
+                    {
+                        const SEG s = CSegment( i );
 
-    return -1;
+                        if( ( s.A == aPt || s.B == aPt ) || s.Distance( aPt ) <= aAccuracy + 1 )
+                        {
+                            edge = i;
+                            return true;
+                        }
+
+                        return false;
+                    };
+
+    walkSegmentsNear( aPt, aAccuracy + 1, prune, contains );
+
+    return edge;
 }
 
 
@@ -444,18 +582,23 @@ bool SHAPE_LINE_CHAIN::CheckClearance( const VECTOR2I& aP, const int aDist) cons
     else if( PointCount() == 1 )
         return m_points[0] == aP;
 
-    for( int i = 0; i < SegmentCount(); i++ )
-    {
-        const SEG s = CSegment( i );
+    // as in EdgeContainingPoint()
+    const BOX2I point_box( aP, VECTOR2I( 0, 0 ) );
+    const BOX2I::ecoord_type limit = std::max( aDist + 3, 1 );
 
-        if( s.A == aP || s.B == aP )
-            return true;
+    auto prune = [&]( const BOX2I& aNode )
+                 {
+                     return aNode.SquaredDistance( point_box ) >= limit * limit;
+                 };
 
-        if( s.Distance( aP ) <= aDist )
-            return true;
-    }
+    auto collide = [&]( int i )
+                   {
+                       const SEG s = CSegment( i );
+
+                       return ( s.A == aP || s.B == aP ) || s.Distance( aP ) <= aDist;
+                   };
 
-    return false;
+    return walkSegmentsNear( aP, aDist, prune, collide );
 }
 
 
@@ -526,6 +669,8 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
     int i = 0;
     int np = PointCount();
 
+    m_bvh.reset();
+
     // stage 1: eliminate duplicate vertices
     while( i < np )
     {
@@ -581,16 +726,59 @@ const VECTOR2I SHAPE_LINE_CHAIN::NearestPoint( const VECTOR2I& aP ) const
     int min_d = INT_MAX;
     int nearest = 0;
 
-    for( int i = 0; i < SegmentCount(); i++ )
-    {
-        int d = CSegment( i ).Distance( aP );
+    const BOX2I point_box( aP, VECTOR2I( 0, 0 ) );
 
-        if( d < min_d )
-        {
-            min_d = d;
-            nearest = i;
-        }
-    }
+    // as in Distance()
+    auto prune = [&]( const BOX2I& aNode )
+                 {
+                     BOX2I::ecoord_type limit = (BOX2I::ecoord_type) min_d + 2;
+
+                     return aNode.SquaredDistance( point_box ) >= limit * limit;
+                 };
+
+    auto nearer = [&]( int i )
+                  {
+                      int d = CSegment( i ).Distance( aP );
+
+                      if( d < min_d )
+                      {
+                          min_d = d;
+                          nearest = i;
+                      }
+
+                      return false;
+                  };
+
+    // A batch gives the smallest distance of its run, then the first segment at it
+    auto nearerRun = [&]( const SEG_BATCH* aBatch, int aFirst, int aEnd )
+                     {
+                         if( !aBatch )
+                         {
+                             for( int i = aFirst; i < aEnd; i++ )
+                                 nearer( i );
+                         }
+                         else
+                         {
+                             int d = aBatch->Distance( aP, aFirst, aEnd );
+
+                             auto first = [&]( int i )
+                                          {
+                                              if( CSegment( i ).Distance( aP ) > d )
+                                                  return false;
+
+                                              min_d = d;
+                                              nearest = i;
+                                              return true;
+                                          };
+
+                             if( d < min_d )
+                                 aBatch->QueryNear( aP, d, aFirst, aEnd, first );
+                         }
+
+                         return false;
+                     };
+
+    walkSegmentRuns( prune, nearerRun );
 
     return CSegment( nearest ).NearestPoint( aP );
 }
@@ -662,6 +850,7 @@ bool SHAPE_LINE_CHAIN::Parse( std::stringstream& aStream )
     int n_pts;
 
     m_points.clear();
+    m_bvh.reset();
     aStream >> n_pts;
 
     // Rough sanity check, just make sure the loop bounds aren't absolutely outlandish
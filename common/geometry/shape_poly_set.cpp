@@ -1907,6 +1907,15 @@ void SHAPE_POLY_SET::CacheTriangulation()
 }
 
 
+void SHAPE_POLY_SET::SetTriangulation(
+        std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> aTriangulation )
+{
+    m_triangulatedPolys = std::move( aTriangulation );
+    m_triangulationValid = true;
+    m_hash = checksum();
+}
+
+
 MD5_HASH SHAPE_POLY_SET::checksum() const
 {
     MD5_HASH hash;
@@ -28,6 +28,10 @@
 #include <class_text_mod.h>
 #include <class_edge_mod.h>
 #include <class_pad.h>
+#include <class_track.h>
+#include <class_drawsegment.h>
+#include <class_pcb_text.h>
+#include <class_zone.h>
 
 #include <functional>
 
@@ -55,57 +59,57 @@ size_t hash_eda( const EDA_ITEM* aItem, int aFlags )
         {
             const MODULE* module = static_cast<const MODULE*>( aItem );
 
-            ret += hash_board_item( module, aFlags );
+            hash_combine( ret, hash_board_item( module, aFlags ) );
 
             if( aFlags & POSITION )
             {
-                ret += hash<int>{}( module->GetPosition().x );
-                ret += hash<int>{}( module->GetPosition().y );
+                hash_combine( ret, hash<int>{}( module->GetPosition().x ) );
+                hash_combine( ret, hash<int>{}( module->GetPosition().y ) );
             }
 
             if( aFlags & ROTATION )
-                ret += hash<double>{}( module->GetOrientation() );
+                hash_combine( ret, hash<double>{}( module->GetOrientation() ) );
 
             for( auto i : module->GraphicalItems() )
-                ret += hash_eda( i, aFlags );
+                hash_combine( ret, hash_eda( i, aFlags ) );
 
             for( auto i : module->Pads() )
-                ret += hash_eda( static_cast<EDA_ITEM*>( i ), aFlags );
+                hash_combine( ret, hash_eda( static_cast<EDA_ITEM*>( i ), aFlags ) );
         }
         break;
 
     case PCB_PAD_T:
         {
             const D_PAD* pad = static_cast<const D_PAD*>( aItem );
-            ret += hash_board_item( pad, aFlags );
-            ret += hash<int>{}( pad->GetShape() << 16 );
-            ret += hash<int>{}( pad->GetDrillShape() << 18 );
-            ret += hash<int>{}( pad->GetSize().x << 8 );
-            ret += hash<int>{}( pad->GetSize().y << 9 );
-            ret += hash<int>{}( pad->GetOffset().x << 6 );
-            ret += hash<int>{}( pad->GetOffset().y << 7 );
-            ret += hash<int>{}( pad->GetDelta().x << 4 );
-            ret += hash<int>{}( pad->GetDelta().y << 5 );
+            hash_combine( ret, hash_board_item( pad, aFlags ) );
+            hash_combine( ret, hash<int>{}( pad->GetShape() << 16 ) );
+            hash_combine( ret, hash<int>{}( pad->GetDrillShape() << 18 ) );
+            hash_combine( ret, hash<int>{}( pad->GetSize().x << 8 ) );
+            hash_combine( ret, hash<int>{}( pad->GetSize().y << 9 ) );
+            hash_combine( ret, hash<int>{}( pad->GetOffset().x << 6 ) );
+            hash_combine( ret, hash<int>{}( pad->GetOffset().y << 7 ) );
+            hash_combine( ret, hash<int>{}( pad->GetDelta().x << 4 ) );
+            hash_combine( ret, hash<int>{}( pad->GetDelta().y << 5 ) );
 
             if( aFlags & POSITION )
             {
                 if( aFlags & REL_COORD )
                 {
-                    ret += hash<int>{}( pad->GetPos0().x );
-                    ret += hash<int>{}( pad->GetPos0().y );
+                    hash_combine( ret, hash<int>{}( pad->GetPos0().x ) );
+                    hash_combine( ret, hash<int>{}( pad->GetPos0().y ) );
                 }
                 else
                 {
-                    ret += hash<int>{}( pad->GetPosition().x );
-                    ret += hash<int>{}( pad->GetPosition().y );
+                    hash_combine( ret, hash<int>{}( pad->GetPosition().x ) );
+                    hash_combine( ret, hash<int>{}( pad->GetPosition().y ) );
                 }
             }
 
             if( aFlags & ROTATION )
-                ret += hash<double>{}( pad->GetOrientation() );
+                hash_combine( ret, hash<double>{}( pad->GetOrientation() ) );
 
             if( aFlags & NET )
-                ret += hash<int>{}( pad->GetNetCode() << 6 );
+                hash_combine( ret, hash<int>{}( pad->GetNetCode() << 6 ) );
         }
         break;
 
@@ -119,69 +123,191 @@ size_t hash_eda( const EDA_ITEM* aItem, int aFlags )
             if( !( aFlags & VALUE ) && text->GetType() == TEXTE_MODULE::TEXT_is_VALUE )
                 break;
 
-            ret += hash_board_item( text, aFlags );
-            ret += hash<string>{}( text->GetText().ToStdString() );
-            ret += hash<bool>{}( text->IsItalic() );
-            ret += hash<bool>{}( text->IsBold() );
-            ret += hash<bool>{}( text->IsMirrored() );
-            ret += hash<int>{}( text->GetTextWidth() );
-            ret += hash<int>{}( text->GetTextHeight() );
-            ret += hash<int>{}( text->GetHorizJustify() );
-            ret += hash<int>{}( text->GetVertJustify() );
+            hash_combine( ret, hash_board_item( text, aFlags ) );
+            hash_combine( ret, hash<string>{}( text->GetText().ToStdString() ) );
+            hash_combine( ret, hash<bool>{}( text->IsItalic() ) );
+            hash_combine( ret, hash<bool>{}( text->IsBold() ) );
+            hash_combine( ret, hash<bool>{}( text->IsMirrored() ) );
+            hash_combine( ret, hash<int>{}( text->GetTextWidth() ) );
+            hash_combine( ret, hash<int>{}( text->GetTextHeight() ) );
+            hash_combine( ret, hash<int>{}( text->GetHorizJustify() ) );
+            hash_combine( ret, hash<int>{}( text->GetVertJustify() ) );
 
             if( aFlags & POSITION )
             {
                 if( aFlags & REL_COORD )
                 {
-                    ret += hash<int>{}( text->GetPos0().x );
-                    ret += hash<int>{}( text->GetPos0().y );
+                    hash_combine( ret, hash<int>{}( text->GetPos0().x ) );
+                    hash_combine( ret, hash<int>{}( text->GetPos0().y ) );
                 }
                 else
                 {
-                    ret += hash<int>{}( text->GetPosition().x );
-                    ret += hash<int>{}( text->GetPosition().y );
+                    hash_combine( ret, hash<int>{}( text->GetPosition().x ) );
+                    hash_combine( ret, hash<int>{}( text->GetPosition().y ) );
                 }
             }
 
-            if( aFlags & ROTATION )
-                ret += hash<double>{}( text->GetTextAngle() );
+            // The text angle is relative to the footprint
+            if( ( aFlags & ROTATION ) && ( aFlags & REL_COORD ) )
+                hash_combine( ret, hash<double>{}( text->GetTextAngle() ) );
+            else if( aFlags & ROTATION )
+                hash_combine( ret, hash<double>{}( text->GetDrawRotation() ) );
         }
         break;
 
     case PCB_MODULE_EDGE_T:
         {
             const EDGE_MODULE* segment = static_cast<const EDGE_MODULE*>( aItem );
-            ret += hash_board_item( segment, aFlags );
-            ret += hash<int>{}( segment->GetType() );
-            ret += hash<int>{}( segment->GetShape() );
-            ret += hash<int>{}( segment->GetWidth() );
-            ret += hash<int>{}( segment->GetRadius() );
+            hash_combine( ret, hash_board_item( segment, aFlags ) );
+            hash_combine( ret, hash<int>{}( segment->GetType() ) );
+            hash_combine( ret, hash<int>{}( segment->GetShape() ) );
+            hash_combine( ret, hash<int>{}( segment->GetWidth() ) );
+            hash_combine( ret, hash<int>{}( segment->GetRadius() ) );
 
             if( aFlags & POSITION )
             {
                 if( aFlags & REL_COORD )
                 {
-                    ret += hash<int>{}( segment->GetStart0().x );
-                    ret += hash<int>{}( segment->GetStart0().y );
-                    ret += hash<int>{}( segment->GetEnd0().x );
-                    ret += hash<int>{}( segment->GetEnd0().y );
+                    hash_combine( ret, hash<int>{}( segment->GetStart0().x ) );
+                    hash_combine( ret, hash<int>{}( segment->GetStart0().y ) );
+                    hash_combine( ret, hash<int>{}( segment->GetEnd0().x ) );
+                    hash_combine( ret, hash<int>{}( segment->GetEnd0().y ) );
                 }
                 else
                 {
-                    ret += hash<int>{}( segment->GetStart().x );
-                    ret += hash<int>{}( segment->GetStart().y );
-                    ret += hash<int>{}( segment->GetEnd().x );
-                    ret += hash<int>{}( segment->GetEnd().y );
+                    hash_combine( ret, hash<int>{}( segment->GetStart().x ) );
+                    hash_combine( ret, hash<int>{}( segment->GetStart().y ) );
+                    hash_combine( ret, hash<int>{}( segment->GetEnd().x ) );
+                    hash_combine( ret, hash<int>{}( segment->GetEnd().y ) );
+                }
+            }
+
+            if( aFlags & ROTATION )
+                hash_combine( ret, hash<double>{}( segment->GetAngle() ) );
+        }
+        break;
+
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+        {
+            const TRACK* track = static_cast<const TRACK*>( aItem );
+            hash_combine( ret, hash_board_item( track, aFlags ) );
+            hash_combine( ret, hash<int>{}( track->Type() ) );
+            hash_combine( ret, hash<int>{}( track->GetWidth() ) );
+
+            if( track->Type() == PCB_VIA_T )
+            {
+                const VIA* via = static_cast<const VIA*>( track );
+                hash_combine( ret, hash<int>{}( via->GetViaType() << 12 ) );
+                hash_combine( ret, hash<int>{}( via->GetDrillValue() << 2 ) );
+            }
+
+            if( aFlags & POSITION )
+            {
+                hash_combine( ret, hash<int>{}( track->GetStart().x ) );
+                hash_combine( ret, hash<int>{}( track->GetStart().y ) );
+                hash_combine( ret, hash<int>{}( track->GetEnd().x << 1 ) );
+                hash_combine( ret, hash<int>{}( track->GetEnd().y << 1 ) );
+            }
+
+            if( aFlags & NET )
+                hash_combine( ret, hash<int>{}( track->GetNetCode() << 6 ) );
+        }
+        break;
+
+    case PCB_LINE_T:
+        {
+            const DRAWSEGMENT* segment = static_cast<const DRAWSEGMENT*>( aItem );
+            hash_combine( ret, hash_board_item( segment, aFlags ) );
+            hash_combine( ret, hash<int>{}( segment->GetShape() ) );
+            hash_combine( ret, hash<int>{}( segment->GetWidth() ) );
+
+            if( aFlags & POSITION )
+            {
+                hash_combine( ret, hash<int>{}( segment->GetStart().x ) );
+                hash_combine( ret, hash<int>{}( segment->GetStart().y ) );
+                hash_combine( ret, hash<int>{}( segment->GetEnd().x << 1 ) );
+                hash_combine( ret, hash<int>{}( segment->GetEnd().y << 1 ) );
+
+                for( const wxPoint& pt : segment->GetBezierPoints() )
+                {
+                    hash_combine( ret, hash<int>{}( pt.x ) );
+                    hash_combine( ret, hash<int>{}( pt.y ) );
+                }
+
+                if( segment->GetPolyShape().OutlineCount() )
+                {
+                    MD5_HASH outlineHash = segment->GetPolyShape().GetHash();
+                    hash_combine( ret, hash<string>{}( outlineHash.Format() ) );
                 }
             }
 
             if( aFlags & ROTATION )
-                ret += hash<double>{}( segment->GetAngle() );
+                hash_combine( ret, hash<double>{}( segment->GetAngle() ) );
+        }
+        break;
+
+    case PCB_TEXT_T:
+        {
+            const TEXTE_PCB* text = static_cast<const TEXTE_PCB*>( aItem );
+            hash_combine( ret, hash_board_item( text, aFlags ) );
+            hash_combine( ret, hash<string>{}( text->GetText().ToStdString() ) );
+            hash_combine( ret, hash<bool>{}( text->IsItalic() ) );
+            hash_combine( ret, hash<bool>{}( text->IsBold() ) );
+            hash_combine( ret, hash<bool>{}( text->IsMirrored() ) );
+            hash_combine( ret, hash<bool>{}( text->IsVisible() ) );
+            hash_combine( ret, hash<int>{}( text->GetTextWidth() ) );
+            hash_combine( ret, hash<int>{}( text->GetTextHeight() ) );
+            hash_combine( ret, hash<int>{}( text->GetThickness() ) );
+            hash_combine( ret, hash<int>{}( text->GetHorizJustify() ) );
+            hash_combine( ret, hash<int>{}( text->GetVertJustify() ) );
+
+            if( aFlags & POSITION )
+            {
+                hash_combine( ret, hash<int>{}( text->GetTextPos().x ) );
+                hash_combine( ret, hash<int>{}( text->GetTextPos().y ) );
+            }
+
+            if( aFlags & ROTATION )
+                hash_combine( ret, hash<double>{}( text->GetTextAngle() ) );
+        }
+        break;
+
+    case PCB_ZONE_AREA_T:
+        {
+            const ZONE_CONTAINER* zone = static_cast<const ZONE_CONTAINER*>( aItem );
+            hash_combine( ret, hash_board_item( zone, aFlags ) );
+            hash_combine( ret, hash<unsigned>{}( zone->GetPriority() ) );
+            hash_combine( ret, hash<bool>{}( zone->GetIsKeepout() ) );
+            hash_combine( ret, hash<int>{}( zone->GetDoNotAllowCopperPour() << 1 ) );
+            hash_combine( ret, hash<int>{}( zone->GetDoNotAllowVias() << 2 ) );
+            hash_combine( ret, hash<int>{}( zone->GetDoNotAllowTracks() << 3 ) );
+            hash_combine( ret, hash<int>{}( zone->GetPadConnection() << 4 ) );
+            hash_combine( ret, hash<int>{}( zone->GetFillMode() << 8 ) );
+            hash_combine( ret, hash<int>{}( zone->GetZoneClearance() ) );
+            hash_combine( ret, hash<int>{}( zone->GetMinThickness() << 1 ) );
+            hash_combine( ret, hash<bool>{}( zone->GetFilledPolysUseThickness() ) );
+            hash_combine( ret, hash<int>{}( zone->GetThermalReliefGap() << 2 ) );
+            hash_combine( ret, hash<int>{}( zone->GetThermalReliefCopperBridge() << 3 ) );
+            hash_combine( ret, hash<int>{}( zone->GetCornerSmoothingType() << 12 ) );
+            hash_combine( ret, hash<unsigned>{}( zone->GetCornerRadius() ) );
+            hash_combine( ret, hash<int>{}( zone->GetHatchFillTypeThickness() << 4 ) );
+            hash_combine( ret, hash<int>{}( zone->GetHatchFillTypeGap() << 5 ) );
+            hash_combine( ret, hash<double>{}( zone->GetHatchFillTypeOrientation() ) );
+            hash_combine( ret, hash<int>{}( zone->GetHatchFillTypeSmoothingLevel() << 16 ) );
+            hash_combine( ret, hash<double>{}( zone->GetHatchFillTypeSmoothingValue() ) );
+
+            // The outline hash depends on the vertex order, unlike a sum of the vertices
+            if( aFlags & POSITION )
+                hash_combine( ret, hash<string>{}( zone->Outline()->GetHash().Format() ) );
+
+            if( aFlags & NET )
+                hash_combine( ret, hash<int>{}( zone->GetNetCode() << 6 ) );
         }
         break;
 
     default:
-        wxASSERT_MSG( false, "Unhandled type in function hashModItem() (exporter_gencad.cpp)" );
+        wxASSERT_MSG( false, "Unhandled type in function hash_eda()" );
     }
 
     return ret;
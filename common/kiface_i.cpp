@@ -30,6 +30,7 @@
 #include <kiface_i.h>
 #include <pgm_base.h>
 #include <systemdirsappend.h>
+#include <thread_pool.h>
 
 #include <common.h>
 
@@ -93,12 +94,16 @@ bool KIFACE_I::start_common( int aCtlBits )
     m_bm.Init();
     setSearchPaths( &m_bm.m_search, m_id );
 
+    // Share the workers of the program with the other kifaces
+    SetKiCadThreadPool( &Pgm().GetThreadPool() );
+
     return true;
 }
 
 
 void KIFACE_I::end_common()
 {
+    SetKiCadThreadPool( nullptr );
     m_bm.End();
 }
 
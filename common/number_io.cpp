@@ -0,0 +1,289 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <clocale>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <locale.h>
+
+#if defined( __APPLE__ ) || defined( __FreeBSD__ )
+#include <xlocale.h>
+#endif
+
+#include <number_io.h>
+
+
+// The powers of ten a double holds exactly
+static const double s_powersOfTen[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+static inline bool isDigit( char c )
+{
+    return c >= '0' && c <= '9';
+}
+
+
+// isspace() in the "C" locale
+static inline bool isSpace( char c )
+{
+    return c == ' ' || ( c >= '\t' && c <= '\r' );
+}
+
+
+/**
+ * @return the "C" locale, created once.  Unlike localeconv(), which the numbers were first
+ * converted with, the conversions using it do not read the global locale, so they can run
+ * in several threads while the locale is changed.
+ */
+#if defined( _WIN32 )
+static _locale_t cLocale()
+{
+    static _locale_t locale = _create_locale( LC_NUMERIC, "C" );
+
+    return locale;
+}
+#else
+static locale_t cLocale()
+{
+    static locale_t locale = newlocale( LC_NUMERIC_MASK, "C", (locale_t) 0 );
+
+    return locale;
+}
+#endif
+
+
+/**
+ * strtod() in the "C" locale, for the numbers ParseDouble() does not convert itself.
+ */
+static double localeFreeStrtod( const char* aText, char** aEnd )
+{
+    // The "C" locale is always available, but never make things worse than strtod()
+    if( !cLocale() )
+        return strtod( aText, aEnd );
+
+#if defined( _WIN32 )
+    return _strtod_l( aText, aEnd, cLocale() );
+#else
+    return strtod_l( aText, aEnd, cLocale() );
+#endif
+}
+
+
+double ParseDouble( const char* aText, char** aEnd )
+{
+    const char* p = aText;
+
+    while( isSpace( *p ) )
+        ++p;
+
+    bool negative = ( *p == '-' );
+
+    if( *p == '-' || *p == '+' )
+        ++p;
+
+    uint64_t mantissa = 0;
+    int      significantDigits = 0;
+    int      exponent = 0;
+    bool     hasDigits = false;
+    bool     tooLong = false;
+
+    // Leading zeros are not significant; past 19 digits the mantissa could overflow
+    auto addDigit = [&]( char c )
+    {
+        hasDigits = true;
+
+        if( mantissa == 0 && c == '0' )
+            return;
+
+        if( significantDigits == 19 )
+        {
+            tooLong = true;
+            return;
+        }
+
+        mantissa = mantissa * 10 + ( c - '0' );
+        significantDigits++;
+    };
+
+    for( ; isDigit( *p ); ++p )
+        addDigit( *p );
+
+    if( *p == '.' )
+    {
+        for( ++p; isDigit( *p ); ++p )
+        {
+            exponent--;
+            addDigit( *p );
+        }
+    }
+
+    // Hex floats, infinities, NaNs and non numbers
+    if( !hasDigits || *p == 'x' || *p == 'X' )
+        return localeFreeStrtod( aText, aEnd );
+
+    if( *p == 'e' || *p == 'E' )
+    {
+        const char* q = p + 1;
+        bool        negativeExponent = ( *q == '-' );
+
+        if( *q == '-' || *q == '+' )
+            ++q;
+
+        // Without digits, the 'e' is not part of the number
+        if( isDigit( *q ) )
+        {
+            int exponentValue = 0;
+
+            for( ; isDigit( *q ); ++q )
+            {
+                if( exponentValue < 100000 )
+                    exponentValue = exponentValue * 10 + ( *q - '0' );
+            }
+
+            exponent += negativeExponent ? -exponentValue : exponentValue;
+            p = q;
+        }
+    }
+
+    double value;
+
+    if( tooLong )
+    {
+        return localeFreeStrtod( aText, aEnd );
+    }
+    else if( mantissa == 0 )
+    {
+        value = 0.0;
+    }
+    else if( mantissa <= ( UINT64_C( 1 ) << 53 ) && exponent >= -22 && exponent <= 22
+             && FLT_EVAL_METHOD == 0 )
+    {
+        // Both operands are exact, so the single rounding of the product or quotient gives
+        // the correctly rounded value, as strtod() does
+        value = (double) mantissa;
+
+        if( exponent < 0 )
+            value /= s_powersOfTen[ -exponent ];
+        else
+            value *= s_powersOfTen[ exponent ];
+    }
+    else
+    {
+        return localeFreeStrtod( aText, aEnd );
+    }
+
+    if( aEnd )
+        *aEnd = const_cast<char*>( p );
+
+    return negative ? -value : value;
+}
+
+
+int FormatFixedPoint( char* aBuffer, long long aValue, int aDecimals )
+{
+    unsigned long long magnitude = aValue < 0 ? 0ULL - (unsigned long long) aValue
+                                              : (unsigned long long) aValue;
+    char digits[40];        // least significant first
+    int  count = 0;
+
+    do
+    {
+        digits[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while( magnitude );
+
+    while( count <= aDecimals )
+        digits[count++] = '0';
+
+    int trailingZeros = 0;
+
+    while( trailingZeros < aDecimals && digits[trailingZeros] == '0' )
+        trailingZeros++;
+
+    char* out = aBuffer;
+
+    if( aValue < 0 )
+        *out++ = '-';
+
+    for( int ii = count - 1; ii >= aDecimals; --ii )
+        *out++ = digits[ii];
+
+    if( trailingZeros < aDecimals )
+    {
+        *out++ = '.';
+
+        for( int ii = aDecimals - 1; ii >= trailingZeros; --ii )
+            *out++ = digits[ii];
+    }
+
+    *out = '\0';
+
+    return out - aBuffer;
+}
+
+
+int FormatDouble( char* aBuffer, size_t aSize, const char* aFormat, double aValue )
+{
+#if defined( _WIN32 )
+    // _snprintf_l() does not tell the length of a truncated result
+    int len = _scprintf_l( aFormat, cLocale(), aValue );
+
+    if( len >= 0 && (size_t) len < aSize )
+        _snprintf_l( aBuffer, aSize, aFormat, cLocale(), aValue );
+#else
+    // The locale of this thread only, which the other threads do not see
+    locale_t previous = uselocale( cLocale() );
+    int      len = snprintf( aBuffer, aSize, aFormat, aValue );
+
+    uselocale( previous );
+#endif
+
+    return len;
+}
+
+
+std::string FormatDouble( const char* aFormat, double aValue )
+{
+    char buffer[64];
+    int  len = FormatDouble( buffer, sizeof( buffer ), aFormat, aValue );
+
+    if( len < 0 )
+        return std::string();
+
+    if( (size_t) len < sizeof( buffer ) )
+        return std::string( buffer, len );
+
+    // %f of a large value
+    std::string result( len + 1, '\0' );
+    len = FormatDouble( &result[0], result.size(), aFormat, aValue );
+    result.resize( std::max( len, 0 ) );
+
+    return result;
+}
@@ -26,6 +26,7 @@
 #include <common.h>
 #include <page_info.h>
 #include <macros.h>
+#include <number_io.h>
 
 
 // late arriving wxPAPER_A0, wxPAPER_A1
@@ -271,9 +272,9 @@ void PAGE_INFO::Format( OUTPUTFORMATTER* aFormatter, int aNestLevel, int aContro
     // The page dimensions are only required for user defined page sizes.
     // Internally, the page size is in mils
     if( GetType() == PAGE_INFO::Custom )
-        aFormatter->Print( 0, " %g %g",
-                           GetWidthMils() * 25.4 / 1000.0,
-                           GetHeightMils() * 25.4 / 1000.0 );
+        aFormatter->Print( 0, " %s %s",
+                           FormatDouble( "%g", GetWidthMils() * 25.4 / 1000.0 ).c_str(),
+                           FormatDouble( "%g", GetHeightMils() * 25.4 / 1000.0 ).c_str() );
 
     if( !IsCustom() && IsPortrait() )
         aFormatter->Print( 0, " portrait" );
@@ -56,6 +56,8 @@
 #include <systemdirsappend.h>
 #include <trace_helpers.h>
 #include <gal/gal_display_options.h>
+#include <advanced_config.h>
+#include <thread_pool.h>
 
 #define KICAD_COMMON                     wxT( "kicad_common" )
 
@@ -140,6 +142,24 @@ void PGM_BASE::Destroy()
 
     delete m_locale;
     m_locale = 0;
+
+    // Joins the workers while the kifaces are still loaded
+    std::lock_guard<std::mutex> lock( m_threadPoolLock );
+    m_threadPool.reset();
+}
+
+
+THREAD_POOL& PGM_BASE::GetThreadPool()
+{
+    std::lock_guard<std::mutex> lock( m_threadPoolLock );
+
+    if( !m_threadPool )
+    {
+        int size = std::max( ADVANCED_CFG::GetCfg().m_threadPoolSize, 0 );
+        m_threadPool = std::make_unique<THREAD_POOL>( (size_t) size );
+    }
+
+    return *m_threadPool;
 }
 
 
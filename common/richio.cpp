@@ -23,11 +23,19 @@
  */
 
 
+#include <algorithm>
 #include <cstdarg>
-#include <config.h> // HAVE_FGETC_NOLOCK
+#include <cstring>
+#include <config.h> // HAVE_FGETC_NOLOCK, HAVE_MMAP
 
 #include <richio.h>
 
+#if defined( HAVE_MMAP )
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 
 // Fall back to getc() when getc_unlocked() is not available on the target platform.
 #if !defined( HAVE_FGETC_NOLOCK )
@@ -225,6 +233,118 @@ char* FILE_LINE_READER::ReadLine()
 }
 
 
+// Below this size, reading a file costs less than mapping it
+#define MMAP_LINE_READER_MIN_MAPPED_SIZE    ( 256 * 1024 )
+
+
+MMAP_LINE_READER::MMAP_LINE_READER( const wxString& aFileName, unsigned aMaxLineLength ) :
+    LINE_READER( aMaxLineLength ),
+    m_data( NULL ), m_size( 0 ), m_ndx( 0 ), m_mapped( false )
+{
+    FILE* fp = wxFopen( aFileName, wxT( "rb" ) );
+
+    if( !fp )
+    {
+        wxString msg = wxString::Format(
+            _( "Unable to open filename \"%s\" for reading" ), aFileName.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+
+    m_source = aFileName;
+
+    long size = fseek( fp, 0, SEEK_END ) == 0 ? ftell( fp ) : -1;
+
+    if( size < 0 )
+    {
+        fclose( fp );
+        THROW_IO_ERROR( wxString::Format( _( "Unable to read file \"%s\"" ), aFileName ) );
+    }
+
+    m_size = (size_t) size;
+
+#if defined( HAVE_MMAP )
+    if( m_size >= MMAP_LINE_READER_MIN_MAPPED_SIZE )
+    {
+        void* data = mmap( NULL, m_size, PROT_READ, MAP_PRIVATE, fileno( fp ), 0 );
+
+        if( data != MAP_FAILED )
+        {
+            madvise( data, m_size, MADV_SEQUENTIAL );
+
+            m_data = (const char*) data;
+            m_mapped = true;
+        }
+    }
+#endif
+
+    if( !m_mapped )
+    {
+        char* data = new char[m_size + 1];
+
+        rewind( fp );
+
+        if( fread( data, 1, m_size, fp ) != m_size )
+        {
+            delete[] data;
+            fclose( fp );
+            THROW_IO_ERROR( wxString::Format( _( "Unable to read file \"%s\"" ), aFileName ) );
+        }
+
+        m_data = data;
+    }
+
+    // The mapping stays valid once the file is closed
+    fclose( fp );
+}
+
+
+MMAP_LINE_READER::~MMAP_LINE_READER()
+{
+#if defined( HAVE_MMAP )
+    if( m_mapped )
+        munmap( (void*) m_data, m_size );
+    else
+#endif
+        delete[] m_data;
+}
+
+
+char* MMAP_LINE_READER::ReadLine()
+{
+    const char* begin = m_data + m_ndx;
+    const char* nl = (const char*) memchr( begin, '\n', m_size - m_ndx );
+
+    // include the newline, so +1
+    m_length = nl ? nl - begin + 1 : m_size - m_ndx;
+
+    if( m_length )
+    {
+        if( m_length >= m_maxLineLength )
+            THROW_IO_ERROR( _( "Maximum line length exceeded" ) );
+
+        if( m_length + 1 > m_capacity )   // +1 for terminating nul
+        {
+            unsigned length = m_length;
+
+            m_length = 0;                   // nothing to keep from the previous line
+            expandCapacity( length + 1 );
+            m_length = length;
+        }
+
+        memcpy( m_line, begin, m_length );
+        m_ndx += m_length;
+    }
+
+    m_line[m_length] = 0;
+
+    // m_lineNum is incremented even if there was no line read, because this
+    // leads to better error reporting when we hit an end of file.
+    ++m_lineNum;
+
+    return m_length ? m_line : NULL;
+}
+
+
 STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource ):
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     m_lines( aString ), m_ndx( 0 )
@@ -363,78 +483,217 @@ const char* OUTPUTFORMATTER::GetQuoteChar( const char* wrapee )
     return GetQuoteChar( wrapee, quoteChar );
 }
 
-int OUTPUTFORMATTER::vprint( const char* fmt,  va_list ap )
-{
-    // This function can call vsnprintf twice.
-    // But internally, vsnprintf retrieves arguments from the va_list identified by arg as if
-    // va_arg was used on it, and thus the state of the va_list is likely to be altered by the call.
-    // see: www.cplusplus.com/reference/cstdio/vsnprintf
-    // we make a copy of va_list ap for the second call, if happens
-    va_list tmp;
-    va_copy( tmp, ap );
-    int ret = vsnprintf( &m_buffer[0], m_buffer.size(), fmt, ap );
+#define NESTWIDTH           2   ///< how many spaces per nestLevel
+
 
-    if( ret >= (int) m_buffer.size() )
+bool OUTPUTFORMATTER::isSimpleFormat( const char* fmt )
+{
+    for( ; *fmt; ++fmt )
     {
-        m_buffer.resize( ret + 1000 );
-        ret = vsnprintf( &m_buffer[0], m_buffer.size(), fmt, tmp );
+        if( *fmt != '%' )
+            continue;
+
+        if( *++fmt == 'l' )
+        {
+            if( !*++fmt || !strchr( "duxX", *fmt ) )
+                return false;
+        }
+        else if( !*fmt || !strchr( "%scduxX", *fmt ) )
+        {
+            return false;
+        }
     }
 
-    va_end( tmp );      // Release the temporary va_list, initialised from ap
+    return true;
+}
 
-    if( ret > 0 )
-        write( &m_buffer[0], ret );
 
-    return ret;
+/**
+ * Writes aValue in base aBase backwards from aEnd.
+ * @return the start of the text.
+ */
+static char* formatUnsigned( char* aEnd, unsigned long aValue, unsigned aBase,
+                             const char* aDigits )
+{
+    do
+    {
+        *--aEnd = aDigits[ aValue % aBase ];
+        aValue /= aBase;
+    } while( aValue );
+
+    return aEnd;
 }
 
 
-int OUTPUTFORMATTER::sprint( const char* fmt, ... )
+size_t OUTPUTFORMATTER::formatSimple( size_t aLength, const char* fmt, va_list ap )
 {
-    va_list     args;
+    char    digits[24];
+    char*   digitsEnd = digits + sizeof( digits );
 
-    va_start( args, fmt );
-    int ret = vprint( fmt, args);
-    va_end( args );
+    while( *fmt )
+    {
+        const char* text;
+        size_t      len;
 
-    return ret;
+        if( *fmt != '%' )
+        {
+            const char* next = strchr( fmt, '%' );
+
+            text = fmt;
+            len = next ? next - fmt : strlen( fmt );
+            fmt += len;
+        }
+        else
+        {
+            bool isLong = fmt[1] == 'l';
+
+            fmt += isLong ? 2 : 1;
+
+            switch( *fmt++ )
+            {
+            case '%':
+                text = "%";
+                len = 1;
+                break;
+
+            case 's':
+                text = va_arg( ap, const char* );
+
+                if( !text )
+                    text = "(null)";    // as printf() writes it
+
+                len = strlen( text );
+                break;
+
+            case 'c':
+                digits[0] = (char) va_arg( ap, int );
+                text = digits;
+                len = 1;
+                break;
+
+            case 'd':
+            {
+                long value = isLong ? va_arg( ap, long ) : va_arg( ap, int );
+                unsigned long magnitude = value < 0 ? 0UL - (unsigned long) value : value;
+                char* start = formatUnsigned( digitsEnd, magnitude, 10, "0123456789" );
+
+                if( value < 0 )
+                    *--start = '-';
+
+                text = start;
+                len = digitsEnd - start;
+                break;
+            }
+
+            default:    // 'u', 'x' or 'X'
+            {
+                char conversion = fmt[-1];
+                unsigned long value = isLong ? va_arg( ap, unsigned long )
+                                             : va_arg( ap, unsigned int );
+
+                if( conversion == 'u' )
+                    text = formatUnsigned( digitsEnd, value, 10, "0123456789" );
+                else if( conversion == 'x' )
+                    text = formatUnsigned( digitsEnd, value, 16, "0123456789abcdef" );
+                else
+                    text = formatUnsigned( digitsEnd, value, 16, "0123456789ABCDEF" );
+
+                len = digitsEnd - text;
+                break;
+            }
+            }
+        }
+
+        if( aLength + len > m_buffer.size() )
+            m_buffer.resize( std::max( 2 * m_buffer.size(), aLength + len ) );
+
+        memcpy( &m_buffer[aLength], text, len );
+        aLength += len;
+    }
+
+    return aLength;
 }
 
 
-int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
+int OUTPUTFORMATTER::vprint( int nestLevel, const char* fmt, va_list ap )
 {
-#define NESTWIDTH           2   ///< how many spaces per nestLevel
+    size_t length = nestLevel > 0 ? (size_t) nestLevel * NESTWIDTH : 0;
 
-    va_list     args;
-
-    va_start( args, fmt );
+    if( length >= m_buffer.size() )
+        m_buffer.resize( length + OUTPUTFMTBUFZ );
 
-    int result = 0;
-    int total  = 0;
+    memset( &m_buffer[0], ' ', length );
 
-    for( int i=0; i<nestLevel;  ++i )
+    if( isSimpleFormat( fmt ) )
     {
-        // no error checking needed, an exception indicates an error.
-        result = sprint( "%*c", NESTWIDTH, ' ' );
+        length = formatSimple( length, fmt, ap );
+    }
+    else
+    {
+        // This can call vsnprintf twice.
+        // But internally, vsnprintf retrieves arguments from the va_list identified by arg as
+        // if va_arg was used on it, and thus the state of the va_list is likely to be altered
+        // by the call.
+        // see: www.cplusplus.com/reference/cstdio/vsnprintf
+        // we make a copy of va_list ap for the second call, if happens
+        va_list tmp;
+        va_copy( tmp, ap );
+        int ret = vsnprintf( &m_buffer[length], m_buffer.size() - length, fmt, ap );
+
+        if( ret >= (int) ( m_buffer.size() - length ) )
+        {
+            m_buffer.resize( length + ret + 1000 );
+            ret = vsnprintf( &m_buffer[length], m_buffer.size() - length, fmt, tmp );
+        }
+
+        va_end( tmp );      // Release the temporary va_list, initialised from ap
 
-        total += result;
+        if( ret < 0 )
+        {
+            if( length )
+                write( &m_buffer[0], length );
+
+            return (int) length + ret;
+        }
+
+        length += ret;
     }
 
+    if( length )
+        write( &m_buffer[0], length );
+
+    return (int) length;
+}
+
+
+int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
+{
+    va_list     args;
+
+    va_start( args, fmt );
+
     // no error checking needed, an exception indicates an error.
-    result = vprint( fmt, args );
+    int result = vprint( nestLevel, fmt, args );
 
     va_end( args );
 
-    total += result;
-    return total;
+    return result;
 }
 
 
 std::string OUTPUTFORMATTER::Quotes( const std::string& aWrapee )
 {
     std::string ret;
+    size_t      escapes = 0;
 
-    ret.reserve( aWrapee.size()*2 + 2 );
+    for( char c : aWrapee )
+    {
+        if( c == '\n' || c == '\r' || c == '\\' || c == '"' )
+            escapes++;
+    }
+
+    // The exact size, so the short tokens stay in the small string buffer
+    ret.reserve( aWrapee.size() + escapes + 2 );
 
     ret += '"';
 
@@ -476,7 +735,26 @@ std::string OUTPUTFORMATTER::Quotew( const wxString& aWrapee )
     // a different quoting or escaping strategy is desired from the standard,
     // a derived class can overload Quotes() above, but
     // should never be a reason to overload this Quotew() here.
-    return Quotes( (const char*) aWrapee.utf8_str() );
+    std::string ascii;
+
+    ascii.reserve( aWrapee.length() );
+
+    // The tokens are nearly always ASCII, which is its own UTF-8: copy them without the
+    // conversion buffer of utf8_str()
+    for( wxString::const_iterator it = aWrapee.begin(); it != aWrapee.end(); ++it )
+    {
+        wxUniChar c = *it;
+
+        if( !c.IsAscii() )
+            return Quotes( (const char*) aWrapee.utf8_str() );
+
+        if( c == 0 )    // where the C string of utf8_str() ends
+            break;
+
+        ascii += (char) c.GetValue();
+    }
+
+    return Quotes( ascii );
 }
 
 
@@ -0,0 +1,286 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+
+#include <advanced_config.h>
+#include <thread_pool.h>
+#include <widgets/progress_reporter.h>
+
+
+// The pool (if any) the current thread is a worker of, and its index in that pool
+static thread_local const THREAD_POOL* s_currentPool = nullptr;
+static thread_local size_t             s_currentWorker = 0;
+
+
+THREAD_POOL::THREAD_POOL( size_t aWorkerCount ) :
+    m_nextQueue( 0 ), m_pending( 0 ), m_stop( false )
+{
+    if( aWorkerCount == 0 )
+        aWorkerCount = std::max<size_t>( std::thread::hardware_concurrency(), 1 );
+
+    for( size_t ii = 0; ii < aWorkerCount; ++ii )
+        m_queues.emplace_back( new WORKER_QUEUE );
+
+    for( size_t ii = 0; ii < aWorkerCount; ++ii )
+        m_workers.emplace_back( &THREAD_POOL::workerLoop, this, ii );
+}
+
+
+THREAD_POOL::~THREAD_POOL()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_sleepLock );
+        m_stop = true;
+    }
+
+    m_wakeUp.notify_all();
+
+    // The workers run the tasks still queued before leaving
+    for( std::thread& worker : m_workers )
+        worker.join();
+}
+
+
+bool THREAD_POOL::IsWorkerThread() const
+{
+    return s_currentPool == this;
+}
+
+
+void THREAD_POOL::push( TASK&& aTask )
+{
+    // Counted first, so that m_pending never goes below the number of queued tasks
+    {
+        std::lock_guard<std::mutex> lock( m_sleepLock );
+        m_pending++;
+    }
+
+    if( IsWorkerThread() )
+    {
+        WORKER_QUEUE& queue = *m_queues[ s_currentWorker ];
+        std::lock_guard<std::mutex> lock( queue.m_lock );
+        queue.m_tasks.push_front( std::move( aTask ) );
+    }
+    else
+    {
+        WORKER_QUEUE& queue = *m_queues[ m_nextQueue++ % m_queues.size() ];
+        std::lock_guard<std::mutex> lock( queue.m_lock );
+        queue.m_tasks.push_back( std::move( aTask ) );
+    }
+
+    m_wakeUp.notify_one();
+}
+
+
+bool THREAD_POOL::pop( size_t aWorker, TASK& aTask )
+{
+    bool found = false;
+
+    for( size_t ii = 0; ii < m_queues.size() && !found; ++ii )
+    {
+        WORKER_QUEUE& queue = *m_queues[ ( aWorker + ii ) % m_queues.size() ];
+        std::lock_guard<std::mutex> lock( queue.m_lock );
+
+        if( queue.m_tasks.empty() )
+            continue;
+
+        // Newest task of our own queue, oldest task of the others
+        if( ii == 0 )
+        {
+            aTask = std::move( queue.m_tasks.front() );
+            queue.m_tasks.pop_front();
+        }
+        else
+        {
+            aTask = std::move( queue.m_tasks.back() );
+            queue.m_tasks.pop_back();
+        }
+
+        found = true;
+    }
+
+    if( found )
+    {
+        std::lock_guard<std::mutex> lock( m_sleepLock );
+        m_pending--;
+    }
+
+    return found;
+}
+
+
+void THREAD_POOL::workerLoop( size_t aWorker )
+{
+    s_currentPool = this;
+    s_currentWorker = aWorker;
+
+    while( true )
+    {
+        TASK task;
+
+        if( pop( aWorker, task ) )
+        {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock( m_sleepLock );
+
+        m_wakeUp.wait( lock, [this]() { return m_stop || m_pending > 0; } );
+
+        if( m_stop && m_pending == 0 )
+            break;
+    }
+}
+
+
+void THREAD_POOL::ParallelFor( size_t aCount, const std::function<void( size_t )>& aFunc,
+                               PROGRESS_REPORTER* aReporter, size_t aMinItemsPerThread )
+{
+    if( aCount == 0 )
+        return;
+
+    // Shared with the helper tasks, which can start after the loop is over
+    struct LOOP_STATE
+    {
+        const std::function<void( size_t )>* m_func;
+        PROGRESS_REPORTER*                   m_reporter;
+        size_t                               m_count;
+        std::atomic<size_t>                  m_next;
+        std::atomic<size_t>                  m_done;
+        std::exception_ptr                   m_error;
+        std::mutex                           m_lock;
+        std::condition_variable              m_finished;
+    };
+
+    auto state = std::make_shared<LOOP_STATE>();
+    state->m_func = &aFunc;
+    state->m_reporter = aReporter;
+    state->m_count = aCount;
+    state->m_next = 0;
+    state->m_done = 0;
+
+    auto runItems = [state]()
+    {
+        for( size_t i = state->m_next++; i < state->m_count; i = state->m_next++ )
+        {
+            // Once cancelled, no more items are started: this one and the ones not claimed
+            // yet are only counted as done
+            if( state->m_reporter && state->m_reporter->IsCancelled() )
+            {
+                size_t unclaimed = state->m_next.exchange( state->m_count );
+                size_t skipped = 1;
+
+                if( unclaimed < state->m_count )
+                    skipped += state->m_count - unclaimed;
+
+                if( ( state->m_done += skipped ) == state->m_count )
+                {
+                    std::lock_guard<std::mutex> lock( state->m_lock );
+                    state->m_finished.notify_all();
+                }
+
+                break;
+            }
+
+            try
+            {
+                ( *state->m_func )( i );
+            }
+            catch( ... )
+            {
+                std::lock_guard<std::mutex> lock( state->m_lock );
+
+                if( !state->m_error )
+                    state->m_error = std::current_exception();
+            }
+
+            if( state->m_reporter )
+                state->m_reporter->AdvanceProgress();
+
+            if( ++state->m_done == state->m_count )
+            {
+                std::lock_guard<std::mutex> lock( state->m_lock );
+                state->m_finished.notify_all();
+            }
+        }
+    };
+
+    size_t threadCount = std::max<size_t>( aCount / std::max<size_t>( aMinItemsPerThread, 1 ), 1 );
+
+    // The calling thread works on the items too, unless it has to refresh the reporter
+    size_t helperCount = std::min( aReporter ? threadCount : threadCount - 1, GetWorkerCount() );
+
+    for( size_t ii = 0; ii < helperCount; ++ii )
+        push( runItems );
+
+    if( !aReporter )
+        runItems();
+
+    std::unique_lock<std::mutex> lock( state->m_lock );
+
+    while( state->m_done < aCount )
+    {
+        state->m_finished.wait_for( lock, std::chrono::milliseconds( 100 ) );
+
+        if( aReporter )
+        {
+            lock.unlock();
+            keepRefreshing( aReporter );
+            lock.lock();
+        }
+    }
+
+    if( state->m_error )
+        std::rethrow_exception( state->m_error );
+}
+
+
+bool THREAD_POOL::keepRefreshing( PROGRESS_REPORTER* aReporter )
+{
+    return aReporter->KeepRefreshing();
+}
+
+
+// The pool of the program, set when a kiface starts.  A function static pool alone would
+// give each kiface its own workers, as each one links its own copy of this library.
+static std::atomic<THREAD_POOL*> s_programPool( nullptr );
+
+
+void SetKiCadThreadPool( THREAD_POOL* aPool )
+{
+    s_programPool = aPool;
+}
+
+
+THREAD_POOL& GetKiCadThreadPool()
+{
+    if( THREAD_POOL* programPool = s_programPool )
+        return *programPool;
+
+    // The scripts and the tests run the kiface code without a program
+    static THREAD_POOL pool( (size_t) std::max( ADVANCED_CFG::GetCfg().m_threadPoolSize, 0 ) );
+
+    return pool;
+}
@@ -293,7 +293,8 @@ VIEW::VIEW( bool aIsDynamic ) :
     m_dynamic( aIsDynamic ),
     m_useDrawPriority( false ),
     m_nextDrawPriority( 0 ),
-    m_reverseDrawOrder( false )
+    m_reverseDrawOrder( false ),
+    m_bulkAdd( false )
 {
     // Set m_boundary to define the max area size. The default area size
     // is defined here as the max value of a int.
@@ -364,7 +365,12 @@ void VIEW::Add( VIEW_ITEM* aItem, int aDrawPriority )
     for( int i = 0; i < layers_count; ++i )
     {
         VIEW_LAYER& l = m_layers[layers[i]];
-        l.items->Insert( aItem );
+
+        if( m_bulkAdd )
+            l.pendingItems.push_back( aItem );
+        else
+            l.items->Insert( aItem );
+
         MarkTargetDirty( l.target );
     }
 
@@ -373,6 +379,30 @@ void VIEW::Add( VIEW_ITEM* aItem, int aDrawPriority )
 }
 
 
+void VIEW::BeginBulkAdd()
+{
+    m_bulkAdd = true;
+}
+
+
+void VIEW::EndBulkAdd()
+{
+    m_bulkAdd = false;
+
+    for( auto& entry : m_layers )
+    {
+        VIEW_LAYER& l = entry.second;
+
+        if( l.pendingItems.empty() )
+            continue;
+
+        l.items->BulkInsert( l.pendingItems );
+        l.pendingItems.clear();
+        MarkTargetDirty( l.target );
+    }
+}
+
+
 void VIEW::Remove( VIEW_ITEM* aItem )
 {
     if( !aItem )
@@ -401,6 +431,14 @@ void VIEW::Remove( VIEW_ITEM* aItem )
         l.items->Remove( aItem );
         MarkTargetDirty( l.target );
 
+        if( m_bulkAdd )
+        {
+            auto pending = std::find( l.pendingItems.begin(), l.pendingItems.end(), aItem );
+
+            if( pending != l.pendingItems.end() )
+                l.pendingItems.erase( pending );
+        }
+
         // Clear the GAL cache
         int prevGroup = viewData->getGroup( layers[i] );
 
@@ -1115,7 +1153,10 @@ void VIEW::Clear()
     m_allItems->clear();
 
     for( LAYER_MAP_ITER i = m_layers.begin(); i != m_layers.end(); ++i )
+    {
         i->second.items->RemoveAll();
+        i->second.pendingItems.clear();
+    }
 
     m_nextDrawPriority = 0;
 
@@ -30,7 +30,8 @@ PROGRESS_REPORTER::PROGRESS_REPORTER( int aNumPhases ) :
     m_phase( 0 ),
     m_numPhases( aNumPhases ),
     m_progress( 0 ),
-    m_maxProgress( 1 )
+    m_maxProgress( 1 ),
+    m_cancelled( false )
 {
 }
 
@@ -84,7 +85,10 @@ bool PROGRESS_REPORTER::KeepRefreshing( bool aWait )
         while( m_progress < m_maxProgress && m_maxProgress > 0 )
         {
             if( !updateUI() )
+            {
+                m_cancelled = true;
                 return false;
+            }
 
             wxMilliSleep( 20 );
         }
@@ -92,7 +96,10 @@ bool PROGRESS_REPORTER::KeepRefreshing( bool aWait )
     }
     else
     {
-        return updateUI();
+        if( !updateUI() )
+            m_cancelled = true;
+
+        return !m_cancelled;
     }
 }
 
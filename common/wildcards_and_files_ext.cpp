@@ -130,6 +130,7 @@ const std::string EquFileExtension( "equ" );
 
 const std::string LegacyPcbFileExtension( "brd" );
 const std::string KiCadPcbFileExtension( "kicad_pcb" );
+const std::string KiCadPcbSnapshotFileExtension( "kicad_pcb-snapshot" );
 const std::string PageLayoutDescrFileExtension( "kicad_wks" );
 
 const std::string PdfFileExtension( "pdf" );
@@ -929,6 +929,31 @@ SEARCH_RESULT LIB_PART::Visit( INSPECTOR aInspector, void* aTestData, const KICA
 }
 
 
+void LIB_PART::TakeDefinition( LIB_PART& aPart )
+{
+    m_FootprintList       = aPart.m_FootprintList;
+    m_unitCount           = aPart.m_unitCount;
+    m_unitsLocked         = aPart.m_unitsLocked;
+    m_pinNameOffset       = aPart.m_pinNameOffset;
+    m_showPinNumbers      = aPart.m_showPinNumbers;
+    m_showPinNames        = aPart.m_showPinNames;
+    m_dateLastEdition     = aPart.m_dateLastEdition;
+    m_options             = aPart.m_options;
+
+    for( int type = LIB_ITEMS_CONTAINER::FIRST_TYPE; type <= LIB_ITEMS_CONTAINER::LAST_TYPE;
+         ++type )
+    {
+        m_drawings[ type ].swap( aPart.m_drawings[ type ] );
+    }
+
+    for( LIB_ITEM& item : m_drawings )
+        item.SetParent( this );
+
+    // The fields come from aPart, the value has to follow the name kept here.
+    GetValueField().SetText( m_libId.GetLibItemName().wx_str() );
+}
+
+
 void LIB_PART::SetUnitCount( int aCount )
 {
     if( m_unitCount == aCount )
@@ -584,6 +584,17 @@ public:
         return m_drawings;
     }
 
+    /**
+     * Take the draw items, the footprint filters and the settings of \a aPart, which is left
+     * without draw items.
+     *
+     * The name, the aliases and the library id of this part are kept, so a part first
+     * created from a library index can be completed without invalidating its aliases.
+     *
+     * @param aPart - The part read from the library file.
+     */
+    void TakeDefinition( LIB_PART& aPart );
+
     SEARCH_RESULT Visit( INSPECTOR inspector, void* testData, const KICAD_T scanTypes[] ) override;
 
     /**
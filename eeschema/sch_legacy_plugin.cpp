@@ -23,17 +23,24 @@
 #include <algorithm>
 #include <boost/algorithm/string/join.hpp>
 #include <cctype>
+#include <exception>
 
 #include <wx/mstream.h>
 #include <wx/filename.h>
 #include <wx/tokenzr.h>
+#include <wx/textfile.h>
 #include <pgm_base.h>
+#include <advanced_config.h>
+#include <common.h>
 #include <gr_text.h>
 #include <kiway.h>
 #include <kicad_string.h>
+#include <md5_hash.h>
 #include <richio.h>
+#include <number_io.h>
 #include <core/typeinfo.h>
 #include <properties.h>
+#include <thread_pool.h>
 #include <trace_helpers.h>
 
 #include <general.h>
@@ -240,12 +247,12 @@ static double parseDouble( LINE_READER& aReader, const char* aLine,
     if( !*aLine )
         SCH_PARSE_ERROR( _( "unexpected end of line" ), aReader, aLine );
 
-    // Clear errno before calling strtod() in case some other crt call set it.
+    // Clear errno before calling ParseDouble() in case some other crt call set it.
     errno = 0;
 
-    double retv = strtod( aLine, (char**) aOutput );
+    double retv = ParseDouble( aLine, (char**) aOutput );
 
-    // Make sure no error occurred when calling strtod().
+    // Make sure no error occurred when calling ParseDouble().
     if( errno == ERANGE )
         SCH_PARSE_ERROR( "invalid floating point number", aReader, aLine );
 
@@ -461,6 +468,60 @@ static void parseQuotedString( wxString& aString, LINE_READER& aReader,
 }
 
 
+/// The first line of the symbol library index files, to change with their format
+static const char s_indexFormat[] = "sym-info-index 1";
+
+
+/**
+ * Opens the library file aFileName in binary mode, so that the lengths of the lines read
+ * add up to their file offsets whatever the line endings of the file.
+ */
+static FILE* openLibraryFile( const wxString& aFileName )
+{
+    FILE* fp = wxFopen( aFileName, wxT( "rb" ) );
+
+    if( !fp )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Unable to open filename \"%s\" for reading" ),
+                                          aFileName ) );
+    }
+
+    return fp;
+}
+
+
+/**
+ * A #FILE_LINE_READER which knows the file offset of the line it read last, so a symbol
+ * definition can be found again in its library file.
+ */
+class OFFSET_LINE_READER : public FILE_LINE_READER
+{
+public:
+    OFFSET_LINE_READER( const wxString& aFileName ) :
+        FILE_LINE_READER( openLibraryFile( aFileName ), aFileName ),
+        m_lineOffset( 0 ),
+        m_nextOffset( 0 )
+    {
+    }
+
+    char* ReadLine() override
+    {
+        char* line = FILE_LINE_READER::ReadLine();
+
+        m_lineOffset = m_nextOffset;
+        m_nextOffset += m_length;
+
+        return line;
+    }
+
+    long LineOffset() const { return m_lineOffset; }
+
+private:
+    long m_lineOffset;      ///< File offset of the current line.
+    long m_nextOffset;      ///< File offset of the next line.
+};
+
+
 /**
  * A cache assistant for the part library portion of the #SCH_PLUGIN API, and only for the
  * #SCH_LEGACY_PLUGIN, so therefore is private to this implementation file, i.e. not placed
@@ -480,7 +541,19 @@ class SCH_LEGACY_PLUGIN_CACHE
     int             m_versionMinor;
     int             m_libType;      // Is this cache a component or symbol library.
 
+    /// Where the definition of a part only read from the library index starts in the file.
+    struct PART_LOCATION
+    {
+        long        m_offset;       // Offset of the DEF line.
+        int         m_line;         // Number of the DEF line.
+    };
+
+    /// The parts which have their names, documentation and unit count but no draw items yet.
+    std::map<LIB_PART*, PART_LOCATION> m_unloadedParts;
+
     void                  loadHeader( FILE_LINE_READER& aReader );
+    void                  addAliases( LIB_PART* aPart );
+    static LIB_PART*      loadPartSummary( LINE_READER& aReader );
     static void           loadAliases( std::unique_ptr<LIB_PART>& aPart, LINE_READER& aReader );
     static void           loadField( std::unique_ptr<LIB_PART>& aPart, LINE_READER& aReader );
     static void           loadDrawEntries( std::unique_ptr<LIB_PART>& aPart, LINE_READER& aReader,
@@ -502,6 +575,11 @@ class SCH_LEGACY_PLUGIN_CACHE
                                           const char** aOutput );
     LIB_ALIAS*      removeAlias( LIB_ALIAS* aAlias );
 
+    wxString        indexFileName() const;
+    wxString        indexTimestamp() const;
+    bool            readIndex();
+    void            writeIndex();
+
     void            saveDocFile();
     static void     saveArc( LIB_ARC* aArc, OUTPUTFORMATTER& aFormatter );
     static void     saveBezier( LIB_BEZIER* aBezier, OUTPUTFORMATTER& aFormatter );
@@ -527,7 +605,24 @@ public:
     /// Save the entire library to file m_libFileName;
     void Save( bool aSaveDocFile = true );
 
-    void Load();
+    /**
+     * Load the library file.
+     *
+     * @param aIndexOnly - Only read the names, the documentation and the unit count of the
+     *                     parts, from the library index file when it is up to date.  The
+     *                     rest of each part is read by LoadUnloadedPart().
+     */
+    void Load( bool aIndexOnly = false );
+
+    /**
+     * Read the draw items of \a aPart, if it was only read from the library index.
+     */
+    void LoadUnloadedPart( LIB_PART* aPart );
+
+    /**
+     * Read the draw items of all the parts only read from the library index.
+     */
+    void LoadUnloadedParts();
 
     void AddSymbol( const LIB_PART* aPart );
 
@@ -559,6 +654,7 @@ public:
 
 SCH_LEGACY_PLUGIN::SCH_LEGACY_PLUGIN()
 {
+    m_parallelLoad = ADVANCED_CFG::GetCfg().m_parallelSchematicLoad;
     init( NULL );
 }
 
@@ -577,6 +673,8 @@ void SCH_LEGACY_PLUGIN::init( KIWAY* aKiway, const PROPERTIES* aProperties )
     m_kiway = aKiway;
     m_cache = NULL;
     m_out = NULL;
+    m_onWorker = false;
+    m_modified = false;
 }
 
 
@@ -627,7 +725,11 @@ SCH_SHEET* SCH_LEGACY_PLUGIN::Load( const wxString& aFileName, KIWAY* aKiway,
         std::unique_ptr< SCH_SHEET > newSheet( new SCH_SHEET );
         newSheet->SetFileName( aFileName );
         m_rootSheet = newSheet.get();
-        loadHierarchy( newSheet.get() );
+
+        if( m_parallelLoad )
+            loadHierarchyParallel( newSheet.get() );
+        else
+            loadHierarchy( newSheet.get() );
 
         // If we got here, the schematic loaded successfully.
         sheet = newSheet.release();
@@ -637,7 +739,11 @@ SCH_SHEET* SCH_LEGACY_PLUGIN::Load( const wxString& aFileName, KIWAY* aKiway,
         m_rootSheet = aAppendToMe->GetRootSheet();
         wxASSERT( m_rootSheet != NULL );
         sheet = aAppendToMe;
-        loadHierarchy( sheet );
+
+        if( m_parallelLoad )
+            loadHierarchyParallel( sheet );
+        else
+            loadHierarchy( sheet );
     }
 
     wxASSERT( m_currentPath.size() == 1 );  // only the project path should remain
@@ -729,6 +835,137 @@ void SCH_LEGACY_PLUGIN::loadHierarchy( SCH_SHEET* aSheet )
 }
 
 
+void SCH_LEGACY_PLUGIN::loadHierarchyParallel( SCH_SHEET* aSheet )
+{
+    struct SHEET_FILE
+    {
+        SCH_SHEET*         m_sheet;     ///< The first sheet using the file, parent of its sheets.
+        bool               m_loaded;
+        bool               m_modified;
+        wxString           m_error;
+        std::exception_ptr m_exception;
+    };
+
+    // The default field names are translated once and cached, before the workers use them.
+    TEMPLATE_FIELDNAME::GetDefaultFieldName( 0 );
+
+    // The sheets of the current level, with the path of the file they are found in.
+    std::vector< std::pair< SCH_SHEET*, wxString > > level;
+
+    if( !aSheet->GetScreen() )
+        level.emplace_back( aSheet, m_currentPath.top() );
+
+    while( !level.empty() )
+    {
+        std::vector< SHEET_FILE > files;
+
+        // Create the screens on the main thread.  As in loadHierarchy(), a file already
+        // loaded (or found earlier on this level) is shared instead of being loaded again.
+        for( const auto& entry : level )
+        {
+            SCH_SHEET*  sheet = entry.first;
+            SCH_SCREEN* screen = NULL;
+            wxFileName  fileName = sheet->GetFileName();
+
+            if( !fileName.IsAbsolute() )
+                fileName.MakeAbsolute( entry.second );
+
+            m_rootSheet->SearchHierarchy( fileName.GetFullPath(), &screen );
+
+            if( screen )
+            {
+                sheet->SetScreen( screen );
+                continue;
+            }
+
+            wxLogTrace( traceSchLegacyPlugin, "Loading        \"%s\"", fileName.GetFullPath() );
+
+            sheet->SetScreen( new SCH_SCREEN( m_kiway ) );
+            sheet->GetScreen()->SetFileName( fileName.GetFullPath() );
+            files.push_back( { sheet, false, false, wxEmptyString, nullptr } );
+        }
+
+        // Each file is parsed by its own plugin, which keeps the state of the file.
+        GetKiCadThreadPool().ParallelFor( files.size(),
+                [&]( size_t aIndex )
+                {
+                    SHEET_FILE&       file = files[aIndex];
+                    SCH_SCREEN*       screen = file.m_sheet->GetScreen();
+                    SCH_LEGACY_PLUGIN loader;
+
+                    loader.init( m_kiway, m_props );
+                    loader.m_onWorker = true;
+
+                    try
+                    {
+                        loader.loadFile( screen->GetFileName(), screen );
+                        file.m_loaded = true;
+                    }
+                    catch( const IO_ERROR& ioe )
+                    {
+                        file.m_error = ioe.What();
+                        file.m_exception = std::current_exception();
+                    }
+
+                    file.m_modified = loader.m_modified;
+                } );
+
+        std::vector< std::pair< SCH_SHEET*, wxString > > nextLevel;
+
+        // Link the loaded files in the hierarchy, in the order of the sheets.
+        for( SHEET_FILE& file : files )
+        {
+            SCH_SCREEN* screen = file.m_sheet->GetScreen();
+
+            if( file.m_modified && m_rootSheet->GetScreen() )
+                m_rootSheet->GetScreen()->SetModify();
+
+            for( EDA_ITEM* item = screen->GetDrawItems(); item; item = item->Next() )
+            {
+                // The bitmaps of the images are only created on the main thread.
+                if( item->Type() == SCH_BITMAP_T )
+                {
+                    BITMAP_BASE* image = static_cast< SCH_BITMAP* >( item )->GetImage();
+
+                    if( image->GetImageData() )
+                        image->SetBitmap( new wxBitmap( *image->GetImageData() ) );
+                }
+            }
+
+            if( !file.m_loaded )
+            {
+                // If there is a problem loading the root sheet, there is no recovery.
+                if( file.m_sheet == m_rootSheet )
+                    std::rethrow_exception( file.m_exception );
+
+                // For all subsheets, queue up the error message for the caller.
+                if( !m_error.IsEmpty() )
+                    m_error += "\n";
+
+                m_error += file.m_error;
+                continue;
+            }
+
+            wxString path = wxFileName( screen->GetFileName() ).GetPath();
+
+            for( EDA_ITEM* item = screen->GetDrawItems(); item; item = item->Next() )
+            {
+                if( item->Type() == SCH_SHEET_T )
+                {
+                    SCH_SHEET* sheet = static_cast< SCH_SHEET* >( item );
+
+                    // See loadHierarchy() about the parent of the sheets.
+                    sheet->SetParent( file.m_sheet );
+                    nextLevel.emplace_back( sheet, path );
+                }
+            }
+        }
+
+        level.swap( nextLevel );
+    }
+}
+
+
 void SCH_LEGACY_PLUGIN::loadFile( const wxString& aFileName, SCH_SCREEN* aScreen )
 {
     FILE_LINE_READER reader( aFileName );
@@ -1138,7 +1375,11 @@ SCH_BITMAP* SCH_LEGACY_PLUGIN::loadBitmap( LINE_READER& aReader )
                     wxMemoryInputStream istream( stream );
                     image->LoadFile( istream, wxBITMAP_TYPE_PNG );
                     bitmap->GetImage()->SetImage( image );
-                    bitmap->GetImage()->SetBitmap( new wxBitmap( *image ) );
+
+                    // Only the main thread can create bitmaps, loadHierarchyParallel() does it
+                    // for the files loaded on the workers.
+                    if( !m_onWorker )
+                        bitmap->GetImage()->SetBitmap( new wxBitmap( *image ) );
                     break;
                 }
 
@@ -1532,6 +1773,8 @@ SCH_COMPONENT* SCH_LEGACY_PLUGIN::loadComponent( LINE_READER& aReader )
                 // Set the file as modified so the user can be warned.
                 if( m_rootSheet && m_rootSheet->GetScreen() )
                     m_rootSheet->GetScreen()->SetModify();
+                else
+                    m_modified = true;
             }
 
             component->SetUnit( unit );
@@ -1546,6 +1789,8 @@ SCH_COMPONENT* SCH_LEGACY_PLUGIN::loadComponent( LINE_READER& aReader )
                 // Set the file as modified so the user can be warned.
                 if( m_rootSheet && m_rootSheet->GetScreen() )
                     m_rootSheet->GetScreen()->SetModify();
+                else
+                    m_modified = true;
             }
 
             component->SetConvert( convert );
@@ -2084,7 +2329,8 @@ void SCH_LEGACY_PLUGIN::saveBitmap( SCH_BITMAP* aBitmap )
 
     m_out->Print( 0, "$Bitmap\n" );
     m_out->Print( 0, "Pos %-4d %-4d\n", aBitmap->GetPosition().x, aBitmap->GetPosition().y );
-    m_out->Print( 0, "Scale %f\n", aBitmap->GetImage()->GetScale() );
+    m_out->Print( 0, "Scale %s\n",
+                  FormatDouble( "%f", aBitmap->GetImage()->GetScale() ).c_str() );
     m_out->Print( 0, "Data\n" );
 
     wxMemoryOutputStream stream;
@@ -2422,6 +2668,7 @@ LIB_ALIAS* SCH_LEGACY_PLUGIN_CACHE::removeAlias( LIB_ALIAS* aAlias )
 
     if( !alias )
     {
+        m_unloadedParts.erase( part );
         delete part;
 
         if( m_aliases.size() > 1 )
@@ -2468,7 +2715,7 @@ void SCH_LEGACY_PLUGIN_CACHE::AddSymbol( const LIB_PART* aPart )
 }
 
 
-void SCH_LEGACY_PLUGIN_CACHE::Load()
+void SCH_LEGACY_PLUGIN_CACHE::Load( bool aIndexOnly )
 {
     if( !m_libFileName.FileExists() )
     {
@@ -2480,10 +2727,20 @@ void SCH_LEGACY_PLUGIN_CACHE::Load()
                  wxString::Format( "Cannot use relative file paths in legacy plugin to "
                                    "open library \"%s\".", m_libFileName.GetFullPath() ) );
 
+    if( aIndexOnly && readIndex() )
+    {
+        wxLogTrace( traceSchLegacyPlugin, "Read the index of legacy symbol file \"%s\"",
+                    m_libFileName.GetFullPath() );
+
+        ++m_modHash;
+        m_fileModTime = GetLibModificationTime();
+        return;
+    }
+
     wxLogTrace( traceSchLegacyPlugin, "Loading legacy symbol file \"%s\"",
                 m_libFileName.GetFullPath() );
 
-    FILE_LINE_READER reader( m_libFileName.GetFullPath() );
+    OFFSET_LINE_READER reader( m_libFileName.GetFullPath() );
 
     if( !reader.ReadLine() )
         THROW_IO_ERROR( _( "unexpected end of file" ) );
@@ -2538,48 +2795,17 @@ void SCH_LEGACY_PLUGIN_CACHE::Load()
         if( strCompare( "DEF", line ) )
         {
             // Read one DEF/ENDDEF part entry from library:
-            LIB_PART * part = LoadPart( reader, m_versionMajor, m_versionMinor );
-
-            // Add aliases to cache
-            for( size_t ii = 0; ii < part->GetAliasCount(); ++ii )
+            if( aIndexOnly )
             {
-                LIB_ALIAS* alias = part->GetAlias( ii );
-                const wxString& aliasName = alias->GetName();
-
-                // This section seems to do a similar job as checkForDuplicates, so
-                // I'm not sure checkForDuplicates needs to be preserved.
-                auto it = m_aliases.find( aliasName );
-
-                if( it != m_aliases.end() )
-                {
-                    // Find a new name for the alias
-                    wxString newName;
-                    int idx = 0;
-                    LIB_ALIAS_MAP::const_iterator jt;
-
-                    do
-                    {
-                        newName = wxString::Format( "%s_%d", aliasName, idx );
-                        jt = m_aliases.find( newName );
-                        ++idx;
-                    }
-                    while( jt != m_aliases.end() );
-
-                    wxLogWarning( "Symbol name conflict in library:\n%s\n"
-                                  "'%s' has been renamed to '%s'",
-                                  m_fileName, aliasName, newName );
+                PART_LOCATION location = { reader.LineOffset(), (int) reader.LineNumber() };
+                LIB_PART*     part = loadPartSummary( reader );
 
-                    if( alias->IsRoot() )
-                        part->SetName( newName );
-                    else
-                        alias->SetName( newName );
-
-                    m_aliases[newName] = alias;
-                }
-                else
-                {
-                    m_aliases[aliasName] = alias;
-                }
+                m_unloadedParts[ part ] = location;
+                addAliases( part );
+            }
+            else
+            {
+                addAliases( LoadPart( reader, m_versionMajor, m_versionMinor ) );
             }
         }
     }
@@ -2593,6 +2819,92 @@ void SCH_LEGACY_PLUGIN_CACHE::Load()
 
     if( USE_OLD_DOC_FILE_FORMAT( m_versionMajor, m_versionMinor ) )
         loadDocs();
+
+    // The index is only a cache: a library which cannot be indexed is read every time.
+    if( aIndexOnly )
+    {
+        try
+        {
+            writeIndex();
+        }
+        catch( const IO_ERROR& )
+        {
+        }
+    }
+}
+
+
+void SCH_LEGACY_PLUGIN_CACHE::addAliases( LIB_PART* aPart )
+{
+    for( size_t ii = 0; ii < aPart->GetAliasCount(); ++ii )
+    {
+        LIB_ALIAS* alias = aPart->GetAlias( ii );
+        const wxString& aliasName = alias->GetName();
+
+        // This section seems to do a similar job as checkForDuplicates, so
+        // I'm not sure checkForDuplicates needs to be preserved.
+        auto it = m_aliases.find( aliasName );
+
+        if( it != m_aliases.end() )
+        {
+            // Find a new name for the alias
+            wxString newName;
+            int idx = 0;
+            LIB_ALIAS_MAP::const_iterator jt;
+
+            do
+            {
+                newName = wxString::Format( "%s_%d", aliasName, idx );
+                jt = m_aliases.find( newName );
+                ++idx;
+            }
+            while( jt != m_aliases.end() );
+
+            wxLogWarning( "Symbol name conflict in library:\n%s\n"
+                          "'%s' has been renamed to '%s'",
+                          m_fileName, aliasName, newName );
+
+            if( alias->IsRoot() )
+                aPart->SetName( newName );
+            else
+                alias->SetName( newName );
+
+            m_aliases[newName] = alias;
+        }
+        else
+        {
+            m_aliases[aliasName] = alias;
+        }
+    }
+}
+
+
+void SCH_LEGACY_PLUGIN_CACHE::LoadUnloadedPart( LIB_PART* aPart )
+{
+    auto it = m_unloadedParts.find( aPart );
+
+    if( it == m_unloadedParts.end() )
+        return;
+
+    FILE* fp = openLibraryFile( m_fileName );
+
+    // The reader takes the file and counts the lines from the DEF line, for the errors.
+    FILE_LINE_READER reader( fp, m_fileName, true, it->second.m_line - 1 );
+
+    if( fseek( fp, it->second.m_offset, SEEK_SET ) != 0 || !reader.ReadLine() )
+        THROW_IO_ERROR( _( "unexpected end of file" ) );
+
+    std::unique_ptr<LIB_PART> part( LoadPart( reader, m_versionMajor, m_versionMinor ) );
+
+    aPart->TakeDefinition( *part );
+    m_unloadedParts.erase( it );
+}
+
+
+void SCH_LEGACY_PLUGIN_CACHE::LoadUnloadedParts()
+{
+    while( !m_unloadedParts.empty() )
+        LoadUnloadedPart( m_unloadedParts.begin()->first );
 }
 
 
@@ -2697,6 +3009,207 @@ void SCH_LEGACY_PLUGIN_CACHE::loadDocs()
 }
 
 
+wxString SCH_LEGACY_PLUGIN_CACHE::indexFileName() const
+{
+    // The library path itself is not usable as a file name
+    wxScopedCharBuffer path = m_fileName.utf8_str();
+    MD5_HASH           hash;
+
+    hash.Hash( (uint8_t*) path.data(), path.length() );
+    hash.Finalize();
+
+    wxFileName fn( GetKicadConfigPath(), hash.Format() );
+
+    fn.AppendDir( wxT( "sym-info-index" ) );
+
+    return fn.GetFullPath();
+}
+
+
+wxString SCH_LEGACY_PLUGIN_CACHE::indexTimestamp() const
+{
+    wxFileName libFn = GetRealFile();
+    wxFileName docFn = m_libFileName;
+    long long  docTime = 0;
+
+    docFn.SetExt( DOC_EXT );
+
+    if( docFn.FileExists() )
+        docTime = docFn.GetModificationTime().GetValue().GetValue();
+
+    return wxString::Format( "%lld %llu %lld",
+                             (long long) libFn.GetModificationTime().GetValue().GetValue(),
+                             (unsigned long long) libFn.GetSize().GetValue(),
+                             docTime );
+}
+
+
+bool SCH_LEGACY_PLUGIN_CACHE::readIndex()
+{
+    wxTextFile file( indexFileName() );
+    size_t     lineNumber = 0;
+    wxString   text;
+
+    auto nextLine = [&]( wxString& aLine ) -> bool
+    {
+        if( lineNumber >= file.GetLineCount() )
+            return false;
+
+        aLine = file[ lineNumber++ ];
+        return true;
+    };
+
+    auto nextNumber = [&]( long& aValue ) -> bool
+    {
+        return nextLine( text ) && text.ToLong( &aValue );
+    };
+
+    long major, minor, libType, count;
+
+    if( !file.Exists() || !file.Open() )
+        return false;
+
+    if( !nextLine( text ) || text != s_indexFormat
+            || !nextLine( text ) || text != m_fileName
+            || !nextLine( text ) || text != indexTimestamp()
+            || !nextNumber( major ) || !nextNumber( minor ) || !nextNumber( libType )
+            || !nextNumber( count ) || count < 0 )
+    {
+        return false;
+    }
+
+    // Nothing is added to the cache before the whole index is read.
+    std::vector<std::unique_ptr<LIB_PART>> parts;
+    std::vector<PART_LOCATION>             locations;
+
+    for( long ii = 0; ii < count; ++ii )
+    {
+        long     offset, line, unitCount, power, aliasCount;
+        wxString footprint;
+
+        if( !nextNumber( offset ) || !nextNumber( line ) || !nextNumber( unitCount )
+                || !nextNumber( power ) || !nextLine( footprint )
+                || !nextNumber( aliasCount ) || aliasCount < 1 )
+        {
+            return false;
+        }
+
+        std::unique_ptr<LIB_PART> part( new LIB_PART( wxEmptyString ) );
+
+        for( long jj = 0; jj < aliasCount; ++jj )
+        {
+            wxString name, description, keywords, docFileName;
+
+            if( !nextLine( name ) || !nextLine( description ) || !nextLine( keywords )
+                    || !nextLine( docFileName ) )
+            {
+                return false;
+            }
+
+            if( jj == 0 )
+                part->SetName( name );
+            else
+                part->AddAlias( name );
+
+            LIB_ALIAS* alias = part->GetAlias( (size_t) jj );
+
+            alias->SetDescription( UnescapeString( description ) );
+            alias->SetKeyWords( UnescapeString( keywords ) );
+            alias->SetDocFileName( UnescapeString( docFileName ) );
+        }
+
+        part->SetUnitCount( std::max( (int) unitCount, 1 ) );
+        part->GetFootprintField().SetText( UnescapeString( footprint ) );
+
+        if( power )
+            part->SetPower();
+
+        parts.push_back( std::move( part ) );
+        locations.push_back( { offset, (int) line } );
+    }
+
+    if( lineNumber != file.GetLineCount() )
+        return false;
+
+    m_versionMajor = (int) major;
+    m_versionMinor = (int) minor;
+    m_libType = (int) libType;
+
+    for( size_t ii = 0; ii < parts.size(); ++ii )
+    {
+        LIB_PART* part = parts[ii].release();
+
+        m_unloadedParts[ part ] = locations[ii];
+        addAliases( part );
+    }
+
+    return true;
+}
+
+
+void SCH_LEGACY_PLUGIN_CACHE::writeIndex()
+{
+    wxFileName fn( indexFileName() );
+
+    if( !fn.DirExists() && !wxFileName::Mkdir( fn.GetPath(), wxS_DIR_DEFAULT,
+                                               wxPATH_MKDIR_FULL ) )
+    {
+        return;
+    }
+
+    wxTextFile file( fn.GetFullPath() );
+
+    if( file.Exists() ? !file.Open() : !file.Create() )
+        return;
+
+    // The parts in the order of the library file
+    std::vector<std::pair<LIB_PART*, PART_LOCATION>> parts( m_unloadedParts.begin(),
+                                                            m_unloadedParts.end() );
+
+    std::sort( parts.begin(), parts.end(),
+               []( const std::pair<LIB_PART*, PART_LOCATION>& a,
+                   const std::pair<LIB_PART*, PART_LOCATION>& b )
+               {
+                   return a.second.m_offset < b.second.m_offset;
+               } );
+
+    file.Clear();
+    file.AddLine( s_indexFormat );
+    file.AddLine( m_fileName );
+    file.AddLine( indexTimestamp() );
+    file.AddLine( wxString::Format( "%d", m_versionMajor ) );
+    file.AddLine( wxString::Format( "%d", m_versionMinor ) );
+    file.AddLine( wxString::Format( "%d", m_libType ) );
+    file.AddLine( wxString::Format( "%d", (int) parts.size() ) );
+
+    for( const std::pair<LIB_PART*, PART_LOCATION>& entry : parts )
+    {
+        LIB_PART* part = entry.first;
+
+        file.AddLine( wxString::Format( "%ld", entry.second.m_offset ) );
+        file.AddLine( wxString::Format( "%d", entry.second.m_line ) );
+        file.AddLine( wxString::Format( "%d", part->GetUnitCount() ) );
+        file.AddLine( part->IsPower() ? "1" : "0" );
+        file.AddLine( EscapeString( part->GetFootprintField().GetText(), CTX_DELIMITED_STR ) );
+        file.AddLine( wxString::Format( "%d", (int) part->GetAliasCount() ) );
+
+        for( size_t ii = 0; ii < part->GetAliasCount(); ++ii )
+        {
+            LIB_ALIAS* alias = part->GetAlias( ii );
+
+            file.AddLine( alias->GetName() );
+            file.AddLine( EscapeString( alias->GetDescription(), CTX_DELIMITED_STR ) );
+            file.AddLine( EscapeString( alias->GetKeyWords(), CTX_DELIMITED_STR ) );
+            file.AddLine( EscapeString( alias->GetDocFileName(), CTX_DELIMITED_STR ) );
+        }
+    }
+
+    // Written to a temporary file renamed at the end, so the index is never seen half written
+    file.Write();
+    file.Close();
+}
+
+
 void SCH_LEGACY_PLUGIN_CACHE::loadHeader( FILE_LINE_READER& aReader )
 {
     const char* line = aReader.Line();
@@ -2897,6 +3410,80 @@ LIB_PART* SCH_LEGACY_PLUGIN_CACHE::LoadPart( LINE_READER& aReader, int aMajorVer
 }
 
 
+LIB_PART* SCH_LEGACY_PLUGIN_CACHE::loadPartSummary( LINE_READER& aReader )
+{
+    const char* line = aReader.Line();
+
+    if( !strCompare( "DEF", line, &line ) )
+        SCH_PARSE_ERROR( "invalid symbol definition", aReader, line );
+
+    wxString utf8Line = wxString::FromUTF8( line );
+    wxStringTokenizer tokens( utf8Line, " \r\n\t" );
+
+    if( tokens.CountTokens() < 8 )
+        SCH_PARSE_ERROR( "invalid symbol definition", aReader, line );
+
+    std::unique_ptr< LIB_PART > part( new LIB_PART( wxEmptyString ) );
+
+    wxString name = tokens.GetNextToken();
+    long     unitCount;
+
+    // The prefix, the unused pin count, the pin name offset and the pin visibility flags
+    // are read with the draw items.
+    for( int ii = 0; ii < 5; ii++ )
+        tokens.GetNextToken();
+
+    if( !tokens.GetNextToken().ToLong( &unitCount ) )
+        SCH_PARSE_ERROR( "invalid unit count", aReader, line );
+
+    part->SetUnitCount( std::max( (int) unitCount, 1 ) );
+
+    // A leading '~' only hides the value field.
+    part->SetName( name[0] == '~' ? name.Mid( 1 ) : name );
+
+    tokens.GetNextToken();                        // Units locked flag.
+
+    if( tokens.HasMoreTokens() && tokens.GetNextToken() == "P" )
+        part->SetPower();
+
+    line = aReader.ReadLine();
+
+    // Read lines until "ENDDEF" is found.  The fields are read for the footprint, which is
+    // searched with the keywords and the description.
+    while( line )
+    {
+        if( strCompare( "ALIAS", line ) )
+        {
+            loadAliases( part, aReader );
+        }
+        else if( *line == 'F' )
+        {
+            loadField( part, aReader );
+        }
+        else if( strCompare( "$FPLIST", line ) )
+        {
+            loadFootprintFilters( part, aReader );
+        }
+        else if( strCompare( "DRAW", line ) )
+        {
+            while( ( line = aReader.ReadLine() ) != NULL && !strCompare( "ENDDRAW", line ) )
+                ;
+
+            if( !line )
+                break;
+        }
+        else if( strCompare( "ENDDEF", line ) )
+        {
+            return part.release();
+        }
+
+        line = aReader.ReadLine();
+    }
+
+    SCH_PARSE_ERROR( "missing ENDDEF", aReader, line );
+}
+
+
 #if 0
 bool SCH_LEGACY_PLUGIN_CACHE::checkForDuplicates( wxString& aAliasName )
 {
@@ -3661,6 +4248,9 @@ void SCH_LEGACY_PLUGIN_CACHE::Save( bool aSaveDocFile )
     if( !m_isModified )
         return;
 
+    // Read before the library file is written over
+    LoadUnloadedParts();
+
     // Write through symlinks, don't replace them
     wxFileName fn = GetRealFile();
 
@@ -4114,7 +4704,8 @@ void SCH_LEGACY_PLUGIN_CACHE::saveText( LIB_TEXT* aText,
         text = wxT( "\"" ) + text + wxT( "\"" );
     }
 
-    aFormatter.Print( 0, "T %g %d %d %d %d %d %d %s", aText->GetTextAngle(),
+    aFormatter.Print( 0, "T %s %d %d %d %d %d %d %s",
+                      FormatDouble( "%g", aText->GetTextAngle() ).c_str(),
                       aText->GetTextPos().x, aText->GetTextPos().y,
                       aText->GetTextWidth(), !aText->IsVisible(),
                       aText->GetUnit(), aText->GetConvert(), TO_UTF8( text ) );
@@ -4229,7 +4820,7 @@ void SCH_LEGACY_PLUGIN_CACHE::DeleteSymbol( const wxString& aAliasName )
 }
 
 
-void SCH_LEGACY_PLUGIN::cacheLib( const wxString& aLibraryFileName )
+void SCH_LEGACY_PLUGIN::cacheLib( const wxString& aLibraryFileName, bool aIndexOnly )
 {
     if( !m_cache || !m_cache->IsFile( aLibraryFileName ) || m_cache->IsFileChanged() )
     {
@@ -4243,7 +4834,11 @@ void SCH_LEGACY_PLUGIN::cacheLib( const wxString& aLibraryFileName )
         PART_LIBS::s_modify_generation++;
 
         if( !isBuffering( m_props ) )
-            m_cache->Load();
+            m_cache->Load( aIndexOnly );
+    }
+    else if( !aIndexOnly )
+    {
+        m_cache->LoadUnloadedParts();
     }
 }
 
@@ -4285,7 +4880,9 @@ void SCH_LEGACY_PLUGIN::EnumerateSymbolLib( wxArrayString&    aAliasNameList,
 
     bool powerSymbolsOnly = ( aProperties &&
                               aProperties->find( SYMBOL_LIB_TABLE::PropPowerSymsOnly ) != aProperties->end() );
-    cacheLib( aLibraryPath );
+
+    // The names and the power flag are in the library index.
+    cacheLib( aLibraryPath, true );
 
     const LIB_ALIAS_MAP& aliases = m_cache->m_aliases;
 
@@ -4307,7 +4904,9 @@ void SCH_LEGACY_PLUGIN::EnumerateSymbolLib( std::vector<LIB_ALIAS*>& aAliasList,
 
     bool powerSymbolsOnly = ( aProperties &&
                               aProperties->find( SYMBOL_LIB_TABLE::PropPowerSymsOnly ) != aProperties->end() );
-    cacheLib( aLibraryPath );
+    bool indexOnly = ( aProperties &&
+                       aProperties->find( SYMBOL_LIB_TABLE::PropIndexOnly ) != aProperties->end() );
+    cacheLib( aLibraryPath, indexOnly );
 
     const LIB_ALIAS_MAP& aliases = m_cache->m_aliases;
 
@@ -4326,13 +4925,16 @@ LIB_ALIAS* SCH_LEGACY_PLUGIN::LoadSymbol( const wxString& aLibraryPath, const wx
 
     m_props = aProperties;
 
-    cacheLib( aLibraryPath );
+    // Only the symbol asked for is read from a library loaded from its index.
+    cacheLib( aLibraryPath, true );
 
     LIB_ALIAS_MAP::const_iterator it = m_cache->m_aliases.find( aAliasName );
 
     if( it == m_cache->m_aliases.end() )
         return NULL;
 
+    m_cache->LoadUnloadedPart( it->second->GetPart() );
+
     return it->second;
 }
 
@@ -140,8 +140,21 @@ public:
     static LIB_PART* ParsePart( LINE_READER& aReader, int majorVersion = 0, int minorVersion = 0 );
     static void FormatPart( LIB_PART* aPart, OUTPUTFORMATTER& aFormatter );
 
+    /**
+     * Parse the sheet files of the hierarchy loaded by Load() on the threads of the KiCad
+     * thread pool.  Defaults to the ParallelSchematicLoad advanced setting.
+     */
+    void SetParallelLoad( bool aEnable ) { m_parallelLoad = aEnable; }
+
 private:
     void loadHierarchy( SCH_SHEET* aSheet );
+
+    /**
+     * Load the same hierarchy as loadHierarchy(), one level after another: the files of the
+     * sheets of a level are found and their screens created first, then the files are parsed
+     * in parallel and the sheets found in them make the next level.
+     */
+    void loadHierarchyParallel( SCH_SHEET* aSheet );
     void loadHeader( LINE_READER& aReader, SCH_SCREEN* aScreen );
     void loadPageSettings( LINE_READER& aReader, SCH_SCREEN* aScreen );
     void loadFile( const wxString& aFileName, SCH_SCREEN* aScreen );
@@ -166,7 +179,14 @@ private:
     void saveText( SCH_TEXT* aText );
     void saveBusAlias( std::shared_ptr<BUS_ALIAS> aAlias );
 
-    void cacheLib( const wxString& aLibraryFileName );
+    /**
+     * Load the library \a aLibraryFileName in the cache, unless it is already loaded.
+     *
+     * @param aIndexOnly - Only the names, the documentation and the unit count of the symbols
+     *                     are needed, they can come from the library index.  Otherwise the
+     *                     symbols only read from the index are read entirely.
+     */
+    void cacheLib( const wxString& aLibraryFileName, bool aIndexOnly = false );
     bool writeDocFile( const PROPERTIES* aProperties );
     bool isBuffering( const PROPERTIES* aProperties );
 
@@ -183,6 +203,9 @@ protected:
     SCH_SHEET*           m_rootSheet;  ///< The root sheet of the schematic being loaded..
     OUTPUTFORMATTER*     m_out;        ///< The output formatter for saving SCH_SCREEN objects.
     SCH_LEGACY_PLUGIN_CACHE* m_cache;
+    bool                 m_parallelLoad; ///< Use loadHierarchyParallel() in Load().
+    bool                 m_onWorker;   ///< Loading one file of a parallel load, on a worker.
+    bool                 m_modified;   ///< A fix-up was made but there is no root screen to flag.
 
     /// initialize PLUGIN like a constructor would.
     void init( KIWAY* aKiway, const PROPERTIES* aProperties = nullptr );
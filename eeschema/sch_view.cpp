@@ -92,6 +92,9 @@ void SCH_VIEW::ResizeSheetWorkingArea( SCH_SCREEN* aScreen )
 
 void SCH_VIEW::DisplaySheet( SCH_SCREEN *aScreen )
 {
+    // The whole sheet is indexed at once, at the end
+    BeginBulkAdd();
+
     for( auto item = aScreen->GetDrawItems(); item; item = item->Next() )
         Add( item );
 
@@ -114,6 +117,8 @@ void SCH_VIEW::DisplaySheet( SCH_SCREEN *aScreen )
     Add( m_worksheet.get() );
     Add( m_selectionArea.get() );
     Add( m_preview.get() );
+
+    EndBulkAdd();
 }
 
 
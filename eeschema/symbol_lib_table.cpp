@@ -44,6 +44,7 @@ static const wxString global_tbl_name( "sym-lib-table" );
 
 const char* SYMBOL_LIB_TABLE::PropPowerSymsOnly = "pwr_sym_only";
 const char* SYMBOL_LIB_TABLE::PropNonPowerSymsOnly = "non_pwr_sym_only";
+const char* SYMBOL_LIB_TABLE::PropIndexOnly = "index_only";
 int SYMBOL_LIB_TABLE::m_modifyHash = 1;     // starts at 1 and goes up
 
 
@@ -304,7 +305,8 @@ SYMBOL_LIB_TABLE_ROW* SYMBOL_LIB_TABLE::FindRow( const wxString& aNickname )
 
 
 void SYMBOL_LIB_TABLE::LoadSymbolLib( std::vector<LIB_ALIAS*>& aAliasList,
-                                      const wxString& aNickname, bool aPowerSymbolsOnly )
+                                      const wxString& aNickname, bool aPowerSymbolsOnly,
+                                      bool aIndexOnly )
 {
     SYMBOL_LIB_TABLE_ROW* row = FindRow( aNickname );
     wxCHECK( row && row->plugin, /* void */  );
@@ -314,9 +316,12 @@ void SYMBOL_LIB_TABLE::LoadSymbolLib( std::vector<LIB_ALIAS*>& aAliasList,
     if( aPowerSymbolsOnly )
         row->SetOptions( row->GetOptions() + " " + PropPowerSymsOnly );
 
+    if( aIndexOnly )
+        row->SetOptions( row->GetOptions() + "|" + PropIndexOnly );
+
     row->plugin->EnumerateSymbolLib( aAliasList, row->GetFullURI( true ), row->GetProperties() );
 
-    if( aPowerSymbolsOnly )
+    if( aPowerSymbolsOnly || aIndexOnly )
         row->SetOptions( options );
 
     // The library cannot know its own name, because it might have been renamed or moved.
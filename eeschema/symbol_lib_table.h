@@ -112,6 +112,10 @@ public:
     static const char* PropPowerSymsOnly;
     static const char* PropNonPowerSymsOnly;
 
+    /// Only the names, the documentation and the unit count of the symbols are needed, the
+    /// plugin may leave the rest of the symbols unread until they are loaded one by one.
+    static const char* PropIndexOnly;
+
     virtual void Parse( LIB_TABLE_LEXER* aLexer ) override;
 
     virtual void Format( OUTPUTFORMATTER* aOutput, int aIndentLevel ) const override;
@@ -157,8 +161,20 @@ public:
     void EnumerateSymbolLib( const wxString& aNickname, wxArrayString& aAliasNames,
                              bool aPowerSymbolsOnly = false );
 
+    /**
+     * Return the symbol aliases of the library given by @a aNickname.
+     *
+     * @param aAliasList is the list to fill with the aliases, which belong to the library.
+     * @param aNickname is a locator for the "library", it is a "name" in LIB_TABLE_ROW.
+     * @param aPowerSymbolsOnly is a flag to list only the power symbols.
+     * @param aIndexOnly is a flag telling that only the names, the documentation and the
+     *                   unit count of the symbols are used.  Their draw items have to be
+     *                   loaded with LoadSymbol() before they are drawn or placed.
+     *
+     * @throw IO_ERROR if the library cannot be found or loaded.
+     */
     void LoadSymbolLib( std::vector<LIB_ALIAS*>& aAliasList, const wxString& aNickname,
-                        bool aPowerSymbolsOnly = false );
+                        bool aPowerSymbolsOnly = false, bool aIndexOnly = false );
 
     /**
      * Load a #LIB_ALIAS having @a aAliasName from the library given by @a aNickname.
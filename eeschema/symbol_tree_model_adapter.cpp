@@ -94,7 +94,8 @@ void SYMBOL_TREE_MODEL_ADAPTER::AddLibrary( wxString const& aLibNickname )
 
     try
     {
-        m_libs->LoadSymbolLib( alias_list, aLibNickname, onlyPowerSymbols );
+        // The symbols are read entirely only once they are previewed or placed.
+        m_libs->LoadSymbolLib( alias_list, aLibNickname, onlyPowerSymbols, true );
     }
     catch( const IO_ERROR& ioe )
     {
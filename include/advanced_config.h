@@ -83,6 +83,26 @@ public:
      */
     int m_coroutineStackSize;
 
+    /**
+     * Number of worker threads of the shared thread pool (0 for one per hardware thread)
+     */
+    int m_threadPoolSize;
+
+    /**
+     * Parse the footprints, tracks and zones of the boards on the shared thread pool
+     */
+    bool m_parallelBoardLoad;
+
+    /**
+     * Parse the sheet files of the schematics on the shared thread pool
+     */
+    bool m_parallelSchematicLoad;
+
+    /**
+     * Write a binary snapshot next to the saved boards, and open the unchanged boards from it
+     */
+    bool m_boardSnapshots;
+
     /**
      * Helper to determine if legacy canvas is allowed (according to platform
      * and config)
@@ -212,4 +212,32 @@ std::string FormatInternalUnits( const wxSize& aSize );
 std::string FormatInternalUnits( const VECTOR2I& aPoint );
 
 
+/**
+ * Class FMT_IU
+ * holds the text of FormatInternalUnits() for a value, a point or a size on the stack,
+ * so the file writers can format it without allocating a std::string:
+ *
+ *      aFormatter->Print( 0, "(at %s)", FMT_IU( aItem->GetPosition() ).c_str() );
+ *
+ * The text lives as long as the FMT_IU, that is to the end of the full expression when
+ * used as above.
+ */
+class FMT_IU
+{
+public:
+    explicit FMT_IU( int aValue );
+    explicit FMT_IU( const wxPoint& aPoint );
+    explicit FMT_IU( const wxSize& aSize );
+    explicit FMT_IU( const VECTOR2I& aPoint );
+
+    const char* c_str() const { return m_text; }
+
+    int size() const { return m_length; }
+
+private:
+    char    m_text[96];     ///< two values of at most 18 decimals and a separator
+    int     m_length;
+};
+
+
 #endif   // _BASE_UNITS_H_
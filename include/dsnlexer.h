@@ -42,6 +42,43 @@ struct KEYWORD
     const char* name;       ///< unique keyword.
     int         token;      ///< a zero based index into an array of KEYWORDs
 };
+
+
+/**
+ * Struct KEYWORD_HASH
+ * is a perfect hash of a KEYWORD table, generated with the table by TokenList2DsnLexer.cmake.
+ * Each keyword has a slot of its own, so a text is hashed once and compared to one keyword
+ * at most.  The keywords are spread in buckets, and the generator chose for each bucket the
+ * displacement which puts its keywords in free slots.
+ */
+struct KEYWORD_HASH
+{
+    unsigned                seed;
+    unsigned                bucketMask;
+    const unsigned short*   displacements;  ///< displacement of each bucket
+    unsigned                slotMask;
+    const short*            slots;          ///< keyword index of each slot, -1 if free
+
+    /**
+     * Function Lookup
+     * @return the index of the only keyword which can be @a aText, or -1 if there is none.
+     *  The keyword still has to be compared to @a aText.
+     */
+    int Lookup( const char* aText, size_t aLength ) const
+    {
+        // Keep in sync with the generator in TokenList2DsnLexer.cmake
+        unsigned hash = seed;
+
+        for( size_t i = 0; i < aLength; ++i )
+            hash = ( ( hash * 33 ) ^ (unsigned char) aText[i] ) & 0xFFFFFF;
+
+        hash ^= hash >> 12;
+
+        unsigned displacement = displacements[hash & bucketMask];
+
+        return slots[( ( hash >> 4 ) + displacement * ( ( hash >> 12 ) | 1 ) ) & slotMask];
+    }
+};
 #endif
 
 // something like this macro can be used to help initialize a KEYWORD table.
@@ -111,6 +148,8 @@ protected:
     const KEYWORD*      keywords;               ///< table sorted by CMake for bsearch()
     unsigned            keywordCount;           ///< count of keywords table
     KEYWORD_MAP         keyword_hash;           ///< fast, specialized "C string" hashtable
+    const KEYWORD_HASH* keywordHash;            ///< perfect hash of keywords, if any, used
+                                                ///< instead of keyword_hash
 
     void init();
 
@@ -169,9 +208,11 @@ public:
      * @param aKeywordCount is the count of tokens in aKeywordTable.
      * @param aFile is an open file, which will be closed when this is destructed.
      * @param aFileName is the name of the file
+     * @param aKeywordHash is the perfect hash of aKeywordTable, if there is one.
      */
     DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-              FILE* aFile, const wxString& aFileName );
+              FILE* aFile, const wxString& aFileName,
+              const KEYWORD_HASH* aKeywordHash = NULL );
 
     /**
      * Constructor ( const KEYWORD*, unsigned, const std::string&, const wxString& )
@@ -182,9 +223,11 @@ public:
      * @param aKeywordCount is the count of tokens in aKeywordTable.
      * @param aSExpression is text to feed through a STRING_LINE_READER
      * @param aSource is a description of aSExpression, used for error reporting.
+     * @param aKeywordHash is the perfect hash of aKeywordTable, if there is one.
      */
     DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-              const std::string& aSExpression, const wxString& aSource = wxEmptyString );
+              const std::string& aSExpression, const wxString& aSource = wxEmptyString,
+              const KEYWORD_HASH* aKeywordHash = NULL );
 
     /**
      * Constructor ( const std::string&, const wxString& )
@@ -209,9 +252,11 @@ public:
      *
      * @param aLineReader is any subclassed instance of LINE_READER, such as
      *  STRING_LINE_READER or FILE_LINE_READER.  No ownership is taken.
+     *
+     * @param aKeywordHash is the perfect hash of aKeywordTable, if there is one.
      */
     DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-              LINE_READER* aLineReader = NULL );
+              LINE_READER* aLineReader = NULL, const KEYWORD_HASH* aKeywordHash = NULL );
 
     virtual ~DSNLEXER();
 
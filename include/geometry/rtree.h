@@ -32,6 +32,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <vector>
 
 #define ASSERT assert    // RTree uses ASSERT( condition )
 
@@ -96,9 +97,21 @@ public:
         int totalItems;
     };
 
+    /// Entry of a bulk load, see BulkLoad()
+    struct BulkItem
+    {
+        ELEMTYPE    m_min[NUMDIMS];                 ///< Min of bounding rect
+        ELEMTYPE    m_max[NUMDIMS];                 ///< Max of bounding rect
+        DATATYPE    m_data;                         ///< Data Id or Ptr
+    };
+
 public:
 
     RTree();
+
+    /// Build a packed tree of a_items, see BulkLoad()
+    explicit RTree( const std::vector<BulkItem>& a_items );
+
     virtual ~RTree();
 
     /// Insert entry
@@ -109,6 +122,14 @@ public:
                  const ELEMTYPE     a_max[NUMDIMS],
                  const DATATYPE&    a_dataId );
 
+    /// Replace the tree contents with a_items, packed with the Sort-Tile-Recursive algorithm
+    /// (Leutenegger et al.): the entries are sorted into tiles along each axis in turn, and
+    /// every node but the last ones of a tile is full.  This is much faster than inserting the
+    /// entries one by one, and the nodes overlap less, which speeds up the later searches.
+    /// The tree can be modified as usual afterwards.
+    /// \param a_items Entries to load
+    void BulkLoad( const std::vector<BulkItem>& a_items );
+
     /// Remove entry
     /// \param a_min Min of bounding rect
     /// \param a_max Max of bounding rect
@@ -438,6 +459,8 @@ protected:
                                    Node**           a_newNode,
                                    int              a_level );
     bool            InsertRect( Rect* a_rect, const DATATYPE& a_id, Node** a_root, int a_level );
+    void            PackTiles( Branch* a_branches, size_t a_count, int a_axis, int a_level,
+                               std::vector<Node*>& a_nodes );
     Rect            NodeCover( Node* a_node );
     bool            AddBranch( Branch* a_branch, Node* a_node, Node** a_newNode );
     void            DisconnectBranch( Node* a_node, int a_index );
@@ -628,6 +651,13 @@ RTREE_TEMPLATE RTREE_QUAL::RTree()
 }
 
 
+RTREE_TEMPLATE
+RTREE_QUAL::RTree( const std::vector<BulkItem>& a_items ) : RTree()
+{
+    BulkLoad( a_items );
+}
+
+
 RTREE_TEMPLATE
 RTREE_QUAL::~RTree() {
     Reset(); // Free, or reset node memory
@@ -660,6 +690,120 @@ void RTREE_QUAL::Insert( const ELEMTYPE     a_min[NUMDIMS],
 }
 
 
+RTREE_TEMPLATE
+void RTREE_QUAL::BulkLoad( const std::vector<BulkItem>& a_items )
+{
+    Reset();
+
+    std::vector<Branch> branches( a_items.size() );
+
+    for( size_t index = 0; index < a_items.size(); ++index )
+    {
+#ifdef _DEBUG
+
+        for( int axis = 0; axis < NUMDIMS; ++axis )
+        {
+            ASSERT( a_items[index].m_min[axis] <= a_items[index].m_max[axis] );
+        }
+
+#endif    // _DEBUG
+
+        for( int axis = 0; axis < NUMDIMS; ++axis )
+        {
+            branches[index].m_rect.m_min[axis] = a_items[index].m_min[axis];
+            branches[index].m_rect.m_max[axis] = a_items[index].m_max[axis];
+        }
+
+        branches[index].m_data = a_items[index].m_data;
+    }
+
+    std::vector<Node*> nodes;
+    int level = 0;
+
+    // Pack the entries into leaves, then the nodes of each level into the nodes of the
+    // level above, until a single node is left
+    while( true )
+    {
+        nodes.clear();
+
+        if( !branches.empty() )
+            PackTiles( &branches[0], branches.size(), 0, level, nodes );
+
+        if( nodes.size() <= 1 )
+            break;
+
+        branches.resize( nodes.size() );
+
+        for( size_t index = 0; index < nodes.size(); ++index )
+        {
+            branches[index].m_rect = NodeCover( nodes[index] );
+            branches[index].m_child = nodes[index];
+        }
+
+        ++level;
+    }
+
+    if( nodes.empty() )
+    {
+        m_root = AllocNode();
+        m_root->m_level = 0;
+    }
+    else
+    {
+        m_root = nodes[0];
+    }
+}
+
+
+// Sort-Tile-Recursive packing of a_count branches into nodes of level a_level.
+// The branches are sorted by the center of their rectangle along a_axis and cut into
+// slabs, which are tiled recursively along the next axes.  Along the last axis, the
+// slabs are cut into runs of MAXNODES branches, one per node.
+RTREE_TEMPLATE
+void RTREE_QUAL::PackTiles( Branch* a_branches, size_t a_count, int a_axis, int a_level,
+                            std::vector<Node*>& a_nodes )
+{
+    size_t nodeCount = ( a_count + MAXNODES - 1 ) / MAXNODES;
+
+    // Summed as reals, as the coordinates can be as large as the type allows
+    std::sort( a_branches, a_branches + a_count,
+               [a_axis]( const Branch& a_a, const Branch& a_b )
+               {
+                   return (ELEMTYPEREAL) a_a.m_rect.m_min[a_axis] + a_a.m_rect.m_max[a_axis]
+                        < (ELEMTYPEREAL) a_b.m_rect.m_min[a_axis] + a_b.m_rect.m_max[a_axis];
+               } );
+
+    if( a_axis == NUMDIMS - 1 || nodeCount <= 1 )
+    {
+        for( size_t first = 0; first < a_count; first += MAXNODES )
+        {
+            Node* node = AllocNode();
+            node->m_level = a_level;
+
+            for( size_t index = first; index < a_count && index < first + MAXNODES; ++index )
+            {
+                node->m_branch[node->m_count++] = a_branches[index];
+            }
+
+            a_nodes.push_back( node );
+        }
+
+        return;
+    }
+
+    // As many slabs as there will be nodes across each of the remaining axes
+    size_t slabCount = (size_t) std::ceil( std::pow( (double) nodeCount,
+                                                     1.0 / ( NUMDIMS - a_axis ) ) );
+    size_t slabSize = MAXNODES * ( ( nodeCount + slabCount - 1 ) / slabCount );
+
+    for( size_t first = 0; first < a_count; first += slabSize )
+    {
+        PackTiles( a_branches + first, std::min( slabSize, a_count - first ), a_axis + 1,
+                   a_level, a_nodes );
+    }
+}
+
+
 RTREE_TEMPLATE
 bool RTREE_QUAL::Remove( const ELEMTYPE     a_min[NUMDIMS],
                          const ELEMTYPE     a_max[NUMDIMS],
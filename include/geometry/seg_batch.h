@@ -0,0 +1,209 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __SEG_BATCH_H
+#define __SEG_BATCH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <geometry/seg.h>
+
+/**
+ * Class SEG_BATCH
+ *
+ * A set of segments stored as a structure of arrays, to measure their distances to a point
+ * or a segment several segments at a time with the SIMD instructions the code is built for
+ * (AVX or SSE2, with a plain loop for the other targets).
+ *
+ * The distances are computed in floating point, from the exact nearest points, and only
+ * select the segments worth testing: the queries give the same answers as the SEG methods
+ * called on every segment.
+ */
+class SEG_BATCH
+{
+public:
+    /// Number of segments measured by each call of the kernels in the queries
+    static const int CHUNK_SIZE = 64;
+
+    SEG_BATCH()
+    {}
+
+    void Reserve( int aCount );
+
+    /**
+     * Function Add()
+     *
+     * Appends a segment to the batch.
+     */
+    void Add( const SEG& aSeg );
+
+    void Clear();
+
+    int Size() const
+    {
+        return m_segs.size();
+    }
+
+    const SEG& Segment( int aIndex ) const
+    {
+        return m_segs[aIndex];
+    }
+
+    /**
+     * Function SquaredDistances()
+     *
+     * Computes the squared distances between aP and the segments aFirst to aEnd - 1.  The
+     * nearest points of SEG are rounded, these distances differ from the ones to the nearest
+     * points of SEG by less than NEAREST_POINT_TOLERANCE.
+     * @param aDist receives aEnd - aFirst distances
+     */
+    void SquaredDistances( const VECTOR2I& aP, int aFirst, int aEnd, double* aDist ) const;
+
+    /**
+     * Function SquaredDistances()
+     *
+     * Computes lower bounds of the squared distances between aSeg and the segments aFirst to
+     * aEnd - 1.  The segments which may intersect aSeg get 0.
+     * @param aDist receives aEnd - aFirst distances
+     */
+    void SquaredDistances( const SEG& aSeg, int aFirst, int aEnd, double* aDist ) const;
+
+    /**
+     * Function SquaredDistance()
+     *
+     * @return the smallest SEG::SquaredDistance( aP ) of the segments aFirst to aEnd - 1,
+     * the same as the one of the SEG method, or VECTOR2I::ECOORD_MAX for an empty range.
+     */
+    SEG::ecoord SquaredDistance( const VECTOR2I& aP, int aFirst, int aEnd ) const;
+
+    /**
+     * Function Distance()
+     *
+     * @return the smallest SEG::Distance( aP ) of the segments aFirst to aEnd - 1, which must
+     * not be empty.
+     */
+    int Distance( const VECTOR2I& aP, int aFirst, int aEnd ) const
+    {
+        return std::sqrt( (double) SquaredDistance( aP, aFirst, aEnd ) );
+    }
+
+    /**
+     * Function QueryNear()
+     *
+     * Calls aVisitor( index ) in increasing index order for the segments aFirst to aEnd - 1
+     * which may be within aDist of aP, until aVisitor returns true.  All the segments for
+     * which SEG::Distance( aP ) <= aDist are visited, a few farther ones may be.
+     * @return true if aVisitor returned true.
+     */
+    template <typename VISITOR>
+    bool QueryNear( const VECTOR2I& aP, int aDist, int aFirst, int aEnd,
+                    VISITOR& aVisitor ) const
+    {
+        // Distance() truncates, and SEG rounds the nearest point by up to sqrt( 2 )
+        const double limit = std::max( aDist, 0 ) + NEAREST_POINT_TOLERANCE + 1.0;
+        double       dist[CHUNK_SIZE];
+
+        for( int first = aFirst; first < aEnd; first += CHUNK_SIZE )
+        {
+            int end = std::min( first + CHUNK_SIZE, aEnd );
+
+            SquaredDistances( aP, first, end, dist );
+
+            for( int i = first; i < end; i++ )
+            {
+                if( dist[i - first] <= limit * limit && aVisitor( i ) )
+                    return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Function QueryColliding()
+     *
+     * Calls aVisitor( index ) in increasing index order for the segments aFirst to aEnd - 1
+     * which may collide with aSeg, until aVisitor returns true.  All the segments for which
+     * SEG::Collide( aSeg, aClearance ) is true are visited, a few other ones may be.
+     * @return true if aVisitor returned true.
+     */
+    template <typename VISITOR>
+    bool QueryColliding( const SEG& aSeg, int aClearance, int aFirst, int aEnd,
+                         VISITOR& aVisitor ) const
+    {
+        // SEG::PointCloserThan() measures the distances to the nearly diagonal segments
+        // from the diagonal through their start, which errs by a few percent
+        const double limit = std::abs( (double) aClearance ) * 1.0625
+                             + NEAREST_POINT_TOLERANCE + 1.0;
+        const bool   approxSeg = isApproximated( aSeg.B - aSeg.A );
+        double       dist[CHUNK_SIZE];
+
+        for( int first = aFirst; first < aEnd; first += CHUNK_SIZE )
+        {
+            int end = std::min( first + CHUNK_SIZE, aEnd );
+
+            if( !approxSeg )
+                SquaredDistances( aSeg, first, end, dist );
+
+            for( int i = first; i < end; i++ )
+            {
+                bool near = approxSeg || m_approximated[i]
+                            || dist[i - first] <= limit * limit;
+
+                if( near && aVisitor( i ) )
+                    return true;
+            }
+        }
+
+        return false;
+    }
+
+private:
+    /// Bound of the error of the nearest points of SEG, plus the floating point errors
+    static constexpr double NEAREST_POINT_TOLERANCE = 1.5;
+
+    /**
+     * @return true if SEG::PointCloserThan() measures the distances to a segment of direction
+     * aD from a diagonal which may be far from it.
+     */
+    static bool isApproximated( const VECTOR2I& aD )
+    {
+        return aD.x && aD.y && std::min( std::abs( aD.x ), std::abs( aD.y ) ) <= 1;
+    }
+
+    std::vector<double> m_ax;
+    std::vector<double> m_ay;
+    std::vector<double> m_dx;
+    std::vector<double> m_dy;
+
+    /// 1 / squared length, or 0 for the null segments
+    std::vector<double> m_invLengthSq;
+
+    std::vector<char>   m_approximated;
+    std::vector<SEG>    m_segs;
+};
+
+#endif // __SEG_BATCH_H
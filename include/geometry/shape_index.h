@@ -216,6 +216,15 @@ class SHAPE_INDEX
          */
         void Add( T aShape );
 
+        /**
+         * Function BulkLoad()
+         *
+         * Replaces the contents of the index with aShapes, which are packed all at once: much
+         * faster than adding them one by one, and the resulting tree is faster to query.
+         * @param aShapes are the new SHAPEs.
+         */
+        void BulkLoad( const std::vector<T>& aShapes );
+
         /**
          * Function Remove()
          *
@@ -332,26 +341,39 @@ void SHAPE_INDEX<T>::RemoveAll()
     this->m_tree->RemoveAll();
 }
 
+template <class T>
+void SHAPE_INDEX<T>::BulkLoad( const std::vector<T>& aShapes )
+{
+    std::vector<typename RTree<T, int, 2, double>::BulkItem> entries( aShapes.size() );
+
+    for( size_t i = 0; i < aShapes.size(); i++ )
+    {
+        BOX2I box = boundingBox( aShapes[i] );
+
+        entries[i].m_min[0] = box.GetX();
+        entries[i].m_min[1] = box.GetY();
+        entries[i].m_max[0] = box.GetRight();
+        entries[i].m_max[1] = box.GetBottom();
+        entries[i].m_data = aShapes[i];
+    }
+
+    this->m_tree->BulkLoad( entries );
+}
+
 template <class T>
 void SHAPE_INDEX<T>::Reindex()
 {
-    RTree<T, int, 2, double>* newTree;
-    newTree = new RTree<T, int, 2, double>();
+    std::vector<T> shapes;
 
     Iterator iter = this->Begin();
 
     while( !iter.IsNull() )
     {
-        T shape = *iter;
-        BOX2I box = boundingBox( shape );
-        int min[2] = { box.GetX(), box.GetY() };
-        int max[2] = { box.GetRight(), box.GetBottom() };
-        newTree->Insert( min, max, shape );
+        shapes.push_back( *iter );
         iter++;
     }
 
-    delete this->m_tree;
-    this->m_tree = newTree;
+    BulkLoad( shapes );
 }
 
 template <class T>
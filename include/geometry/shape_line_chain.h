@@ -26,6 +26,8 @@
 #ifndef __SHAPE_LINE_CHAIN
 #define __SHAPE_LINE_CHAIN
 
+#include <algorithm>
+#include <memory>
 #include <vector>
 #include <sstream>
 
@@ -34,9 +36,99 @@
 #include <math/vector2d.h>
 #include <geometry/shape.h>
 #include <geometry/seg.h>
+#include <geometry/seg_batch.h>
 
 #include <clipper.hpp>
 
+class SHAPE_LINE_CHAIN;
+
+/**
+ * Class SEGMENT_BVH
+ *
+ * Bounding volume hierarchy of the segments of a line chain.  The consecutive segments of a
+ * chain lie next to each other, so the leaves simply bound runs of LEAF_SIZE consecutive
+ * segments, and each level above bounds two boxes of the level below.  The segments are
+ * also kept in a SEG_BATCH, to measure the ones of a leaf together.
+ */
+class SEGMENT_BVH
+{
+public:
+    /// Number of consecutive segments bounded by a leaf
+    static const int LEAF_SIZE = 8;
+
+    /// Chains with fewer segments are searched without a hierarchy
+    static const int MIN_SEGMENTS = 4 * LEAF_SIZE;
+
+    SEGMENT_BVH( const SHAPE_LINE_CHAIN& aChain );
+
+    /**
+     * Function Walk()
+     *
+     * Calls aVisitor( index ) in increasing index order for the segments whose boxes are not
+     * discarded by aPrune( box ), until aVisitor returns true.
+     * @return true if aVisitor returned true.
+     */
+    template <typename PRUNE, typename VISITOR>
+    bool Walk( PRUNE& aPrune, VISITOR& aVisitor ) const
+    {
+        auto leaf = [&aVisitor]( int aFirst, int aEnd )
+                    {
+                        for( int i = aFirst; i < aEnd; i++ )
+                        {
+                            if( aVisitor( i ) )
+                                return true;
+                        }
+
+                        return false;
+                    };
+
+        return WalkLeaves( aPrune, leaf );
+    }
+
+    /**
+     * Function WalkLeaves()
+     *
+     * Calls aVisitor( first, end ) in increasing index order for the runs of segments of the
+     * leaves which are not discarded by aPrune( box ), until aVisitor returns true.
+     * @return true if aVisitor returned true.
+     */
+    template <typename PRUNE, typename VISITOR>
+    bool WalkLeaves( PRUNE& aPrune, VISITOR& aVisitor ) const
+    {
+        return walk( (int) m_levels.size() - 1, 0, aPrune, aVisitor );
+    }
+
+    const SEG_BATCH& Batch() const
+    {
+        return m_batch;
+    }
+
+private:
+    template <typename PRUNE, typename VISITOR>
+    bool walk( int aLevel, int aNode, PRUNE& aPrune, VISITOR& aVisitor ) const
+    {
+        const std::vector<BOX2I>& level = m_levels[aLevel];
+
+        if( aNode >= (int) level.size() || aPrune( level[aNode] ) )
+            return false;
+
+        if( aLevel == 0 )
+            return aVisitor( aNode * LEAF_SIZE, std::min( ( aNode + 1 ) * LEAF_SIZE,
+                                                          m_segmentCount ) );
+
+        return walk( aLevel - 1, 2 * aNode, aPrune, aVisitor )
+               || walk( aLevel - 1, 2 * aNode + 1, aPrune, aVisitor );
+    }
+
+    /// boxes of the leaves first, up to the box of the whole chain
+    std::vector<std::vector<BOX2I>> m_levels;
+
+    SEG_BATCH m_batch;
+
+    int m_segmentCount;
+};
+
+
 /**
  * Class SHAPE_LINE_CHAIN
  *
@@ -82,9 +174,26 @@ public:
      * Copy Constructor
      */
     SHAPE_LINE_CHAIN( const SHAPE_LINE_CHAIN& aShape ) :
-        SHAPE( SH_LINE_CHAIN ), m_points( aShape.m_points ), m_closed( aShape.m_closed )
+        SHAPE( SH_LINE_CHAIN ), m_points( aShape.m_points ), m_closed( aShape.m_closed ),
+        m_bvh( std::atomic_load( &aShape.m_bvh ) )
     {}
 
+    /**
+     * Assignment operator
+     * The segment BVH of aShape is read atomically, as the copy constructor does, since other
+     * threads may be building it.
+     */
+    SHAPE_LINE_CHAIN& operator=( const SHAPE_LINE_CHAIN& aShape )
+    {
+        SHAPE::operator=( aShape );
+        m_points = aShape.m_points;
+        m_closed = aShape.m_closed;
+        m_bbox = aShape.m_bbox;
+        std::atomic_store( &m_bvh, std::atomic_load( &aShape.m_bvh ) );
+
+        return *this;
+    }
+
     /**
      * Constructor
      * Initializes a 2-point line chain (a single segment)
@@ -161,6 +270,7 @@ public:
     {
         m_points.clear();
         m_closed = false;
+        m_bvh.reset();
     }
 
     /**
@@ -173,6 +283,7 @@ public:
     void SetClosed( bool aClosed )
     {
         m_closed = aClosed;
+        m_bvh.reset();
     }
 
     /**
@@ -254,7 +365,8 @@ public:
     /**
      * Function Point()
      *
-     * Returns a reference to a given point in the line chain.
+     * Returns a reference to a given point in the line chain.  The segment BVH is dropped,
+     * as the point may be changed through the reference.
      * @param aIndex index of the point
      * @return reference to the point
      */
@@ -263,6 +375,7 @@ public:
         if( aIndex < 0 )
             aIndex += PointCount();
 
+        m_bvh.reset();
         return m_points[aIndex];
     }
 
@@ -293,6 +406,7 @@ public:
      */
     VECTOR2I& LastPoint()
     {
+        m_bvh.reset();
         return m_points[PointCount() - 1];
     }
 
@@ -341,6 +455,28 @@ public:
      */
     bool Collide( const SEG& aSeg, int aClearance = 0 ) const override;
 
+    /**
+     * Function QuerySegments()
+     *
+     * Calls aVisitor( index ) in increasing index order for the segments which may intersect
+     * aBox, until aVisitor returns true.  The long chains skip the far segments through
+     * their segment BVH, the other ones visit all their segments.
+     * @return true if aVisitor returned true.
+     */
+    template <typename VISITOR>
+    bool QuerySegments( const BOX2I& aBox, VISITOR aVisitor ) const
+    {
+        BOX2I box( aBox );
+        box.Normalize();
+
+        auto prune = [&box]( const BOX2I& aNode )
+                     {
+                         return !aNode.Intersects( box );
+                     };
+
+        return walkSegments( prune, aVisitor );
+    }
+
     /**
      * Function Distance()
      *
@@ -400,6 +536,7 @@ public:
         {
             m_points.push_back( aP );
             m_bbox.Merge( aP );
+            m_bvh.reset();
         }
     }
 
@@ -414,7 +551,9 @@ public:
         if( aOtherLine.PointCount() == 0 )
             return;
 
-        else if( PointCount() == 0 || aOtherLine.CPoint( 0 ) != CPoint( -1 ) )
+        m_bvh.reset();
+
+        if( PointCount() == 0 || aOtherLine.CPoint( 0 ) != CPoint( -1 ) )
         {
             const VECTOR2I p = aOtherLine.CPoint( 0 );
             m_points.push_back( p );
@@ -432,6 +571,7 @@ public:
     void Insert( int aVertex, const VECTOR2I& aP )
     {
         m_points.insert( m_points.begin() + aVertex, aP );
+        m_bvh.reset();
     }
 
     /**
@@ -676,6 +816,8 @@ public:
     {
         for( std::vector<VECTOR2I>::iterator i = m_points.begin(); i != m_points.end(); ++i )
             (*i) += aVector;
+
+        m_bvh.reset();
     }
 
     /**
@@ -696,6 +838,102 @@ public:
     double Area() const;
 
 private:
+    /**
+     * Returns the segment BVH of the chain, built on the first call, or nothing for the
+     * chains too short to need one.  It can be called from several threads at once.
+     */
+    std::shared_ptr<const SEGMENT_BVH> segmentBVH() const;
+
+    template <typename PRUNE, typename VISITOR>
+    bool walkSegments( PRUNE& aPrune, VISITOR& aVisitor ) const
+    {
+        std::shared_ptr<const SEGMENT_BVH> bvh = segmentBVH();
+
+        if( bvh )
+            return bvh->Walk( aPrune, aVisitor );
+
+        for( int i = 0, count = SegmentCount(); i < count; i++ )
+        {
+            if( aVisitor( i ) )
+                return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * Calls aVisitor( batch, first, end ) in increasing index order for the runs of segments
+     * whose boxes are not discarded by aPrune( box ), until aVisitor returns true.  The runs
+     * are the leaves of the segment BVH of the long chains, with their SEG_BATCH.  The other
+     * chains have a single run of all their segments, without batch.
+     */
+    template <typename PRUNE, typename VISITOR>
+    bool walkSegmentRuns( PRUNE& aPrune, VISITOR& aVisitor ) const
+    {
+        std::shared_ptr<const SEGMENT_BVH> bvh = segmentBVH();
+
+        if( !bvh )
+            return aVisitor( nullptr, 0, SegmentCount() );
+
+        auto leaf = [&]( int aFirst, int aEnd )
+                    {
+                        return aVisitor( &bvh->Batch(), aFirst, aEnd );
+                    };
+
+        return bvh->WalkLeaves( aPrune, leaf );
+    }
+
+    /**
+     * Same as walkSegments(), for the segments which may be within aDist of aP.
+     */
+    template <typename PRUNE, typename VISITOR>
+    bool walkSegmentsNear( const VECTOR2I& aP, int aDist, PRUNE& aPrune,
+                           VISITOR& aVisitor ) const
+    {
+        auto run = [&]( const SEG_BATCH* aBatch, int aFirst, int aEnd )
+                   {
+                       if( aBatch )
+                           return aBatch->QueryNear( aP, aDist, aFirst, aEnd, aVisitor );
+
+                       for( int i = aFirst; i < aEnd; i++ )
+                       {
+                           if( aVisitor( i ) )
+                               return true;
+                       }
+
+                       return false;
+                   };
+
+        return walkSegmentRuns( aPrune, run );
+    }
+
+    /**
+     * Same as walkSegments(), for the segments which may collide with aSeg.
+     */
+    template <typename PRUNE, typename VISITOR>
+    bool walkSegmentsColliding( const SEG& aSeg, int aClearance, PRUNE& aPrune,
+                                VISITOR& aVisitor ) const
+    {
+        auto run = [&]( const SEG_BATCH* aBatch, int aFirst, int aEnd )
+                   {
+                       if( aBatch )
+                       {
+                           return aBatch->QueryColliding( aSeg, aClearance, aFirst, aEnd,
+                                                          aVisitor );
+                       }
+
+                       for( int i = aFirst; i < aEnd; i++ )
+                       {
+                           if( aVisitor( i ) )
+                               return true;
+                       }
+
+                       return false;
+                   };
+
+        return walkSegmentRuns( aPrune, run );
+    }
+
     /// array of vertices
     std::vector<VECTOR2I> m_points;
 
@@ -704,6 +942,9 @@ private:
 
     /// cached bounding box
     BOX2I m_bbox;
+
+    /// cached segment BVH of the long chains, dropped by any change of the points
+    mutable std::shared_ptr<const SEGMENT_BVH> m_bvh;
 };
 
 #endif // __SHAPE_LINE_CHAIN
@@ -110,6 +110,16 @@ class SHAPE_POLY_SET : public SHAPE
                 return m_vertices.size();
             }
 
+            const TRI& GetTriangleIndices( int index ) const
+            {
+                return m_triangles[ index ];
+            }
+
+            const VECTOR2I& GetVertex( int index ) const
+            {
+                return m_vertices[ index ];
+            }
+
         private:
 
             std::deque<TRI> m_triangles;
@@ -1263,6 +1273,13 @@ class SHAPE_POLY_SET : public SHAPE
         void CacheTriangulation();
         bool IsTriangulationUpToDate() const;
 
+        /**
+         * Function SetTriangulation
+         * sets the triangulation of the set, as CacheTriangulation() computed it before for
+         * the same polygons, for instance when it is read back from a file.
+         */
+        void SetTriangulation( std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> aTriangulation );
+
         MD5_HASH GetHash() const;
 
     private:
@@ -26,6 +26,7 @@
  * @brief Hashing functions for EDA_ITEMs.
  */
 
+#include <cstdint>
 #include <cstdlib>
 
 class EDA_ITEM;
@@ -46,6 +47,21 @@ enum HASH_FLAGS
     ALL         = 0xff
 };
 
+/**
+ * Mixes aValue into aSeed.  The result depends on the order of the values and, unlike a sum
+ * of the values, changes when an item is mirrored or moved diagonally.
+ */
+inline void hash_combine( std::size_t& aSeed, std::size_t aValue )
+{
+    // std::hash<int> is the identity in the usual standard libraries, scramble it first
+    uint64_t v = (uint64_t) aValue + 0x9e3779b97f4a7c15ULL;
+    v = ( v ^ ( v >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+    v = ( v ^ ( v >> 27 ) ) * 0x94d049bb133111ebULL;
+    v ^= v >> 31;
+
+    aSeed ^= (std::size_t) v + 0x9e3779b9 + ( aSeed << 6 ) + ( aSeed >> 2 );
+}
+
 /**
  * Calculates hash of an EDA_ITEM.
  * @param aItem is the item for which the hash will be computed.
@@ -0,0 +1,73 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file number_io.h
+ * Reading and writing of the numbers of the data files, which always use a '.' as decimal
+ * point whatever the current locale is.  These do not need a LOCALE_IO.
+ */
+
+#ifndef NUMBER_IO_H_
+#define NUMBER_IO_H_
+
+#include <cstddef>
+#include <string>
+
+
+/**
+ * Function ParseDouble
+ * is strtod() in the "C" locale: it gives the same value, end position and errno.
+ *
+ * The plain decimal numbers found in the files (up to 15 significant digits, with or
+ * without exponent) are converted directly, without going through strtod().
+ *
+ * @param aText is the text to convert, possibly starting with whitespace.
+ * @param aEnd if not NULL, is set to the first character after the number, or to aText
+ *             if there is no number.
+ */
+double ParseDouble( const char* aText, char** aEnd = NULL );
+
+
+/**
+ * Function FormatFixedPoint
+ * writes aValue / 10^aDecimals in aBuffer, without exponent nor trailing zeros in the
+ * fractional part, and without a trailing decimal point.
+ *
+ * @param aBuffer has to hold at least 24 + aDecimals characters.
+ * @param aDecimals is the number of fractional digits, at most 18.
+ * @return the length of the nul terminated text.
+ */
+int FormatFixedPoint( char* aBuffer, long long aValue, int aDecimals );
+
+
+/**
+ * Function FormatDouble
+ * is snprintf() of a single double in the "C" locale.
+ * @return the length of the text, as snprintf() does.
+ */
+int FormatDouble( char* aBuffer, size_t aSize, const char* aFormat, double aValue );
+
+std::string FormatDouble( const char* aFormat, double aValue );
+
+
+#endif  // NUMBER_IO_H_
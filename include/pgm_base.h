@@ -33,6 +33,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <wx/filename.h>
 #include <search_stack.h>
 #include <wx/gdicmn.h>
@@ -61,6 +62,7 @@
 ///@}
 
 class wxConfigBase;
+class THREAD_POOL;
 class wxSingleInstanceChecker;
 class wxApp;
 class wxMenu;
@@ -352,6 +354,14 @@ public:
      */
     void SaveCommonSettings();
 
+    /**
+     * Function GetThreadPool
+     * @return the worker pool of the process, created on first use.  Each kiface links its
+     * own copy of the common library, so they all reach this one through the program (see
+     * KIFACE_I::start_common()) instead of spawning their own workers.
+     */
+    THREAD_POOL& GetThreadPool();
+
     /**
      * wxWidgets on MSW tends to crash if you spool up more than one print job at a time.
      */
@@ -407,6 +417,10 @@ protected:
 
     /// Flag to indicate if the environment variable overwrite warning dialog should be shown.
     bool            m_show_env_var_dialog;
+
+    /// The worker pool shared by all the kifaces, and the lock guarding its creation.
+    std::unique_ptr<THREAD_POOL> m_threadPool;
+    std::mutex                   m_threadPoolLock;
 };
 
 
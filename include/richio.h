@@ -247,6 +247,53 @@ public:
 };
 
 
+/**
+ * Class MMAP_LINE_READER
+ * is a LINE_READER that maps a whole file in memory, where available, and copies each line
+ * out of the mapping at once rather than character by character.  Small files, and every
+ * file on platforms without mmap(), are read in memory at once.
+ * <p>
+ * The file is opened in binary mode: "\r\n" line endings are kept, which the DSNLEXER
+ * treats as white space.
+ */
+class MMAP_LINE_READER : public LINE_READER
+{
+protected:
+    const char* m_data;     ///< the file contents
+    size_t      m_size;     ///< size of the file contents
+    size_t      m_ndx;      ///< offset of the next line in m_data
+    bool        m_mapped;   ///< m_data is a mapping, else it was allocated
+
+public:
+
+    /**
+     * Constructor MMAP_LINE_READER
+     * opens and maps @a aFileName.
+     *
+     * @param aFileName is the name of the file to read and to use for error reporting purposes.
+     * @param aMaxLineLength is the maximum allowed length of a line.
+     *
+     * @throw IO_ERROR if @a aFileName cannot be opened or read.
+     */
+    MMAP_LINE_READER( const wxString& aFileName,
+            unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX );
+
+    ~MMAP_LINE_READER();
+
+    char* ReadLine() override;
+
+    /**
+     * Function Rewind
+     * goes back to the beginning of the file and resets the line number back to zero.
+     */
+    void Rewind()
+    {
+        m_ndx = 0;
+        m_lineNum = 0;
+    }
+};
+
+
 /**
  * Class STRING_LINE_READER
  * is a LINE_READER that reads from a multiline 8 bit wide std::string
@@ -329,8 +376,23 @@ class OUTPUTFORMATTER
     std::vector<char>   m_buffer;
     char                quoteChar[2];
 
-    int sprint( const char* fmt, ... );
-    int vprint( const char* fmt,  va_list ap );
+    /**
+     * Function vprint
+     * formats the nest level indentation and the text in m_buffer and writes them at once.
+     * The formats made only of the %s, %c, %d, %u, %x and %X conversions, which are nearly
+     * all the formats of the file writers, are formatted here without vsnprintf().
+     */
+    int vprint( int nestLevel, const char* fmt, va_list ap );
+
+    /**
+     * Function formatSimple
+     * appends to m_buffer, from aLength, exactly what vsnprintf() gives for a format
+     * accepted by isSimpleFormat().
+     * @return the new length of the text in m_buffer.
+     */
+    size_t formatSimple( size_t aLength, const char* fmt, va_list ap );
+
+    static bool isSimpleFormat( const char* fmt );
 
 
 protected:
@@ -0,0 +1,179 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __THREAD_POOL_H
+#define __THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class PROGRESS_REPORTER;
+
+
+/**
+ * Class THREAD_POOL
+ *
+ * A fixed set of worker threads running the tasks submitted to them, so that the parallel
+ * algorithms of the applications share the CPU instead of each starting as many threads as
+ * there are cores.
+ *
+ * Each worker owns a queue.  The tasks submitted by a worker are pushed to the front of its
+ * own queue and run last in, first out, while an idle worker steals the oldest tasks of the
+ * other queues.
+ */
+class THREAD_POOL
+{
+public:
+    /**
+     * @param aWorkerCount is the number of worker threads, 0 for one per hardware thread.
+     */
+    THREAD_POOL( size_t aWorkerCount = 0 );
+    ~THREAD_POOL();
+
+    THREAD_POOL( const THREAD_POOL& ) = delete;
+    THREAD_POOL& operator=( const THREAD_POOL& ) = delete;
+
+    size_t GetWorkerCount() const { return m_workers.size(); }
+
+    /**
+     * Function IsWorkerThread
+     * @return true if the calling thread is one of the workers of this pool.
+     */
+    bool IsWorkerThread() const;
+
+    /**
+     * Function Submit
+     * Queues aTask to be run by a worker.
+     *
+     * A task must not block on the future of another task: if every worker does so, nobody
+     * is left to run them.  Nested parallel work has to use ParallelFor(), in which the
+     * waiting thread takes part.
+     *
+     * @return the future result of the task.
+     */
+    template<typename FUNC>
+    auto Submit( FUNC&& aTask ) -> std::future<decltype( aTask() )>
+    {
+        typedef decltype( aTask() ) RESULT;
+
+        auto task = std::make_shared<std::packaged_task<RESULT()>>( std::forward<FUNC>( aTask ) );
+        std::future<RESULT> result = task->get_future();
+
+        push( [task]() { ( *task )(); } );
+
+        return result;
+    }
+
+    /**
+     * Function ParallelFor
+     * Calls aFunc( i ) for each i in [0, aCount) on the pool, and returns once all the calls
+     * are done.  The items are handed out one at a time, so they can take very different
+     * amounts of time.
+     *
+     * Without a progress reporter, the calling thread works on the items too, which makes
+     * nesting ParallelFor() calls safe.  With a progress reporter, the calling thread (which
+     * has to be the main thread) only keeps it refreshing, and the progress is advanced once
+     * per item.  Once the user cancels the reporter, no more items are started.
+     *
+     * The first exception thrown by aFunc is rethrown once all the items are done.
+     *
+     * @param aMinItemsPerThread avoids waking up threads for too little work: at most
+     *        aCount / aMinItemsPerThread threads work on the items.
+     */
+    void ParallelFor( size_t aCount, const std::function<void( size_t )>& aFunc,
+                      PROGRESS_REPORTER* aReporter = nullptr, size_t aMinItemsPerThread = 1 );
+
+    /**
+     * Function Wait
+     * Waits for aFuture, keeping aReporter (if any) refreshing meanwhile.  Has to be called
+     * from the main thread if a reporter is given.
+     * @return false if the user cancelled the reporter; the task is still waited for.
+     */
+    template<typename T>
+    static bool Wait( const std::future<T>& aFuture, PROGRESS_REPORTER* aReporter )
+    {
+        bool cancelled = false;
+
+        while( aFuture.wait_for( std::chrono::milliseconds( 100 ) ) != std::future_status::ready )
+        {
+            if( aReporter && !keepRefreshing( aReporter ) )
+                cancelled = true;
+        }
+
+        return !cancelled;
+    }
+
+private:
+    typedef std::function<void()> TASK;
+
+    struct WORKER_QUEUE
+    {
+        std::mutex       m_lock;
+        std::deque<TASK> m_tasks;
+    };
+
+    ///> Queues aTask in the queue of the calling worker, or in the next one
+    void push( TASK&& aTask );
+
+    ///> Takes a task from the queue of aWorker, or steals one from another queue
+    bool pop( size_t aWorker, TASK& aTask );
+
+    void workerLoop( size_t aWorker );
+
+    ///> PROGRESS_REPORTER::KeepRefreshing(), kept out of this header
+    static bool keepRefreshing( PROGRESS_REPORTER* aReporter );
+
+    std::vector<std::unique_ptr<WORKER_QUEUE>> m_queues;
+    std::vector<std::thread>                   m_workers;
+    std::atomic<size_t>                        m_nextQueue;
+
+    std::mutex                                 m_sleepLock;
+    std::condition_variable                    m_wakeUp;
+    size_t                                     m_pending;    // queued tasks, under m_sleepLock
+    bool                                       m_stop;       // under m_sleepLock
+};
+
+
+/**
+ * Function SetKiCadThreadPool
+ * sets the pool returned by GetKiCadThreadPool() in this copy of the common library, so
+ * that all the kifaces of a program share the pool it owns.  nullptr restores the default.
+ */
+void SetKiCadThreadPool( THREAD_POOL* aPool );
+
+/**
+ * Function GetKiCadThreadPool
+ * @return the pool shared by the whole application: the one of the program when running in
+ * a kiface, or else a pool of this library.  Its size is given by the ThreadPoolSize advanced
+ * config setting (one worker per hardware thread by default).
+ */
+THREAD_POOL& GetKiCadThreadPool();
+
+#endif  // __THREAD_POOL_H
@@ -95,6 +95,21 @@ public:
      */
     virtual void Remove( VIEW_ITEM* aItem );
 
+    /**
+     * Function BeginBulkAdd()
+     * Defers the spatial indexing of the items added from now on to EndBulkAdd(), which
+     * indexes them all at once.  Much faster when a whole document is displayed, but the
+     * items are neither found by Query() nor drawn until EndBulkAdd() is called, which has
+     * to be done before the view is updated or redrawn.
+     */
+    void BeginBulkAdd();
+
+    /**
+     * Function EndBulkAdd()
+     * Indexes the items added since BeginBulkAdd().
+     */
+    void EndBulkAdd();
+
 
     /**
      * Function Query()
@@ -706,6 +721,8 @@ protected:
         bool                    visible;         ///< is the layer to be rendered?
         bool                    displayOnly;     ///< is the layer display only?
         std::shared_ptr<VIEW_RTREE> items;       ///< R-tree indexing all items on this layer.
+        std::vector<VIEW_ITEM*> pendingItems;    ///< items added to the layer by a bulk add,
+                                                 ///< not indexed yet
         int                     renderingOrder;  ///< rendering order of this layer
         int                     id;              ///< layer ID
         RENDER_TARGET           target;          ///< where the layer should be rendered
@@ -867,6 +884,9 @@ protected:
     /// Flag to reverse the draw order when using draw priority
     bool m_reverseDrawOrder;
 
+    /// Flag telling that the items are being added by a bulk add (see BeginBulkAdd())
+    bool m_bulkAdd;
+
     /// A control for printing: m_printMode <= 0 means no printing mode (normal draw mode
     /// m_printMode > 0 is a printing mode (currently means "we are in printing mode")
     int m_printMode;
@@ -76,6 +76,11 @@ class PROGRESS_REPORTER
          */
         bool KeepRefreshing( bool aWait = false );
 
+        /**
+         * Tells whether the user clicked Cancel.  Can be called from any thread.
+         */
+        bool IsCancelled() const { return m_cancelled; }
+
         /** change the title displayed on the window caption
          * *MUST* only be called from the main thread.
          * Has meaning only for some reporters.
@@ -96,6 +101,7 @@ class PROGRESS_REPORTER
         std::atomic_int    m_numPhases;
         std::atomic_int    m_progress;
         std::atomic_int    m_maxProgress;
+        std::atomic_bool   m_cancelled;
 };
 
 
@@ -125,6 +125,7 @@ extern const std::string EquFileExtension;
 extern const std::string LegacyPcbFileExtension;
 extern const std::string KiCadPcbFileExtension;
 #define PcbFileExtension    KiCadPcbFileExtension       // symlink choice
+extern const std::string KiCadPcbSnapshotFileExtension;
 extern const std::string PageLayoutDescrFileExtension;
 
 extern const std::string LegacyFootprintLibPathExtension;
@@ -92,10 +92,26 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
     std::set<EDA_ITEM*> savedModules;
     SELECTION_TOOL*     selTool = m_toolMgr->GetTool<SELECTION_TOOL>();
     bool                itemsDeselected = false;
+    ZONE_FILL_CACHE*    fillCache = nullptr;
 
     if( Empty() )
         return;
 
+    // Record the changed areas, so the next zone fill can be limited to them
+    if( !m_editModules && frame->IsType( FRAME_PCB_EDITOR ) )
+        fillCache = &static_cast<PCB_EDIT_FRAME*>( frame )->m_ZoneFillCache;
+
+    auto recordDirtyItem = [&]( const COMMIT_LINE& aEntry )
+    {
+        if( !fillCache )
+            return;
+
+        fillCache->AddDirtyItem( static_cast<BOARD_ITEM*>( aEntry.m_item ) );
+
+        if( ( aEntry.m_type & CHT_TYPE ) == CHT_MODIFY && aEntry.m_copy )
+            fillCache->AddDirtyItem( static_cast<BOARD_ITEM*>( aEntry.m_copy ) );
+    };
+
     for( COMMIT_LINE& ent : m_changes )
     {
         int changeType = ent.m_type & CHT_TYPE;
@@ -134,6 +150,8 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
             }
         }
 
+        recordDirtyItem( ent );
+
         switch( changeType )
         {
             case CHT_ADD:
@@ -288,6 +306,8 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
 
                 auto boardItem = static_cast<BOARD_ITEM*>( ent.m_item );
 
+                recordDirtyItem( ent );
+
                 if( aCreateUndoEntry )
                 {
                     ITEM_PICKER itemWrapper( boardItem, UR_CHANGED );
@@ -314,7 +334,12 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
         m_toolMgr->PostEvent( EVENTS::UnselectedEvent );
 
     if( aSetDirtyBit )
+    {
+        if( fillCache )
+            fillCache->SetChangesRecorded();
+
         frame->OnModify();
+    }
 
     frame->UpdateMsgPanel();
 
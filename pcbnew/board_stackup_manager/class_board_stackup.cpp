@@ -26,6 +26,7 @@
 #include <board_design_settings.h>
 #include <class_board.h>
 #include <i18n_utility.h>       // For _HKI definition
+#include <number_io.h>
 #include "stackup_predefined_prms.h"
 
 
@@ -667,7 +668,8 @@ void BOARD_STACKUP::FormatBoardStackup( OUTPUTFORMATTER* aFormatter,
                                    aFormatter->Quotew( item->GetMaterial( idx ) ).c_str() );
 
             if( item->HasEpsilonRValue() && item->HasMaterialValue( idx ) )
-                aFormatter->Print( 0, " (epsilon_r %g)", item->GetEpsilonR( idx ) );
+                aFormatter->Print( 0, " (epsilon_r %s)",
+                                   FormatDouble( "%g", item->GetEpsilonR( idx ) ).c_str() );
 
             if( item->HasLossTangentValue() && item->HasMaterialValue( idx ) )
                 aFormatter->Print( 0, " (loss_tangent %s)",
@@ -47,6 +47,7 @@ ZONE_CONTAINER::ZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent, bool aInModule )
 {
     m_CornerSelection = nullptr;                // no corner is selected
     m_IsFilled = false;                         // fill status : true when the zone is filled
+    m_fillInputHash.clear();                    // inputs of the fill unknown
     m_FillMode = ZFM_POLYGONS;
     m_hatchStyle = DIAGONAL_EDGE;
     m_hatchPitch = GetDefaultHatchPitch();
@@ -104,6 +105,7 @@ ZONE_CONTAINER& ZONE_CONTAINER::operator=( const ZONE_CONTAINER& aOther )
     m_FilledPolysList.Append( aOther.m_FilledPolysList );
     m_FillSegmList.clear();
     m_FillSegmList = aOther.m_FillSegmList;
+    m_fillInputHash = aOther.m_fillInputHash;
 
     m_HatchFillTypeThickness = aOther.m_HatchFillTypeThickness;
     m_HatchFillTypeGap = aOther.m_HatchFillTypeGap;
@@ -148,6 +150,7 @@ void ZONE_CONTAINER::initDataFromSrcInCopyCtor( const ZONE_CONTAINER& aZone )
     m_ThermalReliefCopperBridge = aZone.m_ThermalReliefCopperBridge;
     m_FilledPolysList.Append( aZone.m_FilledPolysList );
     m_FillSegmList = aZone.m_FillSegmList;      // vector <> copy
+    m_fillInputHash = aZone.m_fillInputHash;
 
     m_doNotAllowCopperPour = aZone.m_doNotAllowCopperPour;
     m_doNotAllowVias = aZone.m_doNotAllowVias;
@@ -189,6 +192,7 @@ bool ZONE_CONTAINER::UnFill()
     m_FilledPolysList.RemoveAllContours();
     m_FillSegmList.clear();
     m_IsFilled = false;
+    m_fillInputHash.clear();
 
     return change;
 }
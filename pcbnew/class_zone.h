@@ -559,6 +559,16 @@ public:
      */
     void CacheTriangulation();
 
+    /**
+     * Function SetFillTriangulation
+     * sets the triangulation of the filled polygons, as CacheTriangulation() computed it.
+     */
+    void SetFillTriangulation(
+            std::vector<std::unique_ptr<SHAPE_POLY_SET::TRIANGULATED_POLYGON>> aTriangulation )
+    {
+        m_FilledPolysList.SetTriangulation( std::move( aTriangulation ) );
+    }
+
    /**
      * Function SetFilledPolysList
      * sets the list of filled polygons.
@@ -700,6 +710,13 @@ public:
      */
     void BuildHashValue() { m_filledPolysHash = m_FilledPolysList.GetHash(); }
 
+    /** @return the MD5 digest, as 32 hexadecimal digits, of everything the current fill was
+     *  computed from (outline, settings and nearby items), or an empty string if unknown.
+     *  Used by ZONE_FILLER to skip refilling zones whose inputs did not change.
+     */
+    const std::string& GetFillInputHash() const { return m_fillInputHash; }
+    void SetFillInputHash( const std::string& aHash ) { m_fillInputHash = aHash; }
+
 
 
 #if defined(DEBUG)
@@ -806,6 +823,7 @@ protected:
     SHAPE_POLY_SET        m_RawPolysList;
     MD5_HASH              m_filledPolysHash;    // A hash value used in zone filling calculations
                                                 // to see if the filled areas are up to date
+    std::string           m_fillInputHash;      // Digest of the inputs of the current fill
 
     HATCH_STYLE           m_hatchStyle;     // hatch style, see enum above
     int                   m_hatchPitch;     // for DIAGONAL_EDGE, distance between 2 hatch lines
@@ -26,11 +26,12 @@
 #include <widgets/progress_reporter.h>
 #include <geometry/geometry_utils.h>
 #include <board_commit.h>
+#include <hash_eda.h>
+#include <thread_pool.h>
 
-#include <thread>
 #include <mutex>
 #include <algorithm>
-#include <future>
+#include <unordered_set>
 
 #ifdef PROFILE
 #include <profile.h>
@@ -168,7 +169,7 @@ bool CN_CONNECTIVITY_ALGO::Add( BOARD_ITEM* aItem )
         if( m_itemMap.find( static_cast<ZONE_CONTAINER*>( aItem ) ) != m_itemMap.end() )
             return false;
 
-        m_itemMap[zone] = ITEM_MAP_ENTRY();
+        m_itemMap[zone] = ITEM_MAP_ENTRY( nullptr, zone->GetNetCode(), stateHash( zone ) );
 
         for( auto zitem : m_itemList.Add( zone ) )
             m_itemMap[zone].Link(zitem);
@@ -218,48 +219,14 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
 
     if( m_itemList.IsDirty() )
     {
-        size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
-                ( dirtyItems.size() + 7 ) / 8 );
-
-        std::atomic<size_t> nextItem( 0 );
-        std::vector<std::future<size_t>> returns( parallelThreadCount );
-
-        auto conn_lambda = [&nextItem, &dirtyItems]
-                            ( CN_LIST* aItemList, PROGRESS_REPORTER* aReporter) -> size_t
-        {
-            for( size_t i = nextItem++; i < dirtyItems.size(); i = nextItem++ )
-            {
-                CN_VISITOR visitor( dirtyItems[i] );
-                aItemList->FindNearby( dirtyItems[i], visitor );
-
-                if( aReporter )
-                    aReporter->AdvanceProgress();
-            }
-
-            return 1;
-        };
-
-        if( parallelThreadCount <= 1 )
-            conn_lambda( &m_itemList, m_progressReporter );
-        else
-        {
-            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-                returns[ii] = std::async( std::launch::async, conn_lambda,
-                        &m_itemList, m_progressReporter );
-
-            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            {
-                // Here we balance returns with a 100ms timeout to allow UI updating
-                std::future_status status;
-                do
+        // We don't want to wake up a thread for fewer than 8 items (overhead costs)
+        GetKiCadThreadPool().ParallelFor( dirtyItems.size(),
+                [&]( size_t i )
                 {
-                    if( m_progressReporter )
-                        m_progressReporter->KeepRefreshing();
-
-                    status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
-                } while( status != std::future_status::ready );
-            }
-        }
+                    CN_VISITOR visitor( dirtyItems[i] );
+                    m_itemList.FindNearby( dirtyItems[i], visitor );
+                },
+                m_progressReporter, 8 );
 
         if( m_progressReporter )
             m_progressReporter->KeepRefreshing();
@@ -395,6 +362,9 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
 
 void CN_CONNECTIVITY_ALGO::Build( BOARD* aBoard )
 {
+    // The whole item set is known: index it at once rather than item by item
+    m_itemList.BeginBulkLoad();
+
     for( int i = 0; i<aBoard->GetAreaCount(); i++ )
     {
         auto zone = aBoard->GetArea( i );
@@ -410,14 +380,144 @@ void CN_CONNECTIVITY_ALGO::Build( BOARD* aBoard )
             Add( pad );
     }
 
+    m_itemList.EndBulkLoad();
+
     /*wxLogTrace( "CN", "zones : %lu, pads : %lu vias : %lu tracks : %lu\n",
             m_zoneList.Size(), m_padList.Size(),
             m_viaList.Size(), m_trackList.Size() );*/
 }
 
 
+int CN_CONNECTIVITY_ALGO::Synchronize( BOARD* aBoard )
+{
+    int outOfDate = 0;
+
+    // The entries are keyed by the addresses of their items.  The entries of the items deleted
+    // behind our back are dropped first: the items must not be accessed any more, and an item
+    // allocated since at the same address must not be taken for them.
+    std::unordered_set<const BOARD_CONNECTED_ITEM*> boardItems;
+
+    for( int i = 0; i < aBoard->GetAreaCount(); i++ )
+        boardItems.insert( aBoard->GetArea( i ) );
+
+    for( auto track : aBoard->Tracks() )
+        boardItems.insert( track );
+
+    for( auto mod : aBoard->Modules() )
+    {
+        for( auto pad : mod->Pads() )
+            boardItems.insert( pad );
+    }
+
+    for( auto it = m_itemMap.begin(); it != m_itemMap.end(); )
+    {
+        if( boardItems.count( it->first ) )
+        {
+            ++it;
+            continue;
+        }
+
+        MarkNetAsDirty( it->second.m_net );
+        it->second.MarkItemsAsInvalid();
+        it = m_itemMap.erase( it );
+        outOfDate++;
+    }
+
+    if( outOfDate )
+    {
+        m_itemList.SetDirty( true );
+        m_itemList.SetHasInvalid( true );
+    }
+
+    // An entry left for a reused address is only kept if the whole state of the new item
+    // matches, in which case its items describe the new item exactly
+    auto check = [&]( BOARD_CONNECTED_ITEM* aItem )
+    {
+        auto it = m_itemMap.find( aItem );
+
+        if( it == m_itemMap.end() )
+        {
+            if( Add( aItem ) )
+                outOfDate++;
+
+            return;
+        }
+
+        if( it->second.m_stateHash == stateHash( aItem ) )
+            return;
+
+        // The net the items were built for has to be recomputed too
+        MarkNetAsDirty( it->second.m_net );
+        Remove( aItem );
+        outOfDate++;
+        Add( aItem );
+    };
+
+    for( int i = 0; i < aBoard->GetAreaCount(); i++ )
+        check( aBoard->GetArea( i ) );
+
+    for( auto track : aBoard->Tracks() )
+        check( track );
+
+    for( auto mod : aBoard->Modules() )
+    {
+        for( auto pad : mod->Pads() )
+            check( pad );
+    }
+
+    return outOfDate;
+}
+
+
+size_t CN_CONNECTIVITY_ALGO::stateHash( const BOARD_CONNECTED_ITEM* aItem )
+{
+    size_t ret = hash_eda( aItem, HASH_FLAGS::POSITION | HASH_FLAGS::ROTATION
+                                  | HASH_FLAGS::LAYER | HASH_FLAGS::NET );
+
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:
+    {
+        // The pad shape parameters hash_eda() does not know about
+        auto pad = static_cast<const D_PAD*>( aItem );
+
+        hash_combine( ret, std::hash<int>{}( pad->GetAttribute() ) );
+        hash_combine( ret, std::hash<double>{}( pad->GetRoundRectRadiusRatio() ) );
+        hash_combine( ret, std::hash<double>{}( pad->GetChamferRectRatio() ) );
+        hash_combine( ret, std::hash<int>{}( pad->GetChamferPositions() ) );
+
+        if( pad->GetShape() == PAD_SHAPE_CUSTOM )
+        {
+            MD5_HASH shapeHash = pad->GetCustomShapeAsPolygon().GetHash();
+            hash_combine( ret, std::hash<std::string>{}( shapeHash.Format() ) );
+        }
+
+        break;
+    }
+
+    case PCB_ZONE_AREA_T:
+    {
+        // The zone items are built from the filled areas, not from the outline
+        auto zone = static_cast<const ZONE_CONTAINER*>( aItem );
+
+        hash_combine( ret, std::hash<bool>{}( zone->IsFilled() ) );
+        MD5_HASH fillHash = zone->GetFilledPolysList().GetHash();
+        hash_combine( ret, std::hash<std::string>{}( fillHash.Format() ) );
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    return ret;
+}
+
+
 void CN_CONNECTIVITY_ALGO::Build( const std::vector<BOARD_ITEM*>& aItems )
 {
+    m_itemList.BeginBulkLoad();
+
     for( auto item : aItems )
     {
         switch( item->Type() )
@@ -442,6 +542,8 @@ void CN_CONNECTIVITY_ALGO::Build( const std::vector<BOARD_ITEM*>& aItems )
                 break;
         }
     }
+
+    m_itemList.EndBulkLoad();
 }
 
 
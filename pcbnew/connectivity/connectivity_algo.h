@@ -116,7 +116,9 @@ private:
     class ITEM_MAP_ENTRY
     {
     public:
-        ITEM_MAP_ENTRY( CN_ITEM* aItem = nullptr )
+        ITEM_MAP_ENTRY( CN_ITEM* aItem = nullptr, int aNet = -1, size_t aStateHash = 0 ) :
+            m_net( aNet ),
+            m_stateHash( aStateHash )
         {
             if( aItem )
                 m_items.push_back( aItem );
@@ -141,6 +143,11 @@ private:
         }
 
         std::list<CN_ITEM*> m_items;
+
+        ///> Net and state of the parent when its items were built, which tell Synchronize()
+        ///> the items are out of date (even if the parent was deleted in the meantime)
+        int    m_net;
+        size_t m_stateHash;
     };
 
     CN_LIST m_itemList;
@@ -163,9 +170,12 @@ private:
     {
         auto item = c.Add( brditem );
 
-        m_itemMap[ brditem ] = ITEM_MAP_ENTRY( item );
+        m_itemMap[ brditem ] = ITEM_MAP_ENTRY( item, brditem->GetNetCode(), stateHash( brditem ) );
     }
 
+    ///> Hash of everything the connectivity items of aItem are built from
+    static size_t stateHash( const BOARD_CONNECTED_ITEM* aItem );
+
     void markItemNetAsDirty( const BOARD_ITEM* aItem );
 
 public:
@@ -191,6 +201,11 @@ public:
         return m_dirtyNets[ aNet ];
     }
 
+    bool HasDirtyNets() const
+    {
+        return std::find( m_dirtyNets.begin(), m_dirtyNets.end(), true ) != m_dirtyNets.end();
+    }
+
     void ClearDirtyFlags()
     {
         for( auto i = m_dirtyNets.begin(); i != m_dirtyNets.end(); ++i )
@@ -216,6 +231,16 @@ public:
     void    Build( BOARD* aBoard );
     void    Build( const std::vector<BOARD_ITEM*>& aItems );
 
+    /**
+     * Function Synchronize()
+     * Brings the items up to date with aBoard without rebuilding them: the board items
+     * missing from the database are added, the ones whose geometry, layers or net changed
+     * are rebuilt and the entries of deleted items are invalidated.  The nets of all of
+     * them are marked dirty.
+     * @return the number of board items which were out of date.
+     */
+    int     Synchronize( BOARD* aBoard );
+
     void Clear();
 
     bool    Remove( BOARD_ITEM* aItem );
@@ -27,13 +27,12 @@
 #include <profile.h>
 #endif
 
-#include <thread>
 #include <algorithm>
-#include <future>
 
 #include <connectivity/connectivity_data.h>
 #include <connectivity/connectivity_algo.h>
 #include <ratsnest_data.h>
+#include <thread_pool.h>
 
 CONNECTIVITY_DATA::CONNECTIVITY_DATA()
 {
@@ -94,6 +93,25 @@ void CONNECTIVITY_DATA::Build( const std::vector<BOARD_ITEM*>& aItems )
 }
 
 
+bool CONNECTIVITY_DATA::Synchronize( BOARD* aBoard )
+{
+    // The ratsnest of every net is gone: nothing is left to repair
+    if( m_nets.empty() )
+    {
+        Build( aBoard );
+        return true;
+    }
+
+    int outOfDate = m_connAlgo->Synchronize( aBoard );
+
+    if( !outOfDate && !m_connAlgo->ItemList().IsDirty() && !m_connAlgo->HasDirtyNets() )
+        return false;
+
+    RecalculateRatsnest();
+    return outOfDate > 0;
+}
+
+
 void CONNECTIVITY_DATA::updateRatsnest()
 {
     #ifdef PROFILE
@@ -106,32 +124,13 @@ void CONNECTIVITY_DATA::updateRatsnest()
     std::copy_if( m_nets.begin() + 1, m_nets.end(), std::back_inserter( dirty_nets ),
             [] ( RN_NET* aNet ) { return aNet->IsDirty() && aNet->GetNodeCount() > 0; } );
 
-    // We don't want to spin up a new thread for fewer than 8 nets (overhead costs)
-    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
-            ( dirty_nets.size() + 7 ) / 8 );
-
-    std::atomic<size_t> nextNet( 0 );
-    std::vector<std::future<size_t>> returns( parallelThreadCount );
-
-    auto update_lambda = [&nextNet, &dirty_nets]() -> size_t
-    {
-        for( size_t i = nextNet++; i < dirty_nets.size(); i = nextNet++ )
-            dirty_nets[i]->Update();
-
-        return 1;
-    };
-
-    if( parallelThreadCount == 1 )
-        update_lambda();
-    else
-    {
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii] = std::async( std::launch::async, update_lambda );
-
-        // Finalize the ratsnest threads
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii].wait();
-    }
+    // We don't want to wake up a thread for fewer than 8 nets (overhead costs)
+    GetKiCadThreadPool().ParallelFor( dirty_nets.size(),
+            [&]( size_t i )
+            {
+                dirty_nets[i]->Update();
+            },
+            nullptr, 8 );
 
     #ifdef PROFILE
     rnUpdate.Show();
@@ -97,6 +97,16 @@ public:
      */
     void Build( const std::vector<BOARD_ITEM*>& aItems );
 
+    /**
+     * Function Synchronize()
+     * Repairs the connectivity database of aBoard after changes which may not have been
+     * reported through Add()/Remove()/Update(): only the out of date items are rebuilt and
+     * only the nets they belong to are recomputed.  Falls back to Build() if the database
+     * does not describe aBoard yet.
+     * @return true if anything was out of date.
+     */
+    bool Synchronize( BOARD* aBoard );
+
     /**
      * Function Add()
      * Adds an item to the connectivity data.
@@ -394,6 +394,7 @@ class CN_LIST
 private:
     bool m_dirty;
     bool m_hasInvalid;
+    bool m_bulkLoading;     // items are indexed by EndBulkLoad() instead of one by one
 
     CN_RTREE<CN_ITEM*> m_index;
 
@@ -402,7 +403,8 @@ protected:
 
     void addItemtoTree( CN_ITEM* item )
     {
-        m_index.Insert( item );
+        if( !m_bulkLoading )
+            m_index.Insert( item );
     }
 
 public:
@@ -410,6 +412,27 @@ public:
     {
         m_dirty = false;
         m_hasInvalid = false;
+        m_bulkLoading = false;
+    }
+
+    /**
+     * Function BeginBulkLoad()
+     * Stops indexing the items as they are added.  FindNearby() does not see the items added
+     * until EndBulkLoad() is called.
+     */
+    void BeginBulkLoad()
+    {
+        m_bulkLoading = true;
+    }
+
+    /**
+     * Function EndBulkLoad()
+     * Rebuilds the index of all the items at once.
+     */
+    void EndBulkLoad()
+    {
+        m_bulkLoading = false;
+        m_index.BulkLoad( m_items );
     }
 
     void Clear()
@@ -29,6 +29,8 @@
 
 #include <geometry/rtree.h>
 
+#include <vector>
+
 
 /**
  * Class CN_RTREE -
@@ -65,6 +67,32 @@ public:
         m_tree->Insert( mmin, mmax, aItem );
     }
 
+    /**
+     * Function BulkLoad()
+     * Replaces the contents of the tree with aItems, packed at once.  Much faster than
+     * inserting them one by one, and gives a tree that is faster to query.
+     */
+    void BulkLoad( const std::vector<T>& aItems )
+    {
+        std::vector<typename RTree<T, int, 3, double>::BulkItem> entries( aItems.size() );
+
+        for( size_t i = 0; i < aItems.size(); i++ )
+        {
+            const BOX2I&        bbox    = aItems[i]->BBox();
+            const LAYER_RANGE   layers  = aItems[i]->Layers();
+
+            entries[i].m_min[0] = layers.Start();
+            entries[i].m_min[1] = bbox.GetX();
+            entries[i].m_min[2] = bbox.GetY();
+            entries[i].m_max[0] = layers.End();
+            entries[i].m_max[1] = bbox.GetRight();
+            entries[i].m_max[2] = bbox.GetBottom();
+            entries[i].m_data   = aItems[i];
+        }
+
+        m_tree->BulkLoad( entries );
+    }
+
     /**
      * Function Remove()
      * Removes an item from the tree. Removal is done by comparing pointers, attempting
@@ -0,0 +1,141 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+#ifndef DRC_RTREE__H
+#define DRC_RTREE__H
+
+#include <class_board_item.h>
+#include <layers_id_colors_and_visibility.h>
+#include <eda_rect.h>
+
+#include <geometry/rtree.h>
+
+#include <functional>
+#include <memory>
+
+
+/**
+ * Class DRC_RTREE -
+ * Implements a per layer R-tree of board items, used as a broad phase
+ * by the DRC tests so that an item is only compared against the items whose
+ * (inflated) bounding box overlaps its own.
+ * Non-owning.
+ */
+class DRC_RTREE
+{
+public:
+    typedef RTree<BOARD_ITEM*, int, 2, double> ITEM_TREE;
+
+    DRC_RTREE()
+    {
+        for( int layer = 0; layer < PCB_LAYER_ID_COUNT; ++layer )
+            m_tree[layer].reset( new ITEM_TREE() );
+
+        m_count = 0;
+    }
+
+    /**
+     * Function Insert()
+     * Inserts an item in the tree of each layer it is on.
+     * @param aItem is the item to index
+     * @param aInflate is the amount the item bounding box is inflated by
+     */
+    void Insert( BOARD_ITEM* aItem, int aInflate = 0 )
+    {
+        Insert( aItem, aInflate, aItem->GetLayerSet() );
+    }
+
+    /**
+     * Function Insert()
+     * Inserts an item in the trees of aLayers, which can differ from the item layers (e.g.
+     * for a pad hole, which matters on every copper layer).
+     */
+    void Insert( BOARD_ITEM* aItem, int aInflate, LSET aLayers )
+    {
+        EDA_RECT bbox = aItem->GetBoundingBox();
+        bbox.Normalize();
+        bbox.Inflate( aInflate );
+
+        const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+        const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+        for( PCB_LAYER_ID layer : aLayers.Seq() )
+            m_tree[layer]->Insert( mmin, mmax, aItem );
+
+        m_count++;
+    }
+
+    /**
+     * Function RemoveAll()
+     * Removes all items from the tree of every layer.
+     */
+    void RemoveAll()
+    {
+        for( int layer = 0; layer < PCB_LAYER_ID_COUNT; ++layer )
+            m_tree[layer]->RemoveAll();
+
+        m_count = 0;
+    }
+
+    /**
+     * Function Query()
+     * Executes aVisitor for each item on aLayer whose inflated bounding box intersects
+     * aBounds.  The visitor returns false to stop the search.
+     * The tree is not modified, so several threads may query it at the same time.
+     */
+    void Query( const EDA_RECT& aBounds, PCB_LAYER_ID aLayer,
+                std::function<bool( BOARD_ITEM* )> aVisitor ) const
+    {
+        if( aLayer < 0 || aLayer >= PCB_LAYER_ID_COUNT )
+            return;
+
+        EDA_RECT bbox = aBounds;
+        bbox.Normalize();
+
+        const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+        const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+        m_tree[aLayer]->Search( mmin, mmax,
+                [&]( BOARD_ITEM* const& aItem ) -> bool
+                {
+                    return aVisitor( aItem );
+                } );
+    }
+
+    /**
+     * Function Size()
+     * @return the number of items inserted (an item on several layers is counted once).
+     */
+    int Size() const
+    {
+        return m_count;
+    }
+
+private:
+    std::unique_ptr<ITEM_TREE> m_tree[PCB_LAYER_ID_COUNT];
+    int                        m_count;
+};
+
+
+#endif // DRC_RTREE__H
@@ -44,7 +44,9 @@
 #include <pcbnew.h>
 #include <pcbnew_id.h>
 #include <io_mgr.h>
+#include <snapshot_plugin.h>
 #include <wildcards_and_files_ext.h>
+#include <advanced_config.h>
 
 #include <class_board.h>
 #include <build_version.h>      // LEGACY_BOARD_FILE_VERSION
@@ -367,6 +369,67 @@ IO_MGR::PCB_FILE_T plugin_type( const wxString& aFileName, int aCtl )
 }
 
 
+/**
+ * Function loadBoardSnapshot
+ * loads the board file aFileName from its snapshot, if it has one up to date.
+ * @return the board, or NULL if it has to be loaded from the board file.
+ */
+static BOARD* loadBoardSnapshot( const wxString& aFileName )
+{
+    if( !ADVANCED_CFG::GetCfg().m_boardSnapshots )
+        return NULL;
+
+    wxString snapshotFileName = SNAPSHOT_PLUGIN::SnapshotFileName( aFileName );
+
+    if( !SNAPSHOT_PLUGIN::IsUpToDate( snapshotFileName, aFileName ) )
+        return NULL;
+
+    try
+    {
+        PLUGIN::RELEASER pi( IO_MGR::PluginFind( IO_MGR::KICAD_SNAPSHOT ) );
+
+        return pi->Load( snapshotFileName, NULL );
+    }
+    catch( const IO_ERROR& )
+    {
+        // The board file is still there, and the snapshot will be written again
+        return NULL;
+    }
+}
+
+
+/**
+ * Function saveBoardSnapshot
+ * writes the snapshot of aBoard, which has to be the same as its board file: just loaded
+ * from it, or just saved to it if aSaved.  A snapshot only makes opening the board faster,
+ * so failing to write it is not an error.
+ */
+static void saveBoardSnapshot( BOARD* aBoard, bool aSaved )
+{
+    if( !ADVANCED_CFG::GetCfg().m_boardSnapshots )
+        return;
+
+    wxString snapshotFileName = SNAPSHOT_PLUGIN::SnapshotFileName( aBoard->GetFileName() );
+
+    try
+    {
+        PLUGIN::RELEASER pi( IO_MGR::PluginFind( IO_MGR::KICAD_SNAPSHOT ) );
+        PROPERTIES       props;
+
+        // The saved and the loaded boards do not list their tracks in the same order
+        if( aSaved )
+            props["saved_board"] = "";
+
+        pi->Save( snapshotFileName, aBoard, &props );
+    }
+    catch( const IO_ERROR& )
+    {
+        if( wxFileName::FileExists( snapshotFileName ) )
+            wxRemoveFile( snapshotFileName );
+    }
+}
+
+
 int PCB_EDIT_FRAME::inferLegacyEdgeClearance( BOARD* aBoard )
 {
     PCB_LAYER_COLLECTOR collector;
@@ -513,7 +576,18 @@ bool PCB_EDIT_FRAME::OpenProjectFiles( const std::vector<wxString>& aFileSet, in
             unsigned startTime = GetRunningMicroSecs();
 #endif
 
-            loadedBoard = pi->Load( fullFileName, NULL, &props );
+            // An unchanged board is opened from its snapshot
+            if( pluginType == IO_MGR::KICAD_SEXP )
+                loadedBoard = loadBoardSnapshot( fullFileName );
+
+            if( !loadedBoard )
+            {
+                loadedBoard = pi->Load( fullFileName, NULL, &props );
+
+                // Not when loading changed the board, which would differ from its file
+                if( pluginType == IO_MGR::KICAD_SEXP && !loadedBoard->IsModified() )
+                    saveBoardSnapshot( loadedBoard, false );
+            }
 
 #if USE_INSTRUMENTATION
             unsigned stopTime = GetRunningMicroSecs();
@@ -745,8 +819,12 @@ bool PCB_EDIT_FRAME::SavePcbFile( const wxString& aFileName, bool aCreateBackupF
     // is false.
     // aCreateBackupFile == false is mainly used to write autosave files
     // and not need to have an autosave file in file history
+    // The same goes for the snapshot of the board.
     if( aCreateBackupFile )
+    {
         UpdateFileHistory( GetBoard()->GetFileName() );
+        saveBoardSnapshot( GetBoard(), true );
+    }
 
     // Delete auto save file on successful save.
     wxFileName autoSaveFileName = pcbFileName;
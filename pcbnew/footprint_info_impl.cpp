@@ -33,11 +33,16 @@
 #include <kiway.h>
 #include <lib_id.h>
 #include <macros.h>
+#include <md5_hash.h>
 #include <pgm_base.h>
+#include <thread_pool.h>
 #include <wildcards_and_files_ext.h>
 #include <widgets/progress_reporter.h>
 
-#include <thread>
+#include <wx/dir.h>
+#include <wx/filename.h>
+#include <wx/textfile.h>
+
 #include <mutex>
 
 
@@ -96,6 +101,149 @@ bool FOOTPRINT_LIST_IMPL::CatchErrors( const std::function<void()>& aFunc )
 }
 
 
+/// The first line of the library index files, to change with their format
+static const char s_indexFormat[] = "fp-info-index 2";
+
+
+/**
+ * @return the directory of the library index files
+ */
+static wxString libraryIndexDir()
+{
+    wxFileName fn( GetKicadConfigPath(), wxEmptyString );
+
+    fn.AppendDir( wxT( "fp-info-index" ) );
+
+    return fn.GetPath();
+}
+
+
+/**
+ * @return the index file of the library aLibraryURI
+ */
+static wxString libraryIndexFileName( const wxString& aLibraryURI )
+{
+    // The URI itself is not usable as a file name
+    wxScopedCharBuffer uri = aLibraryURI.utf8_str();
+    MD5_HASH           hash;
+
+    hash.Hash( (uint8_t*) uri.data(), uri.length() );
+    hash.Finalize();
+
+    return wxFileName( libraryIndexDir(), hash.Format() ).GetFullPath();
+}
+
+
+wxString FOOTPRINT_LIST_IMPL::libraryIndexKey( const wxString& aNickname )
+{
+    wxString      uri = m_lib_table->FindRow( aNickname )->GetFullURI( true );
+    long long     timestamp = m_lib_table->GenerateTimestamp( &aNickname );
+    wxArrayString files;
+    MD5_HASH      hash;
+
+    // The timestamp of a library only sums the modification times of its files
+    if( wxDir::Exists( uri ) )
+        wxDir::GetAllFiles( uri, &files, wxEmptyString, wxDIR_FILES );
+    else if( wxFileName::FileExists( uri ) )
+        files.Add( uri );
+
+    files.Sort();
+
+    auto hashText = [&hash]( const wxString& aText )
+    {
+        wxScopedCharBuffer text = aText.utf8_str();
+
+        // With the terminating null, so that the texts cannot run into each other
+        hash.Hash( (uint8_t*) text.data(), text.length() + 1 );
+    };
+
+    hashText( wxString::Format( "%lld", timestamp ) );
+
+    for( const wxString& path : files )
+    {
+        wxFileName fn( path );
+        wxDateTime modTime = fn.GetModificationTime();
+
+        hashText( fn.GetFullName() );
+        hashText( fn.GetSize().ToString() );
+        hashText( wxString::Format( "%lld",
+                                    modTime.IsValid() ? modTime.GetValue().GetValue() : 0LL ) );
+    }
+
+    hash.Finalize();
+
+    return wxString( hash.Format() );
+}
+
+
+bool FOOTPRINT_LIST_IMPL::readLibraryIndex( const wxString& aNickname, const wxString& aKey,
+                                            std::vector<std::unique_ptr<FOOTPRINT_INFO>>& aList )
+{
+    wxString   uri = m_lib_table->FindRow( aNickname )->GetFullURI( true );
+    wxTextFile file( libraryIndexFileName( uri ) );
+    long       count = 0;
+
+    if( !file.Exists() || !file.Open() )
+        return false;
+
+    if( file.GetLineCount() < 4 || file.GetFirstLine() != s_indexFormat
+            || file.GetNextLine() != uri
+            || file.GetNextLine() != aKey
+            || !file.GetNextLine().ToLong( &count ) || count < 0
+            || file.GetLineCount() != 4 + 6 * (size_t) count )
+    {
+        return false;
+    }
+
+    for( long ii = 0; ii < count; ++ii )
+    {
+        wxString name = file.GetNextLine();
+        wxString description = UnescapeString( file.GetNextLine() );
+        wxString keywords = UnescapeString( file.GetNextLine() );
+        int orderNum = wxAtoi( file.GetNextLine() );
+        unsigned int padCount = (unsigned) wxAtoi( file.GetNextLine() );
+        unsigned int uniquePadCount = (unsigned) wxAtoi( file.GetNextLine() );
+
+        aList.emplace_back( std::make_unique<FOOTPRINT_INFO_IMPL>( aNickname, name, description,
+                                                                   keywords, orderNum, padCount,
+                                                                   uniquePadCount ) );
+    }
+
+    return true;
+}
+
+
+void FOOTPRINT_LIST_IMPL::writeLibraryIndex( const wxString& aNickname, const wxString& aKey,
+                                             const std::vector<std::unique_ptr<FOOTPRINT_INFO>>& aList )
+{
+    wxString   uri = m_lib_table->FindRow( aNickname )->GetFullURI( true );
+    wxTextFile file( libraryIndexFileName( uri ) );
+
+    if( file.Exists() ? !file.Open() : !file.Create() )
+        return;
+
+    file.Clear();
+    file.AddLine( s_indexFormat );
+    file.AddLine( uri );
+    file.AddLine( aKey );
+    file.AddLine( wxString::Format( "%d", (int) aList.size() ) );
+
+    for( const std::unique_ptr<FOOTPRINT_INFO>& fpinfo : aList )
+    {
+        file.AddLine( fpinfo->GetName() );
+        file.AddLine( EscapeString( fpinfo->GetDescription(), CTX_DELIMITED_STR ) );
+        file.AddLine( EscapeString( fpinfo->GetKeywords(), CTX_DELIMITED_STR ) );
+        file.AddLine( wxString::Format( "%d", fpinfo->GetOrderNum() ) );
+        file.AddLine( wxString::Format( "%u", fpinfo->GetPadCount() ) );
+        file.AddLine( wxString::Format( "%u", fpinfo->GetUniquePadCount() ) );
+    }
+
+    // Written to a temporary file renamed at the end, so the index is never seen half written
+    file.Write();
+    file.Close();
+}
+
+
 void FOOTPRINT_LIST_IMPL::loader_job()
 {
     wxString nickname;
@@ -199,7 +347,7 @@ void FOOTPRINT_LIST_IMPL::StartWorkers( FP_LIB_TABLE* aTable, wxString const* aN
 
     for( unsigned i = 0; i < aNThreads; ++i )
     {
-        m_threads.emplace_back( &FOOTPRINT_LIST_IMPL::loader_job, this );
+        m_threads.push_back( GetKiCadThreadPool().Submit( [this]() { loader_job(); } ) );
     }
 }
 
@@ -212,7 +360,7 @@ void FOOTPRINT_LIST_IMPL::StopWorkers()
     // for all threads to finish as closing the implementation will free the queues
     // that the threads write to.
     for( auto& i : m_threads )
-        i.join();
+        i.wait();
 
     m_threads.clear();
     m_queue_in.clear();
@@ -229,15 +377,13 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
         std::lock_guard<std::mutex> lock1( m_join );
 
         for( auto& i : m_threads )
-            i.join();
+            i.wait();
 
         m_threads.clear();
         m_queue_in.clear();
         m_count_finished.store( 0 );
     }
 
-    size_t total_count = m_queue_out.size();
-
     LOCALE_IO toggle_locale;
 
     // Parse the footprints in parallel. WARNING! This requires changing the locale, which is
@@ -248,65 +394,83 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
     // TODO: blast LOCALE_IO into the sun
 
     SYNC_QUEUE<std::unique_ptr<FOOTPRINT_INFO>> queue_parsed;
-    std::vector<std::thread>                    threads;
+    std::vector<std::future<void>>              returns;
+    THREAD_POOL&                                pool = GetKiCadThreadPool();
 
-    for( size_t ii = 0; ii < std::thread::hardware_concurrency() + 1; ++ii )
+    // Created once here, the workers only write the files in it
+    if( !wxFileName::DirExists( libraryIndexDir() ) )
+        wxFileName::Mkdir( libraryIndexDir(), wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL );
+
+    for( size_t ii = 0; ii < pool.GetWorkerCount(); ++ii )
     {
-        threads.emplace_back( [this, &queue_parsed]() {
+        returns.push_back( pool.Submit( [this, &queue_parsed]() {
             wxString nickname;
 
             while( this->m_queue_out.pop( nickname ) && !m_cancelled )
             {
-                wxArrayString fpnames;
+                std::vector<std::unique_ptr<FOOTPRINT_INFO>> footprints;
+                wxString                                     key;
+                bool                                         indexed = false;
 
+                // A library which did not change since its index was written is not parsed.
+                // The index is only a cache: its own errors are not reported.
                 try
                 {
-                    m_lib_table->FootprintEnumerate( fpnames, nickname, false );
+                    key = libraryIndexKey( nickname );
+                    indexed = readLibraryIndex( nickname, key, footprints );
                 }
-                catch( const IO_ERROR& ioe )
+                catch( const IO_ERROR& )
                 {
-                    m_errors.move_push( std::make_unique<IO_ERROR>( ioe ) );
+                    key.Clear();
                 }
-                catch( const std::exception& se )
+
+                if( !indexed )
                 {
-                    // This is a round about way to do this, but who knows what THROW_IO_ERROR()
-                    // may be tricked out to do someday, keep it in the game.
-                    try
+                    wxArrayString fpnames;
+
+                    footprints.clear();
+
+                    bool ok = CatchErrors( [this, &nickname, &fpnames]() {
+                        m_lib_table->FootprintEnumerate( fpnames, nickname, false );
+                    } );
+
+                    for( unsigned jj = 0; jj < fpnames.size() && !m_cancelled; ++jj )
                     {
-                        THROW_IO_ERROR( se.what() );
+                        wxString fpname = fpnames[jj];
+                        footprints.emplace_back( std::make_unique<FOOTPRINT_INFO_IMPL>(
+                                this, nickname, fpname ) );
                     }
-                    catch( const IO_ERROR& ioe )
+
+                    // A library with errors is parsed again next time, to report them again
+                    if( ok && !key.IsEmpty() && !m_cancelled )
                     {
-                        m_errors.move_push( std::make_unique<IO_ERROR>( ioe ) );
+                        try
+                        {
+                            writeLibraryIndex( nickname, key, footprints );
+                        }
+                        catch( const IO_ERROR& )
+                        {
+                        }
                     }
                 }
 
-                for( unsigned jj = 0; jj < fpnames.size() && !m_cancelled; ++jj )
-                {
-                    wxString fpname = fpnames[jj];
-                    FOOTPRINT_INFO* fpinfo = new FOOTPRINT_INFO_IMPL( this, nickname, fpname );
-                    queue_parsed.move_push( std::unique_ptr<FOOTPRINT_INFO>( fpinfo ) );
-                }
+                for( std::unique_ptr<FOOTPRINT_INFO>& fpinfo : footprints )
+                    queue_parsed.move_push( std::move( fpinfo ) );
 
                 if( m_progress_reporter )
                     m_progress_reporter->AdvanceProgress();
 
                 m_count_finished.fetch_add( 1 );
             }
-        } );
+        } ) );
     }
 
-    while( !m_cancelled && (size_t)m_count_finished.load() < total_count )
+    for( auto& ret : returns )
     {
-        if( m_progress_reporter && !m_progress_reporter->KeepRefreshing() )
+        if( !THREAD_POOL::Wait( ret, m_progress_reporter ) )
             m_cancelled = true;
-
-        wxMilliSleep( 30 );
     }
 
-    for( auto& thr : threads )
-        thr.join();
-
     std::unique_ptr<FOOTPRINT_INFO> fpi;
 
     while( queue_parsed.pop( fpi ) )
@@ -23,7 +23,7 @@
 #include <atomic>
 #include <functional>
 #include <memory>
-#include <thread>
+#include <future>
 #include <vector>
 
 #include <footprint_info.h>
@@ -83,15 +83,15 @@ protected:
 
 class FOOTPRINT_LIST_IMPL : public FOOTPRINT_LIST
 {
-    FOOTPRINT_ASYNC_LOADER*  m_loader;
-    std::vector<std::thread> m_threads;
-    SYNC_QUEUE<wxString>     m_queue_in;
-    SYNC_QUEUE<wxString>     m_queue_out;
-    std::atomic_size_t       m_count_finished;
-    long long                m_list_timestamp;
-    PROGRESS_REPORTER*       m_progress_reporter;
-    std::atomic_bool         m_cancelled;
-    std::mutex               m_join;
+    FOOTPRINT_ASYNC_LOADER*         m_loader;
+    std::vector<std::future<void>>  m_threads;      // loader jobs running on the thread pool
+    SYNC_QUEUE<wxString>            m_queue_in;
+    SYNC_QUEUE<wxString>            m_queue_out;
+    std::atomic_size_t              m_count_finished;
+    long long                       m_list_timestamp;
+    PROGRESS_REPORTER*              m_progress_reporter;
+    std::atomic_bool                m_cancelled;
+    std::mutex                      m_join;
 
     /**
      * Call aFunc, pushing any IO_ERRORs and std::exceptions it throws onto m_errors.
@@ -113,6 +113,31 @@ protected:
      */
     void loader_job();
 
+    /**
+     * Function libraryIndexKey
+     * @return the key of the current contents of the library aNickname, which changes with
+     * its timestamp and with the name, size or modification time of any of its files.
+     */
+    wxString libraryIndexKey( const wxString& aNickname );
+
+    /**
+     * Function readLibraryIndex
+     * reads the footprints of the library aNickname from its index file in the user
+     * configuration directory, if the index was written when the library key was aKey.
+     *
+     * @return true if the index was read, false if there is no such index.
+     */
+    bool readLibraryIndex( const wxString& aNickname, const wxString& aKey,
+                           std::vector<std::unique_ptr<FOOTPRINT_INFO>>& aList );
+
+    /**
+     * Function writeLibraryIndex
+     * writes the footprints aList of the library aNickname to its index file, for the library
+     * key aKey.
+     */
+    void writeLibraryIndex( const wxString& aNickname, const wxString& aKey,
+                            const std::vector<std::unique_ptr<FOOTPRINT_INFO>>& aList );
+
 public:
     FOOTPRINT_LIST_IMPL();
     virtual ~FOOTPRINT_LIST_IMPL();
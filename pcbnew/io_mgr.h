@@ -63,6 +63,8 @@ public:
 #if defined(BUILD_GITHUB_PLUGIN)
         GITHUB,         ///< Read only http://github.com repo holding pretty footprints
 #endif
+        KICAD_SNAPSHOT, ///< Binary snapshot of a S-expression board, to open it quickly.
+
         // add your type here.
 
         // ALTIUM,
@@ -81,23 +81,37 @@ void filterNetClass( const BOARD& aBoard, NETCLASS& aNetClass )
  * that contain a single module per file.  This class is a helper only for the
  * footprint portion of the PLUGIN API, and only for the #PCB_IO plugin.  It is
  * private to this implementation file so it is not placed into a header.
+ *
+ * The module is parsed only when it is first asked for: until then the item is just an
+ * entry of the index of the library files.
  */
 class FP_CACHE_ITEM
 {
     WX_FILENAME             m_filename;
     std::unique_ptr<MODULE> m_module;
+    long long               m_timestamp;    // of the file m_module was parsed from or
+                                            // saved to.
 
 public:
     FP_CACHE_ITEM( MODULE* aModule, const WX_FILENAME& aFileName );
 
+    WX_FILENAME&       GetFileName()       { return m_filename; }
     const WX_FILENAME& GetFileName() const { return m_filename; }
     const MODULE*      GetModule()   const { return m_module.get(); }
+    long long          GetTimestamp() const { return m_timestamp; }
+
+    void SetModule( MODULE* aModule, long long aTimestamp )
+    {
+        m_module.reset( aModule );
+        m_timestamp = aTimestamp;
+    }
 };
 
 
 FP_CACHE_ITEM::FP_CACHE_ITEM( MODULE* aModule, const WX_FILENAME& aFileName ) :
     m_filename( aFileName ),
-    m_module( aModule )
+    m_module( aModule ),
+    m_timestamp( 0 )
 { }
 
 
@@ -113,10 +127,9 @@ class FP_CACHE
     wxString        m_lib_raw_path;     // For quick comparisons.
     MODULE_MAP      m_modules;          // Map of footprint file name per MODULE*.
 
-    bool            m_cache_dirty;      // Stored separately because it's expensive to check
-                                        // m_cache_timestamp against all the files.
-    long long       m_cache_timestamp;  // A hash of the timestamps for all the footprint
-                                        // files.
+    bool            m_cache_dirty;      // True until the library files are indexed.
+    long long       m_dir_timestamp;    // Of the library directory when it was indexed:
+                                        // it changes when files are added or removed.
 
 public:
     FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath );
@@ -138,8 +151,23 @@ public:
      */
     void Save( MODULE* aModule = NULL );
 
+    /**
+     * Function Load
+     * indexes the footprint files of the library.  The footprints are parsed by GetModule()
+     * when they are first asked for.  Indexing again keeps the footprints already parsed.
+     */
     void Load();
 
+    /**
+     * Function GetModule
+     * returns the footprint aFootprintName, parsing its file the first time, or again
+     * when the file changed since.
+     *
+     * @return NULL if the library has no such footprint.
+     * @throw IO_ERROR if the footprint file cannot be parsed.
+     */
+    const MODULE* GetModule( const wxString& aFootprintName );
+
     void Remove( const wxString& aFootprintName );
 
     /**
@@ -152,7 +180,9 @@ public:
 
     /**
      * Function IsModified
-     * Return true if the cache is not up-to-date.
+     * Return true if the index is not up-to-date, that is if footprint files were added to
+     * or removed from the library since it was built.  The changes of the files themselves
+     * are found by GetModule(), one file at a time.
      */
     bool IsModified();
 
@@ -169,6 +199,9 @@ public:
      * @return true if \a aPath is the same as the cache path.
      */
     bool IsPath( const wxString& aPath ) const;
+
+private:
+    long long dirTimestamp() const;
 };
 
 
@@ -177,15 +210,13 @@ FP_CACHE::FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath )
     m_owner = aOwner;
     m_lib_raw_path = aLibraryPath;
     m_lib_path.SetPath( aLibraryPath );
-    m_cache_timestamp = 0;
+    m_dir_timestamp = 0;
     m_cache_dirty = true;
 }
 
 
 void FP_CACHE::Save( MODULE* aModule )
 {
-    m_cache_timestamp = 0;
-
     if( !m_lib_path.DirExists() && !m_lib_path.Mkdir() )
     {
         THROW_IO_ERROR( wxString::Format( _( "Cannot create footprint library path \"%s\"" ),
@@ -200,10 +231,14 @@ void FP_CACHE::Save( MODULE* aModule )
 
     for( MODULE_ITER it = m_modules.begin();  it != m_modules.end();  ++it )
     {
+        // A footprint which was never parsed is still what its file holds.
+        if( !it->second->GetModule() )
+            continue;
+
         if( aModule && aModule != it->second->GetModule() )
             continue;
 
-        WX_FILENAME fn = it->second->GetFileName();
+        WX_FILENAME& fn = it->second->GetFileName();
 
         wxString tempFileName =
 #ifdef USE_TMP_FILE
@@ -240,22 +275,22 @@ void FP_CACHE::Save( MODULE* aModule )
             THROW_IO_ERROR( msg );
         }
 #endif
-        m_cache_timestamp += fn.GetTimestamp();
+        // So GetModule() does not parse again the file just written
+        MODULE* module = const_cast<MODULE*>( it->second->GetModule() );
+        it->second->SetModule( module, fn.GetTimestamp() );
     }
 
-    m_cache_timestamp += m_lib_path.GetModificationTime().GetValue().GetValue();
-
     // If we've saved the full cache, we clear the dirty flag.
     if( !aModule )
+    {
         m_cache_dirty = false;
+        m_dir_timestamp = dirTimestamp();
+    }
 }
 
 
 void FP_CACHE::Load()
 {
-    m_cache_dirty = false;
-    m_cache_timestamp = 0;
-
     wxDir dir( m_lib_raw_path );
 
     if( !dir.IsOpened() )
@@ -266,48 +301,63 @@ void FP_CACHE::Load()
         THROW_IO_ERROR( msg );
     }
 
+    // Before listing the files, so a file added meanwhile is found by the next IsModified()
+    m_dir_timestamp = dirTimestamp();
+    m_cache_dirty = false;
+
     wxString fullName;
     wxString fileSpec = wxT( "*." ) + KiCadFootprintFileExtension;
 
     // wxFileName construction is egregiously slow.  Construct it once and just swap out
     // the filename thereafter.
     WX_FILENAME fn( m_lib_raw_path, wxT( "dummyName" ) );
+    MODULE_MAP  modules;
 
     if( dir.GetFirst( &fullName, fileSpec ) )
     {
-        wxString cacheError;
-
         do
         {
             fn.SetFullName( fullName );
 
-            // Queue I/O errors so only files that fail to parse don't get loaded.
-            try
-            {
-                FILE_LINE_READER    reader( fn.GetFullPath() );
+            wxString    fpName = fn.GetName();
+            MODULE_ITER it = m_modules.find( fpName );
 
-                m_owner->m_parser->SetLineReader( &reader );
+            // Keep what was already parsed; GetModule() checks whether the file changed
+            if( it != m_modules.end() )
+                modules.transfer( it, m_modules );
+            else
+                modules.insert( fpName, new FP_CACHE_ITEM( nullptr, fn ) );
 
-                MODULE*     footprint = (MODULE*) m_owner->m_parser->Parse();
-                wxString    fpName = fn.GetName();
+        } while( dir.GetNext( &fullName ) );
+    }
 
-                footprint->SetFPID( LIB_ID( wxEmptyString, fpName ) );
-                m_modules.insert( fpName, new FP_CACHE_ITEM( footprint, fn ) );
+    m_modules.swap( modules );
+}
 
-                m_cache_timestamp += fn.GetTimestamp();
-            }
-            catch( const IO_ERROR& ioe )
-            {
-                if( !cacheError.IsEmpty() )
-                    cacheError += "\n\n";
 
-                cacheError += ioe.What();
-            }
-        } while( dir.GetNext( &fullName ) );
+const MODULE* FP_CACHE::GetModule( const wxString& aFootprintName )
+{
+    MODULE_ITER it = m_modules.find( aFootprintName );
 
-        if( !cacheError.IsEmpty() )
-            THROW_IO_ERROR( cacheError );
-    }
+    if( it == m_modules.end() )
+        return nullptr;
+
+    FP_CACHE_ITEM* item = it->second;
+    long long      timestamp = item->GetFileName().GetTimestamp();
+
+    if( item->GetModule() && timestamp == item->GetTimestamp() )
+        return item->GetModule();
+
+    MMAP_LINE_READER reader( item->GetFileName().GetFullPath() );
+
+    m_owner->m_parser->SetLineReader( &reader );
+
+    MODULE* footprint = (MODULE*) m_owner->m_parser->Parse();
+
+    footprint->SetFPID( LIB_ID( wxEmptyString, aFootprintName ) );
+    item->SetModule( footprint, timestamp );
+
+    return footprint;
 }
 
 
@@ -338,12 +388,21 @@ bool FP_CACHE::IsPath( const wxString& aPath ) const
 
 bool FP_CACHE::IsModified()
 {
-    m_cache_dirty = m_cache_dirty || GetTimestamp( m_lib_path.GetFullPath() ) != m_cache_timestamp;
+    m_cache_dirty = m_cache_dirty || dirTimestamp() != m_dir_timestamp;
 
     return m_cache_dirty;
 }
 
 
+long long FP_CACHE::dirTimestamp() const
+{
+    if( !m_lib_path.DirExists() )
+        return 0;
+
+    return m_lib_path.GetModificationTime().GetValue().GetValue();
+}
+
+
 long long FP_CACHE::GetTimestamp( const wxString& aLibPath )
 {
     wxString fileSpec = wxT( "*." ) + KiCadFootprintFileExtension;
@@ -354,8 +413,6 @@ long long FP_CACHE::GetTimestamp( const wxString& aLibPath )
 
 void PCB_IO::Save( const wxString& aFileName, BOARD* aBoard, const PROPERTIES* aProperties )
 {
-    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
-
     init( aProperties );
 
     m_board = aBoard;       // after init()
@@ -400,8 +457,6 @@ BOARD_ITEM* PCB_IO::Parse( const wxString& aClipboardSourceInput )
 
 void PCB_IO::Format( BOARD_ITEM* aItem, int aNestLevel ) const
 {
-    LOCALE_IO   toggle;     // public API function, perform anything convenient for caller
-
     switch( aItem->Type() )
     {
     case PCB_T:
@@ -485,50 +540,50 @@ void PCB_IO::formatSetup( BOARD* aBoard, int aNestLevel ) const
 
     // Save current default track width, for compatibility with older Pcbnew version;
     m_out->Print( aNestLevel+1, "(last_trace_width %s)\n",
-                  FormatInternalUnits( dsnSettings.GetCurrentTrackWidth() ).c_str() );
+                  FMT_IU( dsnSettings.GetCurrentTrackWidth() ).c_str() );
 
     // Save custom track widths list (the first is not saved here: it's the netclass value)
     for( unsigned ii = 1; ii < dsnSettings.m_TrackWidthList.size(); ii++ )
     {
         m_out->Print( aNestLevel+1, "(user_trace_width %s)\n",
-                      FormatInternalUnits( dsnSettings.m_TrackWidthList[ii] ).c_str() );
+                      FMT_IU( dsnSettings.m_TrackWidthList[ii] ).c_str() );
     }
 
     m_out->Print( aNestLevel+1, "(trace_clearance %s)\n",
-                  FormatInternalUnits( dsnSettings.GetDefault()->GetClearance() ).c_str() );
+                  FMT_IU( dsnSettings.GetDefault()->GetClearance() ).c_str() );
 
     // ZONE_SETTINGS
     m_out->Print( aNestLevel+1, "(zone_clearance %s)\n",
-                  FormatInternalUnits( aBoard->GetZoneSettings().m_ZoneClearance ).c_str() );
+                  FMT_IU( aBoard->GetZoneSettings().m_ZoneClearance ).c_str() );
     m_out->Print( aNestLevel+1, "(zone_45_only %s)\n",
                   aBoard->GetZoneSettings().m_Zone_45_Only ? "yes" : "no" );
 
     m_out->Print( aNestLevel+1, "(trace_min %s)\n",
-                  FormatInternalUnits( dsnSettings.m_TrackMinWidth ).c_str() );
+                  FMT_IU( dsnSettings.m_TrackMinWidth ).c_str() );
 
     // Save current default via size, for compatibility with older Pcbnew version;
     m_out->Print( aNestLevel+1, "(via_size %s)\n",
-                  FormatInternalUnits( dsnSettings.GetDefault()->GetViaDiameter() ).c_str() );
+                  FMT_IU( dsnSettings.GetDefault()->GetViaDiameter() ).c_str() );
     m_out->Print( aNestLevel+1, "(via_drill %s)\n",
-                  FormatInternalUnits( dsnSettings.GetDefault()->GetViaDrill() ).c_str() );
+                  FMT_IU( dsnSettings.GetDefault()->GetViaDrill() ).c_str() );
     m_out->Print( aNestLevel+1, "(via_min_size %s)\n",
-                  FormatInternalUnits( dsnSettings.m_ViasMinSize ).c_str() );
+                  FMT_IU( dsnSettings.m_ViasMinSize ).c_str() );
     m_out->Print( aNestLevel+1, "(via_min_drill %s)\n",
-                  FormatInternalUnits( dsnSettings.m_ViasMinDrill ).c_str() );
+                  FMT_IU( dsnSettings.m_ViasMinDrill ).c_str() );
 
     // Save custom via dimensions list (the first is not saved here: it's the netclass value)
     for( unsigned ii = 1; ii < dsnSettings.m_ViasDimensionsList.size(); ii++ )
         m_out->Print( aNestLevel+1, "(user_via %s %s)\n",
-                      FormatInternalUnits( dsnSettings.m_ViasDimensionsList[ii].m_Diameter ).c_str(),
-                      FormatInternalUnits( dsnSettings.m_ViasDimensionsList[ii].m_Drill ).c_str() );
+                      FMT_IU( dsnSettings.m_ViasDimensionsList[ii].m_Diameter ).c_str(),
+                      FMT_IU( dsnSettings.m_ViasDimensionsList[ii].m_Drill ).c_str() );
 
     // Save custom diff-pair dimensions (the first is not saved here: it's the netclass value)
     for( unsigned ii = 1; ii < dsnSettings.m_DiffPairDimensionsList.size(); ii++ )
     {
         m_out->Print( aNestLevel+1, "(user_diff_pair %s %s %s)\n",
-                      FormatInternalUnits( dsnSettings.m_DiffPairDimensionsList[ii].m_Width ).c_str(),
-                      FormatInternalUnits( dsnSettings.m_DiffPairDimensionsList[ii].m_Gap ).c_str(),
-                      FormatInternalUnits( dsnSettings.m_DiffPairDimensionsList[ii].m_ViaGap ).c_str() );
+                      FMT_IU( dsnSettings.m_DiffPairDimensionsList[ii].m_Width ).c_str(),
+                      FMT_IU( dsnSettings.m_DiffPairDimensionsList[ii].m_Gap ).c_str(),
+                      FMT_IU( dsnSettings.m_DiffPairDimensionsList[ii].m_ViaGap ).c_str() );
     }
 
     // for old versions compatibility:
@@ -536,18 +591,18 @@ void PCB_IO::formatSetup( BOARD* aBoard, int aNestLevel ) const
         m_out->Print( aNestLevel+1, "(blind_buried_vias_allowed yes)\n" );
 
     m_out->Print( aNestLevel+1, "(uvia_size %s)\n",
-                  FormatInternalUnits( dsnSettings.GetDefault()->GetuViaDiameter() ).c_str() );
+                  FMT_IU( dsnSettings.GetDefault()->GetuViaDiameter() ).c_str() );
     m_out->Print( aNestLevel+1, "(uvia_drill %s)\n",
-                  FormatInternalUnits( dsnSettings.GetDefault()->GetuViaDrill() ).c_str() );
+                  FMT_IU( dsnSettings.GetDefault()->GetuViaDrill() ).c_str() );
     m_out->Print( aNestLevel+1, "(uvias_allowed %s)\n",
                   ( dsnSettings.m_MicroViasAllowed ) ? "yes" : "no" );
     m_out->Print( aNestLevel+1, "(uvia_min_size %s)\n",
-                  FormatInternalUnits( dsnSettings.m_MicroViasMinSize ).c_str() );
+                  FMT_IU( dsnSettings.m_MicroViasMinSize ).c_str() );
     m_out->Print( aNestLevel+1, "(uvia_min_drill %s)\n",
-                  FormatInternalUnits( dsnSettings.m_MicroViasMinDrill ).c_str() );
+                  FMT_IU( dsnSettings.m_MicroViasMinDrill ).c_str() );
 
     m_out->Print( aNestLevel+1, "(max_error %s)\n",
-                  FormatInternalUnits( dsnSettings.m_MaxError ).c_str() );
+                  FMT_IU( dsnSettings.m_MaxError ).c_str() );
 
     // Store this option only if it is not the legacy option:
     if( dsnSettings.m_ZoneUseNoOutlineInFill )
@@ -556,34 +611,34 @@ void PCB_IO::formatSetup( BOARD* aBoard, int aNestLevel ) const
     formatDefaults( dsnSettings, aNestLevel+1 );
 
     m_out->Print( aNestLevel+1, "(pad_size %s %s)\n",
-                  FormatInternalUnits( dsnSettings.m_Pad_Master.GetSize().x ).c_str(),
-                  FormatInternalUnits( dsnSettings.m_Pad_Master.GetSize().y ).c_str() );
+                  FMT_IU( dsnSettings.m_Pad_Master.GetSize().x ).c_str(),
+                  FMT_IU( dsnSettings.m_Pad_Master.GetSize().y ).c_str() );
     m_out->Print( aNestLevel+1, "(pad_drill %s)\n",
-                  FormatInternalUnits( dsnSettings.m_Pad_Master.GetDrillSize().x ).c_str() );
+                  FMT_IU( dsnSettings.m_Pad_Master.GetDrillSize().x ).c_str() );
 
     m_out->Print( aNestLevel+1, "(pad_to_mask_clearance %s)\n",
-                  FormatInternalUnits( dsnSettings.m_SolderMaskMargin ).c_str() );
+                  FMT_IU( dsnSettings.m_SolderMaskMargin ).c_str() );
 
     if( dsnSettings.m_SolderMaskMinWidth )
         m_out->Print( aNestLevel+1, "(solder_mask_min_width %s)\n",
-                      FormatInternalUnits( dsnSettings.m_SolderMaskMinWidth ).c_str() );
+                      FMT_IU( dsnSettings.m_SolderMaskMinWidth ).c_str() );
 
     if( dsnSettings.m_SolderPasteMargin != 0 )
         m_out->Print( aNestLevel+1, "(pad_to_paste_clearance %s)\n",
-                      FormatInternalUnits( dsnSettings.m_SolderPasteMargin ).c_str() );
+                      FMT_IU( dsnSettings.m_SolderPasteMargin ).c_str() );
 
     if( dsnSettings.m_SolderPasteMarginRatio != 0 )
         m_out->Print( aNestLevel+1, "(pad_to_paste_clearance_ratio %s)\n",
                       Double2Str( dsnSettings.m_SolderPasteMarginRatio ).c_str() );
 
     m_out->Print( aNestLevel+1, "(aux_axis_origin %s %s)\n",
-                  FormatInternalUnits( aBoard->GetAuxOrigin().x ).c_str(),
-                  FormatInternalUnits( aBoard->GetAuxOrigin().y ).c_str() );
+                  FMT_IU( aBoard->GetAuxOrigin().x ).c_str(),
+                  FMT_IU( aBoard->GetAuxOrigin().y ).c_str() );
 
     if( aBoard->GetGridOrigin().x || aBoard->GetGridOrigin().y )
         m_out->Print( aNestLevel+1, "(grid_origin %s %s)\n",
-                      FormatInternalUnits( aBoard->GetGridOrigin().x ).c_str(),
-                      FormatInternalUnits( aBoard->GetGridOrigin().y ).c_str() );
+                      FMT_IU( aBoard->GetGridOrigin().x ).c_str(),
+                      FMT_IU( aBoard->GetGridOrigin().y ).c_str() );
 
     m_out->Print( aNestLevel+1, "(visible_elements %X)\n",
                   dsnSettings.GetVisibleElements() );
@@ -599,38 +654,38 @@ void PCB_IO::formatDefaults( const BOARD_DESIGN_SETTINGS& aSettings, int aNestLe
     m_out->Print( aNestLevel, "(defaults\n" );
 
     m_out->Print( aNestLevel+1, "(edge_clearance %s)\n",
-                  FormatInternalUnits( aSettings.m_CopperEdgeClearance ).c_str() );
+                  FMT_IU( aSettings.m_CopperEdgeClearance ).c_str() );
 
     m_out->Print( aNestLevel+1, "(edge_cuts_line_width %s)\n",
-                  FormatInternalUnits( aSettings.m_LineThickness[ LAYER_CLASS_EDGES ] ).c_str() );
+                  FMT_IU( aSettings.m_LineThickness[ LAYER_CLASS_EDGES ] ).c_str() );
 
     m_out->Print( aNestLevel+1, "(courtyard_line_width %s)\n",
-                  FormatInternalUnits( aSettings.m_LineThickness[ LAYER_CLASS_COURTYARD ] ).c_str() );
+                  FMT_IU( aSettings.m_LineThickness[ LAYER_CLASS_COURTYARD ] ).c_str() );
 
     m_out->Print( aNestLevel+1, "(copper_line_width %s)\n",
-                  FormatInternalUnits( aSettings.m_LineThickness[ LAYER_CLASS_COPPER ] ).c_str() );
+                  FMT_IU( aSettings.m_LineThickness[ LAYER_CLASS_COPPER ] ).c_str() );
     m_out->Print( aNestLevel+1, "(copper_text_dims (size %s %s) (thickness %s)%s%s)\n",
-                  FormatInternalUnits( aSettings.m_TextSize[ LAYER_CLASS_COPPER ].x ).c_str(),
-                  FormatInternalUnits( aSettings.m_TextSize[ LAYER_CLASS_COPPER ].y ).c_str(),
-                  FormatInternalUnits( aSettings.m_TextThickness[ LAYER_CLASS_COPPER ] ).c_str(),
+                  FMT_IU( aSettings.m_TextSize[ LAYER_CLASS_COPPER ].x ).c_str(),
+                  FMT_IU( aSettings.m_TextSize[ LAYER_CLASS_COPPER ].y ).c_str(),
+                  FMT_IU( aSettings.m_TextThickness[ LAYER_CLASS_COPPER ] ).c_str(),
                   aSettings.m_TextItalic[ LAYER_CLASS_COPPER ] ? " italic" : "",
                   aSettings.m_TextUpright[ LAYER_CLASS_COPPER ] ? " keep_upright" : "" );
 
     m_out->Print( aNestLevel+1, "(silk_line_width %s)\n",
-                  FormatInternalUnits( aSettings.m_LineThickness[ LAYER_CLASS_SILK ] ).c_str() );
+                  FMT_IU( aSettings.m_LineThickness[ LAYER_CLASS_SILK ] ).c_str() );
     m_out->Print( aNestLevel+1, "(silk_text_dims (size %s %s) (thickness %s)%s%s)\n",
-                  FormatInternalUnits( aSettings.m_TextSize[ LAYER_CLASS_SILK ].x ).c_str(),
-                  FormatInternalUnits( aSettings.m_TextSize[ LAYER_CLASS_SILK ].y ).c_str(),
-                  FormatInternalUnits( aSettings.m_TextThickness[ LAYER_CLASS_SILK ] ).c_str(),
+                  FMT_IU( aSettings.m_TextSize[ LAYER_CLASS_SILK ].x ).c_str(),
+                  FMT_IU( aSettings.m_TextSize[ LAYER_CLASS_SILK ].y ).c_str(),
+                  FMT_IU( aSettings.m_TextThickness[ LAYER_CLASS_SILK ] ).c_str(),
                   aSettings.m_TextItalic[ LAYER_CLASS_SILK ] ? " italic" : "",
                   aSettings.m_TextUpright[ LAYER_CLASS_SILK ] ? " keep_upright" : "" );
 
     m_out->Print( aNestLevel+1, "(other_layers_line_width %s)\n",
-                  FormatInternalUnits( aSettings.m_LineThickness[ LAYER_CLASS_OTHERS ] ).c_str() );
+                  FMT_IU( aSettings.m_LineThickness[ LAYER_CLASS_OTHERS ] ).c_str() );
     m_out->Print( aNestLevel+1, "(other_layers_text_dims (size %s %s) (thickness %s)%s%s)\n",
-                  FormatInternalUnits( aSettings.m_TextSize[ LAYER_CLASS_OTHERS ].x ).c_str(),
-                  FormatInternalUnits( aSettings.m_TextSize[ LAYER_CLASS_OTHERS ].y ).c_str(),
-                  FormatInternalUnits( aSettings.m_TextThickness[ LAYER_CLASS_OTHERS ] ).c_str(),
+                  FMT_IU( aSettings.m_TextSize[ LAYER_CLASS_OTHERS ].x ).c_str(),
+                  FMT_IU( aSettings.m_TextSize[ LAYER_CLASS_OTHERS ].y ).c_str(),
+                  FMT_IU( aSettings.m_TextThickness[ LAYER_CLASS_OTHERS ] ).c_str(),
                   aSettings.m_TextItalic[ LAYER_CLASS_OTHERS ] ? " italic" : "",
                   aSettings.m_TextUpright[ LAYER_CLASS_OTHERS ] ? " keep_upright" : "" );
 
@@ -646,7 +701,7 @@ void PCB_IO::formatGeneral( BOARD* aBoard, int aNestLevel ) const
     m_out->Print( aNestLevel, "(general\n" );
     // Write Bounding box info
     m_out->Print( aNestLevel+1, "(thickness %s)\n",
-                  FormatInternalUnits( dsnSettings.GetBoardThickness() ).c_str() );
+                  FMT_IU( dsnSettings.GetBoardThickness() ).c_str() );
 
     m_out->Print( aNestLevel+1, "(drawings %u)\n", (unsigned)aBoard->Drawings().size() );
     m_out->Print( aNestLevel + 1, "(tracks %u)\n", (unsigned)aBoard->Tracks().size() );
@@ -782,11 +837,14 @@ void PCB_IO::format( BOARD* aBoard, int aNestLevel ) const
     // Do not save MARKER_PCBs, they can be regenerated easily.
 
     // Save the tracks and vias.
-    for( auto track : aBoard->Tracks() )
-        Format( track, aNestLevel );
+    if( !( m_ctl & CTL_OMIT_TRACKS ) )
+    {
+        for( auto track : aBoard->Tracks() )
+            Format( track, aNestLevel );
 
-    if( aBoard->Tracks().size() )
-        m_out->Print( 0, "\n" );
+        if( aBoard->Tracks().size() )
+            m_out->Print( 0, "\n" );
+    }
 
     // Save the polygon (which are the newer technology) zones.
     for( int i = 0; i < aBoard->GetAreaCount();  ++i )
@@ -797,8 +855,8 @@ void PCB_IO::format( BOARD* aBoard, int aNestLevel ) const
 void PCB_IO::format( DIMENSION* aDimension, int aNestLevel ) const
 {
     m_out->Print( aNestLevel, "(dimension %s (width %s)",
-                  FormatInternalUnits( aDimension->GetValue() ).c_str(),
-                  FormatInternalUnits( aDimension->GetWidth() ).c_str() );
+                  FMT_IU( aDimension->GetValue() ).c_str(),
+                  FMT_IU( aDimension->GetWidth() ).c_str() );
 
     formatLayer( aDimension );
 
@@ -810,46 +868,46 @@ void PCB_IO::format( DIMENSION* aDimension, int aNestLevel ) const
     Format( &aDimension->Text(), aNestLevel+1 );
 
     m_out->Print( aNestLevel+1, "(feature1 (pts (xy %s %s) (xy %s %s)))\n",
-                  FormatInternalUnits( aDimension->m_featureLineDO.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_featureLineDO.y ).c_str(),
-                  FormatInternalUnits( aDimension->m_featureLineDF.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_featureLineDF.y ).c_str() );
+                  FMT_IU( aDimension->m_featureLineDO.x ).c_str(),
+                  FMT_IU( aDimension->m_featureLineDO.y ).c_str(),
+                  FMT_IU( aDimension->m_featureLineDF.x ).c_str(),
+                  FMT_IU( aDimension->m_featureLineDF.y ).c_str() );
 
     m_out->Print( aNestLevel+1, "(feature2 (pts (xy %s %s) (xy %s %s)))\n",
-                  FormatInternalUnits( aDimension->m_featureLineGO.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_featureLineGO.y ).c_str(),
-                  FormatInternalUnits( aDimension->m_featureLineGF.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_featureLineGF.y ).c_str() );
+                  FMT_IU( aDimension->m_featureLineGO.x ).c_str(),
+                  FMT_IU( aDimension->m_featureLineGO.y ).c_str(),
+                  FMT_IU( aDimension->m_featureLineGF.x ).c_str(),
+                  FMT_IU( aDimension->m_featureLineGF.y ).c_str() );
 
     m_out->Print( aNestLevel+1, "(crossbar (pts (xy %s %s) (xy %s %s)))\n",
-                  FormatInternalUnits( aDimension->m_crossBarO.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_crossBarO.y ).c_str(),
-                  FormatInternalUnits( aDimension->m_crossBarF.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_crossBarF.y ).c_str() );
+                  FMT_IU( aDimension->m_crossBarO.x ).c_str(),
+                  FMT_IU( aDimension->m_crossBarO.y ).c_str(),
+                  FMT_IU( aDimension->m_crossBarF.x ).c_str(),
+                  FMT_IU( aDimension->m_crossBarF.y ).c_str() );
 
     m_out->Print( aNestLevel+1, "(arrow1a (pts (xy %s %s) (xy %s %s)))\n",
-                  FormatInternalUnits( aDimension->m_crossBarF.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_crossBarF.y ).c_str(),
-                  FormatInternalUnits( aDimension->m_arrowD1F.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_arrowD1F.y ).c_str() );
+                  FMT_IU( aDimension->m_crossBarF.x ).c_str(),
+                  FMT_IU( aDimension->m_crossBarF.y ).c_str(),
+                  FMT_IU( aDimension->m_arrowD1F.x ).c_str(),
+                  FMT_IU( aDimension->m_arrowD1F.y ).c_str() );
 
     m_out->Print( aNestLevel+1, "(arrow1b (pts (xy %s %s) (xy %s %s)))\n",
-                  FormatInternalUnits( aDimension->m_crossBarF.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_crossBarF.y ).c_str(),
-                  FormatInternalUnits( aDimension->m_arrowD2F.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_arrowD2F.y ).c_str() );
+                  FMT_IU( aDimension->m_crossBarF.x ).c_str(),
+                  FMT_IU( aDimension->m_crossBarF.y ).c_str(),
+                  FMT_IU( aDimension->m_arrowD2F.x ).c_str(),
+                  FMT_IU( aDimension->m_arrowD2F.y ).c_str() );
 
     m_out->Print( aNestLevel+1, "(arrow2a (pts (xy %s %s) (xy %s %s)))\n",
-                  FormatInternalUnits( aDimension->m_crossBarO.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_crossBarO.y ).c_str(),
-                  FormatInternalUnits( aDimension->m_arrowG1F.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_arrowG1F.y ).c_str() );
+                  FMT_IU( aDimension->m_crossBarO.x ).c_str(),
+                  FMT_IU( aDimension->m_crossBarO.y ).c_str(),
+                  FMT_IU( aDimension->m_arrowG1F.x ).c_str(),
+                  FMT_IU( aDimension->m_arrowG1F.y ).c_str() );
 
     m_out->Print( aNestLevel+1, "(arrow2b (pts (xy %s %s) (xy %s %s)))\n",
-                  FormatInternalUnits( aDimension->m_crossBarO.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_crossBarO.y ).c_str(),
-                  FormatInternalUnits( aDimension->m_arrowG2F.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_arrowG2F.y ).c_str() );
+                  FMT_IU( aDimension->m_crossBarO.x ).c_str(),
+                  FMT_IU( aDimension->m_crossBarO.y ).c_str(),
+                  FMT_IU( aDimension->m_arrowG2F.x ).c_str(),
+                  FMT_IU( aDimension->m_arrowG2F.y ).c_str() );
 
     m_out->Print( aNestLevel, ")\n" );
 }
@@ -861,8 +919,8 @@ void PCB_IO::format( DRAWSEGMENT* aSegment, int aNestLevel ) const
     {
     case S_SEGMENT:  // Line
         m_out->Print( aNestLevel, "(gr_line (start %s) (end %s)",
-                      FormatInternalUnits( aSegment->GetStart() ).c_str(),
-                      FormatInternalUnits( aSegment->GetEnd() ).c_str() );
+                      FMT_IU( aSegment->GetStart() ).c_str(),
+                      FMT_IU( aSegment->GetEnd() ).c_str() );
 
         if( aSegment->GetAngle() != 0.0 )
             m_out->Print( 0, " (angle %s)", FormatAngle( aSegment->GetAngle() ).c_str() );
@@ -871,14 +929,14 @@ void PCB_IO::format( DRAWSEGMENT* aSegment, int aNestLevel ) const
 
     case S_CIRCLE:  // Circle
         m_out->Print( aNestLevel, "(gr_circle (center %s) (end %s)",
-                      FormatInternalUnits( aSegment->GetStart() ).c_str(),
-                      FormatInternalUnits( aSegment->GetEnd() ).c_str() );
+                      FMT_IU( aSegment->GetStart() ).c_str(),
+                      FMT_IU( aSegment->GetEnd() ).c_str() );
         break;
 
     case S_ARC:     // Arc
         m_out->Print( aNestLevel, "(gr_arc (start %s) (end %s) (angle %s)",
-                      FormatInternalUnits( aSegment->GetStart() ).c_str(),
-                      FormatInternalUnits( aSegment->GetEnd() ).c_str(),
+                      FMT_IU( aSegment->GetStart() ).c_str(),
+                      FMT_IU( aSegment->GetEnd() ).c_str(),
                       FormatAngle( aSegment->GetAngle() ).c_str() );
         break;
 
@@ -893,7 +951,7 @@ void PCB_IO::format( DRAWSEGMENT* aSegment, int aNestLevel ) const
 
             for( int ii = 0; ii < pointsCount;  ++ii )
             {
-                m_out->Print( 0, " (xy %s)", FormatInternalUnits( outline.CPoint( ii ) ).c_str() );
+                m_out->Print( 0, " (xy %s)", FMT_IU( outline.CPoint( ii ) ).c_str() );
             }
 
             m_out->Print( 0, ")" );
@@ -908,10 +966,10 @@ void PCB_IO::format( DRAWSEGMENT* aSegment, int aNestLevel ) const
 
     case S_CURVE:   // Bezier curve
         m_out->Print( aNestLevel, "(gr_curve (pts (xy %s) (xy %s) (xy %s) (xy %s))",
-                      FormatInternalUnits( aSegment->GetStart() ).c_str(),
-                      FormatInternalUnits( aSegment->GetBezControl1() ).c_str(),
-                      FormatInternalUnits( aSegment->GetBezControl2() ).c_str(),
-                      FormatInternalUnits( aSegment->GetEnd() ).c_str() );
+                      FMT_IU( aSegment->GetStart() ).c_str(),
+                      FMT_IU( aSegment->GetBezControl1() ).c_str(),
+                      FMT_IU( aSegment->GetBezControl2() ).c_str(),
+                      FMT_IU( aSegment->GetEnd() ).c_str() );
         break;
 
     default:
@@ -921,7 +979,7 @@ void PCB_IO::format( DRAWSEGMENT* aSegment, int aNestLevel ) const
 
     formatLayer( aSegment );
 
-    m_out->Print( 0, " (width %s)", FormatInternalUnits( aSegment->GetWidth() ).c_str() );
+    m_out->Print( 0, " (width %s)", FMT_IU( aSegment->GetWidth() ).c_str() );
 
     if( aSegment->GetTimeStamp() )
         m_out->Print( 0, " (tstamp %lX)", (unsigned long)aSegment->GetTimeStamp() );
@@ -939,20 +997,20 @@ void PCB_IO::format( EDGE_MODULE* aModuleDrawing, int aNestLevel ) const
     {
     case S_SEGMENT:  // Line
         m_out->Print( aNestLevel, "(fp_line (start %s) (end %s)",
-                      FormatInternalUnits( aModuleDrawing->GetStart0() ).c_str(),
-                      FormatInternalUnits( aModuleDrawing->GetEnd0() ).c_str() );
+                      FMT_IU( aModuleDrawing->GetStart0() ).c_str(),
+                      FMT_IU( aModuleDrawing->GetEnd0() ).c_str() );
         break;
 
     case S_CIRCLE:  // Circle
         m_out->Print( aNestLevel, "(fp_circle (center %s) (end %s)",
-                      FormatInternalUnits( aModuleDrawing->GetStart0() ).c_str(),
-                      FormatInternalUnits( aModuleDrawing->GetEnd0() ).c_str() );
+                      FMT_IU( aModuleDrawing->GetStart0() ).c_str(),
+                      FMT_IU( aModuleDrawing->GetEnd0() ).c_str() );
         break;
 
     case S_ARC:     // Arc
         m_out->Print( aNestLevel, "(fp_arc (start %s) (end %s) (angle %s)",
-                      FormatInternalUnits( aModuleDrawing->GetStart0() ).c_str(),
-                      FormatInternalUnits( aModuleDrawing->GetEnd0() ).c_str(),
+                      FMT_IU( aModuleDrawing->GetStart0() ).c_str(),
+                      FMT_IU( aModuleDrawing->GetEnd0() ).c_str(),
                       FormatAngle( aModuleDrawing->GetAngle() ).c_str() );
         break;
 
@@ -976,7 +1034,7 @@ void PCB_IO::format( EDGE_MODULE* aModuleDrawing, int aNestLevel ) const
                 }
 
                 m_out->Print( nestLevel, "%s(xy %s)",
-                              nestLevel ? "" : " ", FormatInternalUnits( outline.CPoint( ii ) ).c_str() );
+                              nestLevel ? "" : " ", FMT_IU( outline.CPoint( ii ) ).c_str() );
             }
 
             m_out->Print( 0, ")" );
@@ -990,10 +1048,10 @@ void PCB_IO::format( EDGE_MODULE* aModuleDrawing, int aNestLevel ) const
 
     case S_CURVE:   // Bezier curve
         m_out->Print( aNestLevel, "(fp_curve (pts (xy %s) (xy %s) (xy %s) (xy %s))",
-                      FormatInternalUnits( aModuleDrawing->GetStart0() ).c_str(),
-                      FormatInternalUnits( aModuleDrawing->GetBezier0_C1() ).c_str(),
-                      FormatInternalUnits( aModuleDrawing->GetBezier0_C2() ).c_str(),
-                      FormatInternalUnits( aModuleDrawing->GetEnd0() ).c_str() );
+                      FMT_IU( aModuleDrawing->GetStart0() ).c_str(),
+                      FMT_IU( aModuleDrawing->GetBezier0_C1() ).c_str(),
+                      FMT_IU( aModuleDrawing->GetBezier0_C2() ).c_str(),
+                      FMT_IU( aModuleDrawing->GetEnd0() ).c_str() );
         break;
 
     default:
@@ -1003,7 +1061,7 @@ void PCB_IO::format( EDGE_MODULE* aModuleDrawing, int aNestLevel ) const
 
     formatLayer( aModuleDrawing );
 
-    m_out->Print( 0, " (width %s)", FormatInternalUnits( aModuleDrawing->GetWidth() ).c_str() );
+    m_out->Print( 0, " (width %s)", FMT_IU( aModuleDrawing->GetWidth() ).c_str() );
 
     m_out->Print( 0, ")\n" );
 }
@@ -1013,11 +1071,11 @@ void PCB_IO::format( PCB_TARGET* aTarget, int aNestLevel ) const
 {
     m_out->Print( aNestLevel, "(target %s (at %s) (size %s)",
                   ( aTarget->GetShape() ) ? "x" : "plus",
-                  FormatInternalUnits( aTarget->GetPosition() ).c_str(),
-                  FormatInternalUnits( aTarget->GetSize() ).c_str() );
+                  FMT_IU( aTarget->GetPosition() ).c_str(),
+                  FMT_IU( aTarget->GetSize() ).c_str() );
 
     if( aTarget->GetWidth() != 0 )
-        m_out->Print( 0, " (width %s)", FormatInternalUnits( aTarget->GetWidth() ).c_str() );
+        m_out->Print( 0, " (width %s)", FMT_IU( aTarget->GetWidth() ).c_str() );
 
     formatLayer( aTarget );
 
@@ -1065,7 +1123,7 @@ void PCB_IO::format( MODULE* aModule, int aNestLevel ) const
 
     if( !( m_ctl & CTL_OMIT_AT ) )
     {
-        m_out->Print( aNestLevel+1, "(at %s", FormatInternalUnits( aModule->GetPosition() ).c_str() );
+        m_out->Print( aNestLevel+1, "(at %s", FMT_IU( aModule->GetPosition() ).c_str() );
 
         if( aModule->GetOrientation() != 0.0 )
             m_out->Print( 0, " %s", FormatAngle( aModule->GetOrientation() ).c_str() );
@@ -1093,11 +1151,11 @@ void PCB_IO::format( MODULE* aModule, int aNestLevel ) const
 
     if( aModule->GetLocalSolderMaskMargin() != 0 )
         m_out->Print( aNestLevel+1, "(solder_mask_margin %s)\n",
-                      FormatInternalUnits( aModule->GetLocalSolderMaskMargin() ).c_str() );
+                      FMT_IU( aModule->GetLocalSolderMaskMargin() ).c_str() );
 
     if( aModule->GetLocalSolderPasteMargin() != 0 )
         m_out->Print( aNestLevel+1, "(solder_paste_margin %s)\n",
-                      FormatInternalUnits( aModule->GetLocalSolderPasteMargin() ).c_str() );
+                      FMT_IU( aModule->GetLocalSolderPasteMargin() ).c_str() );
 
     if( aModule->GetLocalSolderPasteMarginRatio() != 0 )
         m_out->Print( aNestLevel+1, "(solder_paste_ratio %s)\n",
@@ -1105,18 +1163,18 @@ void PCB_IO::format( MODULE* aModule, int aNestLevel ) const
 
     if( aModule->GetLocalClearance() != 0 )
         m_out->Print( aNestLevel+1, "(clearance %s)\n",
-                      FormatInternalUnits( aModule->GetLocalClearance() ).c_str() );
+                      FMT_IU( aModule->GetLocalClearance() ).c_str() );
 
     if( aModule->GetZoneConnection() != PAD_ZONE_CONN_INHERITED )
         m_out->Print( aNestLevel+1, "(zone_connect %d)\n", aModule->GetZoneConnection() );
 
     if( aModule->GetThermalWidth() != 0 )
         m_out->Print( aNestLevel+1, "(thermal_width %s)\n",
-                      FormatInternalUnits( aModule->GetThermalWidth() ).c_str() );
+                      FMT_IU( aModule->GetThermalWidth() ).c_str() );
 
     if( aModule->GetThermalGap() != 0 )
         m_out->Print( aNestLevel+1, "(thermal_gap %s)\n",
-                      FormatInternalUnits( aModule->GetThermalGap() ).c_str() );
+                      FMT_IU( aModule->GetThermalGap() ).c_str() );
 
     // Attributes
     if( aModule->GetAttributes() != MOD_DEFAULT )
@@ -1326,16 +1384,16 @@ void PCB_IO::format( D_PAD* aPad, int aNestLevel ) const
     m_out->Print( aNestLevel, "(pad %s %s %s",
                   m_out->Quotew( aPad->GetName() ).c_str(),
                   type, shape );
-    m_out->Print( 0, " (at %s", FormatInternalUnits( aPad->GetPos0() ).c_str() );
+    m_out->Print( 0, " (at %s", FMT_IU( aPad->GetPos0() ).c_str() );
 
     if( aPad->GetOrientation() != 0.0 )
         m_out->Print( 0, " %s", FormatAngle( aPad->GetOrientation() ).c_str() );
 
     m_out->Print( 0, ")" );
-    m_out->Print( 0, " (size %s)", FormatInternalUnits( aPad->GetSize() ).c_str() );
+    m_out->Print( 0, " (size %s)", FMT_IU( aPad->GetSize() ).c_str() );
 
     if( (aPad->GetDelta().GetWidth()) != 0 || (aPad->GetDelta().GetHeight() != 0 ) )
-        m_out->Print( 0, " (rect_delta %s )", FormatInternalUnits( aPad->GetDelta() ).c_str() );
+        m_out->Print( 0, " (rect_delta %s )", FMT_IU( aPad->GetDelta() ).c_str() );
 
     wxSize sz = aPad->GetDrillSize();
     wxPoint shapeoffset = aPad->GetOffset();
@@ -1349,13 +1407,13 @@ void PCB_IO::format( D_PAD* aPad, int aNestLevel ) const
             m_out->Print( 0, " oval" );
 
         if( sz.GetWidth() > 0 )
-            m_out->Print( 0,  " %s", FormatInternalUnits( sz.GetWidth() ).c_str() );
+            m_out->Print( 0,  " %s", FMT_IU( sz.GetWidth() ).c_str() );
 
         if( sz.GetHeight() > 0  && sz.GetWidth() != sz.GetHeight() )
-            m_out->Print( 0,  " %s", FormatInternalUnits( sz.GetHeight() ).c_str() );
+            m_out->Print( 0,  " %s", FMT_IU( sz.GetHeight() ).c_str() );
 
         if( (shapeoffset.x != 0) || (shapeoffset.y != 0) )
-            m_out->Print( 0, " (offset %s)", FormatInternalUnits( aPad->GetOffset() ).c_str() );
+            m_out->Print( 0, " (offset %s)", FMT_IU( aPad->GetOffset() ).c_str() );
 
         m_out->Print( 0, ")" );
     }
@@ -1413,31 +1471,31 @@ void PCB_IO::format( D_PAD* aPad, int aNestLevel ) const
 
     if( aPad->GetPadToDieLength() != 0 )
         StrPrintf( &output, " (die_length %s)",
-                   FormatInternalUnits( aPad->GetPadToDieLength() ).c_str() );
+                   FMT_IU( aPad->GetPadToDieLength() ).c_str() );
 
     if( aPad->GetLocalSolderMaskMargin() != 0 )
         StrPrintf( &output, " (solder_mask_margin %s)",
-                   FormatInternalUnits( aPad->GetLocalSolderMaskMargin() ).c_str() );
+                   FMT_IU( aPad->GetLocalSolderMaskMargin() ).c_str() );
 
     if( aPad->GetLocalSolderPasteMargin() != 0 )
         StrPrintf( &output, " (solder_paste_margin %s)",
-                   FormatInternalUnits( aPad->GetLocalSolderPasteMargin() ).c_str() );
+                   FMT_IU( aPad->GetLocalSolderPasteMargin() ).c_str() );
 
     if( aPad->GetLocalSolderPasteMarginRatio() != 0 )
         StrPrintf( &output, " (solder_paste_margin_ratio %s)",
                    Double2Str( aPad->GetLocalSolderPasteMarginRatio() ).c_str() );
 
     if( aPad->GetLocalClearance() != 0 )
-        StrPrintf( &output, " (clearance %s)", FormatInternalUnits( aPad->GetLocalClearance() ).c_str() );
+        StrPrintf( &output, " (clearance %s)", FMT_IU( aPad->GetLocalClearance() ).c_str() );
 
     if( aPad->GetZoneConnection() != PAD_ZONE_CONN_INHERITED )
         StrPrintf( &output, " (zone_connect %d)", aPad->GetZoneConnection() );
 
     if( aPad->GetThermalWidth() != 0 )
-        StrPrintf( &output, " (thermal_width %s)", FormatInternalUnits( aPad->GetThermalWidth() ).c_str() );
+        StrPrintf( &output, " (thermal_width %s)", FMT_IU( aPad->GetThermalWidth() ).c_str() );
 
     if( aPad->GetThermalGap() != 0 )
-        StrPrintf( &output, " (thermal_gap %s)", FormatInternalUnits( aPad->GetThermalGap() ).c_str() );
+        StrPrintf( &output, " (thermal_gap %s)", FMT_IU( aPad->GetThermalGap() ).c_str() );
 
     if( output.size() )
     {
@@ -1484,34 +1542,34 @@ void PCB_IO::format( D_PAD* aPad, int aNestLevel ) const
             {
             case S_SEGMENT:         // usual segment : line with rounded ends
                 m_out->Print( nested_level, "(gr_line (start %s) (end %s) (width %s))",
-                              FormatInternalUnits( primitive.m_Start ).c_str(),
-                              FormatInternalUnits( primitive.m_End ).c_str(),
-                              FormatInternalUnits( primitive.m_Thickness ).c_str() );
+                              FMT_IU( primitive.m_Start ).c_str(),
+                              FMT_IU( primitive.m_End ).c_str(),
+                              FMT_IU( primitive.m_Thickness ).c_str() );
                 break;
 
             case S_ARC:             // Arc with rounded ends
                 m_out->Print( nested_level, "(gr_arc (start %s) (end %s) (angle %s) (width %s))",
-                              FormatInternalUnits( primitive.m_Start ).c_str(),
-                              FormatInternalUnits( primitive.m_End ).c_str(),
+                              FMT_IU( primitive.m_Start ).c_str(),
+                              FMT_IU( primitive.m_End ).c_str(),
                               FormatAngle( primitive.m_ArcAngle ).c_str(),
-                              FormatInternalUnits( primitive.m_Thickness ).c_str() );
+                              FMT_IU( primitive.m_Thickness ).c_str() );
                 break;
 
             case S_CIRCLE:          //  ring or circle (circle if width == 0
                 m_out->Print( nested_level, "(gr_circle (center %s) (end %s %s) (width %s))",
-                              FormatInternalUnits( primitive.m_Start ).c_str(),
-                              FormatInternalUnits( primitive.m_Start.x + primitive.m_Radius ).c_str(),
-                              FormatInternalUnits( primitive.m_Start.y ).c_str(),
-                              FormatInternalUnits( primitive.m_Thickness ).c_str() );
+                              FMT_IU( primitive.m_Start ).c_str(),
+                              FMT_IU( primitive.m_Start.x + primitive.m_Radius ).c_str(),
+                              FMT_IU( primitive.m_Start.y ).c_str(),
+                              FMT_IU( primitive.m_Thickness ).c_str() );
                 break;
 
             case S_CURVE:          //  Bezier Curve
                 m_out->Print( aNestLevel, "(gr_curve (pts (xy %s) (xy %s) (xy %s) (xy %s)) (width %s))",
-                              FormatInternalUnits( primitive.m_Start ).c_str(),
-                              FormatInternalUnits( primitive.m_Ctrl1 ).c_str(),
-                              FormatInternalUnits( primitive.m_Ctrl2 ).c_str(),
-                              FormatInternalUnits( primitive.m_End ).c_str(),
-                              FormatInternalUnits( primitive.m_Thickness ).c_str() );
+                              FMT_IU( primitive.m_Start ).c_str(),
+                              FMT_IU( primitive.m_Ctrl1 ).c_str(),
+                              FMT_IU( primitive.m_Ctrl2 ).c_str(),
+                              FMT_IU( primitive.m_End ).c_str(),
+                              FMT_IU( primitive.m_Thickness ).c_str() );
                 break;
 
             case S_POLYGON:         // polygon
@@ -1529,10 +1587,10 @@ void PCB_IO::format( D_PAD* aPad, int aNestLevel ) const
                 {
                     if( newLine == 0 )
                         m_out->Print( nested_level+1, " (xy %s)",
-                                      FormatInternalUnits( wxPoint( poly[ii].x, poly[ii].y ) ).c_str() );
+                                      FMT_IU( wxPoint( poly[ii].x, poly[ii].y ) ).c_str() );
                     else
                         m_out->Print( 0, " (xy %s)",
-                                      FormatInternalUnits( wxPoint( poly[ii].x, poly[ii].y ) ).c_str() );
+                                      FMT_IU( wxPoint( poly[ii].x, poly[ii].y ) ).c_str() );
 
                     if( ++newLine > 4 )
                     {
@@ -1541,7 +1599,7 @@ void PCB_IO::format( D_PAD* aPad, int aNestLevel ) const
                     }
                 }
 
-                m_out->Print( 0, ") (width %s))", FormatInternalUnits( primitive.m_Thickness ).c_str() );
+                m_out->Print( 0, ") (width %s))", FMT_IU( primitive.m_Thickness ).c_str() );
                 }
                 break;
 
@@ -1562,7 +1620,7 @@ void PCB_IO::format( TEXTE_PCB* aText, int aNestLevel ) const
 {
     m_out->Print( aNestLevel, "(gr_text %s (at %s",
                   m_out->Quotew( aText->GetText() ).c_str(),
-                  FormatInternalUnits( aText->GetTextPos() ).c_str() );
+                  FMT_IU( aText->GetTextPos() ).c_str() );
 
     if( aText->GetTextAngle() != 0.0 )
         m_out->Print( 0, " %s", FormatAngle( aText->GetTextAngle() ).c_str() );
@@ -1595,7 +1653,7 @@ void PCB_IO::format( TEXTE_MODULE* aText, int aNestLevel ) const
 
     m_out->Print( aNestLevel, "(fp_text %s %s (at %s", type.c_str(),
                   m_out->Quotew( aText->GetText() ).c_str(),
-                  FormatInternalUnits( aText->GetPos0() ).c_str() );
+                  FMT_IU( aText->GetPos0() ).c_str() );
 
     // Due to Pcbnew history, fp_text angle is saved as an absolute on screen angle,
     // but internally the angle is held relative to its parent footprint.  parent
@@ -1675,11 +1733,11 @@ void PCB_IO::format( TRACK* aTrack, int aNestLevel ) const
         }
 
         m_out->Print( 0, " (at %s) (size %s)",
-                      FormatInternalUnits( aTrack->GetStart() ).c_str(),
-                      FormatInternalUnits( aTrack->GetWidth() ).c_str() );
+                      FMT_IU( aTrack->GetStart() ).c_str(),
+                      FMT_IU( aTrack->GetWidth() ).c_str() );
 
         if( via->GetDrill() != UNDEFINED_DRILL_DIAMETER )
-            m_out->Print( 0, " (drill %s)", FormatInternalUnits( via->GetDrill() ).c_str() );
+            m_out->Print( 0, " (drill %s)", FMT_IU( via->GetDrill() ).c_str() );
 
         m_out->Print( 0, " (layers %s %s)",
                       m_out->Quotew( m_board->GetLayerName( layer1 ) ).c_str(),
@@ -1688,8 +1746,8 @@ void PCB_IO::format( TRACK* aTrack, int aNestLevel ) const
     else
     {
         m_out->Print( aNestLevel, "(segment (start %s) (end %s) (width %s)",
-                      FormatInternalUnits( aTrack->GetStart() ).c_str(), FormatInternalUnits( aTrack->GetEnd() ).c_str(),
-                      FormatInternalUnits( aTrack->GetWidth() ).c_str() );
+                      FMT_IU( aTrack->GetStart() ).c_str(), FMT_IU( aTrack->GetEnd() ).c_str(),
+                      FMT_IU( aTrack->GetWidth() ).c_str() );
 
         m_out->Print( 0, " (layer %s)", m_out->Quotew( aTrack->GetLayerName() ).c_str() );
     }
@@ -1739,7 +1797,7 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
     }
 
     m_out->Print( 0, " (hatch %s %s)\n", hatch.c_str(),
-                  FormatInternalUnits( aZone->GetHatchPitch() ).c_str() );
+                  FMT_IU( aZone->GetHatchPitch() ).c_str() );
 
     if( aZone->GetPriority() > 0 )
         m_out->Print( aNestLevel+1, "(priority %d)\n", aZone->GetPriority() );
@@ -1766,10 +1824,10 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
     }
 
     m_out->Print( 0, " (clearance %s))\n",
-                  FormatInternalUnits( aZone->GetZoneClearance() ).c_str() );
+                  FMT_IU( aZone->GetZoneClearance() ).c_str() );
 
     m_out->Print( aNestLevel+1, "(min_thickness %s)",
-                  FormatInternalUnits( aZone->GetMinThickness() ).c_str() );
+                  FMT_IU( aZone->GetMinThickness() ).c_str() );
 
     // write it only if V 6.O version option is not used (i.e. do not write if the
     // "legacy" algorithm is used)
@@ -1797,8 +1855,8 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
         m_out->Print( 0, " (mode hatch)" );
 
     m_out->Print( 0, " (thermal_gap %s) (thermal_bridge_width %s)",
-                  FormatInternalUnits( aZone->GetThermalReliefGap() ).c_str(),
-                  FormatInternalUnits( aZone->GetThermalReliefCopperBridge() ).c_str() );
+                  FMT_IU( aZone->GetThermalReliefGap() ).c_str(),
+                  FMT_IU( aZone->GetThermalReliefCopperBridge() ).c_str() );
 
     if( aZone->GetCornerSmoothingType() != ZONE_SETTINGS::SMOOTHING_NONE )
     {
@@ -1822,15 +1880,19 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
 
         if( aZone->GetCornerRadius() != 0 )
             m_out->Print( 0, " (radius %s)",
-                          FormatInternalUnits( aZone->GetCornerRadius() ).c_str() );
+                          FMT_IU( aZone->GetCornerRadius() ).c_str() );
     }
 
+    // Lets the zone filler know the saved fill is still up to date
+    if( aZone->IsFilled() && !aZone->GetFillInputHash().empty() )
+        m_out->Print( 0, " (input_hash %s)", aZone->GetFillInputHash().c_str() );
+
     if( aZone->GetFillMode() == ZFM_HATCH_PATTERN )
     {
         m_out->Print( 0, "\n" );
         m_out->Print( aNestLevel+2, "(hatch_thickness %s) (hatch_gap %s) (hatch_orientation %s)",
-                         FormatInternalUnits( aZone->GetHatchFillTypeThickness() ).c_str(),
-                         FormatInternalUnits( aZone->GetHatchFillTypeGap() ).c_str(),
+                         FMT_IU( aZone->GetHatchFillTypeThickness() ).c_str(),
+                         FMT_IU( aZone->GetHatchFillTypeGap() ).c_str(),
                          Double2Str( aZone->GetHatchFillTypeOrientation() ).c_str() );
 
         if( aZone->GetHatchFillTypeSmoothingLevel() > 0 )
@@ -1864,10 +1926,10 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
 
             if( newLine == 0 )
                 m_out->Print( aNestLevel+3, "(xy %s %s)",
-                              FormatInternalUnits( iterator->x ).c_str(), FormatInternalUnits( iterator->y ).c_str() );
+                              FMT_IU( iterator->x ).c_str(), FMT_IU( iterator->y ).c_str() );
             else
                 m_out->Print( 0, " (xy %s %s)",
-                              FormatInternalUnits( iterator->x ).c_str(), FormatInternalUnits( iterator->y ).c_str() );
+                              FMT_IU( iterator->x ).c_str(), FMT_IU( iterator->y ).c_str() );
 
             if( newLine < 4 )
             {
@@ -1902,11 +1964,14 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
         }
     }
 
+    // The filled areas of the footprint zones are always saved
+    bool omitFills = ( m_ctl & CTL_OMIT_FILLS ) && aZone->Type() == PCB_ZONE_AREA_T;
+
     // Save the PolysList (filled areas)
     const SHAPE_POLY_SET& fv = aZone->GetFilledPolysList();
     newLine = 0;
 
-    if( !fv.IsEmpty() )
+    if( !fv.IsEmpty() && !omitFills )
     {
         bool new_polygon = true;
         bool is_closed = false;
@@ -1924,10 +1989,10 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
 
             if( newLine == 0 )
                 m_out->Print( aNestLevel+3, "(xy %s %s)",
-                              FormatInternalUnits( it->x ).c_str(), FormatInternalUnits( it->y ).c_str() );
+                              FMT_IU( it->x ).c_str(), FMT_IU( it->y ).c_str() );
             else
                 m_out->Print( 0, " (xy %s %s)",
-                              FormatInternalUnits( it->x ) .c_str(), FormatInternalUnits( it->y ).c_str() );
+                              FMT_IU( it->x ).c_str(), FMT_IU( it->y ).c_str() );
 
             if( newLine < 4 )
             {
@@ -1959,15 +2024,15 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
     // Save the filling segments list
     const auto& segs = aZone->FillSegments();
 
-    if( segs.size() )
+    if( segs.size() && !omitFills )
     {
         m_out->Print( aNestLevel+1, "(fill_segments\n" );
 
         for( ZONE_SEGMENT_FILL::const_iterator it = segs.begin();  it != segs.end();  ++it )
         {
             m_out->Print( aNestLevel+2, "(pts (xy %s) (xy %s))\n",
-                          FormatInternalUnits( wxPoint( it->A ) ).c_str(),
-                          FormatInternalUnits( wxPoint( it->B ) ).c_str() );
+                          FMT_IU( wxPoint( it->A ) ).c_str(),
+                          FMT_IU( wxPoint( it->B ) ).c_str() );
         }
 
         m_out->Print( aNestLevel+1, ")\n" );
@@ -1998,12 +2063,13 @@ PCB_IO::~PCB_IO()
 
 BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPERTIES* aProperties )
 {
-    FILE_LINE_READER    reader( aFileName );
+    MMAP_LINE_READER    reader( aFileName );
 
     init( aProperties );
 
     m_parser->SetLineReader( &reader );
     m_parser->SetBoard( aAppendToMe );
+    m_parser->SetParallelLoad( ADVANCED_CFG::GetCfg().m_parallelBoardLoad );
 
     BOARD* board;
 
@@ -2051,20 +2117,24 @@ void PCB_IO::init( const PROPERTIES* aProperties )
 
 void PCB_IO::validateCache( const wxString& aLibraryPath, bool checkModified )
 {
-    if( !m_cache || !m_cache->IsPath( aLibraryPath ) || ( checkModified && m_cache->IsModified() ) )
+    if( !m_cache || !m_cache->IsPath( aLibraryPath ) )
     {
         // a spectacular episode in memory management:
         delete m_cache;
         m_cache = new FP_CACHE( this, aLibraryPath );
         m_cache->Load();
     }
+    else if( checkModified && m_cache->IsModified() )
+    {
+        // Only the index is built again: the footprints already parsed are kept
+        m_cache->Load();
+    }
 }
 
 
 void PCB_IO::FootprintEnumerate( wxArrayString& aFootprintNames, const wxString& aLibPath,
                                  bool aBestEfforts, const PROPERTIES* aProperties )
 {
-    LOCALE_IO toggle;     // toggles on, then off, the C locale.
     wxDir     dir( aLibPath );
     wxString  errorMsg;
 
@@ -2079,8 +2149,8 @@ void PCB_IO::FootprintEnumerate( wxArrayString& aFootprintNames, const wxString&
         errorMsg = ioe.What();
     }
 
-    // Some of the files may have been parsed correctly so we want to add the valid files to
-    // the library.
+    // The footprints are only parsed when they are loaded, so a footprint file which cannot
+    // be parsed is listed here and reported by FootprintLoad().
 
     for( MODULE_CITER it = m_cache->GetModules().begin(); it != m_cache->GetModules().end(); ++it )
         aFootprintNames.Add( it->first );
@@ -2095,8 +2165,6 @@ const MODULE* PCB_IO::getFootprint( const wxString& aLibraryPath,
                                     const PROPERTIES* aProperties,
                                     bool checkModified )
 {
-    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
-
     init( aProperties );
 
     try
@@ -2108,14 +2176,7 @@ const MODULE* PCB_IO::getFootprint( const wxString& aLibraryPath,
         // do nothing with the error
     }
 
-    const MODULE_MAP& mods = m_cache->GetModules();
-
-    MODULE_CITER it = mods.find( aFootprintName );
-
-    if( it == mods.end() )
-        return nullptr;
-
-    return it->second->GetModule();
+    return m_cache->GetModule( aFootprintName );
 }
 
 
@@ -2123,7 +2184,15 @@ const MODULE* PCB_IO::GetEnumeratedFootprint( const wxString& aLibraryPath,
                                               const wxString& aFootprintName,
                                               const PROPERTIES* aProperties )
 {
-    return getFootprint( aLibraryPath, aFootprintName, aProperties, false );
+    try
+    {
+        return getFootprint( aLibraryPath, aFootprintName, aProperties, false );
+    }
+    catch( const IO_ERROR& )
+    {
+        // A footprint file which cannot be parsed is reported by FootprintLoad()
+        return nullptr;
+    }
 }
 
 
@@ -2154,8 +2223,6 @@ MODULE* PCB_IO::FootprintLoad( const wxString& aLibraryPath, const wxString& aFo
 void PCB_IO::FootprintSave( const wxString& aLibraryPath, const MODULE* aFootprint,
                             const PROPERTIES* aProperties )
 {
-    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
-
     init( aProperties );
 
     // In this public PLUGIN API function, we can safely assume it was
@@ -2258,8 +2325,6 @@ void PCB_IO::FootprintSave( const wxString& aLibraryPath, const MODULE* aFootpri
 void PCB_IO::FootprintDelete( const wxString& aLibraryPath, const wxString& aFootprintName,
                               const PROPERTIES* aProperties )
 {
-    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
-
     init( aProperties );
 
     validateCache( aLibraryPath );
@@ -2289,8 +2354,6 @@ void PCB_IO::FootprintLibCreate( const wxString& aLibraryPath, const PROPERTIES*
                                           aLibraryPath.GetData() ) );
     }
 
-    LOCALE_IO   toggle;
-
     init( aProperties );
 
     delete m_cache;
@@ -2378,8 +2441,6 @@ bool PCB_IO::FootprintLibDelete( const wxString& aLibraryPath, const PROPERTIES*
 
 bool PCB_IO::IsFootprintLibWritable( const wxString& aLibraryPath )
 {
-    LOCALE_IO   toggle;
-
     init( NULL );
 
     validateCache( aLibraryPath );
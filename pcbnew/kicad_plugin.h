@@ -64,7 +64,8 @@ class TEXTE_PCB;
 //#define SEXPR_BOARD_FILE_VERSION    20190605  // Add layer defaults
 //#define SEXPR_BOARD_FILE_VERSION    20190905  // Add board physical stackup info in setup section
 //#define SEXPR_BOARD_FILE_VERSION    20190907  // Keepout areas in footprints
-#define SEXPR_BOARD_FILE_VERSION 20191123       // pin function in pads
+//#define SEXPR_BOARD_FILE_VERSION    20191123  // pin function in pads
+#define SEXPR_BOARD_FILE_VERSION 20191221       // zone fill input hash
 
 #define CTL_STD_LAYER_NAMES         (1 << 0)    ///< Use English Standard layer names
 #define CTL_OMIT_NETS               (1 << 1)    ///< Omit pads net names (useless in library)
@@ -74,6 +75,8 @@ class TEXTE_PCB;
 #define CTL_OMIT_AT                 (1 << 5)    ///< Omit position and rotation
                                                 // (always saved with potion 0,0 and rotation = 0 in library)
 //#define CTL_OMIT_HIDE             (1 << 6)    // found and defined in eda_text.h
+#define CTL_OMIT_TRACKS             (1 << 7)    ///< Omit the tracks and vias of a BOARD
+#define CTL_OMIT_FILLS              (1 << 8)    ///< Omit the filled areas of the BOARD zones
 
 
 // common combinations of the above:
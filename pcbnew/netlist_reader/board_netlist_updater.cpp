@@ -829,7 +829,7 @@ bool BOARD_NETLIST_UPDATER::UpdateNetlist( NETLIST& aNetlist )
     if( !m_isDryRun )
     {
         m_commit.Push( _( "Update netlist" ) );
-        m_board->GetConnectivity()->Build( m_board );
+        m_board->GetConnectivity()->Synchronize( m_board );
         testConnectivity( aNetlist );
 
         // Now the connectivity data is rebuilt, we can delete single pads nets
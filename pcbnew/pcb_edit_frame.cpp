@@ -348,6 +348,8 @@ void PCB_EDIT_FRAME::SetBoard( BOARD* aBoard )
 {
     PCB_BASE_EDIT_FRAME::SetBoard( aBoard );
 
+    m_ZoneFillCache.InvalidateAll();
+
     aBoard->GetConnectivity()->Build( aBoard );
 
     // reload the worksheet
@@ -788,6 +790,10 @@ void PCB_EDIT_FRAME::OnModify( )
     Update3DView( false );
 
     m_ZoneFillsDirty = true;
+
+    // Changes which did not come through a BOARD_COMMIT cannot be localised
+    if( !m_ZoneFillCache.TakeChangesRecorded() )
+        m_ZoneFillCache.InvalidateAll();
 }
 
 
@@ -27,6 +27,7 @@
 #include "config_params.h"
 #include "undo_redo_container.h"
 #include "zones.h"
+#include "zone_fill_cache.h"
 
 /*  Forward declarations of classes. */
 class ACTION_PLUGIN;
@@ -282,6 +283,7 @@ public:
     bool m_show_layer_manager_tools;
 
     bool m_ZoneFillsDirty;                  // Board has been modified since last zone fill.
+    ZONE_FILL_CACHE m_ZoneFillCache;        // Areas modified since each zone was last filled.
 
     virtual ~PCB_EDIT_FRAME();
 
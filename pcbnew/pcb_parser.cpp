@@ -31,6 +31,8 @@
 #include <common.h>
 #include <confirm.h>
 #include <macros.h>
+#include <number_io.h>
+#include <thread_pool.h>
 #include <title_block.h>
 #include <trigo.h>
 
@@ -54,6 +56,62 @@
 using namespace PCB_KEYS_T;
 
 
+/**
+ * Thrown by the parsers of the board items on worker threads when the item has to be parsed
+ * on the main thread, because it needs to change the board or to ask the user.
+ */
+struct NEEDS_MAIN_THREAD
+{
+};
+
+
+/**
+ * Reads the text of a board item read by PCB_PARSER::readItemForm(), numbering its lines as
+ * in the board file.
+ */
+class ITEM_FORM_READER : public STRING_LINE_READER
+{
+public:
+    ITEM_FORM_READER( const std::string& aText, const wxString& aSource, int aLineNumber ) :
+        STRING_LINE_READER( aText, aSource )
+    {
+        m_lineNum = aLineNumber - 1;
+    }
+};
+
+
+///> True for the keywords of the top level board items
+static bool isBoardItem( T aToken )
+{
+    switch( aToken )
+    {
+    case T_gr_arc:
+    case T_gr_circle:
+    case T_gr_curve:
+    case T_gr_line:
+    case T_gr_poly:
+    case T_gr_text:
+    case T_dimension:
+    case T_module:
+    case T_segment:
+    case T_via:
+    case T_zone:
+    case T_target:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+
+///> The tracks are inserted, the other items appended
+static ADD_MODE itemAddMode( T aToken )
+{
+    return aToken == T_segment || aToken == T_via ? ADD_INSERT : ADD_APPEND;
+}
+
+
 void PCB_PARSER::init()
 {
     m_showLegacyZoneWarning = true;
@@ -61,6 +119,8 @@ void PCB_PARSER::init()
     m_requiredVersion = 0;
     m_layerIndices.clear();
     m_layerMasks.clear();
+    m_itemForms.clear();
+    m_itemFormsSize = 0;
 
     // Add untranslated default (i.e. english) layernames.
     // Some may be overridden later if parsing a board rather than a footprint.
@@ -152,7 +212,7 @@ double PCB_PARSER::parseDouble()
 
     errno = 0;
 
-    double fval = strtod( CurText(), &tmp );
+    double fval = ParseDouble( CurText(), &tmp );
 
     if( errno )
     {
@@ -468,7 +528,6 @@ BOARD_ITEM* PCB_PARSER::Parse()
 {
     T               token;
     BOARD_ITEM*     item;
-    LOCALE_IO       toggle;
 
     // MODULEs can be prefixed with an initial block of single line comments and these
     // are kept for Format() so they round trip in s-expression form.  BOARDs might
@@ -532,6 +591,10 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
 
         token = NextTok();
 
+        // What follows the items read so far has to be parsed after them
+        if( !m_itemForms.empty() && !isBoardItem( token ) )
+            parseItemForms();
+
         switch( token )
         {
         case T_general:
@@ -567,35 +630,18 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
         case T_gr_curve:
         case T_gr_line:
         case T_gr_poly:
-            m_board->Add( parseDRAWSEGMENT(), ADD_APPEND );
-            break;
-
         case T_gr_text:
-            m_board->Add( parseTEXTE_PCB(), ADD_APPEND );
-            break;
-
         case T_dimension:
-            m_board->Add( parseDIMENSION(), ADD_APPEND );
-            break;
-
         case T_module:
-            m_board->Add( parseMODULE(), ADD_APPEND );
-            break;
-
         case T_segment:
-            m_board->Add( parseTRACK(), ADD_INSERT );
-            break;
-
         case T_via:
-            m_board->Add( parseVIA(), ADD_INSERT );
-            break;
-
         case T_zone:
-            m_board->Add( parseZONE_CONTAINER( m_board ), ADD_APPEND );
-            break;
-
         case T_target:
-            m_board->Add( parsePCB_TARGET(), ADD_APPEND );
+            if( m_parallelLoad )
+                readItemForm();
+            else
+                m_board->Add( parseBoardItem( token ), itemAddMode( token ) );
+
             break;
 
         default:
@@ -605,6 +651,9 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
         }
     }
 
+    if( !m_itemForms.empty() )
+        parseItemForms();
+
     if( m_undefinedLayers.size() > 0 )
     {
         bool deleteItems;
@@ -688,6 +737,259 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
 }
 
 
+BOARD_ITEM* PCB_PARSER::parseBoardItem( T aToken )
+{
+    switch( aToken )
+    {
+    case T_gr_arc:
+    case T_gr_circle:
+    case T_gr_curve:
+    case T_gr_line:
+    case T_gr_poly:
+        return parseDRAWSEGMENT();
+
+    case T_gr_text:
+        return parseTEXTE_PCB();
+
+    case T_dimension:
+        return parseDIMENSION();
+
+    case T_module:
+        return parseMODULE();
+
+    case T_segment:
+        return parseTRACK();
+
+    case T_via:
+        return parseVIA();
+
+    case T_zone:
+        return parseZONE_CONTAINER( m_board );
+
+    case T_target:
+        return parsePCB_TARGET();
+
+    default:
+        Unexpected( aToken );
+        return NULL;
+    }
+}
+
+
+// The item forms are parsed when they add up to this size, which keeps the memory used by
+// their text reasonable
+static const size_t ITEM_FORMS_BATCH_SIZE = 32 * 1024 * 1024;
+
+// How many item forms a worker parses with the same parser
+static const size_t ITEM_FORMS_PER_TASK = 64;
+
+
+void PCB_PARSER::readItemForm()
+{
+    ITEM_FORM form;
+
+    form.m_token = (T) CurTok();
+    form.m_lineNumber = CurLineNumber();
+    form.m_item = NULL;
+
+    // The keyword keeps its column for the error messages
+    form.m_text.assign( std::max( curOffset - 1, 0 ), ' ' );
+    form.m_text += '(';
+    form.m_text.append( start + curOffset, next );
+
+    const char* cur = next;
+    int         depth = 1;
+
+    while( depth > 0 )
+    {
+        for( ; cur < limit; ++cur )
+        {
+            if( *cur == '"' )
+            {
+                // Parentheses in quoted strings do not count, and neither do escaped quotes
+                for( ++cur; cur < limit && *cur != '"'; ++cur )
+                {
+                    if( *cur == '\\' && cur + 1 < limit )
+                        ++cur;
+                }
+
+                if( cur >= limit )
+                    break;
+            }
+            else if( *cur == '(' )
+            {
+                depth++;
+            }
+            else if( *cur == ')' && --depth == 0 )
+            {
+                ++cur;
+                break;
+            }
+        }
+
+        form.m_text.append( next, cur );
+        next = cur;
+
+        if( depth > 0 )
+        {
+            if( readLine() == 0 )
+                break;      // the end of file is reported by the item parser
+
+            cur = next;
+
+            while( cur < limit && (unsigned char) *cur <= ' ' )
+                ++cur;
+
+            // Comment lines are skipped by the lexer
+            if( cur < limit && *cur == '#' )
+                cur = limit;
+        }
+    }
+
+    curTok = DSN_RIGHT;
+
+    m_itemFormsSize += form.m_text.size();
+    m_itemForms.push_back( std::move( form ) );
+
+    if( depth > 0 || m_itemFormsSize >= ITEM_FORMS_BATCH_SIZE )
+        parseItemForms();
+}
+
+
+void PCB_PARSER::initItemParser( const PCB_PARSER& aParent, bool aInWorker )
+{
+    m_board = aParent.m_board;
+    m_layerIndices = aParent.m_layerIndices;
+    m_layerMasks = aParent.m_layerMasks;
+    m_netCodes = aParent.m_netCodes;
+    m_tooRecent = aParent.m_tooRecent;
+    m_requiredVersion = aParent.m_requiredVersion;
+    m_showLegacyZoneWarning = aParent.m_showLegacyZoneWarning;
+    m_inWorker = aInWorker;
+}
+
+
+void PCB_PARSER::mergeItemParser( const PCB_PARSER& aParser )
+{
+    m_undefinedLayers.insert( aParser.m_undefinedLayers.begin(), aParser.m_undefinedLayers.end() );
+    m_requiredVersion = std::max( m_requiredVersion, aParser.m_requiredVersion );
+    m_tooRecent = m_tooRecent || aParser.m_tooRecent;
+
+    // Only the items parsed on the main thread can add nets or ask the user
+    if( !aParser.m_inWorker )
+    {
+        m_netCodes = aParser.m_netCodes;
+        m_showLegacyZoneWarning = aParser.m_showLegacyZoneWarning;
+    }
+}
+
+
+void PCB_PARSER::parseItemForms()
+{
+    const wxString source = CurSource();
+    const size_t   count = m_itemForms.size();
+    std::mutex     mergeLock;
+
+    // Parses one item form with aParser, and returns it or NULL if it failed
+    auto parseForm = [&]( PCB_PARSER& aParser, ITEM_FORM& aForm ) -> BOARD_ITEM*
+    {
+        ITEM_FORM_READER reader( aForm.m_text, source, aForm.m_lineNumber );
+        BOARD_ITEM*      item;
+
+        aParser.PushReader( &reader );
+
+        try
+        {
+            aParser.NeedLEFT();
+            item = aParser.parseBoardItem( aParser.NextTok() );
+        }
+        catch( ... )
+        {
+            aParser.PopReader();
+            throw;
+        }
+
+        aParser.PopReader();
+
+        return item;
+    };
+
+    size_t taskCount = ( count + ITEM_FORMS_PER_TASK - 1 ) / ITEM_FORMS_PER_TASK;
+
+    GetKiCadThreadPool().ParallelFor( taskCount,
+            [&]( size_t aTask )
+            {
+                std::unique_ptr<PCB_PARSER> parser;
+                size_t first = aTask * ITEM_FORMS_PER_TASK;
+                size_t end = std::min( count, first + ITEM_FORMS_PER_TASK );
+
+                for( size_t ii = first; ii < end; ++ii )
+                {
+                    if( !parser )
+                    {
+                        parser.reset( new PCB_PARSER );
+
+                        std::lock_guard<std::mutex> lock( mergeLock );
+                        parser->initItemParser( *this, true );
+                    }
+
+                    try
+                    {
+                        m_itemForms[ii].m_item = parseForm( *parser, m_itemForms[ii] );
+                    }
+                    catch( ... )
+                    {
+                        // Parsed again on the main thread, with a parser in a known state
+                        std::lock_guard<std::mutex> lock( mergeLock );
+                        mergeItemParser( *parser );
+                        parser.reset();
+                    }
+                }
+
+                if( parser )
+                {
+                    std::lock_guard<std::mutex> lock( mergeLock );
+                    mergeItemParser( *parser );
+                }
+            } );
+
+    PCB_PARSER parser;
+    parser.initItemParser( *this, false );
+
+    for( size_t ii = 0; ii < count; ++ii )
+    {
+        ITEM_FORM&  form = m_itemForms[ii];
+        BOARD_ITEM* item = form.m_item;
+
+        if( !item )
+        {
+            try
+            {
+                item = parseForm( parser, form );
+            }
+            catch( ... )
+            {
+                mergeItemParser( parser );
+
+                for( size_t jj = ii + 1; jj < count; ++jj )
+                    delete m_itemForms[jj].m_item;
+
+                m_itemForms.clear();
+                m_itemFormsSize = 0;
+                throw;
+            }
+        }
+
+        m_board->Add( item, itemAddMode( form.m_token ) );
+    }
+
+    mergeItemParser( parser );
+
+    m_itemForms.clear();
+    m_itemFormsSize = 0;
+}
+
+
 void PCB_PARSER::parseHeader()
 {
     wxCHECK_RET( CurTok() == T_kicad_pcb,
@@ -3584,6 +3886,10 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
 
                     if( token == T_segment )    // deprecated
                     {
+                        // Asking the user and modifying the board is not for workers
+                        if( m_inWorker )
+                            throw NEEDS_MAIN_THREAD();
+
                         // SEGMENT fill mode no longer supported.  Make sure user is OK with converting them.
                         if( m_showLegacyZoneWarning )
                         {
@@ -3681,10 +3987,22 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
                     NeedRIGHT();
                     break;
 
+                case T_input_hash:
+                    NextTok();
+
+                    // Anything but a MD5 digest (such as the hashes written by the first
+                    // versions) is ignored, and the zone will be refilled
+                    if( strlen( CurText() ) == 32 && strspn( CurText(), "0123456789ABCDEF" ) == 32 )
+                        zone->SetFillInputHash( CurText() );
+
+                    NeedRIGHT();
+                    break;
+
                 default:
                     Expecting( "mode, arc_segments, thermal_gap, thermal_bridge_width, "
                                "hatch_thickness, hatch_gap, hatch_orientation, "
-                               "hatch_smoothing_level, hatch_smoothing_value, smoothing, or radius" );
+                               "hatch_smoothing_level, hatch_smoothing_value, smoothing, radius, "
+                               "or input_hash" );
                 }
             }
             break;
@@ -3839,6 +4157,9 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
             zone->SetNetCode( net->GetNet() );
         else    // Not existing net: add a new net to keep trace of the zone netname
         {
+            if( m_inWorker )
+                throw NEEDS_MAIN_THREAD();
+
             int newnetcode = m_board->GetNetCount();
             net = new NETINFO_ITEM( m_board, netnameFromfile, newnetcode );
             m_board->Add( net );
@@ -36,7 +36,9 @@
 #include <common.h>                             // KiROUND
 #include <convert_to_biu.h>                     // IU_PER_MM
 
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 
 class BOARD;
@@ -79,6 +81,24 @@ class PCB_PARSER : public PCB_LEXER
 
     bool                m_showLegacyZoneWarning;
 
+    bool                m_parallelLoad;     ///< parse the board items on several threads
+    bool                m_inWorker;         ///< parser of the items of a board on a worker thread
+
+    /**
+     * A top level item of a board file, such as (module ...) or (segment ...), read as text
+     * to be parsed apart from the rest of the file.
+     */
+    struct ITEM_FORM
+    {
+        PCB_KEYS_T::T m_token;          ///< the keyword of the form
+        int           m_lineNumber;     ///< the line of the file the form starts on
+        std::string   m_text;
+        BOARD_ITEM*   m_item;           ///< the item parsed by a worker, or NULL
+    };
+
+    std::vector<ITEM_FORM> m_itemForms; ///< the items read but not parsed yet
+    size_t              m_itemFormsSize;    ///< the length of their text
+
     ///> Converts net code using the mapping table if available,
     ///> otherwise returns unchanged net code if < 0 or if is is out of range
     inline int getNetCode( int aNetCode )
@@ -167,6 +187,42 @@ class PCB_PARSER : public PCB_LEXER
      */
     BOARD*          parseBOARD_unchecked();
 
+    /**
+     * Function parseBoardItem
+     * parses the top level board item whose keyword aToken was just read.
+     */
+    BOARD_ITEM*     parseBoardItem( PCB_KEYS_T::T aToken );
+
+    /**
+     * Function readItemForm
+     * reads as text the top level board item whose keyword was just read, up to its closing
+     * parenthesis, and queues it in m_itemForms.
+     */
+    void readItemForm();
+
+    /**
+     * Function parseItemForms
+     * parses the queued item forms in parallel, each worker with its own parser, and adds
+     * them to the board in file order.
+     *
+     * The items whose parsing would need to change the board or to ask the user, and the
+     * ones a worker could not parse, are parsed again here in turn.  So the board and the
+     * errors are the same as parsing the items one after another.
+     */
+    void parseItemForms();
+
+    /**
+     * Function initItemParser
+     * prepares this parser to parse the items of the board of aParent.
+     */
+    void initItemParser( const PCB_PARSER& aParent, bool aInWorker );
+
+    /**
+     * Function mergeItemParser
+     * takes back what parsing the items with aParser told about the board.
+     */
+    void mergeItemParser( const PCB_PARSER& aParser );
+
 
     /**
      * Function lookUpLayer
@@ -315,7 +371,9 @@ public:
 
     PCB_PARSER( LINE_READER* aReader = NULL ) :
         PCB_LEXER( aReader ),
-        m_board( 0 )
+        m_board( 0 ),
+        m_parallelLoad( false ),
+        m_inWorker( false )
     {
         init();
     }
@@ -342,6 +400,17 @@ public:
     }
 
     BOARD_ITEM* Parse();
+
+    /**
+     * Function SetParallelLoad
+     * enables parsing the items of a board (footprints, tracks, zones, drawings...) on the
+     * threads of the KiCad thread pool.  Only the header of the board is parsed in turn.
+     */
+    void SetParallelLoad( bool aEnable )
+    {
+        m_parallelLoad = aEnable;
+    }
+
     /**
      * Function parseMODULE
      * @param aInitialComments may be a pointer to a heap allocated initial comment block
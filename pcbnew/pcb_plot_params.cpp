@@ -26,6 +26,7 @@
 #include <layers_id_colors_and_visibility.h>
 #include <plotter.h>
 #include <macros.h>
+#include <number_io.h>
 #include <convert_to_biu.h>
 #include <board_design_settings.h>
 
@@ -178,8 +179,8 @@ void PCB_PLOT_PARAMS::Format( OUTPUTFORMATTER* aFormatter,
 
     aFormatter->Print( aNestLevel+1, "(%s %s)\n", getTokenName( T_excludeedgelayer ),
                        m_excludeEdgeLayer ? trueStr : falseStr );
-    aFormatter->Print( aNestLevel+1, "(%s %f)\n", getTokenName( T_linewidth ),
-                       m_lineWidth / IU_PER_MM );
+    aFormatter->Print( aNestLevel+1, "(%s %s)\n", getTokenName( T_linewidth ),
+                       FormatDouble( "%f", m_lineWidth / IU_PER_MM ).c_str() );
     aFormatter->Print( aNestLevel+1, "(%s %s)\n", getTokenName( T_plotframeref ),
                        m_plotFrameRef ? trueStr : falseStr );
     aFormatter->Print( aNestLevel+1, "(%s %s)\n", getTokenName( T_viasonmask ),
@@ -198,8 +199,8 @@ void PCB_PLOT_PARAMS::Format( OUTPUTFORMATTER* aFormatter,
 
     aFormatter->Print( aNestLevel+1, "(%s %d)\n", getTokenName( T_hpglpenspeed ),
                        m_HPGLPenSpeed );
-    aFormatter->Print( aNestLevel+1, "(%s %f)\n", getTokenName( T_hpglpendiameter ),
-                       m_HPGLPenDiam );
+    aFormatter->Print( aNestLevel+1, "(%s %s)\n", getTokenName( T_hpglpendiameter ),
+                       FormatDouble( "%f", m_HPGLPenDiam ).c_str() );
     aFormatter->Print( aNestLevel+1, "(%s %s)\n", getTokenName( T_psnegative ),
                        m_negative ? trueStr : falseStr );
     aFormatter->Print( aNestLevel+1, "(%s %s)\n", getTokenName( T_psa4output ),
@@ -575,7 +576,7 @@ double PCB_PLOT_PARAMS_PARSER::parseDouble()
     if( token != T_NUMBER )
         Expecting( T_NUMBER );
 
-    double val = strtod( CurText(), NULL );
+    double val = ParseDouble( CurText() );
 
     return val;
 }
@@ -19,13 +19,17 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include "pns_index.h"
 
 namespace PNS {
 
 INDEX::INDEX()
 {
-    memset( m_subIndices, 0, sizeof( m_subIndices ) );
+    m_size = 0;
+    m_bulkLoading = false;
 }
 
 
@@ -35,7 +39,16 @@ INDEX::~INDEX()
 }
 
 
-INDEX::ITEM_SHAPE_INDEX* INDEX::getSubindex( const ITEM* aItem )
+void INDEX::BOX::Merge( const BOX& aB )
+{
+    m_minX = std::min( m_minX, aB.m_minX );
+    m_minY = std::min( m_minY, aB.m_minY );
+    m_maxX = std::max( m_maxX, aB.m_maxX );
+    m_maxY = std::max( m_maxY, aB.m_maxY );
+}
+
+
+int INDEX::getSubindex( const ITEM* aItem ) const
 {
     int idx_n = -1;
 
@@ -73,47 +86,368 @@ INDEX::ITEM_SHAPE_INDEX* INDEX::getSubindex( const ITEM* aItem )
     {
         wxASSERT( idx_n >= 0 );
         wxASSERT( idx_n < MaxSubIndices );
-        return nullptr;
+        return -1;
     }
 
-    if( !m_subIndices[idx_n] )
-        m_subIndices[idx_n] = new ITEM_SHAPE_INDEX;
+    return idx_n;
+}
+
+
+INDEX::TREE_PTR& INDEX::writableRoot( int aIndex )
+{
+    if( !m_subIndices )
+        m_subIndices = std::make_shared<SUBINDICES>();
+    else if( m_subIndices.use_count() > 1 )
+        m_subIndices = std::make_shared<SUBINDICES>( *m_subIndices );
+
+    return ( *m_subIndices )[aIndex];
+}
+
+
+INDEX::TREE_PTR INDEX::newNode( bool aLeaf )
+{
+    TREE_PTR node = std::allocate_shared<TREE_NODE>( POOL_ALLOCATOR<TREE_NODE>() );
+
+    node->m_leaf = aLeaf;
+    return node;
+}
+
+
+INDEX::TREE_NODE* INDEX::writable( TREE_PTR& aNode )
+{
+    // Another index still refers to the node, which must not change under it
+    if( aNode.use_count() > 1 )
+        aNode = std::allocate_shared<TREE_NODE>( POOL_ALLOCATOR<TREE_NODE>(), *aNode );
+
+    return aNode.get();
+}
+
+
+INDEX::BOX INDEX::cover( const TREE_NODE* aNode )
+{
+    BOX box = aNode->m_entries[0].m_box;
+
+    for( const ENTRY& entry : aNode->m_entries )
+        box.Merge( entry.m_box );
 
-    return m_subIndices[idx_n];
+    return box;
 }
 
+
+bool INDEX::insert( TREE_PTR& aNode, const ENTRY& aEntry, ENTRY& aSplit )
+{
+    TREE_NODE* node = writable( aNode );
+
+    if( node->m_leaf )
+    {
+        node->m_entries.push_back( aEntry );
+    }
+    else
+    {
+        // Descend into the child whose box grows the least, the smallest one on ties
+        ENTRY* best = nullptr;
+        double bestGrowth = 0.0, bestArea = 0.0;
+
+        for( ENTRY& entry : node->m_entries )
+        {
+            BOX merged = entry.m_box;
+            merged.Merge( aEntry.m_box );
+
+            double area = entry.m_box.Area();
+            double growth = merged.Area() - area;
+
+            if( !best || growth < bestGrowth || ( growth == bestGrowth && area < bestArea ) )
+            {
+                best = &entry;
+                bestGrowth = growth;
+                bestArea = area;
+            }
+        }
+
+        ENTRY split;
+
+        best->m_box.Merge( aEntry.m_box );
+
+        if( insert( best->m_child, aEntry, split ) )
+        {
+            best->m_box = cover( best->m_child.get() );
+            node->m_entries.push_back( split );
+        }
+    }
+
+    if( (int) node->m_entries.size() <= MaxEntries )
+        return false;
+
+    // Split the node in two halves across the axis along which its entries spread the most
+    double minX = HUGE_VAL, maxX = -HUGE_VAL, minY = HUGE_VAL, maxY = -HUGE_VAL;
+
+    for( const ENTRY& entry : node->m_entries )
+    {
+        minX = std::min( minX, entry.m_box.Center( 0 ) );
+        maxX = std::max( maxX, entry.m_box.Center( 0 ) );
+        minY = std::min( minY, entry.m_box.Center( 1 ) );
+        maxY = std::max( maxY, entry.m_box.Center( 1 ) );
+    }
+
+    int axis = ( maxX - minX >= maxY - minY ) ? 0 : 1;
+
+    std::sort( node->m_entries.begin(), node->m_entries.end(),
+               [axis]( const ENTRY& aA, const ENTRY& aB )
+               {
+                   return aA.m_box.Center( axis ) < aB.m_box.Center( axis );
+               } );
+
+    TREE_PTR sibling = newNode( node->m_leaf );
+    size_t   half = node->m_entries.size() / 2;
+
+    sibling->m_entries.assign( node->m_entries.begin() + half, node->m_entries.end() );
+    node->m_entries.resize( half );
+
+    aSplit.m_box = cover( sibling.get() );
+    aSplit.m_child = sibling;
+    aSplit.m_item = nullptr;
+
+    return true;
+}
+
+
 void INDEX::Add( ITEM* aItem )
 {
-    ITEM_SHAPE_INDEX* idx = getSubindex( aItem );
+    int idx = getSubindex( aItem );
+
+    if( idx < 0 )
+        return;
+
+    m_size++;
+
+    if( m_bulkLoading )
+    {
+        m_bulkItems.push_back( aItem );
+        return;
+    }
+
+    TREE_PTR& root = writableRoot( idx );
+
+    if( !root )
+    {
+        root = newNode( true );
+    }
+
+    ENTRY entry, split;
+
+    entry.m_box = BOX( aItem->Shape()->BBox() );
+    entry.m_item = aItem;
+
+    if( insert( root, entry, split ) )
+    {
+        TREE_PTR newRoot = newNode( false );
+        ENTRY    oldRoot;
+
+        oldRoot.m_box = cover( root.get() );
+        oldRoot.m_child = root;
+        oldRoot.m_item = nullptr;
+
+        newRoot->m_entries.push_back( oldRoot );
+        newRoot->m_entries.push_back( split );
+        root = newRoot;
+    }
+}
+
+
+void INDEX::BeginBulkLoad()
+{
+    m_bulkLoading = true;
+}
+
+
+void INDEX::collectItems( const TREE_NODE* aNode, std::vector<ENTRY>& aEntries )
+{
+    for( const ENTRY& entry : aNode->m_entries )
+    {
+        if( aNode->m_leaf )
+            aEntries.push_back( entry );
+        else
+            collectItems( entry.m_child.get(), aEntries );
+    }
+}
+
+
+void INDEX::EndBulkLoad()
+{
+    std::vector<std::vector<ENTRY>> subIndexItems( MaxSubIndices );
+
+    m_bulkLoading = false;
+
+    // The items indexed before BeginBulkLoad() are reloaded too
+    for( int i = 0; m_subIndices && i < MaxSubIndices; i++ )
+    {
+        if( ( *m_subIndices )[i] )
+            collectItems( ( *m_subIndices )[i].get(), subIndexItems[i] );
+    }
+
+    for( ITEM* item : m_bulkItems )
+    {
+        ENTRY entry;
+
+        entry.m_box = BOX( item->Shape()->BBox() );
+        entry.m_item = item;
+        subIndexItems[getSubindex( item )].push_back( entry );
+    }
+
+    m_bulkItems.clear();
+
+    for( int i = 0; i < MaxSubIndices; i++ )
+    {
+        if( !subIndexItems[i].empty() )
+            writableRoot( i ) = pack( subIndexItems[i] );
+    }
+}
+
+
+INDEX::TREE_PTR INDEX::pack( std::vector<ENTRY>& aEntries )
+{
+    std::vector<TREE_PTR> nodes;
+    bool leaf = true;
+
+    // Pack the items into leaves, then the nodes of each level into the nodes of the
+    // level above, until a single node is left
+    while( true )
+    {
+        nodes.clear();
+        packTiles( &aEntries[0], aEntries.size(), 0, leaf, nodes );
+
+        if( nodes.size() == 1 )
+            return nodes[0];
+
+        aEntries.resize( nodes.size() );
+
+        for( size_t i = 0; i < nodes.size(); i++ )
+        {
+            aEntries[i].m_box = cover( nodes[i].get() );
+            aEntries[i].m_child = nodes[i];
+            aEntries[i].m_item = nullptr;
+        }
+
+        leaf = false;
+    }
+}
+
+
+// Sort-Tile-Recursive packing of aCount entries into nodes: the entries are sorted by the
+// center of their box along X and cut into vertical slabs, whose entries are sorted along Y
+// and cut into runs of MaxEntries entries, one per node.
+void INDEX::packTiles( ENTRY* aEntries, size_t aCount, int aAxis, bool aLeaf,
+                       std::vector<TREE_PTR>& aNodes )
+{
+    size_t nodeCount = ( aCount + MaxEntries - 1 ) / MaxEntries;
+
+    std::sort( aEntries, aEntries + aCount,
+               [aAxis]( const ENTRY& aA, const ENTRY& aB )
+               {
+                   return aA.m_box.Center( aAxis ) < aB.m_box.Center( aAxis );
+               } );
+
+    if( aAxis == 1 || nodeCount <= 1 )
+    {
+        for( size_t first = 0; first < aCount; first += MaxEntries )
+        {
+            TREE_PTR node = newNode( aLeaf );
+
+            node->m_entries.assign( aEntries + first,
+                                    aEntries + std::min( aCount, first + MaxEntries ) );
+            aNodes.push_back( node );
+        }
 
-    if( !idx )
         return;
+    }
+
+    size_t slabCount = (size_t) std::ceil( std::sqrt( (double) nodeCount ) );
+    size_t slabSize = MaxEntries * ( ( nodeCount + slabCount - 1 ) / slabCount );
+
+    for( size_t first = 0; first < aCount; first += slabSize )
+        packTiles( aEntries + first, std::min( slabSize, aCount - first ), 1, aLeaf, aNodes );
+}
 
-    idx->Add( aItem );
-    m_allItems.insert( aItem );
-    int net = aItem->Net();
 
-    if( net >= 0 )
+bool INDEX::findPath( const TREE_NODE* aNode, const BOX& aBox, const ITEM* aItem,
+                      std::vector<int>& aPath )
+{
+    for( size_t i = 0; i < aNode->m_entries.size(); i++ )
     {
-        m_netMap[net].push_back( aItem );
+        const ENTRY& entry = aNode->m_entries[i];
+
+        if( !entry.m_box.Contains( aBox ) )
+            continue;
+
+        aPath.push_back( i );
+
+        if( aNode->m_leaf ? entry.m_item == aItem
+                          : findPath( entry.m_child.get(), aBox, aItem, aPath ) )
+            return true;
+
+        aPath.pop_back();
     }
+
+    return false;
+}
+
+
+bool INDEX::removePath( TREE_PTR& aNode, const int* aPath )
+{
+    TREE_NODE* node = writable( aNode );
+    ENTRY&     entry = node->m_entries[aPath[0]];
+
+    // Underfull nodes are kept, only the empty ones are removed
+    if( node->m_leaf || removePath( entry.m_child, aPath + 1 ) )
+        node->m_entries.erase( node->m_entries.begin() + aPath[0] );
+    else
+        entry.m_box = cover( entry.m_child.get() );
+
+    return node->m_entries.empty();
 }
 
+
 void INDEX::Remove( ITEM* aItem )
 {
-    ITEM_SHAPE_INDEX* idx = getSubindex( aItem );
+    int idx = getSubindex( aItem );
 
-    if( !idx )
+    if( idx < 0 )
         return;
 
-    idx->Remove( aItem );
-    m_allItems.erase( aItem );
-    int net = aItem->Net();
+    if( m_bulkLoading )
+    {
+        auto it = std::find( m_bulkItems.begin(), m_bulkItems.end(), aItem );
 
-    if( net >= 0 && m_netMap.find( net ) != m_netMap.end() )
-        m_netMap[net].remove( aItem );
+        if( it != m_bulkItems.end() )
+        {
+            m_bulkItems.erase( it );
+            m_size--;
+            return;
+        }
+    }
+
+    std::vector<int> path;
+
+    if( !m_subIndices || !( *m_subIndices )[idx]
+            || !findPath( ( *m_subIndices )[idx].get(), BOX( aItem->Shape()->BBox() ), aItem,
+                          path ) )
+        return;
+
+    TREE_PTR& root = writableRoot( idx );
+
+    if( removePath( root, &path[0] ) )
+        root.reset();
+
+    while( root && !root->m_leaf && root->m_entries.size() == 1 )
+    {
+        TREE_PTR child = root->m_entries[0].m_child;
+        root = child;
+    }
+
+    m_size--;
 }
 
+
 void INDEX::Replace( ITEM* aOldItem, ITEM* aNewItem )
 {
     Remove( aOldItem );
@@ -121,26 +455,24 @@ void INDEX::Replace( ITEM* aOldItem, ITEM* aNewItem )
 }
 
 
-void INDEX::Clear()
+bool INDEX::Contains( const ITEM* aItem ) const
 {
-    for( int i = 0; i < MaxSubIndices; ++i )
-    {
-        ITEM_SHAPE_INDEX* idx = m_subIndices[i];
+    int idx = getSubindex( aItem );
 
-        if( idx )
-            delete idx;
+    if( idx < 0 || !m_subIndices || !( *m_subIndices )[idx] )
+        return false;
 
-        m_subIndices[i] = NULL;
-    }
+    std::vector<int> path;
+
+    return findPath( ( *m_subIndices )[idx].get(), BOX( aItem->Shape()->BBox() ), aItem, path );
 }
 
 
-INDEX::NET_ITEMS_LIST* INDEX::GetItemsForNet( int aNet )
+void INDEX::Clear()
 {
-    if( m_netMap.find( aNet ) == m_netMap.end() )
-        return NULL;
-
-    return &m_netMap[aNet];
+    m_subIndices.reset();
+    m_bulkItems.clear();
+    m_size = 0;
 }
 
 };
@@ -23,15 +23,14 @@
 #define __PNS_INDEX_H
 
 #include <layers_id_colors_and_visibility.h>
-#include <map>
-#include <unordered_set>
+#include <array>
+#include <memory>
+#include <vector>
 
-#include <boost/range/adaptor/map.hpp>
-
-#include <list>
-#include <geometry/shape_index.h>
+#include <math/box2.h>
 
 #include "pns_item.h"
+#include "pns_pool.h"
 
 namespace PNS {
 
@@ -42,14 +41,15 @@ namespace PNS {
  * Custom spatial index, holding our board items and allowing for very fast searches. Items
  * are assigned to separate R-Tree subindices depending on their type and spanned layers, reducing
  * overlap and improving search time.
+ *
+ * The R-Trees are copied on write: copying an INDEX only shares its trees, and the nodes of
+ * a tree are copied when they are changed while another index still refers to them. A
+ * branch of the router world gets the index of its parent at no cost, and holds all the
+ * items it sees, so it is searched in a single pass.
  **/
 class INDEX
 {
 public:
-    typedef std::list<ITEM*>            NET_ITEMS_LIST;
-    typedef SHAPE_INDEX<ITEM*>          ITEM_SHAPE_INDEX;
-    typedef std::unordered_set<ITEM*>   ITEM_SET;
-
     INDEX();
     ~INDEX();
 
@@ -60,6 +60,22 @@ public:
      */
     void Add( ITEM* aItem );
 
+    /**
+     * Function BeginBulkLoad()
+     *
+     * Stops indexing the items as they are added, until EndBulkLoad() is called.  The items
+     * added meanwhile are not found by Query() nor Contains().
+     */
+    void BeginBulkLoad();
+
+    /**
+     * Function EndBulkLoad()
+     *
+     * Rebuilds all the subindices at once, which is much faster than adding a large
+     * number of items one by one.
+     */
+    void EndBulkLoad();
+
     /**
      * Function Remove()
      *
@@ -88,7 +104,7 @@ public:
      * @return number of items found.
      */
     template<class Visitor>
-    int Query( const ITEM* aItem, int aMinDistance, Visitor& aVisitor );
+    int Query( const ITEM* aItem, int aMinDistance, Visitor& aVisitor ) const;
 
     /**
      * Function Query()
@@ -104,7 +120,7 @@ public:
      * @return number of items found.
      */
     template<class Visitor>
-    int Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor );
+    int Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor ) const;
 
     /**
      * Function Clear()
@@ -113,32 +129,19 @@ public:
      */
     void Clear();
 
-    /**
-     * Function GetItemsForNet()
-     *
-     * Returns list of all items in a given net.
-     */
-    NET_ITEMS_LIST* GetItemsForNet( int aNet );
-
     /**
      * Function Contains()
      *
      * Returns true if item aItem exists in the index.
      */
-    bool Contains( ITEM* aItem ) const
-    {
-        return m_allItems.find( aItem ) != m_allItems.end();
-    }
+    bool Contains( const ITEM* aItem ) const;
 
     /**
      * Function Size()
      *
      * Returns number of items stored in the index.
      */
-    int Size() const { return m_allItems.size(); }
-
-    ITEM_SET::iterator begin() { return m_allItems.begin(); }
-    ITEM_SET::iterator end() { return m_allItems.end(); }
+    int Size() const { return m_size; }
 
 private:
     static const int    MaxSubIndices   = 128;
@@ -149,66 +152,210 @@ private:
     static const int    SI_PadsTop      = 0;
     static const int    SI_PadsBottom   = 1;
 
+    ///> Maximum number of entries of a tree node
+    static const int    MaxEntries      = 16;
+
+    ///> Bounding box of an item or a tree node, bounds included
+    struct BOX
+    {
+        BOX()
+        {}
+
+        BOX( const BOX2I& aBox ) :
+            m_minX( aBox.GetX() ),
+            m_minY( aBox.GetY() ),
+            m_maxX( aBox.GetRight() ),
+            m_maxY( aBox.GetBottom() )
+        {}
+
+        bool Overlaps( const BOX& aB ) const
+        {
+            return m_minX <= aB.m_maxX && aB.m_minX <= m_maxX
+                && m_minY <= aB.m_maxY && aB.m_minY <= m_maxY;
+        }
+
+        bool Contains( const BOX& aB ) const
+        {
+            return m_minX <= aB.m_minX && aB.m_maxX <= m_maxX
+                && m_minY <= aB.m_minY && aB.m_maxY <= m_maxY;
+        }
+
+        void Merge( const BOX& aB );
+
+        ///> Center along X (axis 0) or Y (axis 1), as a real to avoid overflows
+        double Center( int aAxis ) const
+        {
+            if( aAxis == 0 )
+                return ( (double) m_minX + m_maxX ) / 2;
+            else
+                return ( (double) m_minY + m_maxY ) / 2;
+        }
+
+        ///> Area as a real, as the coordinates span the whole integer range
+        double Area() const
+        {
+            return ( (double) m_maxX - m_minX ) * ( (double) m_maxY - m_minY );
+        }
+
+        int m_minX, m_minY, m_maxX, m_maxY;
+    };
+
+    struct TREE_NODE;
+
+    ///> Tree nodes are shared by the indices copied from one another, and copied on write
+    typedef std::shared_ptr<TREE_NODE> TREE_PTR;
+
+    ///> Child node of an internal node, or item of a leaf
+    struct ENTRY
+    {
+        BOX      m_box;
+        TREE_PTR m_child;
+        ITEM*    m_item;
+    };
+
+    ///> Tree nodes and their entries are taken from the router POOL
+    struct TREE_NODE
+    {
+        bool                                      m_leaf;
+        std::vector<ENTRY, POOL_ALLOCATOR<ENTRY>> m_entries;
+    };
+
+    typedef std::array<TREE_PTR, MaxSubIndices> SUBINDICES;
+
+    template <class Visitor>
+    bool querySingle( int index, const BOX& aBox, Visitor& aVisitor, int& aTotal ) const;
+
     template <class Visitor>
-    int querySingle( int index, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor );
+    static bool search( const TREE_NODE* aNode, const BOX& aBox, Visitor& aVisitor,
+                        int& aTotal );
+
+    int getSubindex( const ITEM* aItem ) const;
+
+    ///> returns the root of subindex aIndex, after unsharing the subindex table
+    TREE_PTR& writableRoot( int aIndex );
+
+    static TREE_PTR newNode( bool aLeaf );
+
+    ///> copies aNode if another index refers to it
+    static TREE_NODE* writable( TREE_PTR& aNode );
+
+    static BOX cover( const TREE_NODE* aNode );
+
+    ///> adds an item entry to the leaves below aNode, and splits aNode if it overflows
+    ///> @return true if aNode was split, the new node being returned in aSplit
+    static bool insert( TREE_PTR& aNode, const ENTRY& aEntry, ENTRY& aSplit );
+
+    ///> finds the path of entry indices from aNode to the leaf entry of aItem
+    static bool findPath( const TREE_NODE* aNode, const BOX& aBox, const ITEM* aItem,
+                          std::vector<int>& aPath );
+
+    ///> removes the entry at the end of aPath, and the nodes it leaves empty
+    ///> @return true if aNode is empty
+    static bool removePath( TREE_PTR& aNode, const int* aPath );
+
+    static void collectItems( const TREE_NODE* aNode, std::vector<ENTRY>& aEntries );
 
-    ITEM_SHAPE_INDEX* getSubindex( const ITEM* aItem );
+    ///> builds a packed tree of aEntries, see EndBulkLoad()
+    static TREE_PTR pack( std::vector<ENTRY>& aEntries );
 
-    ITEM_SHAPE_INDEX* m_subIndices[MaxSubIndices];
-    std::map<int, NET_ITEMS_LIST> m_netMap;
-    ITEM_SET m_allItems;
+    static void packTiles( ENTRY* aEntries, size_t aCount, int aAxis, bool aLeaf,
+                           std::vector<TREE_PTR>& aNodes );
+
+    std::shared_ptr<SUBINDICES> m_subIndices;
+    std::vector<ITEM*> m_bulkItems;
+    int m_size;
+    bool m_bulkLoading;
 };
 
 
 template<class Visitor>
-int INDEX::querySingle( int index, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor )
+bool INDEX::querySingle( int index, const BOX& aBox, Visitor& aVisitor, int& aTotal ) const
+{
+    if( !m_subIndices || !( *m_subIndices )[index] )
+        return true;
+
+    return search( ( *m_subIndices )[index].get(), aBox, aVisitor, aTotal );
+}
+
+template<class Visitor>
+bool INDEX::search( const TREE_NODE* aNode, const BOX& aBox, Visitor& aVisitor, int& aTotal )
 {
-    if( !m_subIndices[index] )
-        return 0;
+    for( const ENTRY& entry : aNode->m_entries )
+    {
+        if( !entry.m_box.Overlaps( aBox ) )
+            continue;
+
+        if( aNode->m_leaf )
+        {
+            aTotal++;
+
+            if( !aVisitor( entry.m_item ) )
+                return false;
+        }
+        else if( !search( entry.m_child.get(), aBox, aVisitor, aTotal ) )
+        {
+            return false;
+        }
+    }
 
-    return m_subIndices[index]->Query( aShape, aMinDistance, aVisitor, false );
+    return true;
 }
 
 template<class Visitor>
-int INDEX::Query( const ITEM* aItem, int aMinDistance, Visitor& aVisitor )
+int INDEX::Query( const ITEM* aItem, int aMinDistance, Visitor& aVisitor ) const
 {
-    const SHAPE* shape = aItem->Shape();
+    BOX2I bbox = aItem->Shape()->BBox();
+    bbox.Inflate( aMinDistance );
+
+    const BOX box( bbox );
     int total = 0;
 
-    total += querySingle( SI_Multilayer, shape, aMinDistance, aVisitor );
+    if( !querySingle( SI_Multilayer, box, aVisitor, total ) )
+        return total;
 
     const LAYER_RANGE& layers = aItem->Layers();
 
     if( layers.IsMultilayer() )
     {
-        total += querySingle( SI_PadsTop, shape, aMinDistance, aVisitor );
-        total += querySingle( SI_PadsBottom, shape, aMinDistance, aVisitor );
+        if( !querySingle( SI_PadsTop, box, aVisitor, total )
+                || !querySingle( SI_PadsBottom, box, aVisitor, total ) )
+            return total;
 
         for( int i = layers.Start(); i <= layers.End(); ++i )
-            total += querySingle( SI_Traces + 2 * i + SI_SegStraight, shape, aMinDistance, aVisitor );
+        {
+            if( !querySingle( SI_Traces + 2 * i + SI_SegStraight, box, aVisitor, total ) )
+                return total;
+        }
     }
     else
     {
         int l = layers.Start();
 
-        if( l == B_Cu )
-            total += querySingle( SI_PadsTop, shape, aMinDistance, aVisitor );
-        else if( l == F_Cu )
-            total += querySingle( SI_PadsBottom, shape, aMinDistance, aVisitor );
+        if( l == B_Cu && !querySingle( SI_PadsTop, box, aVisitor, total ) )
+            return total;
+        else if( l == F_Cu && !querySingle( SI_PadsBottom, box, aVisitor, total ) )
+            return total;
 
-        total += querySingle(  SI_Traces + 2 * l + SI_SegStraight, shape, aMinDistance, aVisitor );
+        querySingle( SI_Traces + 2 * l + SI_SegStraight, box, aVisitor, total );
     }
 
     return total;
 }
 
 template<class Visitor>
-int INDEX::Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor )
+int INDEX::Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor ) const
 {
+    BOX2I bbox = aShape->BBox();
+    bbox.Inflate( aMinDistance );
+
+    const BOX box( bbox );
     int total = 0;
 
     for( int i = 0; i < MaxSubIndices; i++ )
-        total += querySingle( i, aShape, aMinDistance, aVisitor );
+    {
+        if( !querySingle( i, box, aVisitor, total ) )
+            break;
+    }
 
     return total;
 }
@@ -29,6 +29,7 @@
 #include <geometry/shape_line_chain.h>
 
 #include "pns_layerset.h"
+#include "pns_pool.h"
 
 class BOARD_CONNECTED_ITEM;
 
@@ -94,6 +95,17 @@ public:
 
     virtual ~ITEM();
 
+    ///> Items are cloned and freed on every mouse move, their memory is recycled by the POOL
+    static void* operator new( size_t aSize )
+    {
+        return POOL::Allocate( aSize );
+    }
+
+    static void operator delete( void* aBlock, size_t aSize )
+    {
+        POOL::Release( aBlock, aSize );
+    }
+
     /**
      * Function Clone()
      *
@@ -495,6 +495,9 @@ public:
 
     void AddLine( const SHAPE_LINE_CHAIN& aLine, int aType, int aWidth ) override
     {
+        if( !m_view )
+            return;
+
         ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( NULL, m_view );
 
         pitem->Line( aLine, aWidth, aType );
@@ -531,8 +534,10 @@ PNS_KICAD_IFACE::PNS_KICAD_IFACE()
     m_view = nullptr;
     m_previewItems = nullptr;
     m_router = nullptr;
-    m_debugDecorator = nullptr;
     m_dispOptions = nullptr;
+
+    // Draws nothing until a view is set, the router can run without one
+    m_debugDecorator = new PNS_PCBNEW_DEBUG_DECORATOR();
 }
 
 
@@ -1195,6 +1200,9 @@ void PNS_KICAD_IFACE::SyncWorld( PNS::NODE *aWorld )
 
 void PNS_KICAD_IFACE::EraseView()
 {
+    if( !m_view )
+        return;
+
     for( auto item : m_hiddenItems )
         m_view->SetVisible( item, true );
 
@@ -1215,6 +1223,9 @@ void PNS_KICAD_IFACE::DisplayItem( const PNS::ITEM* aItem, int aColor, int aClea
 {
     wxLogTrace( "PNS", "DisplayItem %p", aItem );
 
+    if( !m_view )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( aItem, m_view );
 
     if( aColor >= 0 )
@@ -1258,7 +1269,7 @@ void PNS_KICAD_IFACE::HideItem( PNS::ITEM* aItem )
 {
     BOARD_CONNECTED_ITEM* parent = aItem->Parent();
 
-    if( parent )
+    if( parent && m_view )
     {
         if( m_view->IsVisible( parent ) )
             m_hiddenItems.insert( parent );
@@ -1273,10 +1284,19 @@ void PNS_KICAD_IFACE::RemoveItem( PNS::ITEM* aItem )
 {
     BOARD_CONNECTED_ITEM* parent = aItem->Parent();
 
-    if( parent )
+    if( !parent )
+        return;
+
+    if( m_commit )
     {
         m_commit->Remove( parent );
     }
+    else
+    {
+        // Without a host tool, the board is changed directly
+        m_board->Remove( parent );
+        delete parent;
+    }
 }
 
 
@@ -1321,11 +1341,16 @@ void PNS_KICAD_IFACE::AddItem( PNS::ITEM* aItem )
 
     if( newBI )
     {
-        newBI->SetLocalRatsnestVisible( m_dispOptions->m_ShowGlobalRatsnest );
+        if( m_dispOptions )
+            newBI->SetLocalRatsnestVisible( m_dispOptions->m_ShowGlobalRatsnest );
+
         aItem->SetParent( newBI );
         newBI->ClearFlags();
 
-        m_commit->Add( newBI );
+        if( m_commit )
+            m_commit->Add( newBI );
+        else
+            m_board->Add( newBI );
     }
 }
 
@@ -1333,6 +1358,10 @@ void PNS_KICAD_IFACE::AddItem( PNS::ITEM* aItem )
 void PNS_KICAD_IFACE::Commit()
 {
     EraseView();
+
+    if( !m_commit )
+        return;
+
     m_commit->Push( _( "Added a track" ) );
     m_commit = std::make_unique<BOARD_COMMIT>( m_tool );
 }
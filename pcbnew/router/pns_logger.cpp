@@ -139,6 +139,44 @@ void LOGGER::Log( const VECTOR2I& aStart, const VECTOR2I& aEnd,
 }
 
 
+void LOGGER::Log( const EVENT_ENTRY& aEvent )
+{
+    m_theLog << "event " << aEvent.m_type << " " << aEvent.m_p.x << " " << aEvent.m_p.y << " "
+             << aEvent.m_layer << " " << aEvent.m_net << " " << aEvent.m_mode << " "
+             << aEvent.m_trackWidth << " " << aEvent.m_viaDiameter << " " << aEvent.m_viaDrill
+             << " " << aEvent.m_diffPairWidth << " " << aEvent.m_diffPairGap << std::endl;
+}
+
+
+bool LOGGER::ParseEvents( std::istream& aStream, std::vector<EVENT_ENTRY>& aEvents )
+{
+    std::string line;
+
+    while( std::getline( aStream, line ) )
+    {
+        std::istringstream record( line );
+        std::string        tag;
+        EVENT_ENTRY        evt;
+        int                type;
+
+        if( !( record >> tag ) || tag != "event" )
+            continue;
+
+        record >> type >> evt.m_p.x >> evt.m_p.y >> evt.m_layer >> evt.m_net >> evt.m_mode
+               >> evt.m_trackWidth >> evt.m_viaDiameter >> evt.m_viaDrill
+               >> evt.m_diffPairWidth >> evt.m_diffPairGap;
+
+        if( !record || type < EVT_START_ROUTE || type > EVT_FIX )
+            return false;
+
+        evt.m_type = (EVENT_TYPE) type;
+        aEvents.push_back( evt );
+    }
+
+    return true;
+}
+
+
 void LOGGER::dumpShape( const SHAPE* aSh )
 {
     switch( aSh->Type() )
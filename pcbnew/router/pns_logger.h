@@ -39,6 +39,47 @@ class ITEM;
 class LOGGER
 {
 public:
+    ///> Routing events recorded by ROUTER, which the router QA tool replays
+    enum EVENT_TYPE
+    {
+        EVT_START_ROUTE = 0,
+        EVT_START_DRAG,
+        EVT_MOVE,
+        EVT_FIX
+    };
+
+    struct EVENT_ENTRY
+    {
+        EVENT_ENTRY() :
+            m_type( EVT_MOVE ),
+            m_layer( 0 ),
+            m_net( -1 ),
+            m_mode( 0 ),
+            m_trackWidth( 0 ),
+            m_viaDiameter( 0 ),
+            m_viaDrill( 0 ),
+            m_diffPairWidth( 0 ),
+            m_diffPairGap( 0 )
+        {}
+
+        EVENT_TYPE m_type;
+        VECTOR2I   m_p;
+        int        m_layer;
+
+        ///> net of the item under the cursor, -1 if there was none
+        int        m_net;
+
+        ///> ROUTER_MODE of a route, DRAG_MODE of a drag, forced finish of a fix
+        int        m_mode;
+
+        ///> sizes the route was started with
+        int        m_trackWidth;
+        int        m_viaDiameter;
+        int        m_viaDrill;
+        int        m_diffPairWidth;
+        int        m_diffPairGap;
+    };
+
     LOGGER();
     ~LOGGER();
 
@@ -52,6 +93,15 @@ public:
     void Log( const SHAPE_LINE_CHAIN *aL, int aKind = 0, const std::string& aName = std::string() );
     void Log( const VECTOR2I& aStart, const VECTOR2I& aEnd, int aKind = 0,
               const std::string& aName = std::string() );
+    void Log( const EVENT_ENTRY& aEvent );
+
+    /**
+     * Function ParseEvents()
+     *
+     * Reads back the events of a saved log, skipping its other records.
+     * @return false if an event record is malformed.
+     */
+    static bool ParseEvents( std::istream& aStream, std::vector<EVENT_ENTRY>& aEvents );
 
 private:
     void dumpShape( const SHAPE* aSh );
@@ -20,6 +20,7 @@
  */
 
 #include <vector>
+#include <algorithm>
 #include <cassert>
 
 #include <math/vector2d.h>
@@ -48,6 +49,7 @@ NODE::NODE()
     m_depth = 0;
     m_root = this;
     m_parent = NULL;
+    m_parentChanges = NULL;
     m_maxClearance = 800000;    // fixme: depends on how thick traces are.
     m_ruleResolver = NULL;
     m_index = new INDEX;
@@ -80,12 +82,17 @@ NODE::~NODE()
 
     m_joints.clear();
 
-    for( ITEM* item : *m_index )
+    // A branch owns the items it added itself and did not remove since
+    for( const CHANGE* change = m_changes.get(); change != m_parentChanges;
+         change = change->m_prev.get() )
     {
-        if( item->BelongsTo( this ) )
-            delete item;
+        if( change->m_added && change->m_item->BelongsTo( this ) )
+            delete change->m_item;
     }
 
+    for( ITEM* item : m_rootItems )
+        delete item;
+
     releaseGarbage();
     unlinkParent();
 
@@ -115,21 +122,18 @@ NODE* NODE::Branch()
     child->m_root = isRoot() ? this : m_root;
     child->m_maxClearance = m_maxClearance;
 
-    // Immmediate offspring of the root branch needs not copy anything. For the rest, deep-copy
-    // joints, overridden item maps and pointers to stored items.
-    if( !isRoot() )
-    {
-        JOINT_MAP::iterator j;
-
-        for( ITEM* item : *m_index )
-            child->m_index->Add( item );
+    // The index and the change list are shared with the child, and copied on write.
+    // Immmediate offspring of the root branch needs not copy the joints either, the
+    // others deep-copy the joints changed by their parents.
+    *child->m_index = *m_index;
+    child->m_changes = m_changes;
+    child->m_parentChanges = m_changes.get();
 
+    if( !isRoot() )
         child->m_joints = m_joints;
-        child->m_override = m_override;
-    }
 
-    wxLogTrace( "PNS", "%d items, %d joints, %d overrides",
-            child->m_index->Size(), (int) child->m_joints.size(), (int) child->m_override.size() );
+    wxLogTrace( "PNS", "%d items, %d joints", child->m_index->Size(),
+            (int) child->m_joints.size() );
 
     return child;
 }
@@ -147,27 +151,14 @@ void NODE::unlinkParent()
 OBSTACLE_VISITOR::OBSTACLE_VISITOR( const ITEM* aItem ) :
     m_item( aItem ),
     m_node( NULL ),
-    m_override( NULL ),
     m_extraClearance( 0 )
 {
 }
 
 
-void OBSTACLE_VISITOR::SetWorld( const NODE* aNode, const NODE* aOverride )
+void OBSTACLE_VISITOR::SetWorld( const NODE* aNode )
 {
     m_node = aNode;
-    m_override = aOverride;
-}
-
-
-bool OBSTACLE_VISITOR::visit( ITEM* aCandidate )
-{
-    // check if there is a more recent branch with a newer
-    // (possibily modified) version of this item.
-    if( m_override && m_override->Overrides( aCandidate ) )
-        return true;
-
-    return false;
 }
 
 
@@ -220,9 +211,6 @@ struct NODE::DEFAULT_OBSTACLE_VISITOR : public OBSTACLE_VISITOR
         if( !aCandidate->OfKind( m_kindMask ) )
             return true;
 
-        if( visit( aCandidate ) )
-            return true;
-
         int clearance = m_extraClearance + m_node->GetClearance( aCandidate, m_item );
 
         if( aCandidate->Kind() == ITEM::LINE_T ) // this should never happen.
@@ -255,16 +243,9 @@ struct NODE::DEFAULT_OBSTACLE_VISITOR : public OBSTACLE_VISITOR
 
 int NODE::QueryColliding( const ITEM* aItem, OBSTACLE_VISITOR& aVisitor )
 {
-    aVisitor.SetWorld( this, NULL );
+    aVisitor.SetWorld( this );
     m_index->Query( aItem, m_maxClearance, aVisitor );
 
-    // if we haven't found enough items, look in the root branch as well.
-    if( !isRoot() )
-    {
-        aVisitor.SetWorld( m_root, this );
-        m_root->m_index->Query( aItem, m_maxClearance, aVisitor );
-    }
-
     return 0;
 }
 
@@ -279,17 +260,11 @@ int NODE::QueryColliding( const ITEM* aItem, NODE::OBSTACLES& aObstacles, int aK
 #endif
 
     visitor.SetCountLimit( aLimitCount );
-    visitor.SetWorld( this, NULL );
+    visitor.SetWorld( this );
     visitor.m_forceClearance = aForceClearance;
-    // first, look for colliding items in the local index
-    m_index->Query( aItem, m_maxClearance, visitor );
 
-    // if we haven't found enough items, look in the root branch as well.
-    if( !isRoot() && ( visitor.m_matchCount < aLimitCount || aLimitCount < 0 ) )
-    {
-        visitor.SetWorld( m_root, this );
-        m_root->m_index->Query( aItem, m_maxClearance, visitor );
-    }
+    // the index of a branch holds the items of the root it still has, too
+    m_index->Query( aItem, m_maxClearance, visitor );
 
     return aObstacles.size();
 }
@@ -504,32 +479,43 @@ const ITEM_SET NODE::HitTest( const VECTOR2I& aPoint ) const
     // fixme: we treat a point as an infinitely small circle - this is inefficient.
     SHAPE_CIRCLE s( aPoint, 0 );
     HIT_VISITOR visitor( items, aPoint );
-    visitor.SetWorld( this, NULL );
+    visitor.SetWorld( this );
 
     m_index->Query( &s, m_maxClearance, visitor );
 
-    if( !isRoot() )    // fixme: could be made cleaner
-    {
-        ITEM_SET items_root;
-        visitor.SetWorld( m_root, NULL );
-        HIT_VISITOR  visitor_root( items_root, aPoint );
-        m_root->m_index->Query( &s, m_maxClearance, visitor_root );
+    return items;
+}
 
-        for( ITEM* item : items_root.Items() )
-        {
-            if( !Overrides( item ) )
-                items.Add( item );
-        }
+
+void NODE::logChange( ITEM* aItem, bool aAdded )
+{
+    CHANGE change = { aItem, aAdded, m_changes };
+
+    m_changes = std::allocate_shared<const CHANGE>( POOL_ALLOCATOR<CHANGE>(), std::move( change ) );
+}
+
+
+void NODE::indexItem( ITEM* aItem )
+{
+    m_index->Add( aItem );
+
+    if( !isRoot() )
+    {
+        logChange( aItem, true );
+        return;
     }
 
-    return items;
+    m_rootItems.insert( aItem );
+
+    if( aItem->Net() >= 0 )
+        m_rootNetItems[aItem->Net()].push_back( aItem );
 }
 
 
 void NODE::addSolid( SOLID* aSolid )
 {
     linkJoint( aSolid->Pos(), aSolid->Layers(), aSolid->Net(), aSolid );
-    m_index->Add( aSolid );
+    indexItem( aSolid );
 }
 
 void NODE::Add( std::unique_ptr< SOLID > aSolid )
@@ -541,7 +527,7 @@ void NODE::Add( std::unique_ptr< SOLID > aSolid )
 void NODE::addVia( VIA* aVia )
 {
     linkJoint( aVia->Pos(), aVia->Layers(), aVia->Net(), aVia );
-    m_index->Add( aVia );
+    indexItem( aVia );
 }
 
 void NODE::Add( std::unique_ptr< VIA > aVia )
@@ -584,7 +570,7 @@ void NODE::addSegment( SEGMENT* aSeg )
     linkJoint( aSeg->Seg().A, aSeg->Layers(), aSeg->Net(), aSeg );
     linkJoint( aSeg->Seg().B, aSeg->Layers(), aSeg->Net(), aSeg );
 
-    m_index->Add( aSeg );
+    indexItem( aSeg );
 }
 
 bool NODE::Add( std::unique_ptr< SEGMENT > aSegment, bool aAllowRedundant )
@@ -621,15 +607,21 @@ void NODE::Add( std::unique_ptr< ITEM > aItem, bool aAllowRedundant )
 
 void NODE::doRemove( ITEM* aItem )
 {
-    // case 1: removing an item that is stored in the root node from any branch:
-    // mark it as overridden, but do not remove
-    if( aItem->BelongsTo( m_root ) && !isRoot() )
-        m_override.insert( aItem );
+    // the index of a branch is its own copy, removing the item from it leaves the
+    // root and the other branches unchanged
+    m_index->Remove( aItem );
+
+    if( !isRoot() )
+    {
+        logChange( aItem, false );
+    }
+    else if( m_rootItems.erase( aItem ) && aItem->Net() >= 0 )
+    {
+        auto netItems = m_rootNetItems.find( aItem->Net() );
 
-    // case 2: the item belongs to this branch or a parent, non-root branch,
-    // or the root itself and we are the root: remove from the index
-    else if( !aItem->BelongsTo( m_root ) || isRoot() )
-        m_index->Remove( aItem );
+        if( netItems != m_rootNetItems.end() )
+            netItems->second.remove( aItem );
+    }
 
     // the item belongs to this particular branch: un-reference it
     if( aItem->BelongsTo( this ) )
@@ -1148,17 +1140,26 @@ void NODE::Dump( bool aLong )
 
 void NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
 {
-    aRemoved.reserve( m_override.size() );
-    aAdded.reserve( m_index->Size() );
-
     if( isRoot() )
         return;
 
-    for( ITEM* item : m_override )
-        aRemoved.push_back( item );
+    std::unordered_set<ITEM*> seen;
+
+    // The newest change of an item tells whether the branch still has it. The items added
+    // and removed again, or coming from a parent branch and removed, are left out.
+    for( const CHANGE* change = m_changes.get(); change; change = change->m_prev.get() )
+    {
+        if( !seen.insert( change->m_item ).second )
+            continue;
+
+        if( change->m_added )
+            aAdded.push_back( change->m_item );
+        else if( change->m_item->BelongsTo( m_root ) )
+            aRemoved.push_back( change->m_item );
+    }
 
-    for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-        aAdded.push_back( *i );
+    std::reverse( aRemoved.begin(), aRemoved.end() );
+    std::reverse( aAdded.begin(), aAdded.end() );
 }
 
 void NODE::releaseChildren()
@@ -1190,24 +1191,28 @@ void NODE::releaseGarbage()
 
 
 void NODE::Commit( NODE* aNode )
-    {
-        if( aNode->isRoot() )
-            return;
+{
+    if( aNode->isRoot() )
+        return;
 
-        for( ITEM* item : aNode->m_override )
-            Remove( item );
+    ITEM_VECTOR removed, added;
 
-        for( auto i : *aNode->m_index )
-        {
-            i->SetRank( -1 );
-            i->Unmark();
-            Add( std::unique_ptr<ITEM>( i ) );
-        }
+    aNode->GetUpdatedItems( removed, added );
+
+    for( ITEM* item : removed )
+        Remove( item );
 
-        releaseChildren();
-        releaseGarbage();
+    for( ITEM* item : added )
+    {
+        item->SetRank( -1 );
+        item->Unmark();
+        Add( std::unique_ptr<ITEM>( item ) );
     }
 
+    releaseChildren();
+    releaseGarbage();
+}
+
 
 void NODE::KillChildren()
 {
@@ -1216,43 +1221,80 @@ void NODE::KillChildren()
 }
 
 
+void NODE::BeginBulkLoad()
+{
+    m_index->BeginBulkLoad();
+}
+
+
+void NODE::EndBulkLoad()
+{
+    m_index->EndBulkLoad();
+}
+
+
 void NODE::AllItemsInNet( int aNet, std::set<ITEM*>& aItems )
 {
-    INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aNet );
+    ITEM_VECTOR removed, added;
+
+    GetUpdatedItems( removed, added );
 
-    if( l_cur )
+    std::unordered_set<ITEM*> overridden( removed.begin(), removed.end() );
+    auto l_root = m_root->m_rootNetItems.find( aNet );
+
+    if( l_root != m_root->m_rootNetItems.end() )
     {
-        for( ITEM*item : *l_cur )
-            aItems.insert( item );
+        for( ITEM* item : l_root->second )
+        {
+            if( !overridden.count( item ) )
+                aItems.insert( item );
+        }
     }
 
-    if( !isRoot() )
+    for( ITEM* item : added )
     {
-        INDEX::NET_ITEMS_LIST* l_root = m_root->m_index->GetItemsForNet( aNet );
+        if( item->Net() == aNet )
+            aItems.insert( item );
+    }
+}
+
 
-        if( l_root )
-            for( INDEX::NET_ITEMS_LIST::iterator i = l_root->begin(); i!= l_root->end(); ++i )
-                if( !Overrides( *i ) )
-                    aItems.insert( *i );
+void NODE::localItems( ITEM_VECTOR& aItems )
+{
+    if( isRoot() )
+    {
+        aItems.assign( m_rootItems.begin(), m_rootItems.end() );
+    }
+    else
+    {
+        ITEM_VECTOR removed;
+        GetUpdatedItems( removed, aItems );
     }
 }
 
 
 void NODE::ClearRanks( int aMarkerMask )
 {
-    for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+    ITEM_VECTOR items;
+
+    localItems( items );
+
+    for( ITEM* item : items )
     {
-        (*i)->SetRank( -1 );
-        (*i)->Mark( (*i)->Marker() & (~aMarkerMask) );
+        item->SetRank( -1 );
+        item->Mark( item->Marker() & (~aMarkerMask) );
     }
 }
 
 
 void NODE::RemoveByMarker( int aMarker )
 {
+    ITEM_VECTOR items;
     std::list<ITEM*> garbage;
 
-    for( ITEM* item : *m_index )
+    localItems( items );
+
+    for( ITEM* item : items )
     {
         if( item->Marker() & aMarker )
             garbage.push_back( item );
@@ -1296,13 +1338,22 @@ SEGMENT* NODE::findRedundantSegment( SEGMENT* aSeg )
 
 ITEM *NODE::FindItemByParent( const BOARD_CONNECTED_ITEM* aParent )
 {
-    INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aParent->GetNetCode() );
+    auto l_cur = m_rootNetItems.find( aParent->GetNetCode() );
 
-    for( ITEM*item : *l_cur )
+    if( l_cur == m_rootNetItems.end() )
+        return NULL;
+
+    for( ITEM*item : l_cur->second )
         if( item->Parent() == aParent )
             return item;
 
     return NULL;
 }
 
+
+bool NODE::Overrides( ITEM* aItem ) const
+{
+    return !isRoot() && aItem->BelongsTo( m_root ) && !m_index->Contains( aItem );
+}
+
 }
@@ -24,6 +24,8 @@
 
 #include <vector>
 #include <list>
+#include <map>
+#include <memory>
 #include <unordered_set>
 #include <unordered_map>
 
@@ -36,6 +38,7 @@
 #include "pns_item.h"
 #include "pns_joint.h"
 #include "pns_itemset.h"
+#include "pns_pool.h"
 
 namespace PNS {
 
@@ -104,23 +107,18 @@ public:
 
     OBSTACLE_VISITOR( const ITEM* aItem );
 
-    void SetWorld( const NODE* aNode, const NODE* aOverride = NULL );
+    void SetWorld( const NODE* aNode );
 
     virtual bool operator()( ITEM* aCandidate ) = 0;
 
 protected:
 
-    bool visit( ITEM* aCandidate );
-
     ///> the item we are looking for collisions with
     const ITEM* m_item;
 
     ///> node we are searching in (either root or a branch)
     const NODE* m_node;
 
-    ///> node that overrides root entries
-    const NODE* m_override;
-
     ///> additional clearance
     int m_extraClearance;
 };
@@ -147,6 +145,18 @@ public:
     NODE();
     ~NODE();
 
+    ///> Branches are created and discarded on every mouse move, their memory is recycled
+    ///> by the POOL, as the one of their joints and change lists
+    static void* operator new( size_t aSize )
+    {
+        return POOL::Allocate( aSize );
+    }
+
+    static void operator delete( void* aBlock, size_t aSize )
+    {
+        POOL::Release( aBlock, aSize );
+    }
+
     ///> Returns the expected clearance between items a and b.
     int GetClearance( const ITEM* aA, const ITEM* aB ) const;
 
@@ -321,8 +331,10 @@ public:
      * Function Branch()
      *
      * Creates a lightweight copy (called branch) of self that tracks
-     * the changes (added/removed items) wrs to the root. Note that if there are
-     * any branches in use, their parents must NOT be deleted.
+     * the changes (added/removed items) wrs to the root. The branch shares the index
+     * and the change list of its parent, so branching costs the same whatever the
+     * number of items. Note that if there are any branches in use, their parents
+     * must NOT be deleted.
      * @return the new branch
      */
     NODE* Branch();
@@ -401,6 +413,11 @@ public:
     ///> Destroys all child nodes. Applicable only to the root node.
     void KillChildren();
 
+    ///> Defers the spatial indexing of the items added to EndBulkLoad(), which indexes them
+    ///> all at once. Used while the root node is built from the board.
+    void BeginBulkLoad();
+    void EndBulkLoad();
+
     void AllItemsInNet( int aNet, std::set<ITEM*>& aItems );
 
     void ClearRanks( int aMarkerMask = MK_HEAD | MK_VIOLATION );
@@ -416,14 +433,24 @@ public:
 
     ///> checks if this branch contains an updated version of the m_item
     ///> from the root branch.
-    bool Overrides( ITEM* aItem ) const
-    {
-        return m_override.find( aItem ) != m_override.end();
-    }
+    bool Overrides( ITEM* aItem ) const;
 
 private:
     struct DEFAULT_OBSTACLE_VISITOR;
-    typedef std::unordered_multimap<JOINT::HASH_TAG, JOINT, JOINT::JOINT_TAG_HASH> JOINT_MAP;
+
+    ///> Item added or removed by a branch. The changes of a branch are listed newest
+    ///> first, followed by the ones of its parents, which the parents share.
+    struct CHANGE
+    {
+        ITEM*                         m_item;
+        bool                          m_added;
+        std::shared_ptr<const CHANGE> m_prev;
+    };
+
+    typedef std::unordered_multimap<JOINT::HASH_TAG, JOINT, JOINT::JOINT_TAG_HASH,
+                                    std::equal_to<JOINT::HASH_TAG>,
+                                    POOL_ALLOCATOR<std::pair<const JOINT::HASH_TAG, JOINT>>>
+            JOINT_MAP;
     typedef JOINT_MAP::value_type TagJointPair;
 
     /// nodes are not copyable
@@ -442,6 +469,8 @@ private:
     void unlinkJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int aNet, ITEM* aWhere );
 
     ///> helpers for adding/removing items
+    void logChange( ITEM* aItem, bool aAdded );
+    void indexItem( ITEM* aItem );
     void addSolid( SOLID* aSeg );
     void addSegment( SEGMENT* aSeg );
     void addVia( VIA* aVia );
@@ -456,6 +485,9 @@ private:
     void releaseChildren();
     void releaseGarbage();
 
+    ///> items added by this branch and its parents, or all the items of the root
+    void localItems( ITEM_VECTOR& aItems );
+
     bool isRoot() const
     {
         return m_parent == NULL;
@@ -488,8 +520,17 @@ private:
     ///> list of nodes branched from this one
     std::set<NODE*> m_children;
 
-    ///> hash of root's items that have been changed in this node
-    std::unordered_set<ITEM*> m_override;
+    ///> items added and removed by this branch and its parents (empty for the root)
+    std::shared_ptr<const CHANGE> m_changes;
+
+    ///> first change of m_changes made by the parent, before this branch was created
+    const CHANGE* m_parentChanges;
+
+    ///> items of the root node, all owned by it (empty for the branches)
+    std::unordered_set<ITEM*> m_rootItems;
+
+    ///> items of the root node, by net
+    std::map<int, std::list<ITEM*>> m_rootNetItems;
 
     ///> worst case item-item clearance
     int m_maxClearance;
@@ -497,7 +538,7 @@ private:
     ///> Design rules resolver
     RULE_RESOLVER* m_ruleResolver;
 
-    ///> Geometric/Net index of the items
+    ///> Geometric index of the items, those of the root included for a branch
     INDEX* m_index;
 
     ///> depth of the node (number of parent nodes in the inheritance chain)
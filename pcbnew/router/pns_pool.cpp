@@ -0,0 +1,56 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <mutex>
+#include <vector>
+
+#include "pns_pool.h"
+
+namespace PNS {
+
+thread_local POOL::FREE_BLOCK* POOL::s_freeLists[CLASS_COUNT];
+
+
+void POOL::refill( size_t aClass )
+{
+    // The chunks stay referenced until the end of the program, as blocks released by a
+    // thread may still be in use by another one
+    static std::mutex         chunksLock;
+    static std::vector<char*> chunks;
+
+    const size_t blockSize = ( aClass + 1 ) * GRANULARITY;
+    char*        chunk = static_cast<char*>( ::operator new( CHUNK_SIZE ) );
+
+    {
+        std::lock_guard<std::mutex> lock( chunksLock );
+        chunks.push_back( chunk );
+    }
+
+    FREE_BLOCK*& freeList = s_freeLists[aClass];
+
+    for( size_t offset = 0; offset + blockSize <= CHUNK_SIZE; offset += blockSize )
+    {
+        FREE_BLOCK* block = reinterpret_cast<FREE_BLOCK*>( chunk + offset );
+
+        block->m_next = freeList;
+        freeList = block;
+    }
+}
+
+}
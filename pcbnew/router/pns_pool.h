@@ -0,0 +1,159 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_POOL_H
+#define __PNS_POOL_H
+
+#include <cstddef>
+#include <new>
+
+namespace PNS {
+
+/**
+ * Class POOL
+ *
+ * Recycles the memory of the router objects (items, nodes, joints, ...), which are
+ * allocated and freed by the thousands on each mouse move.  The freed blocks are kept on a
+ * free list per size class and handed out again by the next allocations of the same size,
+ * without going through the heap.  The blocks are carved out of large chunks which are
+ * never returned to the system: the pool grows up to the largest working set of the
+ * router, then stops allocating.
+ *
+ * Each thread has its own free lists.  A block may be released by another thread than the
+ * one which allocated it, it then joins the free lists of the releasing thread.
+ */
+class POOL
+{
+public:
+    ///> Largest block size served by the pool, the larger blocks come from the heap
+    static const size_t MAX_BLOCK_SIZE = 1024;
+
+    /**
+     * Function Allocate()
+     *
+     * @return a block of at least aSize bytes, aligned for any object.
+     */
+    static void* Allocate( size_t aSize )
+    {
+        if( aSize > MAX_BLOCK_SIZE )
+            return ::operator new( aSize );
+
+        FREE_BLOCK*& freeList = s_freeLists[sizeClass( aSize )];
+
+        if( !freeList )
+            refill( sizeClass( aSize ) );
+
+        FREE_BLOCK* block = freeList;
+        freeList = block->m_next;
+
+        return block;
+    }
+
+    /**
+     * Function Release()
+     *
+     * Gives back a block returned by Allocate( aSize ).
+     */
+    static void Release( void* aBlock, size_t aSize )
+    {
+        if( !aBlock )
+            return;
+
+        if( aSize > MAX_BLOCK_SIZE )
+        {
+            ::operator delete( aBlock );
+            return;
+        }
+
+        FREE_BLOCK*& freeList = s_freeLists[sizeClass( aSize )];
+        FREE_BLOCK*  block = static_cast<FREE_BLOCK*>( aBlock );
+
+        block->m_next = freeList;
+        freeList = block;
+    }
+
+private:
+    struct FREE_BLOCK
+    {
+        FREE_BLOCK* m_next;
+    };
+
+    ///> Block sizes are multiples of the alignment of the blocks
+    static const size_t GRANULARITY = 16;
+    static const size_t CLASS_COUNT = MAX_BLOCK_SIZE / GRANULARITY;
+
+    ///> Size of the chunks the blocks are carved out of
+    static const size_t CHUNK_SIZE = 64 * 1024;
+
+    static size_t sizeClass( size_t aSize )
+    {
+        return aSize ? ( aSize - 1 ) / GRANULARITY : 0;
+    }
+
+    ///> allocates a chunk of blocks of the size class aClass and puts them on its free list
+    static void refill( size_t aClass );
+
+    static thread_local FREE_BLOCK* s_freeLists[CLASS_COUNT];
+};
+
+
+/**
+ * Class POOL_ALLOCATOR
+ *
+ * Standard allocator taking the memory of the containers from the router POOL.
+ */
+template <typename T>
+class POOL_ALLOCATOR
+{
+public:
+    typedef T value_type;
+
+    POOL_ALLOCATOR()
+    {}
+
+    template <typename U>
+    POOL_ALLOCATOR( const POOL_ALLOCATOR<U>& )
+    {}
+
+    T* allocate( size_t aCount )
+    {
+        return static_cast<T*>( POOL::Allocate( aCount * sizeof( T ) ) );
+    }
+
+    void deallocate( T* aBlock, size_t aCount )
+    {
+        POOL::Release( aBlock, aCount * sizeof( T ) );
+    }
+
+    template <typename U>
+    bool operator==( const POOL_ALLOCATOR<U>& ) const
+    {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=( const POOL_ALLOCATOR<U>& ) const
+    {
+        return false;
+    }
+};
+
+}
+
+#endif
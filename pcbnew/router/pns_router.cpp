@@ -92,7 +92,11 @@ void ROUTER::SyncWorld()
     ClearWorld();
 
     m_world = std::make_unique<NODE>( );
+
+    // Nothing queries the world while it is built from the board
+    m_world->BeginBulkLoad();
     m_iface->SyncWorld( m_world.get() );
+    m_world->EndBulkLoad();
 
 }
 
@@ -125,6 +129,8 @@ const ITEM_SET ROUTER::QueryHoverItems( const VECTOR2I& aP )
 
 bool ROUTER::StartDragging( const VECTOR2I& aP, ITEM* aStartItem, int aDragMode )
 {
+    logEvent( LOGGER::EVT_START_DRAG, aP, aStartItem,
+              aStartItem ? aStartItem->Layers().Start() : -1, aDragMode );
 
     if( aDragMode & DM_FREE_ANGLE )
         m_forceMarkObstaclesMode = true;
@@ -174,6 +180,7 @@ bool ROUTER::isStartingPointRoutable( const VECTOR2I& aWhere, int aLayer )
 
 bool ROUTER::StartRouting( const VECTOR2I& aP, ITEM* aStartItem, int aLayer )
 {
+    logEvent( LOGGER::EVT_START_ROUTE, aP, aStartItem, aLayer, m_mode );
 
     if( ! isStartingPointRoutable( aP, aLayer ) )
     {
@@ -229,6 +236,8 @@ void ROUTER::DisplayItems( const ITEM_SET& aItems )
 
 void ROUTER::Move( const VECTOR2I& aP, ITEM* endItem )
 {
+    logEvent( LOGGER::EVT_MOVE, aP, endItem, GetCurrentLayer() );
+
     m_currentEnd = aP;
 
     switch( m_state )
@@ -372,6 +381,8 @@ void ROUTER::CommitRouting( NODE* aNode )
 
 bool ROUTER::FixRoute( const VECTOR2I& aP, ITEM* aEndItem, bool aForceFinish )
 {
+    logEvent( LOGGER::EVT_FIX, aP, aEndItem, GetCurrentLayer(), aForceFinish ? 1 : 0 );
+
     bool rv = false;
 
     switch( m_state )
@@ -492,6 +503,50 @@ void ROUTER::DumpLog()
 
     if( logger )
         logger->Save( "/tmp/shove.log" );
+
+    if( m_eventLogger )
+        m_eventLogger->Save( "/tmp/pns_events.log" );
+}
+
+
+void ROUTER::RecordEvents( bool aEnable )
+{
+    if( !aEnable )
+        m_eventLogger.reset();
+    else if( !m_eventLogger )
+        m_eventLogger = std::make_unique<LOGGER>();
+}
+
+
+void ROUTER::logEvent( LOGGER::EVENT_TYPE aType, const VECTOR2I& aP, const ITEM* aItem,
+                       int aLayer, int aMode )
+{
+    if( !m_eventLogger )
+        return;
+
+    // Only the last route or drag is kept: it is the one to replay when something went wrong,
+    // and the log does not grow with every mouse move of the session
+    if( aType == LOGGER::EVT_START_ROUTE || aType == LOGGER::EVT_START_DRAG )
+        m_eventLogger->Clear();
+
+    LOGGER::EVENT_ENTRY evt;
+
+    evt.m_type = aType;
+    evt.m_p = aP;
+    evt.m_layer = aLayer;
+    evt.m_net = aItem ? aItem->Net() : -1;
+    evt.m_mode = aMode;
+
+    if( aType == LOGGER::EVT_START_ROUTE )
+    {
+        evt.m_trackWidth = m_sizes.TrackWidth();
+        evt.m_viaDiameter = m_sizes.ViaDiameter();
+        evt.m_viaDrill = m_sizes.ViaDrill();
+        evt.m_diffPairWidth = m_sizes.DiffPairWidth();
+        evt.m_diffPairGap = m_sizes.DiffPairGap();
+    }
+
+    m_eventLogger->Log( evt );
 }
 
 
@@ -35,6 +35,7 @@
 #include "pns_sizes_settings.h"
 #include "pns_item.h"
 #include "pns_itemset.h"
+#include "pns_logger.h"
 #include "pns_node.h"
 
 namespace KIGFX
@@ -163,6 +164,20 @@ public:
 
     void DumpLog();
 
+    /**
+     * Function RecordEvents()
+     *
+     * Starts or stops recording the routing events, with the mode and sizes of each route, so
+     * that the router QA tool can replay them.  Only the events of the last route or drag are
+     * kept.  DumpLog() saves the recorded events.
+     */
+    void RecordEvents( bool aEnable );
+
+    LOGGER* EventLogger() const
+    {
+        return m_eventLogger.get();
+    }
+
     RULE_RESOLVER* GetRuleResolver() const
     {
         return m_iface->GetRuleResolver();
@@ -249,6 +264,8 @@ private:
 
     void markViolations( NODE* aNode, ITEM_SET& aCurrent, NODE::ITEM_VECTOR& aRemoved );
     bool isStartingPointRoutable( const VECTOR2I& aWhere, int aLayer );
+    void logEvent( LOGGER::EVENT_TYPE aType, const VECTOR2I& aP, const ITEM* aItem, int aLayer,
+                   int aMode = 0 );
 
     VECTOR2I m_currentEnd;
     RouterState m_state;
@@ -259,6 +276,7 @@ private:
     std::unique_ptr< PLACEMENT_ALGO > m_placer;
     std::unique_ptr< DRAGGER >        m_dragger;
     std::unique_ptr< SHOVE >          m_shove;
+    std::unique_ptr< LOGGER >         m_eventLogger;
 
     ROUTER_IFACE* m_iface;
 
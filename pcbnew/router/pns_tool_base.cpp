@@ -105,6 +105,11 @@ void TOOL_BASE::Reset( RESET_REASON aReason )
     m_router->LoadSettings( m_savedSettings );
     m_router->UpdateSizes( m_savedSizes );
 
+#ifdef DEBUG
+    // Saved with the other router logs by the debug key of the router tool
+    m_router->RecordEvents( true );
+#endif
+
     m_gridHelper = new GRID_HELPER( frame() );
 }
 
@@ -0,0 +1,710 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file snapshot_plugin.cpp
+ * @brief Binary snapshots of the s-expression boards.
+ *
+ * A snapshot holds, in the byte order and integer sizes of the build which wrote it:
+ *  - a header: the magic string, the byte order mark, the snapshot and board file format
+ *    versions, the build which wrote the snapshot, and the size and MD5 hash of the board
+ *    file,
+ *  - the board in the s-expression format, without its tracks and zone fills,
+ *  - the tracks and vias, in the order of the board file,
+ *  - the filled areas, triangulation and fill segments of each zone of the board.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <fctsys.h>
+#include <advanced_config.h>
+#include <build_version.h>
+#include <class_board.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <macros.h>
+#include <md5_hash.h>
+#include <pcb_parser.h>
+#include <properties.h>
+#include <richio.h>
+#include <wildcards_and_files_ext.h>
+#include <snapshot_plugin.h>
+
+
+#define SNAPSHOT_FILE_VERSION   3       // build identifier in the header
+
+static const char     s_magic[16] = "KiCad snapshot";
+static const uint32_t s_byteOrderMark = 0x01020304;
+
+// The header is at most this long (the build identifier is a short version string, and the
+// hash is 32 hex digits)
+static const size_t   SNAPSHOT_HEADER_MAX_SIZE = 1024;
+
+
+/**
+ * Class SNAPSHOT_WRITER
+ * appends the binary values of a snapshot to a buffer.
+ */
+class SNAPSHOT_WRITER
+{
+public:
+    template <typename T>
+    void Write( T aValue )
+    {
+        static_assert( std::is_arithmetic<T>::value, "only numbers are written as is" );
+
+        m_data.append( reinterpret_cast<const char*>( &aValue ), sizeof( T ) );
+    }
+
+    void WriteString( const std::string& aText )
+    {
+        Write<uint64_t>( aText.size() );
+        m_data.append( aText );
+    }
+
+    void WritePoint( const VECTOR2I& aPoint )
+    {
+        Write<int32_t>( aPoint.x );
+        Write<int32_t>( aPoint.y );
+    }
+
+    const std::string& GetData() const { return m_data; }
+
+private:
+    std::string m_data;
+};
+
+
+/**
+ * Class SNAPSHOT_READER
+ * reads back the values written by SNAPSHOT_WRITER from a file, and throws an IO_ERROR
+ * when they go past its end.
+ */
+class SNAPSHOT_READER
+{
+public:
+    /**
+     * Reads the file aFileName, or only its first aMaxSize bytes.
+     */
+    SNAPSHOT_READER( const wxString& aFileName, size_t aMaxSize = SIZE_MAX ) :
+        m_fileName( aFileName ),
+        m_pos( 0 )
+    {
+        wxFFile file( aFileName, wxT( "rb" ) );
+
+        if( !file.IsOpened() )
+            THROW_IO_ERROR( wxString::Format( _( "Unable to read file \"%s\"" ), aFileName ) );
+
+        wxFileOffset length = file.Length();
+
+        if( length < 0 )
+            THROW_IO_ERROR( wxString::Format( _( "Unable to read file \"%s\"" ), aFileName ) );
+
+        m_data.resize( std::min<uint64_t>( length, aMaxSize ) );
+
+        if( !m_data.empty() && file.Read( &m_data[0], m_data.size() ) != m_data.size() )
+            THROW_IO_ERROR( wxString::Format( _( "Unable to read file \"%s\"" ), aFileName ) );
+    }
+
+    template <typename T>
+    T Read()
+    {
+        static_assert( std::is_arithmetic<T>::value, "only numbers are read as is" );
+
+        T value;
+
+        need( sizeof( T ) );
+        memcpy( &value, m_data.data() + m_pos, sizeof( T ) );
+        m_pos += sizeof( T );
+
+        return value;
+    }
+
+    std::string ReadString()
+    {
+        uint64_t length = Read<uint64_t>();
+
+        need( length );
+
+        std::string text( m_data.data() + m_pos, length );
+        m_pos += length;
+
+        return text;
+    }
+
+    /**
+     * Reads the number of the items which follow, each at least aItemSize bytes long, and
+     * checks that they fit in the file.
+     */
+    uint32_t ReadCount( size_t aItemSize )
+    {
+        uint32_t count = Read<uint32_t>();
+
+        need( (uint64_t) count * aItemSize );
+
+        return count;
+    }
+
+    VECTOR2I ReadPoint()
+    {
+        int32_t x = Read<int32_t>();
+        int32_t y = Read<int32_t>();
+
+        return VECTOR2I( x, y );
+    }
+
+    bool AtEnd() const
+    {
+        return m_pos == m_data.size();
+    }
+
+    const wxString& GetFileName() const
+    {
+        return m_fileName;
+    }
+
+    /**
+     * Throws the IO_ERROR of a snapshot whose contents do not make sense.
+     */
+    void Invalid() const
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Snapshot file \"%s\" is damaged" ), m_fileName ) );
+    }
+
+private:
+    void need( uint64_t aSize ) const
+    {
+        if( aSize > m_data.size() - m_pos )
+            Invalid();
+    }
+
+    wxString            m_fileName;
+    std::vector<char>   m_data;
+    size_t              m_pos;
+};
+
+
+/**
+ * Struct SNAPSHOT_HEADER
+ * is what a snapshot tells about the board file it was written from.
+ */
+struct SNAPSHOT_HEADER
+{
+    uint64_t    m_boardFileSize;
+    std::string m_boardFileHash;
+};
+
+
+/**
+ * @return the MD5 hash of the contents of the file aFileName, or an empty string if it
+ * cannot be read.
+ */
+static std::string hashFile( const wxString& aFileName )
+{
+    wxFFile file( aFileName, wxT( "rb" ) );
+
+    if( !file.IsOpened() )
+        return std::string();
+
+    MD5_HASH             hash;
+    std::vector<uint8_t> buffer( 1024 * 1024 );
+    size_t               length;
+
+    while( ( length = file.Read( buffer.data(), buffer.size() ) ) > 0 )
+        hash.Hash( buffer.data(), length );
+
+    if( file.Error() )
+        return std::string();
+
+    hash.Finalize();
+
+    return hash.Format();
+}
+
+
+/**
+ * @return the identifier of the build, which only reads the snapshots it wrote: the KiCad
+ * version and the width of its pointers.  The byte order is checked on its own.
+ */
+static std::string buildIdentifier()
+{
+    return std::string( TO_UTF8( GetBuildVersion() ) ) + " "
+           + std::to_string( sizeof( void* ) * 8 ) + " bit";
+}
+
+
+static void writeHeader( SNAPSHOT_WRITER& aOut, const wxString& aBoardFileName )
+{
+    wxULongLong size = wxFileName::GetSize( aBoardFileName );
+    std::string hash = hashFile( aBoardFileName );
+
+    if( size == wxInvalidSize || hash.empty() )
+        THROW_IO_ERROR( wxString::Format( _( "Unable to read file \"%s\"" ), aBoardFileName ) );
+
+    for( char c : s_magic )
+        aOut.Write<char>( c );
+
+    aOut.Write<uint32_t>( s_byteOrderMark );
+    aOut.Write<uint32_t>( SNAPSHOT_FILE_VERSION );
+    aOut.Write<uint32_t>( SEXPR_BOARD_FILE_VERSION );
+    aOut.WriteString( buildIdentifier() );
+    aOut.Write<uint64_t>( size.GetValue() );
+    aOut.WriteString( hash );
+}
+
+
+/**
+ * Reads the header of a snapshot, and throws an IO_ERROR if it was not written by a build
+ * writing the same snapshots.
+ */
+static SNAPSHOT_HEADER readHeader( SNAPSHOT_READER& aIn )
+{
+    SNAPSHOT_HEADER header;
+    bool            valid = true;
+
+    for( char c : s_magic )
+        valid = valid && aIn.Read<char>() == c;
+
+    valid = valid && aIn.Read<uint32_t>() == s_byteOrderMark;
+    valid = valid && aIn.Read<uint32_t>() == SNAPSHOT_FILE_VERSION;
+    valid = valid && aIn.Read<uint32_t>() == SEXPR_BOARD_FILE_VERSION;
+    valid = valid && aIn.ReadString() == buildIdentifier();
+
+    if( !valid )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "File \"%s\" is not a snapshot of this version" ),
+                                          aIn.GetFileName() ) );
+    }
+
+    header.m_boardFileSize = aIn.Read<uint64_t>();
+    header.m_boardFileHash = aIn.ReadString();
+
+    return header;
+}
+
+
+static void writePolySet( SNAPSHOT_WRITER& aOut, const SHAPE_POLY_SET& aPolySet )
+{
+    aOut.Write<uint32_t>( aPolySet.OutlineCount() );
+
+    for( int ii = 0; ii < aPolySet.OutlineCount(); ++ii )
+    {
+        const SHAPE_POLY_SET::POLYGON& polygon = aPolySet.CPolygon( ii );
+
+        aOut.Write<uint32_t>( polygon.size() );
+
+        for( const SHAPE_LINE_CHAIN& chain : polygon )
+        {
+            aOut.Write<uint8_t>( chain.IsClosed() );
+            aOut.Write<uint32_t>( chain.PointCount() );
+
+            for( int jj = 0; jj < chain.PointCount(); ++jj )
+                aOut.WritePoint( chain.CPoint( jj ) );
+        }
+    }
+}
+
+
+static void readPolySet( SNAPSHOT_READER& aIn, SHAPE_POLY_SET& aPolySet )
+{
+    uint32_t             polygonCount = aIn.ReadCount( sizeof( uint32_t ) );
+    std::vector<VECTOR2I> points;
+
+    for( uint32_t ii = 0; ii < polygonCount; ++ii )
+    {
+        uint32_t chainCount = aIn.ReadCount( sizeof( uint8_t ) + sizeof( uint32_t ) );
+
+        for( uint32_t jj = 0; jj < chainCount; ++jj )
+        {
+            bool     closed = aIn.Read<uint8_t>() != 0;
+            uint32_t pointCount = aIn.ReadCount( 2 * sizeof( int32_t ) );
+
+            points.resize( pointCount );
+
+            for( VECTOR2I& point : points )
+                point = aIn.ReadPoint();
+
+            SHAPE_LINE_CHAIN chain( points.data(), pointCount );
+            chain.SetClosed( closed );
+
+            // The first chain is the outline, the others its holes
+            if( jj == 0 )
+            {
+                if( !closed )
+                    aIn.Invalid();
+
+                aPolySet.AddOutline( chain );
+            }
+            else
+            {
+                aPolySet.AddHole( chain );
+            }
+        }
+    }
+}
+
+
+static void writeTriangulation( SNAPSHOT_WRITER& aOut, const SHAPE_POLY_SET& aPolySet )
+{
+    // It is computed again when it is not stored
+    bool stored = aPolySet.IsTriangulationUpToDate();
+
+    aOut.Write<uint8_t>( stored );
+
+    if( !stored )
+        return;
+
+    aOut.Write<uint32_t>( aPolySet.TriangulatedPolyCount() );
+
+    for( unsigned ii = 0; ii < aPolySet.TriangulatedPolyCount(); ++ii )
+    {
+        const auto* triangulation = aPolySet.TriangulatedPolygon( ii );
+
+        aOut.Write<uint32_t>( triangulation->GetVertexCount() );
+
+        for( size_t jj = 0; jj < triangulation->GetVertexCount(); ++jj )
+            aOut.WritePoint( triangulation->GetVertex( jj ) );
+
+        aOut.Write<uint32_t>( triangulation->GetTriangleCount() );
+
+        for( size_t jj = 0; jj < triangulation->GetTriangleCount(); ++jj )
+        {
+            const auto& triangle = triangulation->GetTriangleIndices( jj );
+
+            aOut.Write<int32_t>( triangle.a );
+            aOut.Write<int32_t>( triangle.b );
+            aOut.Write<int32_t>( triangle.c );
+        }
+    }
+}
+
+
+static void readTriangulation( SNAPSHOT_READER& aIn, ZONE_CONTAINER* aZone )
+{
+    typedef SHAPE_POLY_SET::TRIANGULATED_POLYGON TRIANGULATED_POLYGON;
+
+    if( !aIn.Read<uint8_t>() )
+        return;
+
+    std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> triangulation;
+    uint32_t count = aIn.ReadCount( 2 * sizeof( uint32_t ) );
+
+    for( uint32_t ii = 0; ii < count; ++ii )
+    {
+        triangulation.push_back( std::make_unique<TRIANGULATED_POLYGON>() );
+
+        TRIANGULATED_POLYGON& polygon = *triangulation.back();
+        uint32_t              vertexCount = aIn.ReadCount( 2 * sizeof( int32_t ) );
+
+        for( uint32_t jj = 0; jj < vertexCount; ++jj )
+            polygon.AddVertex( aIn.ReadPoint() );
+
+        uint32_t triangleCount = aIn.ReadCount( 3 * sizeof( int32_t ) );
+
+        for( uint32_t jj = 0; jj < triangleCount; ++jj )
+        {
+            int32_t a = aIn.Read<int32_t>();
+            int32_t b = aIn.Read<int32_t>();
+            int32_t c = aIn.Read<int32_t>();
+
+            if( a < 0 || b < 0 || c < 0 || (uint32_t) std::max( { a, b, c } ) >= vertexCount )
+                aIn.Invalid();
+
+            polygon.AddTriangle( a, b, c );
+        }
+    }
+
+    aZone->SetFillTriangulation( std::move( triangulation ) );
+}
+
+
+static PCB_LAYER_ID readCopperLayer( SNAPSHOT_READER& aIn )
+{
+    int32_t layer = aIn.Read<int32_t>();
+
+    if( !IsCopperLayer( layer ) )
+        aIn.Invalid();
+
+    return ToLAYER_ID( layer );
+}
+
+
+SNAPSHOT_PLUGIN::SNAPSHOT_PLUGIN() :
+    PCB_IO( CTL_FOR_BOARD | CTL_OMIT_TRACKS | CTL_OMIT_FILLS )
+{
+}
+
+
+const wxString SNAPSHOT_PLUGIN::GetFileExtension() const
+{
+    return KiCadPcbSnapshotFileExtension;
+}
+
+
+wxString SNAPSHOT_PLUGIN::SnapshotFileName( const wxString& aBoardFileName )
+{
+    wxFileName fn( aBoardFileName );
+
+    fn.SetExt( KiCadPcbSnapshotFileExtension );
+
+    return fn.GetFullPath();
+}
+
+
+bool SNAPSHOT_PLUGIN::IsUpToDate( const wxString& aSnapshotFileName,
+                                  const wxString& aBoardFileName )
+{
+    if( !wxFileName::FileExists( aSnapshotFileName ) || !wxFileName::FileExists( aBoardFileName ) )
+        return false;
+
+    try
+    {
+        SNAPSHOT_READER in( aSnapshotFileName, SNAPSHOT_HEADER_MAX_SIZE );
+        SNAPSHOT_HEADER header = readHeader( in );
+
+        // The size tells most changes without reading the board file
+        if( header.m_boardFileSize != wxFileName::GetSize( aBoardFileName ).GetValue() )
+            return false;
+
+        return header.m_boardFileHash == hashFile( aBoardFileName );
+    }
+    catch( const IO_ERROR& )
+    {
+        return false;
+    }
+}
+
+
+void SNAPSHOT_PLUGIN::Save( const wxString& aFileName, BOARD* aBoard,
+                            const PROPERTIES* aProperties )
+{
+    init( aProperties );
+
+    m_board = aBoard;       // after init()
+
+    // The net codes are the ones of the board text, whose parsing creates the nets
+    m_mapping->SetBoard( aBoard );
+
+    SNAPSHOT_WRITER out;
+
+    writeHeader( out, aBoard->GetFileName() );
+
+    // The board without its tracks and zone fills
+    m_sf.Clear();
+    m_out = &m_sf;
+
+    m_out->Print( 0, "(kicad_pcb (version %d) (host pcbnew %s)\n", SEXPR_BOARD_FILE_VERSION,
+                  m_out->Quotew( GetBuildVersion() ).c_str() );
+
+    Format( aBoard, 1 );
+
+    m_out->Print( 0, ")\n" );
+
+    out.WriteString( GetStringOutput( true ) );
+
+    // The tracks are written in the order of the board file, which the board parser reverses.
+    // A board just saved is in that order, a board just loaded in the reverse one.
+    std::vector<TRACK*> tracks( aBoard->Tracks().begin(), aBoard->Tracks().end() );
+
+    if( !m_props || !m_props->Exists( "saved_board" ) )
+        std::reverse( tracks.begin(), tracks.end() );
+
+    out.Write<uint64_t>( tracks.size() );
+
+    for( TRACK* track : tracks )
+    {
+        bool isVia = track->Type() == PCB_VIA_T;
+
+        out.Write<uint8_t>( isVia );
+        out.WritePoint( track->GetStart() );
+        out.WritePoint( track->GetEnd() );
+        out.Write<int32_t>( track->GetWidth() );
+        out.Write<int32_t>( m_mapping->Translate( track->GetNetCode() ) );
+        out.Write<uint32_t>( track->GetTimeStamp() );
+        out.Write<uint32_t>( track->GetStatus() );
+
+        if( isVia )
+        {
+            VIA*         via = static_cast<VIA*>( track );
+            PCB_LAYER_ID top, bottom;
+
+            via->LayerPair( &top, &bottom );
+
+            out.Write<int32_t>( via->GetViaType() );
+            out.Write<int32_t>( via->GetDrill() );
+            out.Write<int32_t>( top );
+            out.Write<int32_t>( bottom );
+        }
+        else
+        {
+            out.Write<int32_t>( track->GetLayer() );
+        }
+    }
+
+    // The zone fills, in the order of the zones of the board text
+    out.Write<uint32_t>( aBoard->GetAreaCount() );
+
+    for( int ii = 0; ii < aBoard->GetAreaCount(); ++ii )
+    {
+        ZONE_CONTAINER* zone = aBoard->GetArea( ii );
+
+        writePolySet( out, zone->GetFilledPolysList() );
+        writeTriangulation( out, zone->GetFilledPolysList() );
+
+        out.Write<uint32_t>( zone->FillSegments().size() );
+
+        for( const SEG& segment : zone->FillSegments() )
+        {
+            out.WritePoint( segment.A );
+            out.WritePoint( segment.B );
+        }
+    }
+
+    const std::string& data = out.GetData();
+    wxFFile            file( aFileName, wxT( "wb" ) );
+
+    if( !file.IsOpened() || file.Write( data.data(), data.size() ) != data.size()
+            || !file.Close() )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Unable to write file \"%s\"" ), aFileName ) );
+    }
+}
+
+
+BOARD* SNAPSHOT_PLUGIN::Load( const wxString& aFileName, BOARD* aAppendToMe,
+                              const PROPERTIES* aProperties )
+{
+    if( aAppendToMe )
+        THROW_IO_ERROR( _( "A snapshot cannot be appended to a board" ) );
+
+    init( aProperties );
+
+    SNAPSHOT_READER in( aFileName );
+
+    readHeader( in );
+
+    std::unique_ptr<BOARD> board;
+
+    {
+        STRING_LINE_READER reader( in.ReadString(), aFileName );
+
+        m_parser->SetLineReader( &reader );
+        m_parser->SetBoard( NULL );
+        m_parser->SetParallelLoad( ADVANCED_CFG::GetCfg().m_parallelBoardLoad );
+
+        BOARD_ITEM* item = m_parser->Parse();
+
+        board.reset( dynamic_cast<BOARD*>( item ) );
+
+        if( !board )
+        {
+            delete item;
+            in.Invalid();
+        }
+    }
+
+    uint64_t trackCount = in.Read<uint64_t>();
+
+    for( uint64_t ii = 0; ii < trackCount; ++ii )
+    {
+        bool                   isVia = in.Read<uint8_t>() != 0;
+        std::unique_ptr<TRACK> track( isVia ? new VIA( board.get() ) : new TRACK( board.get() ) );
+
+        track->SetStart( (wxPoint) in.ReadPoint() );
+        track->SetEnd( (wxPoint) in.ReadPoint() );
+        track->SetWidth( in.Read<int32_t>() );
+
+        int netCode = in.Read<int32_t>();
+
+        track->SetTimeStamp( in.Read<uint32_t>() );
+        track->SetStatus( in.Read<uint32_t>() );
+
+        if( isVia )
+        {
+            VIA* via = static_cast<VIA*>( track.get() );
+
+            via->SetViaType( static_cast<VIATYPE_T>( in.Read<int32_t>() ) );
+            via->SetDrill( in.Read<int32_t>() );
+
+            PCB_LAYER_ID top = readCopperLayer( in );
+            PCB_LAYER_ID bottom = readCopperLayer( in );
+
+            via->SetLayerPair( top, bottom );
+        }
+        else
+        {
+            track->SetLayer( readCopperLayer( in ) );
+        }
+
+        if( !track->SetNetCode( netCode, /* aNoAssert */ true ) )
+            in.Invalid();
+
+        // Inserted like the board parser does
+        board->Add( track.release(), ADD_INSERT );
+    }
+
+    if( in.Read<uint32_t>() != (uint32_t) board->GetAreaCount() )
+        in.Invalid();
+
+    for( int ii = 0; ii < board->GetAreaCount(); ++ii )
+    {
+        ZONE_CONTAINER* zone = board->GetArea( ii );
+        SHAPE_POLY_SET  fill;
+
+        readPolySet( in, fill );
+
+        if( !fill.IsEmpty() )
+            zone->SetFilledPolysList( fill );
+
+        // After the fill, which drops the triangulation it had
+        readTriangulation( in, zone );
+
+        ZONE_SEGMENT_FILL segments( in.ReadCount( 4 * sizeof( int32_t ) ) );
+
+        for( SEG& segment : segments )
+        {
+            segment.A = in.ReadPoint();
+            segment.B = in.ReadPoint();
+        }
+
+        if( !segments.empty() )
+            zone->SetFillSegments( segments );
+    }
+
+    if( !in.AtEnd() )
+        in.Invalid();
+
+    wxFileName boardFileName( aFileName );
+
+    boardFileName.SetExt( KiCadPcbFileExtension );
+    board->SetFileName( boardFileName.GetFullPath() );
+
+    return board.release();
+}
@@ -0,0 +1,94 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file snapshot_plugin.h
+ * @brief Binary snapshots of the s-expression boards, to open them again quickly.
+ */
+
+#ifndef SNAPSHOT_PLUGIN_H_
+#define SNAPSHOT_PLUGIN_H_
+
+#include <kicad_plugin.h>
+
+
+/**
+ * Class SNAPSHOT_PLUGIN
+ * is a PLUGIN derivation for saving and loading binary snapshots of the boards saved in
+ * the s-expression format.
+ *
+ * A snapshot is written next to its board file and records the hash of the board file it
+ * stands for, so it is used only while the board file is unchanged.  It holds in binary
+ * form the bulk of the large boards, which is the slowest to parse: the tracks and vias,
+ * and the filled areas of the zones with their triangulation.  The rest of the board is
+ * kept in the s-expression format.
+ *
+ * A snapshot is a cache, not a document: it is only readable by the build which wrote it,
+ * which is recorded in its header.
+ */
+class SNAPSHOT_PLUGIN : public PCB_IO
+{
+public:
+
+    //-----<PLUGIN API>---------------------------------------------------------
+
+    const wxString PluginName() const override
+    {
+        return wxT( "KiCad snapshot" );
+    }
+
+    const wxString GetFileExtension() const override;
+
+    /**
+     * Loads the snapshot aFileName.  The board is given the name of the board file of the
+     * snapshot.  Appending to an existing board is not supported.
+     */
+    BOARD* Load( const wxString& aFileName, BOARD* aAppendToMe,
+                 const PROPERTIES* aProperties = NULL ) override;
+
+    /**
+     * Writes the snapshot aFileName of aBoard, which has to be the same as its board file:
+     * just loaded from it, or just saved to it if aProperties has "saved_board".
+     */
+    void Save( const wxString& aFileName, BOARD* aBoard,
+               const PROPERTIES* aProperties = NULL ) override;
+
+    //-----</PLUGIN API>--------------------------------------------------------
+
+    SNAPSHOT_PLUGIN();
+
+    /**
+     * Function SnapshotFileName
+     * @return the name of the snapshot of the board file aBoardFileName.
+     */
+    static wxString SnapshotFileName( const wxString& aBoardFileName );
+
+    /**
+     * Function IsUpToDate
+     * tells whether the snapshot aSnapshotFileName exists, can be read by this build and
+     * was written from the current contents of the board file aBoardFileName.
+     */
+    static bool IsUpToDate( const wxString& aSnapshotFileName, const wxString& aBoardFileName );
+};
+
+#endif  // SNAPSHOT_PLUGIN_H_
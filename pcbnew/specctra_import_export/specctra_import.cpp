@@ -76,8 +76,7 @@ bool PCB_EDIT_FRAME::ImportSpecctraSession( const wxString& fullFileName )
 
     OnModify();
 
-    GetBoard()->GetConnectivity()->Clear();
-    GetBoard()->GetConnectivity()->Build( GetBoard() );
+    GetBoard()->GetConnectivity()->Synchronize( GetBoard() );
 
     if( GetCanvas() )    // Update view:
     {
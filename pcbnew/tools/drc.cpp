@@ -51,18 +51,39 @@
 #include <netlist_reader/pcb_netlist.h>
 
 #include <dialog_drc.h>
-#include <wx/progdlg.h>
+#include <widgets/progress_reporter.h>
 #include <board_commit.h>
 #include <geometry/shape_segment.h>
 #include <geometry/shape_arc.h>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <unordered_map>
 
 #include <drc/courtyard_overlap.h>
+#include <drc/drc_rtree.h>
+#include <zone_filler.h>
+#include <profile.h>
+#include <thread_pool.h>
 #include "zone_filler_tool.h"
 
+thread_local MARKER_PCB* DRC::m_currentMarker = nullptr;
+thread_local wxPoint     DRC::m_padToTestPos;
+thread_local wxPoint     DRC::m_segmEnd;
+thread_local double      DRC::m_segmAngle = 0;
+thread_local int         DRC::m_segmLength = 0;
+thread_local int         DRC::m_xcliplo = 0;
+thread_local int         DRC::m_ycliplo = 0;
+thread_local int         DRC::m_xcliphi = 0;
+thread_local int         DRC::m_ycliphi = 0;
+
+
 DRC::DRC() :
         PCB_TOOL_BASE( "pcbnew.DRCTool" )
 {
     m_drcDialog  = NULL;
+    m_pcbEditorFrame = nullptr;
+    m_pcb = nullptr;
 
     // establish initial values for everything:
     m_doPad2PadTest     = true;         // enable pad to pad clearance tests
@@ -79,15 +100,6 @@ DRC::DRC() :
     m_doCreateRptFile = false;
     // m_rptFilename set to empty by its constructor
 
-    m_currentMarker = NULL;
-
-    m_segmAngle  = 0;
-    m_segmLength = 0;
-
-    m_xcliplo = 0;
-    m_ycliplo = 0;
-    m_xcliphi = 0;
-    m_ycliphi = 0;
 }
 
 
@@ -163,12 +175,40 @@ int DRC::ShowDRCDialog( const TOOL_EVENT& aEvent )
 
 void DRC::addMarkerToPcb( MARKER_PCB* aMarker )
 {
+    if( m_markerHandler )
+    {
+        m_markerHandler( aMarker );
+        return;
+    }
+
     BOARD_COMMIT commit( m_pcbEditorFrame );
     commit.Add( aMarker );
     commit.Push( wxEmptyString, false, false );
 }
 
 
+void DRC::addMarkersToPcb( const std::vector<MARKER_PCB*>& aMarkers )
+{
+    if( aMarkers.empty() )
+        return;
+
+    if( m_markerHandler )
+    {
+        for( MARKER_PCB* marker : aMarkers )
+            m_markerHandler( marker );
+
+        return;
+    }
+
+    BOARD_COMMIT commit( m_pcbEditorFrame );
+
+    for( MARKER_PCB* marker : aMarkers )
+        commit.Add( marker );
+
+    commit.Push( wxEmptyString, false, false );
+}
+
+
 void DRC::DestroyDRCDialog( int aReason )
 {
     if( m_drcDialog )
@@ -183,8 +223,7 @@ void DRC::DestroyDRCDialog( int aReason )
 
 int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
 {
-    BOARD* board = m_pcbEditorFrame->GetBoard();
-    BOARD_COMMIT commit( m_pcbEditorFrame );
+    BOARD* board = m_pcbEditorFrame ? m_pcbEditorFrame->GetBoard() : m_pcb;
     int nerrors = 0;
 
     std::vector<SHAPE_POLY_SET> smoothed_polys;
@@ -199,17 +238,22 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
         zoneRef->BuildSmoothedPoly( smoothed_polys[ia], &colinearCorners );
     }
 
+    // Each reference area is a work item with its own marker buffer and error count
+    std::vector<std::vector<MARKER_PCB*>> markers( board->GetAreaCount() );
+    std::vector<int>                      errors( board->GetAreaCount(), 0 );
+
     // iterate through all areas
-    for( int ia = 0; ia < board->GetAreaCount(); ia++ )
+    auto testArea = [&]( size_t aIndex )
     {
+        int ia = (int) aIndex;
         ZONE_CONTAINER* zoneRef = board->GetArea( ia );
 
         if( !zoneRef->IsOnCopperLayer() )
-            continue;
+            return;
 
         // When testing only a single area, skip all others
         if( aZone && ( aZone != zoneRef) )
-            continue;
+            return;
 
         // If we are testing a single zone, then iterate through all other zones
         // Otherwise, we have already tested the zone combination
@@ -257,10 +301,10 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
                 if( smoothed_polys[ia2].Contains( currentVertex ) )
                 {
                     if( aCreateMarkers )
-                        commit.Add( m_markerFactory.NewMarker( pt, zoneRef, zoneToTest,
-                                                               DRCE_ZONES_INTERSECT ) );
+                        markers[ia].push_back( m_markerFactory.NewMarker( pt, zoneRef, zoneToTest,
+                                                                          DRCE_ZONES_INTERSECT ) );
 
-                    nerrors++;
+                    errors[ia]++;
                 }
             }
 
@@ -273,10 +317,10 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
                 if( smoothed_polys[ia].Contains( currentVertex ) )
                 {
                     if( aCreateMarkers )
-                        commit.Add( m_markerFactory.NewMarker( pt, zoneToTest, zoneRef,
-                                                               DRCE_ZONES_INTERSECT ) );
+                        markers[ia].push_back( m_markerFactory.NewMarker( pt, zoneToTest, zoneRef,
+                                                                          DRCE_ZONES_INTERSECT ) );
 
-                    nerrors++;
+                    errors[ia]++;
                 }
             }
 
@@ -322,16 +366,26 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
             for( wxPoint pt : conflictPoints )
             {
                 if( aCreateMarkers )
-                    commit.Add( m_markerFactory.NewMarker( pt, zoneRef, zoneToTest,
-                                                           DRCE_ZONES_TOO_CLOSE ) );
+                    markers[ia].push_back( m_markerFactory.NewMarker( pt, zoneRef, zoneToTest,
+                                                                      DRCE_ZONES_TOO_CLOSE ) );
 
-                nerrors++;
+                errors[ia]++;
             }
         }
+    };
+
+    GetKiCadThreadPool().ParallelFor( board->GetAreaCount(), testArea );
+
+    std::vector<MARKER_PCB*> allMarkers;
+
+    for( int ia = 0; ia < board->GetAreaCount(); ia++ )
+    {
+        allMarkers.insert( allMarkers.end(), markers[ia].begin(), markers[ia].end() );
+        nerrors += errors[ia];
     }
 
     if( aCreateMarkers )
-        commit.Push( wxEmptyString, false, false );
+        addMarkersToPcb( allMarkers );
 
     return nerrors;
 }
@@ -341,7 +395,18 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 {
     // be sure m_pcb is the current board, not a old one
     // ( the board can be reloaded )
-    m_pcb = m_pcbEditorFrame->GetBoard();
+    if( m_pcbEditorFrame )
+        m_pcb = m_pcbEditorFrame->GetBoard();
+
+    m_stageTimes.clear();
+
+    // Run a test stage and record the time it took
+    auto runStage = [&]( const std::string& aName, const std::function<void()>& aStage )
+    {
+        PROF_COUNTER timer;
+        aStage();
+        m_stageTimes.push_back( { aName, timer.msecs() } );
+    };
 
     if( aMessages )
     {
@@ -349,10 +414,14 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
-    testOutline();
+    runStage( "outline", [&]() { testOutline(); } );
 
     // someone should have cleared the two lists before calling this.
-    if( !testNetClasses() )
+    bool netclassesOk = true;
+
+    runStage( "netclasses", [&]() { netclassesOk = testNetClasses(); } );
+
+    if( !netclassesOk )
     {
         // testing the netclasses is a special case because if the netclasses
         // do not pass the BOARD_DESIGN_SETTINGS checks, then every member of a net
@@ -376,7 +445,7 @@ void DRC::RunTests( wxTextCtrl* aMessages )
             wxSafeYield();
         }
 
-        testPad2Pad();
+        runStage( "pad_to_pad", [&]() { testPad2Pad(); } );
     }
 
     // test clearances between drilled holes
@@ -386,12 +455,26 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
-    testDrilledHoles();
+    runStage( "drilled_holes", [&]() { testDrilledHoles(); } );
 
     // caller (a wxTopLevelFrame) is the wxDialog or the Pcb Editor frame that call DRC:
     wxWindow* caller = aMessages ? aMessages->GetParent() : m_pcbEditorFrame;
 
-    if( m_refillZones )
+    if( !m_pcbEditorFrame )
+    {
+        // Without the editor there is nobody to ask whether out of date zones should be
+        // refilled, so only refill them when requested.
+        if( m_refillZones )
+        {
+            runStage( "zone_fill",
+                    [&]()
+                    {
+                        ZONE_FILLER filler( m_pcb );
+                        filler.Fill( m_pcb->Zones() );
+                    } );
+        }
+    }
+    else if( m_refillZones )
     {
         if( aMessages )
             aMessages->AppendText( _( "Refilling all zones...\n" ) );
@@ -413,7 +496,7 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
-    testTracks( aMessages ? aMessages->GetParent() : m_pcbEditorFrame, true );
+    runStage( "tracks", [&]() { testTracks( caller, m_pcbEditorFrame != nullptr ); } );
 
     // test zone clearances to other zones
     if( aMessages )
@@ -422,7 +505,7 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
-    testZones();
+    runStage( "zones", [&]() { testZones(); } );
 
     // find and gather unconnected pads.
     if( m_doUnconnectedTest )
@@ -433,7 +516,7 @@ void DRC::RunTests( wxTextCtrl* aMessages )
             aMessages->Refresh();
         }
 
-        testUnconnected();
+        runStage( "unconnected", [&]() { testUnconnected(); } );
     }
 
     // find and gather vias, tracks, pads inside keepout areas.
@@ -445,7 +528,7 @@ void DRC::RunTests( wxTextCtrl* aMessages )
             aMessages->Refresh();
         }
 
-        testKeepoutAreas();
+        runStage( "keepouts", [&]() { testKeepoutAreas(); } );
     }
 
     // find and gather vias, tracks, pads inside text boxes.
@@ -455,7 +538,7 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
-    testCopperTextAndGraphics();
+    runStage( "text_and_graphics", [&]() { testCopperTextAndGraphics(); } );
 
     // find overlapping courtyard ares.
     if( m_pcb->GetDesignSettings().m_ProhibitOverlappingCourtyards
@@ -467,7 +550,7 @@ void DRC::RunTests( wxTextCtrl* aMessages )
             aMessages->Refresh();
         }
 
-        doFootprintOverlappingDrc();
+        runStage( "courtyard", [&]() { doFootprintOverlappingDrc(); } );
     }
 
     for( DRC_ITEM* footprintItem : m_footprints )
@@ -476,7 +559,8 @@ void DRC::RunTests( wxTextCtrl* aMessages )
     m_footprints.clear();
     m_footprintsTested = false;
 
-    if( m_testFootprints && !Kiface().IsSingle() )
+    // The schematic is only reachable through the editor frame
+    if( m_testFootprints && m_pcbEditorFrame && !Kiface().IsSingle() )
     {
         if( aMessages )
         {
@@ -495,7 +579,7 @@ void DRC::RunTests( wxTextCtrl* aMessages )
     }
 
     // Check if there are items on disabled layers
-    testDisabledLayers();
+    runStage( "disabled_layers", [&]() { testDisabledLayers(); } );
 
     if( aMessages )
     {
@@ -517,8 +601,31 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 }
 
 
+void DRC::RunTestsHeadless( BOARD* aBoard, DRC_PROVIDER::MARKER_HANDLER aMarkerHandler )
+{
+    m_pcbEditorFrame = nullptr;
+    m_drcDialog = nullptr;
+    m_pcb = aBoard;
+    m_markerHandler = aMarkerHandler;
+
+    RunTests( nullptr );
+
+    m_markerHandler = nullptr;
+}
+
+
+EDA_UNITS_T DRC::userUnits() const
+{
+    return m_pcbEditorFrame ? m_pcbEditorFrame->GetUserUnits() : MILLIMETRES;
+}
+
+
 void DRC::updatePointers()
 {
+    // Nothing to update when running without the editor
+    if( !m_pcbEditorFrame )
+        return;
+
     // update my pointers, m_pcbEditorFrame is the only unchangeable one
     m_pcb = m_pcbEditorFrame->GetBoard();
 
@@ -542,7 +649,7 @@ bool DRC::doNetClass( const NETCLASSPTR& nc, wxString& msg )
 
     const BOARD_DESIGN_SETTINGS& g = m_pcb->GetDesignSettings();
 
-#define FmtVal( x ) GetChars( StringFromValue( m_pcbEditorFrame->GetUserUnits(), x ) )
+#define FmtVal( x ) GetChars( StringFromValue( userUnits(), x ) )
 
 #if 0   // set to 1 when (if...) BOARD_DESIGN_SETTINGS has a m_MinClearance value
     if( nc->GetClearance() < g.m_MinClearance )
@@ -668,18 +775,25 @@ void DRC::testPad2Pad()
     // Upper limit of pad list (limit not included)
     D_PAD** listEnd = &sortedPads[0] + sortedPads.size();
 
-    // Test the pads
-    for( auto& pad : sortedPads )
-    {
-        int x_limit = pad->GetClearance() + pad->GetBoundingRadius() + pad->GetPosition().x;
+    // Test the pads, one work item per pad.  Each pad reports at most one marker.
+    std::vector<MARKER_PCB*> markers( sortedPads.size(), nullptr );
 
-        if( !doPadToPadsDrc( pad, &pad, listEnd, max_size + x_limit ) )
-        {
-            wxASSERT( m_currentMarker );
-            addMarkerToPcb ( m_currentMarker );
-            m_currentMarker = nullptr;
-        }
-    }
+    GetKiCadThreadPool().ParallelFor( sortedPads.size(),
+            [&]( size_t aIdx )
+            {
+                D_PAD* pad = sortedPads[aIdx];
+                int x_limit = pad->GetClearance() + pad->GetBoundingRadius() + pad->GetPosition().x;
+
+                if( !doPadToPadsDrc( pad, &sortedPads[aIdx], listEnd, max_size + x_limit ) )
+                {
+                    wxASSERT( m_currentMarker );
+                    markers[aIdx] = m_currentMarker;
+                    m_currentMarker = nullptr;
+                }
+            } );
+
+    markers.erase( std::remove( markers.begin(), markers.end(), nullptr ), markers.end() );
+    addMarkersToPcb( markers );
 }
 
 
@@ -746,7 +860,7 @@ void DRC::testDrilledHoles()
             if( KiROUND( GetLineLength( checkHole.m_location, refHole.m_location ) )
                     <  checkHole.m_drillRadius + refHole.m_drillRadius + holeToHoleMin )
             {
-                addMarkerToPcb( new MARKER_PCB( m_pcbEditorFrame->GetUserUnits(),
+                addMarkerToPcb( new MARKER_PCB( userUnits(),
                                                 DRCE_DRILLED_HOLES_TOO_CLOSE, refHole.m_location,
                                                 refHole.m_owner, refHole.m_location,
                                                 checkHole.m_owner, checkHole.m_location ) );
@@ -758,58 +872,103 @@ void DRC::testDrilledHoles()
 
 void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
 {
-    wxProgressDialog * progressDialog = NULL;
-    const int delta = 500;  // This is the number of tests between 2 calls to the
-                            // progress bar
+    std::unique_ptr<WX_PROGRESS_REPORTER> reporter;
     int count = m_pcb->Tracks().size();
 
-    int deltamax = count/delta;
+    // The progress bar is only worth showing for the large boards
+    if( aShowProgressBar && count >= 2000 )
+    {
+        reporter = std::make_unique<WX_PROGRESS_REPORTER>( aActiveWindow,
+                                                           _( "Track clearances" ), 1 );
+        reporter->SetMaxProgress( count );
+    }
+
+    // Broad phase: index the tracks per layer, with their bounding box inflated by the
+    // largest clearance in use, so that each segment is only tested against the segments
+    // which can actually be too close to it.
+    // Rounding in the fine tests can move a coordinate by a few nanometers, so add a
+    // small margin to be sure no candidate is missed.
+    const int margin = 10;
+    int       maxClearance = 0;
 
-    if( aShowProgressBar && deltamax > 3 )
+    for( TRACK* track : m_pcb->Tracks() )
+    {
+        maxClearance = std::max( maxClearance, track->GetClearance() );
+        maxClearance = std::max( maxClearance, track->GetNetClass()->GetClearance() );
+    }
+
+    std::vector<TRACK*>                  tracks( m_pcb->Tracks().begin(), m_pcb->Tracks().end() );
+    DRC_RTREE                            trackIndex;
+    std::unordered_map<BOARD_ITEM*, int> trackOrder;
+
+    for( size_t ii = 0; ii < tracks.size(); ++ii )
+    {
+        trackIndex.Insert( tracks[ii], maxClearance + margin );
+        trackOrder[ tracks[ii] ] = (int) ii;
+    }
+
+    // The pad bounding radius is cached on first use; compute it here, before the
+    // worker threads share the pads.
+    for( MODULE* mod : m_pcb->Modules() )
     {
-        // Do not use wxPD_APP_MODAL style here: it is not necessary and create issues
-        // on OSX
-        progressDialog = new wxProgressDialog( _( "Track clearances" ), wxEmptyString,
-                                               deltamax, aActiveWindow,
-                                               wxPD_AUTO_HIDE | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME );
-        progressDialog->Update( 0, wxEmptyString );
+        for( D_PAD* pad : mod->Pads() )
+            pad->GetBoundingRadius();
     }
 
-    int ii = 0;
-    count = 0;
+    // Each track is a work item with its own marker buffer.  The buffers are added to the
+    // board in track order once all workers are done, so the markers do not depend on the
+    // thread scheduling.
+    std::vector<std::vector<MARKER_PCB*>> markers( tracks.size() );
 
-    for( auto seg_it = m_pcb->Tracks().begin(); seg_it != m_pcb->Tracks().end(); seg_it++ )
+    auto testTrack = [&]( size_t aIdx )
     {
-        if( ii++ > delta )
+        TRACK* refSeg = tracks[aIdx];
+
+        // Only the segments after this one in the track list are tested, in list order,
+        // so the markers are the same as when testing against the whole remaining list.
+        std::vector<int> found;
+
+        for( PCB_LAYER_ID layer : refSeg->GetLayerSet().Seq() )
         {
-            ii = 0;
-            count++;
+            trackIndex.Query( refSeg->GetBoundingBox(), layer,
+                    [&]( BOARD_ITEM* aItem ) -> bool
+                    {
+                        int itemOrder = trackOrder.at( aItem );
 
-            if( progressDialog )
-            {
-                if( !progressDialog->Update( count, wxEmptyString ) )
-                    break;  // Aborted by user
-#ifdef __WXMAC__
-                // Work around a dialog z-order issue on OS X
-                if( count == deltamax )
-                    aActiveWindow->Raise();
-#endif
-            }
+                        if( itemOrder > (int) aIdx )
+                            found.push_back( itemOrder );
+
+                        return true;
+                    } );
         }
 
+        std::sort( found.begin(), found.end() );
+        found.erase( std::unique( found.begin(), found.end() ), found.end() );
+
+        std::vector<TRACK*> candidates;
+
+        for( int idx : found )
+            candidates.push_back( tracks[ idx ] );
+
         // Test new segment against tracks and pads, optionally against copper zones
-        if( !doTrackDrc( *seg_it, seg_it + 1, m_pcb->Tracks().end(), m_doZonesTest ) )
-        {
-            if( m_currentMarker )
-            {
-                addMarkerToPcb ( m_currentMarker );
-                m_currentMarker = nullptr;
-            }
-        }
-    }
+        doTrackDrc( refSeg, candidates.begin(), candidates.end(), m_doZonesTest, markers[aIdx] );
+    };
+
+    // The tracks not tested yet once the user cancels are skipped
+    GetKiCadThreadPool().ParallelFor( tracks.size(), testTrack, reporter.get() );
+
+#ifdef __WXMAC__
+    // Work around a dialog z-order issue on OS X
+    if( reporter )
+        aActiveWindow->Raise();
+#endif
+
+    std::vector<MARKER_PCB*> allMarkers;
 
-    if( progressDialog )
-        progressDialog->Destroy();
+    for( const std::vector<MARKER_PCB*>& trackMarkers : markers )
+        allMarkers.insert( allMarkers.end(), trackMarkers.begin(), trackMarkers.end() );
+
+    addMarkersToPcb( allMarkers );
 }
 
 
@@ -822,9 +981,9 @@ void DRC::testUnconnected()
 
     auto connectivity = m_pcb->GetConnectivity();
 
-    connectivity->Clear();
-    connectivity->Build( m_pcb ); // just in case. This really needs to be reliable.
-    connectivity->RecalculateRatsnest();
+    // Just in case: this really needs to be reliable.  Only the items changed behind the
+    // back of the connectivity are rebuilt.
+    connectivity->Synchronize( m_pcb );
 
     std::vector<CN_EDGE> edges;
     connectivity->GetUnconnectedEdges( edges );
@@ -834,7 +993,7 @@ void DRC::testUnconnected()
         auto src = edge.GetSourcePos();
         auto dst = edge.GetTargetPos();
 
-        m_unconnected.emplace_back( new DRC_ITEM( m_pcbEditorFrame->GetUserUnits(),
+        m_unconnected.emplace_back( new DRC_ITEM( userUnits(),
                                                   DRCE_UNCONNECTED_ITEMS,
                                                   edge.GetSourceNode()->Parent(),
                                                   wxPoint( src.x, src.y ),
@@ -932,15 +1091,15 @@ void DRC::testKeepoutAreas()
 void DRC::testCopperTextAndGraphics()
 {
     // Test copper items for clearance violations with vias, tracks and pads
+    // Gather the items first; each one is then a work item with its own marker buffer.
+    std::vector<BOARD_ITEM*> items;
 
     for( BOARD_ITEM* brdItem : m_pcb->Drawings() )
     {
         if( IsCopperLayer( brdItem->GetLayer() ) )
         {
-            if( brdItem->Type() == PCB_TEXT_T )
-                testCopperTextItem( brdItem );
-            else if( brdItem->Type() == PCB_LINE_T )
-                testCopperDrawItem( static_cast<DRAWSEGMENT*>( brdItem ));
+            if( brdItem->Type() == PCB_TEXT_T || brdItem->Type() == PCB_LINE_T )
+                items.push_back( brdItem );
         }
     }
 
@@ -950,10 +1109,10 @@ void DRC::testCopperTextAndGraphics()
         TEXTE_MODULE& val = module->Value();
 
         if( ref.IsVisible() && IsCopperLayer( ref.GetLayer() ) )
-            testCopperTextItem( &ref );
+            items.push_back( &ref );
 
         if( val.IsVisible() && IsCopperLayer( val.GetLayer() ) )
-            testCopperTextItem( &val );
+            items.push_back( &val );
 
         if( module->IsNetTie() )
             continue;
@@ -963,16 +1122,43 @@ void DRC::testCopperTextAndGraphics()
             if( IsCopperLayer( item->GetLayer() ) )
             {
                 if( item->Type() == PCB_MODULE_TEXT_T && ( (TEXTE_MODULE*) item )->IsVisible() )
-                    testCopperTextItem( item );
+                    items.push_back( item );
                 else if( item->Type() == PCB_MODULE_EDGE_T )
-                    testCopperDrawItem( static_cast<DRAWSEGMENT*>( item ));
+                    items.push_back( item );
             }
         }
     }
+
+    // The pad bounding radius is cached on first use; compute it before the workers
+    // share the pads.
+    std::vector<D_PAD*> pads = m_pcb->GetPads();
+
+    for( D_PAD* pad : pads )
+        pad->GetBoundingRadius();
+
+    std::vector<std::vector<MARKER_PCB*>> markers( items.size() );
+
+    GetKiCadThreadPool().ParallelFor( items.size(),
+            [&]( size_t aIdx )
+            {
+                BOARD_ITEM* item = items[aIdx];
+
+                if( item->Type() == PCB_LINE_T || item->Type() == PCB_MODULE_EDGE_T )
+                    testCopperDrawItem( static_cast<DRAWSEGMENT*>( item ), markers[aIdx] );
+                else
+                    testCopperTextItem( item, markers[aIdx] );
+            } );
+
+    std::vector<MARKER_PCB*> allMarkers;
+
+    for( const std::vector<MARKER_PCB*>& itemMarkers : markers )
+        allMarkers.insert( allMarkers.end(), itemMarkers.begin(), itemMarkers.end() );
+
+    addMarkersToPcb( allMarkers );
 }
 
 
-void DRC::testCopperDrawItem( DRAWSEGMENT* aItem )
+void DRC::testCopperDrawItem( DRAWSEGMENT* aItem, std::vector<MARKER_PCB*>& aMarkers )
 {
     std::vector<SEG> itemShape;
     int itemWidth = aItem->GetWidth();
@@ -1041,10 +1227,10 @@ void DRC::testCopperDrawItem( DRAWSEGMENT* aItem )
             if( trackAsSeg.Distance( itemSeg ) < minDist )
             {
                 if( track->Type() == PCB_VIA_T )
-                    addMarkerToPcb( m_markerFactory.NewMarker(
+                    aMarkers.push_back( m_markerFactory.NewMarker(
                             track, aItem, itemSeg, DRCE_VIA_NEAR_COPPER ) );
                 else
-                    addMarkerToPcb( m_markerFactory.NewMarker(
+                    aMarkers.push_back( m_markerFactory.NewMarker(
                             track, aItem, itemSeg, DRCE_TRACK_NEAR_COPPER ) );
                 break;
             }
@@ -1068,7 +1254,7 @@ void DRC::testCopperDrawItem( DRAWSEGMENT* aItem )
         {
             if( padOutline.Distance( itemSeg, itemWidth ) == 0 )
             {
-                addMarkerToPcb( m_markerFactory.NewMarker( pad, aItem, DRCE_PAD_NEAR_COPPER ) );
+                aMarkers.push_back( m_markerFactory.NewMarker( pad, aItem, DRCE_PAD_NEAR_COPPER ) );
                 break;
             }
         }
@@ -1076,7 +1262,7 @@ void DRC::testCopperDrawItem( DRAWSEGMENT* aItem )
 }
 
 
-void DRC::testCopperTextItem( BOARD_ITEM* aTextItem )
+void DRC::testCopperTextItem( BOARD_ITEM* aTextItem, std::vector<MARKER_PCB*>& aMarkers )
 {
     EDA_TEXT* text = dynamic_cast<EDA_TEXT*>( aTextItem );
 
@@ -1115,10 +1301,10 @@ void DRC::testCopperTextItem( BOARD_ITEM* aTextItem )
             if( trackAsSeg.Distance( textSeg ) < minDist )
             {
                 if( track->Type() == PCB_VIA_T )
-                    addMarkerToPcb( m_markerFactory.NewMarker(
+                    aMarkers.push_back( m_markerFactory.NewMarker(
                             track, aTextItem, textSeg, DRCE_VIA_NEAR_COPPER ) );
                 else
-                    addMarkerToPcb( m_markerFactory.NewMarker(
+                    aMarkers.push_back( m_markerFactory.NewMarker(
                             track, aTextItem, textSeg, DRCE_TRACK_NEAR_COPPER ) );
                 break;
             }
@@ -1150,7 +1336,8 @@ void DRC::testCopperTextItem( BOARD_ITEM* aTextItem )
 
             if( padOutline.Distance( textSeg, 0 ) <= minDist )
             {
-                addMarkerToPcb( m_markerFactory.NewMarker( pad, aTextItem, DRCE_PAD_NEAR_COPPER ) );
+                aMarkers.push_back( m_markerFactory.NewMarker( pad, aTextItem,
+                                                               DRCE_PAD_NEAR_COPPER ) );
                 break;
             }
         }
@@ -1174,7 +1361,7 @@ void DRC::testOutline()
 
 void DRC::testDisabledLayers()
 {
-    BOARD* board = m_pcbEditorFrame->GetBoard();
+    BOARD* board = m_pcb;
     wxCHECK( board, /*void*/ );
     LSET disabledLayers = board->GetEnabledLayers().flip();
 
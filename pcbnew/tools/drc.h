@@ -30,9 +30,11 @@
 #include <geometry/seg.h>
 #include <geometry/shape_poly_set.h>
 #include <memory>
+#include <string>
 #include <vector>
 #include <tools/pcb_tool_base.h>
 #include <drc/drc_marker_factory.h>
+#include <drc/drc_provider.h>
 
 #define OK_DRC  0
 #define BAD_DRC 1
@@ -175,6 +177,16 @@ public:
 typedef std::vector<DRC_ITEM*> DRC_LIST;
 
 
+/**
+ * Time taken by one stage of DRC::RunTests(), e.g. "tracks" or "unconnected".
+ */
+struct DRC_STAGE_TIME
+{
+    std::string m_name;
+    double      m_msecs;
+};
+
+
 /**
  * Design Rule Checker object that performs all the DRC tests.  The output of
  * the checking goes to the BOARD file in the form of two MARKER lists.  Those
@@ -208,30 +220,33 @@ private:
 
     wxString m_rptFilename;
 
-    MARKER_PCB* m_currentMarker;
+    /* The tests are run on several worker threads, so the per-test working variables
+     * below are thread local: each worker has its own copy.
+     */
+    static thread_local MARKER_PCB* m_currentMarker;
 
     /* In DRC functions, many calculations are using coordinates relative
      * to the position of the segment under test (segm to segm DRC, segm to pad DRC
      * Next variables store coordinates relative to the start point of this segment
      */
-    wxPoint m_padToTestPos; // Position of the pad to compare in drc test segm to pad or pad to pad
-    wxPoint m_segmEnd;      // End point of the reference segment (start point = (0,0) )
+    static thread_local wxPoint m_padToTestPos; // Position of the pad to compare in drc test segm to pad or pad to pad
+    static thread_local wxPoint m_segmEnd;      // End point of the reference segment (start point = (0,0) )
 
     /* Some functions are comparing the ref segm to pads or others segments using
      * coordinates relative to the ref segment considered as the X axis
      * so we store the ref segment length (the end point relative to these axis)
      * and the segment orientation (used to rotate other coordinates)
      */
-    double m_segmAngle;     // Ref segm orientation in 0,1 degre
-    int m_segmLength;       // length of the reference segment
+    static thread_local double m_segmAngle;     // Ref segm orientation in 0,1 degre
+    static thread_local int m_segmLength;       // length of the reference segment
 
     /* variables used in checkLine to test DRC segm to segm:
      * define the area relative to the ref segment that does not contains any other segment
      */
-    int                 m_xcliplo;
-    int                 m_ycliplo;
-    int                 m_xcliphi;
-    int                 m_ycliphi;
+    static thread_local int m_xcliplo;
+    static thread_local int m_ycliplo;
+    static thread_local int m_xcliphi;
+    static thread_local int m_ycliphi;
 
     PCB_EDIT_FRAME*     m_pcbEditorFrame;   ///< The pcb frame editor which owns the board
     BOARD*              m_pcb;
@@ -244,6 +259,12 @@ private:
     bool                m_drcRun;
     bool                m_footprintsTested;
 
+    ///> When set, markers are passed to it instead of being committed to the board
+    DRC_PROVIDER::MARKER_HANDLER m_markerHandler;
+
+    ///> Time taken by each stage of the last RunTests()
+    std::vector<DRC_STAGE_TIME> m_stageTimes;
+
 
     ///> Sets up handlers for various events.
     void setTransitions() override;
@@ -253,11 +274,19 @@ private:
      */
     void updatePointers();
 
+    ///> Units used in messages: the editor units, or millimetres without an editor.
+    EDA_UNITS_T userUnits() const;
+
     /**
      * Adds a DRC marker to the PCB through the COMMIT mechanism.
      */
     void addMarkerToPcb( MARKER_PCB* aMarker );
 
+    /**
+     * Adds a list of DRC markers to the PCB, in list order, through a single COMMIT.
+     */
+    void addMarkersToPcb( const std::vector<MARKER_PCB*>& aMarkers );
+
     //-----<categorical group tests>-----------------------------------------
 
     /**
@@ -292,9 +321,10 @@ private:
     void testKeepoutAreas();
 
     // aTextItem is type BOARD_ITEM* to accept either TEXTE_PCB or TEXTE_MODULE
-    void testCopperTextItem( BOARD_ITEM* aTextItem );
+    // The markers are returned in aMarkers, so these can run on a worker thread.
+    void testCopperTextItem( BOARD_ITEM* aTextItem, std::vector<MARKER_PCB*>& aMarkers );
 
-    void testCopperDrawItem( DRAWSEGMENT* aDrawing );
+    void testCopperDrawItem( DRAWSEGMENT* aDrawing, std::vector<MARKER_PCB*>& aMarkers );
 
     void testCopperTextAndGraphics();
 
@@ -331,11 +361,13 @@ private:
      * @param aStartIt the iterator to the first track to test
      * @param aEndIt the marker for the iterator end
      * @param aTestZones true if should do copper zones test. This can be very time consumming
-     * @return bool - true if no problems, else false and m_currentMarker is
-     *          filled in with the problem information.
+     * @param aMarkers receives the markers of the problems found.  They are not added to
+     *                 the board, so this can be called from a worker thread.
+     * @return bool - true if no problems, else false.
      */
-    bool doTrackDrc( TRACK* aRefSeg, TRACKS::iterator aStartIt, TRACKS::iterator aEndIt,
-                     bool aTestZones );
+    bool doTrackDrc( TRACK* aRefSeg, std::vector<TRACK*>::const_iterator aStartIt,
+                     std::vector<TRACK*>::const_iterator aEndIt, bool aTestZones,
+                     std::vector<MARKER_PCB*>& aMarkers );
 
     /**
      * Test for footprint courtyard overlaps.
@@ -448,6 +480,34 @@ public:
      * @param aMessages = a wxTextControl where to display some activity messages. Can be NULL
      */
     void RunTests( wxTextCtrl* aMessages = NULL );
+
+    /**
+     * Run all the tests on a board without the editor frame, the DRC dialog or any
+     * progress dialog, e.g. from a batch runner.
+     *
+     * Zones are only refilled if SetRefillZones() was called, and the footprints are not
+     * tested against the schematic.  This DRC object must not be registered as a tool.
+     *
+     * @param aBoard is the board to test
+     * @param aMarkerHandler receives the markers (and their ownership) instead of the board
+     */
+    void RunTestsHeadless( BOARD* aBoard, DRC_PROVIDER::MARKER_HANDLER aMarkerHandler );
+
+    void SetTestTracksAgainstZones( bool aEnable ) { m_doZonesTest = aEnable; }
+
+    void SetRefillZones( bool aEnable ) { m_refillZones = aEnable; }
+
+    void SetReportAllTrackErrors( bool aEnable ) { m_reportAllTrackErrors = aEnable; }
+
+    /**
+     * @return the unconnected items found by the last run, owned by this DRC object.
+     */
+    const DRC_LIST& GetUnconnectedItems() const { return m_unconnected; }
+
+    /**
+     * @return the time taken by each test stage of the last run, in run order.
+     */
+    const std::vector<DRC_STAGE_TIME>& GetStageTimes() const { return m_stageTimes; }
 };
 
 
@@ -110,23 +110,22 @@ bool poly2segmentDRC( wxPoint* aTref, int aTrefCount, wxPoint aSegStart, wxPoint
 #define PUSH_NEW_MARKER_4( a, b, c, d ) push_back( m_markerFactory.NewMarker( a, b, c, d ) )
 
 
-bool DRC::doTrackDrc( TRACK* aRefSeg, TRACKS::iterator aStartIt, TRACKS::iterator aEndIt,
-                      bool aTestZones )
+bool DRC::doTrackDrc( TRACK* aRefSeg, std::vector<TRACK*>::const_iterator aStartIt,
+                      std::vector<TRACK*>::const_iterator aEndIt, bool aTestZones,
+                      std::vector<MARKER_PCB*>& aMarkers )
 {
     TRACK*    track;
     wxPoint   delta;           // length on X and Y axis of segments
     wxPoint   shape_pos;
 
     std::vector<MARKER_PCB*> markers;
+    std::vector<MARKER_PCB*> zoneMarkers;
 
+    // Zone markers come first: they used to be committed as soon as they were found
     auto commitMarkers = [&]()
     {
-        BOARD_COMMIT commit( m_pcbEditorFrame );
-
-        for( MARKER_PCB* marker : markers )
-            commit.Add( marker );
-
-        commit.Push( wxEmptyString, false, false );
+        aMarkers.insert( aMarkers.end(), zoneMarkers.begin(), zoneMarkers.end() );
+        aMarkers.insert( aMarkers.end(), markers.begin(), markers.end() );
     };
 
     // Returns false if we should return false from call site, or true to continue
@@ -675,7 +674,8 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACKS::iterator aStartIt, TRACKS::iterato
             SHAPE_POLY_SET* outline = const_cast<SHAPE_POLY_SET*>( &zone->GetFilledPolysList() );
 
             if( outline->Distance( refSeg, ref_seg_width ) < clearance )
-                addMarkerToPcb( m_markerFactory.NewMarker( aRefSeg, zone, DRCE_TRACK_NEAR_ZONE ) );
+                zoneMarkers.push_back( m_markerFactory.NewMarker( aRefSeg, zone,
+                                                                  DRCE_TRACK_NEAR_ZONE ) );
         }
     }
 
@@ -730,10 +730,10 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACKS::iterator aStartIt, TRACKS::iterato
     }
 
 
-    if( markers.size() > 0 )
+    if( markers.size() > 0 || zoneMarkers.size() > 0 )
     {
         commitMarkers();
-        return false;
+        return markers.empty();
     }
     else
         return true;
@@ -58,14 +58,20 @@ void ZONE_FILLER_TOOL::CheckAllZones( wxWindow* aCaller )
     if( !getEditFrame<PCB_EDIT_FRAME>()->m_ZoneFillsDirty )
         return;
 
+    ZONE_FILL_CACHE&             fillCache = getEditFrame<PCB_EDIT_FRAME>()->m_ZoneFillCache;
     std::vector<ZONE_CONTAINER*> toFill;
 
+    // Zones no change has reached since their last fill are up to date
     for( auto zone : board()->Zones() )
-        toFill.push_back(zone);
+    {
+        if( !zone->IsFilled() || fillCache.NeedsRefill( zone ) )
+            toFill.push_back( zone );
+    }
 
     BOARD_COMMIT commit( this );
 
     ZONE_FILLER filler( frame()->GetBoard(), &commit );
+    filler.SetFillCache( &fillCache );
     filler.InstallNewProgressReporter( aCaller, _( "Checking Zones" ), 4 );
 
     if( filler.Fill( toFill, true ) )
@@ -85,14 +91,20 @@ void ZONE_FILLER_TOOL::singleShotRefocus( wxIdleEvent& )
 
 void ZONE_FILLER_TOOL::FillAllZones( wxWindow* aCaller )
 {
+    ZONE_FILL_CACHE&             fillCache = getEditFrame<PCB_EDIT_FRAME>()->m_ZoneFillCache;
     std::vector<ZONE_CONTAINER*> toFill;
 
     BOARD_COMMIT commit( this );
 
+    // Zones no change has reached since their last fill are up to date
     for( auto zone : board()->Zones() )
-        toFill.push_back(zone);
+    {
+        if( !zone->IsFilled() || fillCache.NeedsRefill( zone ) )
+            toFill.push_back( zone );
+    }
 
     ZONE_FILLER filler( board(), &commit );
+    filler.SetFillCache( &fillCache );
     filler.InstallNewProgressReporter( aCaller, _( "Fill All Zones" ),  4 );
 
     if( filler.Fill( toFill ) )
@@ -127,6 +139,7 @@ int ZONE_FILLER_TOOL::ZoneFill( const TOOL_EVENT& aEvent )
     }
 
     ZONE_FILLER filler( board(), &commit );
+    filler.SetFillCache( &getEditFrame<PCB_EDIT_FRAME>()->m_ZoneFillCache );
     filler.InstallNewProgressReporter( frame(), _( "Fill Zone" ), 4 );
     filler.Fill( toFill );
 
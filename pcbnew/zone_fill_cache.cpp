@@ -0,0 +1,241 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_zone.h>
+
+#include "zone_fill_cache.h"
+
+
+ZONE_FILL_CACHE::ZONE_FILL_CACHE() :
+    m_firstSeq( 0 ), m_recording( true ), m_changesRecorded( false )
+{
+}
+
+
+void ZONE_FILL_CACHE::AddDirtyItem( const BOARD_ITEM* aItem )
+{
+    if( !m_recording || !aItem )
+        return;
+
+    switch( aItem->Type() )
+    {
+    case PCB_MARKER_T:
+        // Markers are not part of the copper
+        break;
+
+    case PCB_MODULE_T:
+    {
+        const MODULE* module = static_cast<const MODULE*>( aItem );
+
+        for( const D_PAD* pad : module->Pads() )
+            AddDirtyItem( pad );
+
+        for( const BOARD_ITEM* item : module->GraphicalItems() )
+            AddDirtyItem( item );
+
+        AddDirtyItem( &module->Reference() );
+        AddDirtyItem( &module->Value() );
+        break;
+    }
+
+    case PCB_PAD_T:
+    {
+        const D_PAD* pad = static_cast<const D_PAD*>( aItem );
+        LSET layers = pad->GetLayerSet() & LSET::AllCuMask();
+
+        // The hole of a pad is knocked out on every copper layer
+        if( pad->GetDrillSize().x > 0 || pad->GetDrillSize().y > 0 )
+            layers = LSET::AllCuMask();
+
+        addDirtyArea( pad, layers, std::max( pad->GetClearance(), pad->GetThermalGap() ) );
+        break;
+    }
+
+    case PCB_ZONE_AREA_T:
+    {
+        const ZONE_CONTAINER* zone = static_cast<const ZONE_CONTAINER*>( aItem );
+
+        InvalidateZone( zone );
+        addDirtyArea( zone, zone->GetLayerSet() & LSET::AllCuMask(), zone->GetClearance() );
+        break;
+    }
+
+    default:
+        // The board outline clips every zone: there is no way to localise its changes
+        if( aItem->IsOnLayer( Edge_Cuts ) )
+        {
+            InvalidateAll();
+            break;
+        }
+
+        if( aItem->IsConnected() )
+        {
+            const BOARD_CONNECTED_ITEM* item = static_cast<const BOARD_CONNECTED_ITEM*>( aItem );
+            addDirtyArea( item, item->GetLayerSet() & LSET::AllCuMask(), item->GetClearance() );
+        }
+        else
+        {
+            addDirtyArea( aItem, aItem->GetLayerSet() & LSET::AllCuMask(), 0 );
+        }
+
+        break;
+    }
+}
+
+
+void ZONE_FILL_CACHE::addDirtyArea( const BOARD_ITEM* aItem, LSET aLayers, int aClearance )
+{
+    if( aLayers.none() )
+        return;
+
+    EDA_RECT bbox = aItem->GetBoundingBox();
+    bbox.Normalize();
+
+    std::lock_guard<std::mutex> guard( m_lock );
+
+    // Nothing is cached, so nobody is interested in this change
+    if( m_zones.empty() )
+        return;
+
+    m_dirtyAreas.push_back( { bbox, aLayers, aClearance } );
+}
+
+
+void ZONE_FILL_CACHE::InvalidateAll()
+{
+    std::lock_guard<std::mutex> guard( m_lock );
+
+    m_zones.clear();
+    m_firstSeq += m_dirtyAreas.size();
+    m_dirtyAreas.clear();
+}
+
+
+void ZONE_FILL_CACHE::InvalidateZone( const ZONE_CONTAINER* aZone )
+{
+    std::lock_guard<std::mutex> guard( m_lock );
+
+    m_zones.erase( aZone );
+    compact();
+}
+
+
+bool ZONE_FILL_CACHE::collectDirtyAreas( size_t aMark, PCB_LAYER_ID aLayer,
+                                         const EDA_RECT& aBBox, int aClearance,
+                                         std::vector<EDA_RECT>* aAreas ) const
+{
+    bool found = false;
+
+    for( size_t seq = std::max( aMark, m_firstSeq ); seq < m_firstSeq + m_dirtyAreas.size(); ++seq )
+    {
+        const DIRTY_AREA& area = m_dirtyAreas[ seq - m_firstSeq ];
+
+        if( !area.m_layers[ aLayer ] )
+            continue;
+
+        EDA_RECT bbox = area.m_bbox;
+        bbox.Inflate( std::max( area.m_clearance, aClearance ) );
+
+        if( !bbox.Intersects( aBBox ) )
+            continue;
+
+        found = true;
+
+        if( !aAreas )
+            break;
+
+        aAreas->push_back( bbox );
+    }
+
+    return found;
+}
+
+
+bool ZONE_FILL_CACHE::NeedsRefill( const ZONE_CONTAINER* aZone ) const
+{
+    std::lock_guard<std::mutex> guard( m_lock );
+
+    auto it = m_zones.find( aZone );
+
+    if( it == m_zones.end() )
+        return true;
+
+    // Thermal reliefs reach as far as the thermal gap, other items as far as the clearance
+    int margin = std::max( aZone->GetClearance(), aZone->GetThermalReliefGap() );
+
+    return collectDirtyAreas( it->second.m_mark, aZone->GetLayer(), aZone->GetBoundingBox(),
+                              margin, nullptr );
+}
+
+
+bool ZONE_FILL_CACHE::GetCachedHoles( const ZONE_CONTAINER* aZone, int aClearance,
+                                      SHAPE_POLY_SET& aHoles,
+                                      std::vector<EDA_RECT>& aDirtyAreas ) const
+{
+    std::lock_guard<std::mutex> guard( m_lock );
+
+    auto it = m_zones.find( aZone );
+
+    if( it == m_zones.end() )
+        return false;
+
+    EDA_RECT bbox = aZone->GetBoundingBox();
+    bbox.Inflate( aClearance );
+
+    aHoles = it->second.m_holes;
+    collectDirtyAreas( it->second.m_mark, aZone->GetLayer(), bbox, aClearance, &aDirtyAreas );
+
+    return true;
+}
+
+
+void ZONE_FILL_CACHE::StoreHoles( const ZONE_CONTAINER* aZone, const SHAPE_POLY_SET& aHoles )
+{
+    std::lock_guard<std::mutex> guard( m_lock );
+
+    ZONE_ENTRY& entry = m_zones[ aZone ];
+    entry.m_holes = aHoles;
+    entry.m_mark = m_firstSeq + m_dirtyAreas.size();
+
+    compact();
+}
+
+
+void ZONE_FILL_CACHE::compact()
+{
+    size_t oldest = m_firstSeq + m_dirtyAreas.size();
+
+    for( const auto& entry : m_zones )
+        oldest = std::min( oldest, entry.second.m_mark );
+
+    while( m_firstSeq < oldest && !m_dirtyAreas.empty() )
+    {
+        m_dirtyAreas.pop_front();
+        m_firstSeq++;
+    }
+}
@@ -0,0 +1,155 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __ZONE_FILL_CACHE_H
+#define __ZONE_FILL_CACHE_H
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <eda_rect.h>
+#include <layers_id_colors_and_visibility.h>
+#include <geometry/shape_poly_set.h>
+
+class BOARD_ITEM;
+class ZONE_CONTAINER;
+
+
+/**
+ * Class ZONE_FILL_CACHE
+ *
+ * Remembers which parts of the board have been touched by BOARD_COMMITs since each zone
+ * was last filled, together with the copper clearance holes computed for that zone.
+ *
+ * It allows ZONE_FILLER to refill only the zones a change can have affected, and to
+ * rebuild the clearance holes of those zones only inside the changed areas: the holes
+ * outside of the dirty areas are by construction the same as in the previous fill.
+ *
+ * Any change which cannot be localised (undo/redo, design rules, board outline, ...)
+ * must call InvalidateAll(), which falls back to refilling every zone from scratch.
+ */
+class ZONE_FILL_CACHE
+{
+public:
+    ZONE_FILL_CACHE();
+
+    /**
+     * Function AddDirtyItem
+     * Records the area covered by aItem (with its clearance) as changed.  Modified items
+     * have to be recorded twice: once in their old state and once in their new one.
+     */
+    void AddDirtyItem( const BOARD_ITEM* aItem );
+
+    /**
+     * Function InvalidateAll
+     * Forgets every cached zone, so that the next fill is a full one.
+     */
+    void InvalidateAll();
+
+    /**
+     * Function InvalidateZone
+     * Forgets the data cached for a zone whose outline or settings have changed.
+     */
+    void InvalidateZone( const ZONE_CONTAINER* aZone );
+
+    /**
+     * Function NeedsRefill
+     * @return true if aZone has never been filled through this cache, or if an item changed
+     * since then on its layer close enough to affect its fill.
+     */
+    bool NeedsRefill( const ZONE_CONTAINER* aZone ) const;
+
+    /**
+     * Function GetCachedHoles
+     * Fetches the clearance holes computed for aZone by the last fill, and the areas in
+     * which they are out of date (already inflated by aClearance, the biggest clearance
+     * an item can have to this zone).
+     * @return false if nothing is cached for aZone.
+     */
+    bool GetCachedHoles( const ZONE_CONTAINER* aZone, int aClearance, SHAPE_POLY_SET& aHoles,
+                         std::vector<EDA_RECT>& aDirtyAreas ) const;
+
+    /**
+     * Function StoreHoles
+     * Caches the clearance holes just computed for aZone, which is up to date from now on.
+     */
+    void StoreHoles( const ZONE_CONTAINER* aZone, const SHAPE_POLY_SET& aHoles );
+
+    /**
+     * Function SetRecording
+     * Disables the recording of dirty items, e.g. while the zone filler commits the new
+     * fills (which do not change any zone outline).
+     */
+    void SetRecording( bool aRecording )        { m_recording = aRecording; }
+
+    /**
+     * Functions SetChangesRecorded / TakeChangesRecorded
+     * BOARD_COMMIT flags the board modification it is about to report as already recorded,
+     * so PCB_EDIT_FRAME::OnModify() does not have to invalidate the whole cache.
+     */
+    void SetChangesRecorded()                   { m_changesRecorded = true; }
+
+    bool TakeChangesRecorded()
+    {
+        bool recorded = m_changesRecorded;
+        m_changesRecorded = false;
+        return recorded;
+    }
+
+private:
+    struct DIRTY_AREA
+    {
+        EDA_RECT m_bbox;        // item bounding box
+        LSET     m_layers;      // copper layers the item can knock out
+        int      m_clearance;   // the item own clearance
+    };
+
+    struct ZONE_ENTRY
+    {
+        SHAPE_POLY_SET m_holes; // clearance holes of the last fill
+        size_t         m_mark;  // sequence number of the first dirty area not in m_holes
+    };
+
+    void addDirtyArea( const BOARD_ITEM* aItem, LSET aLayers, int aClearance );
+
+    ///> Finds the areas recorded since aMark which touch aBBox on aLayer once inflated by
+    ///> the clearance.  Stops at the first one if aAreas is null.
+    bool collectDirtyAreas( size_t aMark, PCB_LAYER_ID aLayer, const EDA_RECT& aBBox,
+                            int aClearance, std::vector<EDA_RECT>* aAreas ) const;
+
+    ///> Drops the dirty areas which are older than every cached zone
+    void compact();
+
+    std::deque<DIRTY_AREA>                         m_dirtyAreas;
+    size_t                                         m_firstSeq;     // seq of m_dirtyAreas[0]
+    std::map<const ZONE_CONTAINER*, ZONE_ENTRY>    m_zones;
+    bool                                           m_recording;
+    bool                                           m_changesRecorded;
+
+    // Zones are filled on several threads
+    mutable std::mutex                             m_lock;
+};
+
+#endif
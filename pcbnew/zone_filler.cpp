@@ -24,10 +24,11 @@
  */
 
 #include <cstdint>
-#include <thread>
+#include <cstring>
 #include <mutex>
 #include <algorithm>
-#include <future>
+#include <cmath>
+#include <functional>
 
 #include <class_board.h>
 #include <class_zone.h>
@@ -40,6 +41,7 @@
 
 #include <connectivity/connectivity_data.h>
 #include <board_commit.h>
+#include <drc/drc_rtree.h>
 
 #include <widgets/progress_reporter.h>
 
@@ -47,10 +49,14 @@
 #include <geometry/shape_file_io.h>
 #include <geometry/convex_hull.h>
 #include <geometry/geometry_utils.h>
+#include <math/math_util.h>
+#include <thread_pool.h>
 #include <confirm.h>
+#include <macros.h>
 #include <convert_to_biu.h>
 
 #include "zone_filler.h"
+#include "zone_fill_cache.h"
 
 #include <advanced_config.h>        // To be removed later, when the zone fill option will be always allowed
 
@@ -79,10 +85,56 @@ private:
 static const double s_RoundPadThermalSpokeAngle = 450;
 static const bool s_DumpZonesWhenFilling = false;
 
+// Zones with fewer clearance hole vertices than this are not split in tiles
+static const int s_TiledFillMinVertices = 20000;
+
+// Must be changed whenever the fill algorithm changes, so that the fills saved by an older
+// version are not mistaken for up to date ones
+static const int s_FillAlgorithmVersion = 2;
+
+
+static SHAPE_LINE_CHAIN rectOutline( int aLeft, int aTop, int aRight, int aBottom )
+{
+    SHAPE_LINE_CHAIN rect;
+
+    rect.Append( aLeft, aTop );
+    rect.Append( aRight, aTop );
+    rect.Append( aRight, aBottom );
+    rect.Append( aLeft, aBottom );
+    rect.SetClosed( true );
+
+    return rect;
+}
+
+
+/**
+ * Returns the distance the zone areas are deflated then inflated by to remove the features
+ * thinner than the zone min width (0 for none), and the parameters of these operations.
+ */
+static int getPruneParams( const ZONE_CONTAINER* aZone, int aMaxError, int& aNumSegs,
+                           SHAPE_POLY_SET::CORNER_STRATEGY& aCornerStrategy )
+{
+    // Features which are min_width should survive pruning; features that are *less* than
+    // min_width should not.  Therefore we subtract epsilon from the min_width when
+    // deflating/inflating.
+    int half_min_width = aZone->GetMinThickness() / 2;
+    int epsilon = Millimeter2iu( 0.001 );
+
+    aNumSegs = std::max( GetArcToSegmentCount( half_min_width, aMaxError, 360.0 ), 6 );
+    aCornerStrategy = SHAPE_POLY_SET::CHOP_ACUTE_CORNERS;
+
+    if( aZone->GetCornerSmoothingType() == ZONE_SETTINGS::SMOOTHING_FILLET )
+        aCornerStrategy = SHAPE_POLY_SET::ROUND_ACUTE_CORNERS;
+
+    return half_min_width - epsilon > epsilon ? half_min_width - epsilon : 0;
+}
+
 
 ZONE_FILLER::ZONE_FILLER(  BOARD* aBoard, COMMIT* aCommit ) :
     m_board( aBoard ), m_brdOutlinesValid( false ), m_commit( aCommit ),
-    m_progressReporter( nullptr )
+    m_fillCache( nullptr ), m_progressReporter( nullptr ),
+    m_tiledFillMinVertices( s_TiledFillMinVertices ), m_tiledFillGridSize( 0 ),
+    m_walkWholeBoard( false )
 {
 }
 
@@ -121,12 +173,24 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
     m_boardOutline.RemoveAllContours();
     m_brdOutlinesValid = m_board->GetBoardPolygonOutlines( m_boardOutline );
 
+    buildItemIndex();
+
+    std::vector<std::string> inputHashes;
+
     for( auto zone : aZones )
     {
         // Keepout zones are not filled
         if( zone->GetIsKeepout() )
             continue;
 
+        // Nothing the fill depends on changed since the zone was last filled
+        std::string inputHash = computeFillInputHash( zone );
+
+        if( zone->IsFilled() && zone->GetFillInputHash() == inputHash )
+            continue;
+
+        inputHashes.push_back( inputHash );
+
         if( m_commit )
             m_commit->Modify( zone );
 
@@ -142,54 +206,34 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
         zone->UnFill();
     }
 
-    std::atomic<size_t> nextItem( 0 );
-    size_t              parallelThreadCount =
-            std::min<size_t>( std::thread::hardware_concurrency(), aZones.size() );
-    std::vector<std::future<size_t>> returns( parallelThreadCount );
-
-    auto fill_lambda = [&] ( PROGRESS_REPORTER* aReporter ) -> size_t
+    GetKiCadThreadPool().ParallelFor( toFill.size(),
+            [&]( size_t i )
+            {
+                ZONE_CONTAINER* zone = toFill[i].m_zone;
+                zone->SetFilledPolysUseThickness( filledPolyWithOutline );
+                SHAPE_POLY_SET rawPolys, finalPolys;
+                fillSingleZone( zone, rawPolys, finalPolys );
+
+                zone->SetRawPolysList( rawPolys );
+                zone->SetFilledPolysList( finalPolys );
+                zone->SetIsFilled( true );
+                zone->SetFillInputHash( inputHashes[i] );
+            },
+            m_progressReporter );
+
+    // The zones not filled yet would be left empty
+    if( m_progressReporter && m_progressReporter->IsCancelled() )
     {
-        size_t num = 0;
+        if( m_commit )
+            m_commit->Revert();
 
-        for( size_t i = nextItem++; i < toFill.size(); i = nextItem++ )
+        if( m_fillCache )
         {
-            ZONE_CONTAINER* zone = toFill[i].m_zone;
-            zone->SetFilledPolysUseThickness( filledPolyWithOutline );
-            SHAPE_POLY_SET rawPolys, finalPolys;
-            fillSingleZone( zone, rawPolys, finalPolys );
-
-            zone->SetRawPolysList( rawPolys );
-            zone->SetFilledPolysList( finalPolys );
-            zone->SetIsFilled( true );
-
-            if( m_progressReporter )
-                m_progressReporter->AdvanceProgress();
-
-            num++;
+            for( auto& zone : toFill )
+                m_fillCache->InvalidateZone( zone.m_zone );
         }
 
-        return num;
-    };
-
-    if( parallelThreadCount <= 1 )
-        fill_lambda( m_progressReporter );
-    else
-    {
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii] = std::async( std::launch::async, fill_lambda, m_progressReporter );
-
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-        {
-            // Here we balance returns with a 100ms timeout to allow UI updating
-            std::future_status status;
-            do
-            {
-                if( m_progressReporter )
-                    m_progressReporter->KeepRefreshing();
-
-                status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
-            } while( status != std::future_status::ready );
-        }
+        return false;
     }
 
     // Now update the connectivity to check for copper islands
@@ -263,6 +307,13 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
             if( m_commit )
                 m_commit->Revert();
 
+            // The old fills are kept, so these zones are still to be refilled
+            if( m_fillCache )
+            {
+                for( auto& zone : toFill )
+                    m_fillCache->InvalidateZone( zone.m_zone );
+            }
+
             connectivity->SetProgressReporter( nullptr );
             return false;
         }
@@ -276,44 +327,12 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
     }
 
 
-    nextItem = 0;
-
-    auto tri_lambda = [&] ( PROGRESS_REPORTER* aReporter ) -> size_t
-    {
-        size_t num = 0;
-
-        for( size_t i = nextItem++; i < toFill.size(); i = nextItem++ )
-        {
-            toFill[i].m_zone->CacheTriangulation();
-            num++;
-
-            if( m_progressReporter )
-                m_progressReporter->AdvanceProgress();
-        }
-
-        return num;
-    };
-
-    if( parallelThreadCount <= 1 )
-        tri_lambda( m_progressReporter );
-    else
-    {
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii] = std::async( std::launch::async, tri_lambda, m_progressReporter );
-
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-        {
-            // Here we balance returns with a 100ms timeout to allow UI updating
-            std::future_status status;
-            do
+    GetKiCadThreadPool().ParallelFor( toFill.size(),
+            [&]( size_t i )
             {
-                if( m_progressReporter )
-                    m_progressReporter->KeepRefreshing();
-
-                status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
-            } while( status != std::future_status::ready );
-        }
-    }
+                toFill[i].m_zone->CacheTriangulation();
+            },
+            m_progressReporter );
 
     if( m_progressReporter )
     {
@@ -326,7 +345,14 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
 
     if( m_commit )
     {
+        // New fills do not change the areas the other zones have to be refilled in
+        if( m_fillCache )
+            m_fillCache->SetRecording( false );
+
         m_commit->Push( _( "Fill Zone(s)" ), false );
+
+        if( m_fillCache )
+            m_fillCache->SetRecording( true );
     }
     else
     {
@@ -469,14 +495,364 @@ void ZONE_FILLER::addKnockout( BOARD_ITEM* aItem, int aGap, bool aIgnoreLineWidt
 }
 
 
+void ZONE_FILLER::buildItemIndex()
+{
+    BOARD_DESIGN_SETTINGS& bds = m_board->GetDesignSettings();
+    int biggest_clearance = bds.GetBiggestClearanceValue();
+
+    m_itemIndex.reset( new DRC_RTREE() );
+
+    for( auto module : m_board->Modules() )
+    {
+        for( auto pad : module->Pads() )
+        {
+            LSET layers = pad->GetLayerSet() & LSET::AllCuMask();
+
+            // The thermal relief of a pad can reach further than its clearance
+            int  inflate = std::max( pad->GetClearance(), pad->GetThermalGap() );
+
+            // The hole of a pad is knocked out of the zones of every copper layer, with
+            // the netclass clearance
+            if( pad->GetDrillSize().x > 0 || pad->GetDrillSize().y > 0 )
+            {
+                layers = LSET::AllCuMask();
+                inflate = std::max( inflate, biggest_clearance )
+                          + std::max( pad->GetDrillSize().x, pad->GetDrillSize().y );
+            }
+
+            m_itemIndex->Insert( pad, inflate, layers );
+        }
+
+        m_itemIndex->Insert( &module->Reference() );
+        m_itemIndex->Insert( &module->Value() );
+
+        for( auto item : module->GraphicalItems() )
+            m_itemIndex->Insert( item );
+    }
+
+    for( auto track : m_board->Tracks() )
+        m_itemIndex->Insert( track );
+
+    for( auto item : m_board->Drawings() )
+        m_itemIndex->Insert( item );
+}
+
+
 /**
- * Removes thermal reliefs from the shape for any pads connected to the zone.  Does NOT add
- * in spokes, which must be done later.
+ * Feeds the inputs of a zone fill to a MD5 digest in a canonical form: integers as 64 bit
+ * little endian values, doubles by their IEEE 754 bits and texts as length prefixed UTF-8.
+ * The digest is saved in the board files, so it must not depend on the platform, the
+ * compiler or its standard library.
  */
-void ZONE_FILLER::knockoutThermalReliefs( const ZONE_CONTAINER* aZone, SHAPE_POLY_SET& aFill )
+class FILL_INPUT_DIGEST
 {
-    SHAPE_POLY_SET holes;
+public:
+    void AddInt( int64_t aValue )
+    {
+        uint8_t bytes[8];
+
+        for( int i = 0; i < 8; ++i )
+            bytes[i] = (uint8_t) ( (uint64_t) aValue >> ( 8 * i ) );
+
+        m_md5.Hash( bytes, sizeof( bytes ) );
+    }
+
+    void AddDouble( double aValue )
+    {
+        static_assert( sizeof( double ) == sizeof( uint64_t ), "double is not 64 bits wide" );
+
+        uint64_t bits;
+        memcpy( &bits, &aValue, sizeof( bits ) );
+        AddInt( (int64_t) bits );
+    }
+
+    void AddPoint( const wxPoint& aPoint )
+    {
+        AddInt( aPoint.x );
+        AddInt( aPoint.y );
+    }
+
+    void AddText( const std::string& aText )
+    {
+        AddInt( aText.size() );
+        m_md5.Hash( (uint8_t*) aText.data(), aText.size() );
+    }
+
+    void AddText( const wxString& aText )
+    {
+        AddText( std::string( TO_UTF8( aText ) ) );
+    }
+
+    void AddChain( const SHAPE_LINE_CHAIN& aChain )
+    {
+        AddInt( aChain.PointCount() );
+
+        for( int i = 0; i < aChain.PointCount(); ++i )
+        {
+            AddInt( aChain.CPoint( i ).x );
+            AddInt( aChain.CPoint( i ).y );
+        }
+    }
+
+    void AddPolySet( const SHAPE_POLY_SET& aPolys )
+    {
+        AddInt( aPolys.OutlineCount() );
+
+        for( int i = 0; i < aPolys.OutlineCount(); ++i )
+        {
+            AddChain( aPolys.COutline( i ) );
+            AddInt( aPolys.HoleCount( i ) );
+
+            for( int j = 0; j < aPolys.HoleCount( i ); ++j )
+                AddChain( aPolys.CHole( i, j ) );
+        }
+    }
+
+    /// @return the digest, as 32 hexadecimal digits
+    std::string Finish()
+    {
+        m_md5.Finalize();
+        return m_md5.Format();
+    }
+
+private:
+    MD5_HASH m_md5;
+};
+
+
+/**
+ * Adds to aDigest the zone settings and outline its own fill and the fill of the lower
+ * priority zones depend on.
+ */
+static void digestZone( FILL_INPUT_DIGEST& aDigest, const ZONE_CONTAINER* aZone )
+{
+    aDigest.AddInt( aZone->Type() );
+    aDigest.AddInt( aZone->GetLayerSet().to_ullong() );
+    aDigest.AddInt( aZone->GetNetCode() );
+    aDigest.AddInt( aZone->GetPriority() );
+    aDigest.AddInt( aZone->GetIsKeepout() );
+    aDigest.AddInt( aZone->GetDoNotAllowCopperPour() );
+    aDigest.AddInt( aZone->GetDoNotAllowVias() );
+    aDigest.AddInt( aZone->GetDoNotAllowTracks() );
+    aDigest.AddInt( aZone->GetPadConnection() );
+    aDigest.AddInt( aZone->GetFillMode() );
+    aDigest.AddInt( aZone->GetZoneClearance() );
+    aDigest.AddInt( aZone->GetClearance() );
+    aDigest.AddInt( aZone->GetMinThickness() );
+    aDigest.AddInt( aZone->GetFilledPolysUseThickness() );
+    aDigest.AddInt( aZone->GetThermalReliefGap() );
+    aDigest.AddInt( aZone->GetThermalReliefCopperBridge() );
+    aDigest.AddInt( aZone->GetCornerSmoothingType() );
+    aDigest.AddInt( aZone->GetCornerRadius() );
+    aDigest.AddInt( aZone->GetHatchFillTypeThickness() );
+    aDigest.AddInt( aZone->GetHatchFillTypeGap() );
+    aDigest.AddDouble( aZone->GetHatchFillTypeOrientation() );
+    aDigest.AddInt( aZone->GetHatchFillTypeSmoothingLevel() );
+    aDigest.AddDouble( aZone->GetHatchFillTypeSmoothingValue() );
+    aDigest.AddPolySet( *aZone->Outline() );
+}
+
+
+/**
+ * @return the digest of the shape, position and clearance of an item which can be knocked
+ * out of a zone or connected to it, or an empty string if the fill does not depend on
+ * this kind of item.  The footprint items are digested by their position on the board.
+ */
+static std::string digestFillItem( const BOARD_ITEM* aItem )
+{
+    FILL_INPUT_DIGEST digest;
+
+    digest.AddInt( aItem->Type() );
+    digest.AddInt( aItem->GetLayerSet().to_ullong() );
+
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:
+    {
+        const D_PAD* pad = static_cast<const D_PAD*>( aItem );
+
+        digest.AddInt( pad->GetNetCode() );
+        digest.AddInt( pad->GetShape() );
+        digest.AddInt( pad->GetDrillShape() );
+        digest.AddPoint( pad->GetPosition() );
+        digest.AddDouble( pad->GetOrientation() );
+        digest.AddPoint( wxPoint( pad->GetSize() ) );
+        digest.AddPoint( wxPoint( pad->GetDrillSize() ) );
+        digest.AddPoint( pad->GetOffset() );
+        digest.AddPoint( wxPoint( pad->GetDelta() ) );
+        digest.AddInt( pad->GetClearance() );
+        digest.AddInt( pad->GetZoneConnection() );
+        digest.AddInt( pad->GetThermalGap() );
+        digest.AddInt( pad->GetThermalWidth() );
+        digest.AddDouble( pad->GetRoundRectRadiusRatio() );
+        digest.AddDouble( pad->GetChamferRectRatio() );
+        digest.AddInt( pad->GetChamferPositions() );
+        digest.AddInt( pad->GetCustomShapeInZoneOpt() );
+
+        if( pad->GetShape() == PAD_SHAPE_CUSTOM )
+            digest.AddPolySet( pad->GetCustomShapeAsPolygon() );
+
+        break;
+    }
+
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+    {
+        const TRACK* track = static_cast<const TRACK*>( aItem );
+
+        digest.AddInt( track->GetNetCode() );
+        digest.AddInt( track->GetWidth() );
+        digest.AddPoint( track->GetStart() );
+        digest.AddPoint( track->GetEnd() );
+        digest.AddInt( track->GetClearance() );
+
+        if( track->Type() == PCB_VIA_T )
+        {
+            const VIA* via = static_cast<const VIA*>( track );
+
+            digest.AddInt( via->GetViaType() );
+            digest.AddInt( via->GetDrillValue() );
+        }
+
+        break;
+    }
+
+    case PCB_MODULE_TEXT_T:
+    case PCB_TEXT_T:
+    {
+        const EDA_TEXT* text = dynamic_cast<const EDA_TEXT*>( aItem );
+
+        digest.AddText( text->GetShownText() );
+        digest.AddInt( text->IsVisible() );
+        digest.AddInt( text->IsItalic() );
+        digest.AddInt( text->IsBold() );
+        digest.AddInt( text->IsMirrored() );
+        digest.AddPoint( wxPoint( text->GetTextSize() ) );
+        digest.AddInt( text->GetThickness() );
+        digest.AddInt( text->GetHorizJustify() );
+        digest.AddInt( text->GetVertJustify() );
+        digest.AddPoint( text->GetTextPos() );
+
+        // The module text angle is relative to its footprint
+        if( aItem->Type() == PCB_MODULE_TEXT_T )
+            digest.AddDouble( static_cast<const TEXTE_MODULE*>( aItem )->GetDrawRotation() );
+        else
+            digest.AddDouble( text->GetTextAngle() );
+
+        break;
+    }
+
+    case PCB_LINE_T:
+    case PCB_MODULE_EDGE_T:
+    {
+        const DRAWSEGMENT* segment = static_cast<const DRAWSEGMENT*>( aItem );
+
+        digest.AddInt( segment->GetShape() );
+        digest.AddInt( segment->GetWidth() );
+        digest.AddPoint( segment->GetStart() );
+        digest.AddPoint( segment->GetEnd() );
+        digest.AddDouble( segment->GetAngle() );
+
+        for( const wxPoint& pt : segment->GetBezierPoints() )
+            digest.AddPoint( pt );
+
+        // The polygon of a footprint graphic is placed by its footprint
+        if( segment->GetShape() == S_POLYGON )
+        {
+            if( MODULE* module = segment->GetParentModule() )
+            {
+                digest.AddPoint( module->GetPosition() );
+                digest.AddDouble( module->GetOrientation() );
+            }
+
+            digest.AddPolySet( segment->GetPolyShape() );
+        }
+
+        break;
+    }
+
+    default:
+        // Other items (dimensions, targets...) are not knocked out
+        return std::string();
+    }
+
+    return digest.Finish();
+}
+
+
+std::string ZONE_FILLER::computeFillInputHash( const ZONE_CONTAINER* aZone ) const
+{
+    const BOARD_DESIGN_SETTINGS& bds = m_board->GetDesignSettings();
+
+    FILL_INPUT_DIGEST digest;
+
+    digest.AddInt( s_FillAlgorithmVersion );
+    digestZone( digest, aZone );
+    digest.AddInt( bds.m_MaxError );
+    digest.AddInt( bds.m_CopperEdgeClearance );
+    digest.AddInt( bds.m_ZoneUseNoOutlineInFill );
+
+    // Every zone is clipped by the board outline
+    digest.AddInt( m_brdOutlinesValid );
+
+    if( m_brdOutlinesValid )
+        digest.AddPolySet( m_boardOutline );
+
+    // The items which can be knocked out of the zone or connected to it by a thermal relief.
+    // They are visited in no particular order, so their digests are sorted before being
+    // added to the zone's one.
+    std::vector<std::string> itemDigests;
+    EDA_RECT bbox = aZone->GetBoundingBox();
+    bbox.Inflate( std::max( bds.GetBiggestClearanceValue(), aZone->GetClearance() )
+                  + aZone->GetThermalReliefGap() + aZone->GetThermalReliefCopperBridge() );
+
+    auto visitor = [&]( BOARD_ITEM* aItem ) -> bool
+    {
+        std::string itemDigest = digestFillItem( aItem );
+
+        if( !itemDigest.empty() )
+            itemDigests.push_back( std::move( itemDigest ) );
+
+        return true;
+    };
+
+    m_itemIndex->Query( bbox, aZone->GetLayer(), visitor );
+    m_itemIndex->Query( bbox, Edge_Cuts, visitor );
+
+    // The higher priority zones and the keepouts are knocked out too
+    for( ZONE_CONTAINER* zone : m_board->GetZoneList( true ) )
+    {
+        if( zone == aZone || !aZone->CommonLayerExists( zone->GetLayerSet() ) )
+            continue;
+
+        if( !zone->GetIsKeepout() && zone->GetPriority() <= aZone->GetPriority() )
+            continue;
 
+        if( !zone->GetBoundingBox().Intersects( bbox ) )
+            continue;
+
+        FILL_INPUT_DIGEST zoneDigest;
+        digestZone( zoneDigest, zone );
+        itemDigests.push_back( zoneDigest.Finish() );
+    }
+
+    std::sort( itemDigests.begin(), itemDigests.end() );
+
+    digest.AddInt( itemDigests.size() );
+
+    for( const std::string& itemDigest : itemDigests )
+        digest.AddText( itemDigest );
+
+    return digest.Finish();
+}
+
+
+/**
+ * Builds the thermal reliefs to remove from the shape for any pads connected to the zone.
+ * Does NOT add in spokes, which must be done later.
+ */
+void ZONE_FILLER::buildThermalReliefHoles( const ZONE_CONTAINER* aZone, SHAPE_POLY_SET& aHoles )
+{
     // Use a dummy pad to calculate relief when a pad has a hole but is not on the zone's
     // copper layer.  The dummy pad has the size and shape of the original pad's hole. We have
     // to give it a parent because some functions expect a non-null parent to find clearance
@@ -502,12 +878,11 @@ void ZONE_FILLER::knockoutThermalReliefs( const ZONE_CONTAINER* aZone, SHAPE_POL
                 pad = &dummypad;
             }
 
-            addKnockout( pad, aZone->GetThermalReliefGap( pad ), holes );
+            addKnockout( pad, aZone->GetThermalReliefGap( pad ), aHoles );
         }
     }
 
-    holes.Simplify( SHAPE_POLY_SET::PM_FAST );
-    aFill.BooleanSubtract( holes, SHAPE_POLY_SET::PM_FAST );
+    aHoles.Simplify( SHAPE_POLY_SET::PM_FAST );
 }
 
 
@@ -515,7 +890,8 @@ void ZONE_FILLER::knockoutThermalReliefs( const ZONE_CONTAINER* aZone, SHAPE_POL
  * Removes clearance from the shape for copper items which share the zone's layer but are
  * not connected to it.
  */
-void ZONE_FILLER::buildCopperItemClearances( const ZONE_CONTAINER* aZone, SHAPE_POLY_SET& aHoles )
+void ZONE_FILLER::buildCopperItemClearances( const ZONE_CONTAINER* aZone, SHAPE_POLY_SET& aHoles,
+                                              const std::vector<EDA_RECT>* aDirtyAreas )
 {
     int zone_clearance = aZone->GetClearance();
     int edgeClearance = m_board->GetDesignSettings().m_CopperEdgeClearance;
@@ -528,6 +904,25 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE_CONTAINER* aZone, SHAPE_
     biggest_clearance = std::max( biggest_clearance, zone_clearance );
     zone_boundingbox.Inflate( biggest_clearance );
 
+    // When only some areas are rebuilt, items whose clearance area (including the arc
+    // approximation error) does not reach them are skipped
+    auto isInDirtyArea = [&]( EDA_RECT aItemBBox, int aGap ) -> bool
+    {
+        if( !aDirtyAreas )
+            return true;
+
+        aItemBBox.Normalize();
+        aItemBBox.Inflate( aGap + m_high_def );
+
+        for( const EDA_RECT& area : *aDirtyAreas )
+        {
+            if( aItemBBox.Intersects( area ) )
+                return true;
+        }
+
+        return false;
+    };
+
     // Use a dummy pad to calculate hole clearance when a pad has a hole but is not on the
     // zone's copper layer.  The dummy pad has the size and shape of the original pad's hole.
     // We have to give it a parent because some functions expect a non-null parent to find
@@ -537,49 +932,48 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE_CONTAINER* aZone, SHAPE_
 
     // Add non-connected pad clearances
     //
-    for( auto module : m_board->Modules() )
+    auto doPad = [&]( D_PAD* aPad )
     {
-        for( auto pad : module->Pads() )
+        if( !aPad->IsOnLayer( aZone->GetLayer() ) )
         {
-            if( !pad->IsOnLayer( aZone->GetLayer() ) )
-            {
-                if( pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
-                    continue;
+            if( aPad->GetDrillSize().x == 0 && aPad->GetDrillSize().y == 0 )
+                return;
 
-                setupDummyPadForHole( pad, dummypad );
-                pad = &dummypad;
-            }
+            setupDummyPadForHole( aPad, dummypad );
+            aPad = &dummypad;
+        }
 
-            if( pad->GetNetCode() != aZone->GetNetCode()
-                  || pad->GetNetCode() <= 0
-                  || aZone->GetPadConnection( pad ) == PAD_ZONE_CONN_NONE )
-            {
-                int gap = std::max( zone_clearance, pad->GetClearance() );
-                EDA_RECT item_boundingbox = pad->GetBoundingBox();
-                item_boundingbox.Inflate( pad->GetClearance() );
+        if( aPad->GetNetCode() != aZone->GetNetCode()
+              || aPad->GetNetCode() <= 0
+              || aZone->GetPadConnection( aPad ) == PAD_ZONE_CONN_NONE )
+        {
+            int gap = std::max( zone_clearance, aPad->GetClearance() );
+            EDA_RECT item_boundingbox = aPad->GetBoundingBox();
+            item_boundingbox.Inflate( aPad->GetClearance() );
 
-                if( item_boundingbox.Intersects( zone_boundingbox ) )
-                    addKnockout( pad, gap, aHoles );
-            }
+            if( item_boundingbox.Intersects( zone_boundingbox )
+                    && isInDirtyArea( aPad->GetBoundingBox(), gap ) )
+                addKnockout( aPad, gap, aHoles );
         }
-    }
+    };
 
     // Add non-connected track clearances
     //
-    for( auto track : m_board->Tracks() )
+    auto doTrack = [&]( TRACK* aTrack )
     {
-        if( !track->IsOnLayer( aZone->GetLayer() ) )
-            continue;
+        if( !aTrack->IsOnLayer( aZone->GetLayer() ) )
+            return;
 
-        if( track->GetNetCode() == aZone->GetNetCode()  && ( aZone->GetNetCode() != 0) )
-            continue;
+        if( aTrack->GetNetCode() == aZone->GetNetCode()  && ( aZone->GetNetCode() != 0) )
+            return;
 
-        int gap = std::max( zone_clearance, track->GetClearance() );
-        EDA_RECT item_boundingbox = track->GetBoundingBox();
+        int gap = std::max( zone_clearance, aTrack->GetClearance() );
+        EDA_RECT item_boundingbox = aTrack->GetBoundingBox();
 
-        if( item_boundingbox.Intersects( zone_boundingbox ) )
-            track->TransformShapeWithClearanceToPolygon( aHoles, gap, m_low_def );
-    }
+        if( item_boundingbox.Intersects( zone_boundingbox )
+                && isInDirtyArea( item_boundingbox, gap ) )
+            aTrack->TransformShapeWithClearanceToPolygon( aHoles, gap, m_low_def );
+    };
 
     // Add graphic item clearances.  They are by definition unconnected, and have no clearance
     // definitions of their own.
@@ -604,20 +998,59 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE_CONTAINER* aZone, SHAPE_
             ignoreLineWidth = true;
         }
 
+        if( !isInDirtyArea( aItem->GetBoundingBox(), gap ) )
+            return;
+
         addKnockout( aItem, gap, ignoreLineWidth, aHoles );
     };
 
-    for( auto module : m_board->Modules() )
+    // Only the items whose inflated bounding box reaches the zone one are visited
+    auto visitor = [&]( BOARD_ITEM* aItem ) -> bool
     {
-        doGraphicItem( &module->Reference() );
-        doGraphicItem( &module->Value() );
+        switch( aItem->Type() )
+        {
+        case PCB_PAD_T:
+            doPad( static_cast<D_PAD*>( aItem ) );
+            break;
 
-        for( auto item : module->GraphicalItems() )
-            doGraphicItem( item );
-    }
+        case PCB_TRACE_T:
+        case PCB_VIA_T:
+            doTrack( static_cast<TRACK*>( aItem ) );
+            break;
 
-    for( auto item : m_board->Drawings() )
-        doGraphicItem( item );
+        default:
+            doGraphicItem( aItem );
+            break;
+        }
+
+        return true;
+    };
+
+    if( m_walkWholeBoard )
+    {
+        for( auto module : m_board->Modules() )
+        {
+            for( auto pad : module->Pads() )
+                visitor( pad );
+
+            visitor( &module->Reference() );
+            visitor( &module->Value() );
+
+            for( auto item : module->GraphicalItems() )
+                visitor( item );
+        }
+
+        for( auto track : m_board->Tracks() )
+            visitor( track );
+
+        for( auto item : m_board->Drawings() )
+            visitor( item );
+    }
+    else
+    {
+        m_itemIndex->Query( zone_boundingbox, aZone->GetLayer(), visitor );
+        m_itemIndex->Query( zone_boundingbox, Edge_Cuts, visitor );
+    }
 
     // Add zones outlines having an higher priority and keepout
     //
@@ -656,6 +1089,9 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE_CONTAINER* aZone, SHAPE_
             useNetClearance = false;
         }
 
+        if( !isInDirtyArea( item_boundingbox, std::max( minClearance, zone->GetClearance() ) ) )
+            continue;
+
         zone->TransformOutlinesShapeWithClearanceToPolygon( aHoles, minClearance, useNetClearance );
     }
 
@@ -683,19 +1119,8 @@ void ZONE_FILLER::computeRawFilledArea( const ZONE_CONTAINER* aZone,
     m_high_def = m_board->GetDesignSettings().m_MaxError;
     m_low_def = std::min( ARC_LOW_DEF, int( m_high_def*1.5 ) );   // Reasonable value
 
-    // Features which are min_width should survive pruning; features that are *less* than
-    // min_width should not.  Therefore we subtract epsilon from the min_width when
-    // deflating/inflating.
-    int half_min_width = aZone->GetMinThickness() / 2;
-    int epsilon = Millimeter2iu( 0.001 );
-    int numSegs = std::max( GetArcToSegmentCount( half_min_width, m_high_def, 360.0 ), 6 );
-
-    SHAPE_POLY_SET::CORNER_STRATEGY cornerStrategy = SHAPE_POLY_SET::CHOP_ACUTE_CORNERS;
-
-    if( aZone->GetCornerSmoothingType() == ZONE_SETTINGS::SMOOTHING_FILLET )
-        cornerStrategy = SHAPE_POLY_SET::ROUND_ACUTE_CORNERS;
-
     std::deque<SHAPE_LINE_CHAIN> thermalSpokes;
+    SHAPE_POLY_SET thermalHoles;
     SHAPE_POLY_SET clearanceHoles;
 
     std::unique_ptr<SHAPE_FILE_IO> dumper( new SHAPE_FILE_IO(
@@ -706,79 +1131,181 @@ void ZONE_FILLER::computeRawFilledArea( const ZONE_CONTAINER* aZone,
     if( s_DumpZonesWhenFilling )
         dumper->BeginGroup( "clipper-zone" );
 
-    knockoutThermalReliefs( aZone, aRawPolys );
+    buildThermalReliefHoles( aZone, thermalHoles );
 
-    if( s_DumpZonesWhenFilling )
-        dumper->Write( &aRawPolys, "solid-areas-minus-thermal-reliefs" );
+    // Outside of the areas changed since the previous fill, the clearance holes are the
+    // cached ones: only the items reaching the changed areas have to be knocked out again.
+    std::vector<EDA_RECT> dirtyAreas;
+    int dirtyClearance = std::max( m_board->GetDesignSettings().GetBiggestClearanceValue(),
+                                   aZone->GetClearance() ) + m_high_def;
 
-    buildCopperItemClearances( aZone, clearanceHoles );
+    if( m_fillCache
+            && m_fillCache->GetCachedHoles( aZone, dirtyClearance, clearanceHoles, dirtyAreas ) )
+    {
+        if( !dirtyAreas.empty() )
+        {
+            SHAPE_POLY_SET dirtyPoly;
+
+            for( const EDA_RECT& area : dirtyAreas )
+            {
+                dirtyPoly.AddOutline( rectOutline( area.GetLeft(), area.GetTop(),
+                                                   area.GetRight(), area.GetBottom() ) );
+            }
+
+            dirtyPoly.Simplify( SHAPE_POLY_SET::PM_FAST );
+            clearanceHoles.BooleanSubtract( dirtyPoly, SHAPE_POLY_SET::PM_FAST );
+            buildCopperItemClearances( aZone, clearanceHoles, &dirtyAreas );
+        }
+    }
+    else
+    {
+        buildCopperItemClearances( aZone, clearanceHoles );
+    }
+
+    if( m_fillCache )
+        m_fillCache->StoreHoles( aZone, clearanceHoles );
 
     if( s_DumpZonesWhenFilling )
-        dumper->Write( &aRawPolys, "clearance holes" );
+        dumper->Write( &clearanceHoles, "clearance holes" );
 
     buildThermalSpokes( aZone, thermalSpokes );
 
+    int gridSize = getFillGridSize( aZone, aSmoothedOutline, clearanceHoles );
+
+    if( gridSize > 1 )
+    {
+        computeTiledFilledArea( aZone, aSmoothedOutline, thermalHoles, clearanceHoles,
+                                thermalSpokes, gridSize, aRawPolys );
+    }
+    else
+    {
+        aRawPolys.BooleanSubtract( thermalHoles, SHAPE_POLY_SET::PM_FAST );
+
+        if( s_DumpZonesWhenFilling )
+            dumper->Write( &aRawPolys, "solid-areas-minus-thermal-reliefs" );
+
+        std::vector<char> connectedSpokes( thermalSpokes.size(), 0 );
+
+        testThermalSpokes( aZone, aRawPolys, clearanceHoles, thermalSpokes, nullptr,
+                           connectedSpokes );
+        finishRawFilledArea( aZone, aSmoothedOutline, clearanceHoles, thermalSpokes,
+                             connectedSpokes, nullptr, dumper.get(), aRawPolys );
+    }
+
+    aRawPolys.Fracture( SHAPE_POLY_SET::PM_FAST );
+
+    if( s_DumpZonesWhenFilling )
+        dumper->Write( &aRawPolys, "areas_fractured" );
+
+    aFinalPolys = aRawPolys;
+
+    if( s_DumpZonesWhenFilling )
+        dumper->EndGroup();
+}
+
+
+void ZONE_FILLER::testThermalSpokes( const ZONE_CONTAINER* aZone, const SHAPE_POLY_SET& aFill,
+                                     const SHAPE_POLY_SET& aClearanceHoles,
+                                     const std::deque<SHAPE_LINE_CHAIN>& aSpokes,
+                                     const std::vector<size_t>* aSpokesToTest,
+                                     std::vector<char>& aConnected )
+{
+    int numSegs;
+    SHAPE_POLY_SET::CORNER_STRATEGY cornerStrategy;
+    int prune = getPruneParams( aZone, m_high_def, numSegs, cornerStrategy );
+
     // Create a temporary zone that we can hit-test spoke-ends against.  It's only temporary
     // because the "real" subtract-clearance-holes has to be done after the spokes are added.
     static const bool USE_BBOX_CACHES = true;
-    SHAPE_POLY_SET testAreas = aRawPolys;
-    testAreas.BooleanSubtract( clearanceHoles, SHAPE_POLY_SET::PM_FAST );
+    SHAPE_POLY_SET testAreas = aFill;
+    testAreas.BooleanSubtract( aClearanceHoles, SHAPE_POLY_SET::PM_FAST );
 
     // Prune features that don't meet minimum-width criteria
-    if( half_min_width - epsilon > epsilon )
+    if( prune > 0 )
     {
-        testAreas.Deflate( half_min_width - epsilon, numSegs, cornerStrategy );
-        testAreas.Inflate( half_min_width - epsilon, numSegs, cornerStrategy );
+        testAreas.Deflate( prune, numSegs, cornerStrategy );
+        testAreas.Inflate( prune, numSegs, cornerStrategy );
     }
 
     // Spoke-end-testing is hugely expensive so we generate cached bounding-boxes to speed
     // things up a bit.
     testAreas.BuildBBoxCaches();
 
-    for( const SHAPE_LINE_CHAIN& spoke : thermalSpokes )
+    auto testSpoke = [&]( size_t aIdx )
     {
+        const SHAPE_LINE_CHAIN& spoke = aSpokes[aIdx];
         const VECTOR2I& testPt = spoke.CPoint( 3 );
 
         // Hit-test against zone body
         if( testAreas.Contains( testPt, -1, 1, USE_BBOX_CACHES ) )
         {
-            aRawPolys.AddOutline( spoke );
-            continue;
+            aConnected[aIdx] = 1;
+            return;
         }
 
         // Hit-test against other spokes
-        for( const SHAPE_LINE_CHAIN& other : thermalSpokes )
+        for( const SHAPE_LINE_CHAIN& other : aSpokes )
         {
             if( &other != &spoke && other.PointInside( testPt, 1, USE_BBOX_CACHES  ) )
             {
-                aRawPolys.AddOutline( spoke );
-                break;
+                aConnected[aIdx] = 1;
+                return;
             }
         }
+    };
+
+    if( aSpokesToTest )
+    {
+        for( size_t idx : *aSpokesToTest )
+            testSpoke( idx );
+    }
+    else
+    {
+        for( size_t idx = 0; idx < aSpokes.size(); ++idx )
+            testSpoke( idx );
+    }
+}
+
+
+void ZONE_FILLER::finishRawFilledArea( const ZONE_CONTAINER* aZone,
+                                       const SHAPE_POLY_SET& aSmoothedOutline,
+                                       const SHAPE_POLY_SET& aClearanceHoles,
+                                       const std::deque<SHAPE_LINE_CHAIN>& aSpokes,
+                                       const std::vector<char>& aConnected, const BOX2I* aArea,
+                                       SHAPE_FILE_IO* aDumper, SHAPE_POLY_SET& aFill )
+{
+    int numSegs;
+    SHAPE_POLY_SET::CORNER_STRATEGY cornerStrategy;
+    int prune = getPruneParams( aZone, m_high_def, numSegs, cornerStrategy );
+
+    for( size_t idx = 0; idx < aSpokes.size(); ++idx )
+    {
+        if( aConnected[idx] && ( !aArea || aSpokes[idx].BBox().Intersects( *aArea ) ) )
+            aFill.AddOutline( aSpokes[idx] );
     }
 
     // Ensure previous changes (adding thermal stubs) do not add
     // filled areas outside the zone boundary
-    aRawPolys.BooleanIntersection( aSmoothedOutline, SHAPE_POLY_SET::PM_FAST );
-    aRawPolys.Simplify( SHAPE_POLY_SET::PM_FAST );
+    aFill.BooleanIntersection( aSmoothedOutline, SHAPE_POLY_SET::PM_FAST );
+    aFill.Simplify( SHAPE_POLY_SET::PM_FAST );
 
-    if( s_DumpZonesWhenFilling )
-        dumper->Write( &aRawPolys, "solid-areas-with-thermal-spokes" );
+    if( s_DumpZonesWhenFilling && aDumper )
+        aDumper->Write( &aFill, "solid-areas-with-thermal-spokes" );
 
-    aRawPolys.BooleanSubtract( clearanceHoles, SHAPE_POLY_SET::PM_FAST );
+    aFill.BooleanSubtract( aClearanceHoles, SHAPE_POLY_SET::PM_FAST );
     // Prune features that don't meet minimum-width criteria
-    if( half_min_width - epsilon > epsilon )
-        aRawPolys.Deflate( half_min_width - epsilon, numSegs, cornerStrategy );
+    if( prune > 0 )
+        aFill.Deflate( prune, numSegs, cornerStrategy );
 
-    if( s_DumpZonesWhenFilling )
-        dumper->Write( &aRawPolys, "solid-areas-before-hatching" );
+    if( s_DumpZonesWhenFilling && aDumper )
+        aDumper->Write( &aFill, "solid-areas-before-hatching" );
 
     // Now remove the non filled areas due to the hatch pattern
     if( aZone->GetFillMode() == ZFM_HATCH_PATTERN )
-        addHatchFillTypeOnZone( aZone, aRawPolys );
+        addHatchFillTypeOnZone( aZone, aFill );
 
-    if( s_DumpZonesWhenFilling )
-        dumper->Write( &aRawPolys, "solid-areas-after-hatching" );
+    if( s_DumpZonesWhenFilling && aDumper )
+        aDumper->Write( &aFill, "solid-areas-after-hatching" );
 
     // Re-inflate after pruning of areas that don't meet minimum-width criteria
     if( aZone->GetFilledPolysUseThickness() )
@@ -786,26 +1313,196 @@ void ZONE_FILLER::computeRawFilledArea( const ZONE_CONTAINER* aZone,
         // If we're stroking the zone with a min_width stroke then this will naturally
         // inflate the zone by half_min_width
     }
-    else if( half_min_width - epsilon > epsilon )
+    else if( prune > 0 )
     {
-        aRawPolys.Simplify( SHAPE_POLY_SET::PM_FAST );
-        aRawPolys.Inflate( half_min_width - epsilon, numSegs, cornerStrategy );
+        aFill.Simplify( SHAPE_POLY_SET::PM_FAST );
+        aFill.Inflate( prune, numSegs, cornerStrategy );
 
         // If we've deflated/inflated by something near our corner radius then we will have
         // ended up with too-sharp corners.  Apply outline smoothing again.
         if( aZone->GetMinThickness() > (int)aZone->GetCornerRadius() )
-            aRawPolys.BooleanIntersection( aSmoothedOutline, SHAPE_POLY_SET::PM_FAST );
+            aFill.BooleanIntersection( aSmoothedOutline, SHAPE_POLY_SET::PM_FAST );
     }
+}
 
-    aRawPolys.Fracture( SHAPE_POLY_SET::PM_FAST );
 
-    if( s_DumpZonesWhenFilling )
-        dumper->Write( &aRawPolys, "areas_fractured" );
+int ZONE_FILLER::getTileHalo( int aPrune ) const
+{
+    // The spoke test and the final fill deflate then inflate the areas, so a point depends
+    // on the areas at most 2 * aPrune around it.  Add some room for the arc approximation.
+    return 2 * aPrune + 2 * m_high_def + Millimeter2iu( 0.01 );
+}
 
-    aFinalPolys = aRawPolys;
 
-    if( s_DumpZonesWhenFilling )
-        dumper->EndGroup();
+int ZONE_FILLER::getFillGridSize( const ZONE_CONTAINER* aZone,
+                                  const SHAPE_POLY_SET& aSmoothedOutline,
+                                  const SHAPE_POLY_SET& aClearanceHoles ) const
+{
+    int threads = (int) GetKiCadThreadPool().GetWorkerCount();
+
+    // The hatch pattern is aligned on the whole zone: it is not split
+    if( aZone->GetFillMode() == ZFM_HATCH_PATTERN )
+        return 1;
+
+    if( aClearanceHoles.TotalVertices() < m_tiledFillMinVertices )
+        return 1;
+
+    if( m_tiledFillGridSize > 0 )
+        return m_tiledFillGridSize;
+
+    if( threads < 2 )
+        return 1;
+
+    int numSegs;
+    SHAPE_POLY_SET::CORNER_STRATEGY cornerStrategy;
+    int halo = getTileHalo( getPruneParams( aZone, m_high_def, numSegs, cornerStrategy ) );
+
+    // Tiles have to be much larger than their halo to be worth it
+    BOX2I bbox = aSmoothedOutline.BBox();
+    int maxGridSize = std::min( bbox.GetWidth(), bbox.GetHeight() ) / ( 4 * halo );
+    int gridSize = KiROUND( std::ceil( std::sqrt( 2.0 * threads ) ) );
+
+    return std::max( 1, std::min( gridSize, maxGridSize ) );
+}
+
+
+void ZONE_FILLER::computeTiledFilledArea( const ZONE_CONTAINER* aZone,
+                                          const SHAPE_POLY_SET& aSmoothedOutline,
+                                          const SHAPE_POLY_SET& aThermalHoles,
+                                          const SHAPE_POLY_SET& aClearanceHoles,
+                                          const std::deque<SHAPE_LINE_CHAIN>& aSpokes,
+                                          int aGridSize, SHAPE_POLY_SET& aRawPolys )
+{
+    struct TILE
+    {
+        BOX2I               m_area;     // part of the zone built by the tile
+        BOX2I               m_halo;     // part of the zone it depends on
+        std::vector<size_t> m_spokes;   // spokes whose end is tested by the tile
+        SHAPE_POLY_SET      m_fill;
+        SHAPE_POLY_SET      m_holes;
+    };
+
+    int numSegs;
+    SHAPE_POLY_SET::CORNER_STRATEGY cornerStrategy;
+    int halo = getTileHalo( getPruneParams( aZone, m_high_def, numSegs, cornerStrategy ) );
+
+    // Split the zone bounding box in a aGridSize x aGridSize grid, the same way as
+    // POLY_GRID_PARTITION does.  The box is enlarged so no outline lies on its border.
+    BOX2I bbox = aSmoothedOutline.BBox();
+    bbox.Inflate( halo );
+
+    std::vector<TILE> tiles( aGridSize * aGridSize );
+
+    for( int ty = 0; ty < aGridSize; ty++ )
+    {
+        for( int tx = 0; tx < aGridSize; tx++ )
+        {
+            TILE& tile = tiles[ ty * aGridSize + tx ];
+            int x0 = bbox.GetX() + rescale( tx, bbox.GetWidth(), aGridSize );
+            int x1 = bbox.GetX() + rescale( tx + 1, bbox.GetWidth(), aGridSize );
+            int y0 = bbox.GetY() + rescale( ty, bbox.GetHeight(), aGridSize );
+            int y1 = bbox.GetY() + rescale( ty + 1, bbox.GetHeight(), aGridSize );
+
+            tile.m_area = BOX2I( VECTOR2I( x0, y0 ), VECTOR2I( x1 - x0, y1 - y0 ) );
+            tile.m_halo = tile.m_area;
+            tile.m_halo.Inflate( halo );
+        }
+    }
+
+    // Each spoke is tested by a single tile, the one its end falls in
+    for( size_t idx = 0; idx < aSpokes.size(); ++idx )
+    {
+        const VECTOR2I& testPt = aSpokes[idx].CPoint( 3 );
+        int tx = rescale( testPt.x - bbox.GetX(), aGridSize, bbox.GetWidth() );
+        int ty = rescale( testPt.y - bbox.GetY(), aGridSize, bbox.GetHeight() );
+
+        tx = std::max( 0, std::min( tx, aGridSize - 1 ) );
+        ty = std::max( 0, std::min( ty, aGridSize - 1 ) );
+
+        tiles[ ty * aGridSize + tx ].m_spokes.push_back( idx );
+    }
+
+    // Hand each tile only the holes overlapping it, so no tile has to clip the whole zone
+    auto polyBBoxes = []( const SHAPE_POLY_SET& aSet )
+    {
+        std::vector<BOX2I> bboxes;
+
+        for( int ii = 0; ii < aSet.OutlineCount(); ii++ )
+            bboxes.push_back( aSet.COutline( ii ).BBox() );
+
+        return bboxes;
+    };
+
+    auto selectPolys = []( const SHAPE_POLY_SET& aSet, const std::vector<BOX2I>& aBBoxes,
+                           const BOX2I& aArea, SHAPE_POLY_SET& aResult )
+    {
+        for( int ii = 0; ii < aSet.OutlineCount(); ii++ )
+        {
+            if( !aBBoxes[ii].Intersects( aArea ) )
+                continue;
+
+            const SHAPE_POLY_SET::POLYGON& poly = aSet.CPolygon( ii );
+            int outline = aResult.AddOutline( poly[0] );
+
+            for( size_t hole = 1; hole < poly.size(); hole++ )
+                aResult.AddHole( poly[hole], outline );
+        }
+    };
+
+    std::vector<BOX2I> thermalBBoxes = polyBBoxes( aThermalHoles );
+    std::vector<BOX2I> clearanceBBoxes = polyBBoxes( aClearanceHoles );
+    std::vector<char>  connectedSpokes( aSpokes.size(), 0 );
+
+    // Zones are themselves filled on the pool: the calling thread works on the tiles too
+    auto runTiles = [&]( const std::function<void( TILE& )>& aTileWork )
+    {
+        GetKiCadThreadPool().ParallelFor( tiles.size(),
+                [&]( size_t i )
+                {
+                    aTileWork( tiles[i] );
+                } );
+    };
+
+    // First pass: decide which spokes are connected.  Each tile writes only the flags of
+    // its own spokes.
+    runTiles( [&]( TILE& aTile )
+            {
+                SHAPE_POLY_SET clip, thermalHoles;
+                clip.AddOutline( rectOutline( aTile.m_halo.GetX(), aTile.m_halo.GetY(),
+                                              aTile.m_halo.GetRight(), aTile.m_halo.GetBottom() ) );
+
+                selectPolys( aThermalHoles, thermalBBoxes, aTile.m_halo, thermalHoles );
+                selectPolys( aClearanceHoles, clearanceBBoxes, aTile.m_halo, aTile.m_holes );
+
+                aTile.m_fill = aSmoothedOutline;
+                aTile.m_fill.BooleanIntersection( clip, SHAPE_POLY_SET::PM_FAST );
+                aTile.m_fill.BooleanSubtract( thermalHoles, SHAPE_POLY_SET::PM_FAST );
+
+                testThermalSpokes( aZone, aTile.m_fill, aTile.m_holes, aSpokes, &aTile.m_spokes,
+                                   connectedSpokes );
+            } );
+
+    // Second pass: build each tile, keeping only the part it is exact for
+    runTiles( [&]( TILE& aTile )
+            {
+                finishRawFilledArea( aZone, aSmoothedOutline, aTile.m_holes, aSpokes,
+                                     connectedSpokes, &aTile.m_halo, nullptr, aTile.m_fill );
+
+                SHAPE_POLY_SET clip;
+                clip.AddOutline( rectOutline( aTile.m_area.GetX(), aTile.m_area.GetY(),
+                                              aTile.m_area.GetRight(), aTile.m_area.GetBottom() ) );
+
+                aTile.m_fill.BooleanIntersection( clip, SHAPE_POLY_SET::PM_FAST );
+                aTile.m_holes.RemoveAllContours();
+            } );
+
+    // The tiles do not overlap: their union stitches the pieces back along the tile edges
+    aRawPolys.RemoveAllContours();
+
+    for( TILE& tile : tiles )
+        aRawPolys.Append( tile.m_fill );
+
+    aRawPolys.Simplify( SHAPE_POLY_SET::PM_FAST );
 }
 
 
@@ -26,14 +26,18 @@
 #ifndef __ZONE_FILLER_H
 #define __ZONE_FILLER_H
 
+#include <memory>
 #include <vector>
 #include <class_zone.h>
 
 class WX_PROGRESS_REPORTER;
+class ZONE_FILL_CACHE;
+class DRC_RTREE;
 class BOARD;
 class COMMIT;
 class SHAPE_POLY_SET;
 class SHAPE_LINE_CHAIN;
+class SHAPE_FILE_IO;
 
 
 class ZONE_FILLER
@@ -43,6 +47,36 @@ public:
     ~ZONE_FILLER();
 
     void InstallNewProgressReporter( wxWindow* aParent, const wxString& aTitle, int aNumPhases );
+
+    /**
+     * Function SetFillCache
+     * Allows the filler to reuse the clearance holes computed by previous fills outside of
+     * the areas changed since then, and stores the new ones in aCache.
+     */
+    void SetFillCache( ZONE_FILL_CACHE* aCache ) { m_fillCache = aCache; }
+
+    /**
+     * Function SetTiledFill
+     * Sets which zones are filled in tiles: the ones with at least aMinVertices clearance
+     * hole vertices, split in a aGridSize x aGridSize grid (or a grid sized for the thread
+     * pool if aGridSize is 0).  The tests use it to compare the tiled and the plain fills.
+     */
+    void SetTiledFill( int aMinVertices, int aGridSize = 0 )
+    {
+        m_tiledFillMinVertices = aMinVertices;
+        m_tiledFillGridSize = aGridSize;
+    }
+
+    /**
+     * Function SetWalkWholeBoard
+     * Makes the clearance holes be gathered by walking every item of the board, as before
+     * the item index, instead of querying the index.  The tests use it to check the index.
+     */
+    void SetWalkWholeBoard( bool aWalk )
+    {
+        m_walkWholeBoard = aWalk;
+    }
+
     bool Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck = false );
 
 private:
@@ -51,9 +85,32 @@ private:
 
     void addKnockout( BOARD_ITEM* aItem, int aGap, bool aIgnoreLineWidth, SHAPE_POLY_SET& aHoles );
 
-    void knockoutThermalReliefs( const ZONE_CONTAINER* aZone, SHAPE_POLY_SET& aFill );
+    /**
+     * Function buildItemIndex
+     * Indexes the board copper and graphic items by layer, with their bounding box inflated
+     * by their clearance, so that each zone only visits the items it can collide with.
+     */
+    void buildItemIndex();
+
+    /**
+     * Function computeFillInputHash
+     * @return the MD5 digest, as 32 hexadecimal digits, of everything the fill of aZone
+     * depends on: its outline and settings, the board outline, the design rules and the
+     * items and zones which can knock out or connect to its copper.  A zone whose digest
+     * did not change since its last fill does not need to be refilled.
+     */
+    std::string computeFillInputHash( const ZONE_CONTAINER* aZone ) const;
 
-    void buildCopperItemClearances( const ZONE_CONTAINER* aZone, SHAPE_POLY_SET& aHoles );
+    void buildThermalReliefHoles( const ZONE_CONTAINER* aZone, SHAPE_POLY_SET& aHoles );
+
+    /**
+     * Function buildCopperItemClearances
+     * Adds to aHoles the clearance areas of the copper items which are not connected to the
+     * zone.  If aDirtyAreas is given, only the items whose clearance area reaches one of them
+     * are added.
+     */
+    void buildCopperItemClearances( const ZONE_CONTAINER* aZone, SHAPE_POLY_SET& aHoles,
+                                    const std::vector<EDA_RECT>* aDirtyAreas = nullptr );
 
     /**
      * Function computeRawFilledArea
@@ -71,6 +128,53 @@ private:
                                std::set<VECTOR2I>* aPreserveCorners,
                                SHAPE_POLY_SET& aRawPolys, SHAPE_POLY_SET& aFinalPolys );
 
+    /**
+     * Function testThermalSpokes
+     * Flags in aConnected the thermal spokes (among aSpokesToTest, or all of them if null)
+     * whose end reaches the zone body aFill once the clearance holes are knocked out.
+     */
+    void testThermalSpokes( const ZONE_CONTAINER* aZone, const SHAPE_POLY_SET& aFill,
+                            const SHAPE_POLY_SET& aClearanceHoles,
+                            const std::deque<SHAPE_LINE_CHAIN>& aSpokes,
+                            const std::vector<size_t>* aSpokesToTest,
+                            std::vector<char>& aConnected );
+
+    /**
+     * Function finishRawFilledArea
+     * Adds the connected spokes (only the ones reaching aArea if not null) to aFill, knocks
+     * out the clearance holes, applies the hatch pattern and prunes the features thinner than
+     * the zone min width.
+     */
+    void finishRawFilledArea( const ZONE_CONTAINER* aZone, const SHAPE_POLY_SET& aSmoothedOutline,
+                              const SHAPE_POLY_SET& aClearanceHoles,
+                              const std::deque<SHAPE_LINE_CHAIN>& aSpokes,
+                              const std::vector<char>& aConnected, const BOX2I* aArea,
+                              SHAPE_FILE_IO* aDumper, SHAPE_POLY_SET& aFill );
+
+    /**
+     * Function getFillGridSize
+     * @return the size of the grid of tiles a large zone is split into to be filled on
+     * several threads, or 1 to fill it in one piece.
+     */
+    int getFillGridSize( const ZONE_CONTAINER* aZone, const SHAPE_POLY_SET& aSmoothedOutline,
+                         const SHAPE_POLY_SET& aClearanceHoles ) const;
+
+    ///> Returns the margin around a tile which can change the fill of the tile
+    int getTileHalo( int aPrune ) const;
+
+    /**
+     * Function computeTiledFilledArea
+     * Same as the end of computeRawFilledArea (without fracturing), but each tile of a
+     * aGridSize x aGridSize grid is built on its own thread from the parts of the zone and of
+     * the holes around it, then the tiles are stitched back together.
+     */
+    void computeTiledFilledArea( const ZONE_CONTAINER* aZone,
+                                 const SHAPE_POLY_SET& aSmoothedOutline,
+                                 const SHAPE_POLY_SET& aThermalHoles,
+                                 const SHAPE_POLY_SET& aClearanceHoles,
+                                 const std::deque<SHAPE_LINE_CHAIN>& aSpokes,
+                                 int aGridSize, SHAPE_POLY_SET& aRawPolys );
+
     /**
      * Function buildThermalSpokes
      * Constructs a list of all thermal spokes for the given zone.
@@ -108,8 +212,13 @@ private:
     bool m_brdOutlinesValid;            // true if m_boardOutline can be calculated
                                         // false if not (not closed outlines for instance)
     COMMIT* m_commit;
+    ZONE_FILL_CACHE* m_fillCache;
+    std::unique_ptr<DRC_RTREE> m_itemIndex;   // Items knocked out of the zones, by layer
     WX_PROGRESS_REPORTER* m_progressReporter;
     std::unique_ptr<WX_PROGRESS_REPORTER> m_uniqueReporter;
+    int m_tiledFillMinVertices;         // Zones with fewer clearance hole vertices are not tiled
+    int m_tiledFillGridSize;            // Forced size of the tile grid, 0 for automatic
+    bool m_walkWholeBoard;              // Clearance holes gathered without the item index
 
     // m_high_def can be used to define a high definition arc to polygon approximation
     int m_high_def;
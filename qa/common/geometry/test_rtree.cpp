@@ -0,0 +1,177 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <geometry/rtree.h>
+
+#include <climits>
+#include <random>
+#include <set>
+
+
+typedef RTree<intptr_t, int, 3, double> TEST_TREE;
+
+
+/**
+ * Generates aCount random entries.  Some of them span the whole range of the middle axis,
+ * as the view items with a maximum bounding box do.
+ */
+static std::vector<TEST_TREE::BulkItem> randomEntries( int aCount, std::mt19937& aRng )
+{
+    std::uniform_int_distribution<int> pos( -50000, 50000 );
+    std::uniform_int_distribution<int> size( 0, 1000 );
+    std::vector<TEST_TREE::BulkItem>   entries( aCount );
+
+    for( int i = 0; i < aCount; i++ )
+    {
+        for( int axis = 0; axis < 3; axis++ )
+        {
+            entries[i].m_min[axis] = pos( aRng );
+            entries[i].m_max[axis] = entries[i].m_min[axis] + size( aRng );
+        }
+
+        if( i % 97 == 0 )
+        {
+            entries[i].m_min[1] = INT_MIN;
+            entries[i].m_max[1] = INT_MAX;
+        }
+
+        entries[i].m_data = i + 1;
+    }
+
+    return entries;
+}
+
+
+/**
+ * Checks that searching aTree finds exactly the entries of aEntries overlapping the
+ * search rectangles.
+ */
+static void checkSearches( const TEST_TREE&                       aTree,
+                           const std::vector<TEST_TREE::BulkItem>& aEntries, std::mt19937& aRng )
+{
+    std::uniform_int_distribution<int> pos( -50000, 50000 );
+    std::uniform_int_distribution<int> size( 0, 20000 );
+
+    for( int query = 0; query < 100; query++ )
+    {
+        int mmin[3], mmax[3];
+
+        for( int axis = 0; axis < 3; axis++ )
+        {
+            mmin[axis] = pos( aRng );
+            mmax[axis] = mmin[axis] + size( aRng );
+        }
+
+        std::set<intptr_t> expected, found;
+
+        for( const auto& entry : aEntries )
+        {
+            bool overlap = true;
+
+            for( int axis = 0; axis < 3; axis++ )
+            {
+                if( entry.m_min[axis] > mmax[axis] || entry.m_max[axis] < mmin[axis] )
+                    overlap = false;
+            }
+
+            if( overlap )
+                expected.insert( entry.m_data );
+        }
+
+        aTree.Search( mmin, mmax,
+                [&]( const intptr_t& aData ) -> bool
+                {
+                    found.insert( aData );
+                    return true;
+                } );
+
+        BOOST_CHECK( found == expected );
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE( RTreeBulkLoad )
+
+
+/**
+ * A bulk loaded tree finds the same entries as a brute force search, whatever the number
+ * of entries with respect to the node size.
+ */
+BOOST_AUTO_TEST_CASE( BulkLoadSearch )
+{
+    std::mt19937 rng( 42 );
+
+    for( int count : { 0, 1, 7, 8, 9, 64, 65, 1000, 10000 } )
+    {
+        BOOST_TEST_CONTEXT( "Entries: " << count )
+        {
+            auto      entries = randomEntries( count, rng );
+            TEST_TREE tree( entries );
+
+            BOOST_CHECK_EQUAL( tree.Count(), count );
+            checkSearches( tree, entries, rng );
+        }
+    }
+}
+
+
+/**
+ * A bulk loaded tree can still be modified as usual.
+ */
+BOOST_AUTO_TEST_CASE( BulkLoadModify )
+{
+    std::mt19937 rng( 7 );
+    auto         entries = randomEntries( 5000, rng );
+    TEST_TREE    tree;
+
+    // Replaces the previous contents
+    tree.Insert( entries[0].m_min, entries[0].m_max, -1 );
+    tree.BulkLoad( entries );
+
+    std::vector<TEST_TREE::BulkItem> kept;
+
+    for( size_t i = 0; i < entries.size(); i++ )
+    {
+        if( i % 3 == 0 )
+            BOOST_CHECK( !tree.Remove( entries[i].m_min, entries[i].m_max, entries[i].m_data ) );
+        else
+            kept.push_back( entries[i] );
+    }
+
+    auto added = randomEntries( 500, rng );
+
+    for( auto& entry : added )
+    {
+        entry.m_data += entries.size();
+        tree.Insert( entry.m_min, entry.m_max, entry.m_data );
+        kept.push_back( entry );
+    }
+
+    BOOST_CHECK_EQUAL( tree.Count(), (int) kept.size() );
+    checkSearches( tree, kept, rng );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
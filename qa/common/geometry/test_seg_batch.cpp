@@ -0,0 +1,249 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for SEG_BATCH, whose answers must be the ones of the SEG methods called on each
+ * segment.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <geometry/seg_batch.h>
+
+#include <random>
+
+
+/**
+ * Segments of all sizes and directions, with the ones SEG measures in a special way
+ */
+struct SEG_BATCH_FIXTURE
+{
+    SEG_BATCH_FIXTURE() :
+        m_rng( 1234 )
+    {
+        // long segments, up to the size of the largest boards
+        for( int i = 0; i < 60; i++ )
+            add( randomPoint( 500000000 ), randomPoint( 500000000 ) );
+
+        // segments of a board
+        for( int i = 0; i < 60; i++ )
+        {
+            VECTOR2I a = randomPoint( 100000 );
+            add( a, a + randomPoint( 20000 ) );
+        }
+
+        // null, tiny, axis aligned and nearly diagonal segments
+        for( int i = 0; i < 60; i++ )
+        {
+            VECTOR2I a = randomPoint( 100000 );
+            int      len = random( 0, 30000 );
+
+            switch( i % 6 )
+            {
+            case 0: add( a, a );                                           break;
+            case 1: add( a, a + randomPoint( 2 ) );                        break;
+            case 2: add( a, a + VECTOR2I( len, 0 ) );                      break;
+            case 3: add( a, a + VECTOR2I( 0, -len ) );                     break;
+            case 4: add( a, a + VECTOR2I( len, len + random( -1, 1 ) ) );  break;
+            case 5: add( a, a + VECTOR2I( 1, len ) );                      break;
+            }
+        }
+    }
+
+    int random( int aMin, int aMax )
+    {
+        return std::uniform_int_distribution<int>( aMin, aMax )( m_rng );
+    }
+
+    VECTOR2I randomPoint( int aRange )
+    {
+        return VECTOR2I( random( -aRange, aRange ), random( -aRange, aRange ) );
+    }
+
+    void add( const VECTOR2I& aA, const VECTOR2I& aB )
+    {
+        m_segs.emplace_back( aA, aB );
+        m_batch.Add( m_segs.back() );
+    }
+
+    /// Points near the segments, or on them
+    std::vector<VECTOR2I> probes()
+    {
+        std::vector<VECTOR2I> points;
+
+        for( const SEG& seg : m_segs )
+        {
+            points.push_back( seg.A );
+            points.push_back( seg.NearestPoint( seg.A + randomPoint( 1000 ) ) );
+            points.push_back( seg.B + randomPoint( 3 ) );
+        }
+
+        for( int i = 0; i < 200; i++ )
+            points.push_back( randomPoint( 120000 ) );
+
+        return points;
+    }
+
+    std::mt19937          m_rng;
+    std::vector<SEG>      m_segs;
+    SEG_BATCH             m_batch;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( SegBatch, SEG_BATCH_FIXTURE )
+
+
+/**
+ * The smallest distances are the ones of SEG, over any range of segments
+ */
+BOOST_AUTO_TEST_CASE( SquaredDistance )
+{
+    BOOST_REQUIRE_EQUAL( m_batch.Size(), (int) m_segs.size() );
+
+    const int ranges[][2] = { { 0, m_batch.Size() }, { 60, 180 }, { 61, 66 }, { 7, 8 } };
+
+    for( const VECTOR2I& p : probes() )
+    {
+        for( const auto& range : ranges )
+        {
+            SEG::ecoord expected = VECTOR2I::ECOORD_MAX;
+            int         expectedDist = INT_MAX;
+
+            for( int i = range[0]; i < range[1]; i++ )
+            {
+                expected = std::min( expected, m_segs[i].SquaredDistance( p ) );
+                expectedDist = std::min( expectedDist, m_segs[i].Distance( p ) );
+            }
+
+            BOOST_TEST_CONTEXT( "Point " << p << " segments " << range[0] << " to " << range[1] )
+            {
+                BOOST_CHECK_EQUAL( m_batch.SquaredDistance( p, range[0], range[1] ), expected );
+                BOOST_CHECK_EQUAL( m_batch.Distance( p, range[0], range[1] ), expectedDist );
+            }
+        }
+    }
+
+    BOOST_CHECK_EQUAL( m_batch.SquaredDistance( VECTOR2I( 0, 0 ), 5, 5 ),
+                       (SEG::ecoord) VECTOR2I::ECOORD_MAX );
+}
+
+
+/**
+ * The segments near a point are all visited, in order
+ */
+BOOST_AUTO_TEST_CASE( QueryNear )
+{
+    for( const VECTOR2I& p : probes() )
+    {
+        for( int dist : { -1, 0, 1, 10, 2500 } )
+        {
+            std::vector<int> visited;
+            auto             visit = [&]( int i )
+                                     {
+                                         visited.push_back( i );
+                                         return false;
+                                     };
+
+            BOOST_CHECK( !m_batch.QueryNear( p, dist, 0, m_batch.Size(), visit ) );
+            BOOST_CHECK( std::is_sorted( visited.begin(), visited.end() ) );
+
+            for( int i = 0; i < m_batch.Size(); i++ )
+            {
+                bool near = m_segs[i].Distance( p ) <= dist || m_segs[i].A == p
+                            || m_segs[i].B == p;
+
+                BOOST_TEST_CONTEXT( "Point " << p << " distance " << dist << " segment " << i )
+                {
+                    BOOST_CHECK( !near
+                                 || std::count( visited.begin(), visited.end(), i ) == 1 );
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * The segments colliding with a segment are all visited, in order, and the visit stops when
+ * asked to
+ */
+BOOST_AUTO_TEST_CASE( QueryColliding )
+{
+    std::vector<SEG> queries;
+
+    for( const VECTOR2I& p : probes() )
+        queries.emplace_back( p, p + randomPoint( 3000 ) );
+
+    queries.emplace_back( VECTOR2I( 0, 0 ), VECTOR2I( 1, 5000 ) );
+    queries.emplace_back( VECTOR2I( -90000, -90000 ), VECTOR2I( 90000, 90000 ) );
+
+    for( const SEG& query : queries )
+    {
+        for( int clearance : { 0, 1, 300, 5000 } )
+        {
+            std::vector<int> visited;
+            auto             visit = [&]( int i )
+                                     {
+                                         visited.push_back( i );
+                                         return false;
+                                     };
+
+            m_batch.QueryColliding( query, clearance, 0, m_batch.Size(), visit );
+            BOOST_CHECK( std::is_sorted( visited.begin(), visited.end() ) );
+
+            int first = -1;
+
+            for( int i = 0; i < m_batch.Size(); i++ )
+            {
+                bool collide = m_segs[i].Collide( query, clearance );
+
+                if( collide && first < 0 )
+                    first = i;
+
+                BOOST_TEST_CONTEXT( "Segment " << query << " clearance " << clearance
+                                               << " segment " << i )
+                {
+                    BOOST_CHECK( !collide
+                                 || std::count( visited.begin(), visited.end(), i ) == 1 );
+                }
+            }
+
+            int  found = -1;
+            auto stop = [&]( int i )
+                        {
+                            found = i;
+                            return m_segs[i].Collide( query, clearance );
+                        };
+
+            BOOST_CHECK_EQUAL( m_batch.QueryColliding( query, clearance, 0, m_batch.Size(),
+                                                       stop ), first >= 0 );
+
+            if( first >= 0 )
+                BOOST_CHECK_EQUAL( found, first );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
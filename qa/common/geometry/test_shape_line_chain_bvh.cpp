@@ -0,0 +1,324 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the queries of the long line chains, which go through their segment BVH.
+ * The answers are checked against a plain scan of all the segments.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <geometry/shape_circle.h>
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_rect.h>
+
+#include <climits>
+#include <thread>
+
+
+/**
+ * A meander long enough for its segment BVH to be used
+ */
+struct CHAIN_BVH_FIXTURE
+{
+    CHAIN_BVH_FIXTURE()
+    {
+        for( int i = 0; i < 60; i++ )
+        {
+            int x = i * 1000;
+            int y = ( i % 2 ) ? 5000 : 0;
+
+            m_chain.Append( VECTOR2I( x, y ) );
+            m_chain.Append( VECTOR2I( x + 500, y ) );
+        }
+
+        BOOST_REQUIRE_GE( m_chain.SegmentCount(), SEGMENT_BVH::MIN_SEGMENTS );
+    }
+
+    /// Probe points spread over and around the meander
+    std::vector<VECTOR2I> probes() const
+    {
+        std::vector<VECTOR2I> points;
+
+        for( int x = -2000; x < 62000; x += 1370 )
+        {
+            for( int y = -3000; y < 8000; y += 730 )
+                points.emplace_back( x, y );
+        }
+
+        points.push_back( m_chain.CPoint( 17 ) );
+        points.push_back( m_chain.CPoint( -1 ) );
+
+        return points;
+    }
+
+    int scanDistance( const VECTOR2I& aP ) const
+    {
+        int d = INT_MAX;
+
+        for( int i = 0; i < m_chain.SegmentCount(); i++ )
+            d = std::min( d, m_chain.CSegment( i ).Distance( aP ) );
+
+        return d;
+    }
+
+    VECTOR2I scanNearestPoint( const VECTOR2I& aP ) const
+    {
+        int nearest = 0;
+
+        for( int i = 1; i < m_chain.SegmentCount(); i++ )
+        {
+            if( m_chain.CSegment( i ).Distance( aP ) < m_chain.CSegment( nearest ).Distance( aP ) )
+                nearest = i;
+        }
+
+        return m_chain.CSegment( nearest ).NearestPoint( aP );
+    }
+
+    int scanEdge( const VECTOR2I& aP, int aAccuracy ) const
+    {
+        for( int i = 0; i < m_chain.SegmentCount(); i++ )
+        {
+            const SEG s = m_chain.CSegment( i );
+
+            if( s.A == aP || s.B == aP || s.Distance( aP ) <= aAccuracy + 1 )
+                return i;
+        }
+
+        return -1;
+    }
+
+    bool scanCollide( const SEG& aSeg, int aClearance ) const
+    {
+        for( int i = 0; i < m_chain.SegmentCount(); i++ )
+        {
+            if( m_chain.CSegment( i ).Collide( aSeg, aClearance ) )
+                return true;
+        }
+
+        return false;
+    }
+
+    SHAPE_LINE_CHAIN m_chain;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ShapeLineChainBvh, CHAIN_BVH_FIXTURE )
+
+
+/**
+ * Distances and nearest points match the scan of all the segments
+ */
+BOOST_AUTO_TEST_CASE( Distance )
+{
+    for( const VECTOR2I& p : probes() )
+    {
+        BOOST_TEST_CONTEXT( "Point " << p.Format() )
+        {
+            int d = scanDistance( p );
+
+            BOOST_CHECK_EQUAL( m_chain.Distance( p ), d );
+            BOOST_CHECK_EQUAL( m_chain.NearestPoint( p ), scanNearestPoint( p ) );
+        }
+    }
+}
+
+
+/**
+ * The edge found for a point is the first one containing it
+ */
+BOOST_AUTO_TEST_CASE( EdgeContainingPoint )
+{
+    for( const VECTOR2I& p : probes() )
+    {
+        for( int accuracy : { 0, 400, 1000 } )
+        {
+            BOOST_TEST_CONTEXT( "Point " << p.Format() << " accuracy " << accuracy )
+            {
+                BOOST_CHECK_EQUAL( m_chain.EdgeContainingPoint( p, accuracy ),
+                                   scanEdge( p, accuracy ) );
+                BOOST_CHECK_EQUAL( m_chain.CheckClearance( p, accuracy ),
+                                   scanEdge( p, accuracy - 1 ) >= 0 );
+            }
+        }
+    }
+}
+
+
+/**
+ * Segments collide with the chain as with one of its segments
+ */
+BOOST_AUTO_TEST_CASE( CollideSegment )
+{
+    for( const VECTOR2I& p : probes() )
+    {
+        const SEG seg( p, p + VECTOR2I( 700, -300 ) );
+
+        for( int clearance : { 1, 250, 1200 } )
+        {
+            BOOST_TEST_CONTEXT( "Segment " << seg << " clearance " << clearance )
+            {
+                BOOST_CHECK_EQUAL( m_chain.Collide( seg, clearance ),
+                                   scanCollide( seg, clearance ) );
+            }
+        }
+    }
+}
+
+
+/**
+ * Other shapes collide with the chain as with one of its segments
+ */
+BOOST_AUTO_TEST_CASE( CollideShapes )
+{
+    auto collideShapes = []( const SHAPE& aA, const SHAPE& aB, int aClearance )
+                         {
+                             return aA.Collide( &aB, aClearance );
+                         };
+
+    for( const VECTOR2I& p : probes() )
+    {
+        const SHAPE_CIRCLE     circle( p, 300 );
+        const SHAPE_RECT       rect( p, 600, 200 );
+        const SHAPE_LINE_CHAIN chain( p, p + VECTOR2I( 400, 900 ) );
+
+        for( int clearance : { 0, 250 } )
+        {
+            BOOST_TEST_CONTEXT( "Point " << p.Format() << " clearance " << clearance )
+            {
+                bool circleHit = false, rectHit = false, chainHit = false;
+
+                for( int i = 0; i < m_chain.SegmentCount(); i++ )
+                {
+                    circleHit |= circle.Collide( m_chain.CSegment( i ), clearance );
+                    rectHit |= rect.Collide( m_chain.CSegment( i ), clearance );
+                    chainHit |= chain.Collide( m_chain.CSegment( i ), clearance );
+                }
+
+                BOOST_CHECK_EQUAL( collideShapes( circle, m_chain, clearance ), circleHit );
+                BOOST_CHECK_EQUAL( collideShapes( rect, m_chain, clearance ), rectHit );
+                BOOST_CHECK_EQUAL( collideShapes( chain, m_chain, clearance ), chainHit );
+            }
+        }
+    }
+}
+
+
+/**
+ * Intersections are found in the order of the segments of the chain
+ */
+BOOST_AUTO_TEST_CASE( Intersect )
+{
+    const SEG cut( VECTOR2I( -1000, 2500 ), VECTOR2I( 61000, 2600 ) );
+
+    SHAPE_LINE_CHAIN::INTERSECTIONS found;
+    m_chain.Intersect( cut, found );
+
+    std::vector<int> expected;
+
+    for( int i = 0; i < m_chain.SegmentCount(); i++ )
+    {
+        if( m_chain.CSegment( i ).Intersect( cut ) )
+            expected.push_back( i );
+    }
+
+    BOOST_REQUIRE_EQUAL( found.size(), expected.size() );
+
+    for( size_t i = 0; i < found.size(); i++ )
+        BOOST_CHECK_EQUAL( found[i].our.Index(), expected[i] );
+
+    SHAPE_LINE_CHAIN other( cut.A, cut.B );
+    found.clear();
+
+    BOOST_CHECK_EQUAL( m_chain.Intersect( other, found ), (int) expected.size() );
+    BOOST_CHECK_EQUAL( other.Intersect( m_chain, found ), 2 * (int) expected.size() );
+}
+
+
+/**
+ * The changes of the chain are seen by the next queries
+ */
+BOOST_AUTO_TEST_CASE( Changes )
+{
+    const VECTOR2I p( 30250, 20000 );
+
+    BOOST_CHECK_EQUAL( m_chain.Distance( p ), scanDistance( p ) );
+
+    m_chain.Point( 60 ) += VECTOR2I( 0, 14000 );
+    BOOST_CHECK_EQUAL( m_chain.Distance( p ), scanDistance( p ) );
+
+    m_chain.Move( VECTOR2I( 0, 1000 ) );
+    BOOST_CHECK_EQUAL( m_chain.Distance( p ), scanDistance( p ) );
+
+    m_chain.Append( p );
+    BOOST_CHECK_EQUAL( m_chain.Distance( p ), 0 );
+
+    m_chain.Remove( -1 );
+    m_chain.SetClosed( true );
+    BOOST_CHECK_EQUAL( m_chain.Distance( p, true ), scanDistance( p ) );
+
+    // The copies share the hierarchy until they change
+    SHAPE_LINE_CHAIN copy( m_chain );
+    copy.Point( 0 ) = p;
+
+    BOOST_CHECK_EQUAL( copy.Distance( p, true ), 0 );
+    BOOST_CHECK_EQUAL( m_chain.Distance( p, true ), scanDistance( p ) );
+
+    // And so do the assigned ones
+    SHAPE_LINE_CHAIN assigned;
+    assigned = m_chain;
+    assigned.Point( 0 ) = p;
+
+    BOOST_CHECK_EQUAL( assigned.Distance( p, true ), 0 );
+    BOOST_CHECK_EQUAL( m_chain.Distance( p, true ), scanDistance( p ) );
+}
+
+
+/**
+ * A chain can be copied and assigned while other threads build its hierarchy
+ */
+BOOST_AUTO_TEST_CASE( ConcurrentCopies )
+{
+    const VECTOR2I p( 30250, 20000 );
+    const int      d = scanDistance( p );
+
+    for( int round = 0; round < 20; round++ )
+    {
+        SHAPE_LINE_CHAIN source( m_chain );
+        SHAPE_LINE_CHAIN assigned;
+
+        std::thread query( [&]() { source.Distance( p ); } );
+
+        assigned = source;
+        SHAPE_LINE_CHAIN copy( source );
+
+        query.join();
+
+        BOOST_CHECK_EQUAL( assigned.Distance( p ), d );
+        BOOST_CHECK_EQUAL( copy.Distance( p ), d );
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,127 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the keyword lookup of DSNLEXER, through the perfect hash of the generated
+ * lexers or through the hashtable of the other keyword tables.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+// Code under test
+#include <dsnlexer.h>
+#include <lib_table_lexer.h>
+
+#include <vector>
+
+
+BOOST_AUTO_TEST_SUITE( DsnLexer )
+
+
+/**
+ * Every keyword of a generated lexer is found by the perfect hash
+ */
+BOOST_AUTO_TEST_CASE( GeneratedKeywords )
+{
+    std::vector<std::string> names;
+
+    for( int tok = 0; ; ++tok )
+    {
+        std::string name = LIB_TABLE_LEXER::TokenName( (LIB_TABLE_T::T) tok );
+
+        if( name == "token too big" )
+            break;
+
+        names.push_back( name );
+    }
+
+    BOOST_REQUIRE( !names.empty() );
+
+    std::string text;
+
+    for( const std::string& name : names )
+        text += name + " ";
+
+    LIB_TABLE_LEXER lexer( text );
+
+    for( size_t tok = 0; tok < names.size(); ++tok )
+    {
+        BOOST_TEST_CONTEXT( "Keyword " << names[tok] )
+        {
+            BOOST_CHECK_EQUAL( lexer.NextTok(), (LIB_TABLE_T::T) tok );
+            BOOST_CHECK_EQUAL( lexer.CurText(), names[tok] );
+        }
+    }
+
+    BOOST_CHECK_EQUAL( lexer.NextTok(), LIB_TABLE_T::T_EOF );
+}
+
+
+/**
+ * Texts which only look like keywords are symbols
+ */
+BOOST_AUTO_TEST_CASE( GeneratedSymbols )
+{
+    LIB_TABLE_LEXER lexer( "(lib libs li Lib name_ nam 12 \"name\" _ uri)" );
+
+    const std::vector<LIB_TABLE_T::T> expected = {
+        LIB_TABLE_T::T_LEFT,
+        LIB_TABLE_T::T_lib,
+        LIB_TABLE_T::T_SYMBOL,
+        LIB_TABLE_T::T_SYMBOL,
+        LIB_TABLE_T::T_SYMBOL,
+        LIB_TABLE_T::T_SYMBOL,
+        LIB_TABLE_T::T_SYMBOL,
+        LIB_TABLE_T::T_NUMBER,
+        LIB_TABLE_T::T_STRING,
+        LIB_TABLE_T::T_SYMBOL,
+        LIB_TABLE_T::T_uri,
+        LIB_TABLE_T::T_RIGHT,
+        LIB_TABLE_T::T_EOF,
+    };
+
+    for( LIB_TABLE_T::T tok : expected )
+        BOOST_CHECK_EQUAL( lexer.NextTok(), tok );
+}
+
+
+/**
+ * A keyword table without a perfect hash is still looked up through the hashtable
+ */
+BOOST_AUTO_TEST_CASE( KeywordTable )
+{
+    static const KEYWORD keywords[] = { { "alpha", 0 }, { "beta", 1 } };
+
+    DSNLEXER lexer( keywords, 2, std::string( "(beta alpha gamma)" ) );
+
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_LEFT );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), 1 );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), 0 );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_SYMBOL );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_RIGHT );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_EOF );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
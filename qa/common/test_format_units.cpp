@@ -74,4 +74,31 @@ BOOST_AUTO_TEST_CASE( wxPointUnitFormat )
 }
 
 
+/**
+ * Check the text held by FMT_IU is the one of FormatInternalUnits()
+ */
+BOOST_AUTO_TEST_CASE( FmtIuSameText )
+{
+    const int min = std::numeric_limits<int>::min();
+    const int max = std::numeric_limits<int>::max();
+
+    for( int value : { 0, 1, -1, 10, 350000, -350000, 123456789, min, max } )
+    {
+        BOOST_CHECK_EQUAL( FMT_IU( value ).c_str(), FormatInternalUnits( value ) );
+        BOOST_CHECK_EQUAL( FMT_IU( value ).size(), FormatInternalUnits( value ).size() );
+
+        wxPoint point( value, -value / 3 );
+        wxSize  size( max - 1, value );
+
+        BOOST_CHECK_EQUAL( FMT_IU( point ).c_str(), FormatInternalUnits( point ) );
+        BOOST_CHECK_EQUAL( FMT_IU( VECTOR2I( point ) ).c_str(),
+                           FormatInternalUnits( VECTOR2I( point ) ) );
+        BOOST_CHECK_EQUAL( FMT_IU( size ).c_str(), FormatInternalUnits( size ) );
+    }
+
+    BOOST_CHECK_EQUAL( FMT_IU( wxPoint( min, min ) ).c_str(),
+                       FormatInternalUnits( min ) + " " + FormatInternalUnits( min ) );
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
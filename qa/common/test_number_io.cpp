@@ -0,0 +1,305 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the locale independent number reading and writing, checked against the
+ * printf() and strtod() based code they replace.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+// Code under test
+#include <base_units.h>
+#include <convert_to_biu.h>
+#include <number_io.h>
+
+#include <cerrno>
+#include <climits>
+#include <clocale>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+
+/**
+ * FormatInternalUnits() as it was written with snprintf()
+ */
+static std::string printfInternalUnits( int aValue )
+{
+    char    buf[50];
+    double  engUnits = aValue;
+    int     len;
+
+#ifndef EESCHEMA
+    engUnits /= IU_PER_MM;
+#endif
+
+    if( engUnits != 0.0 && fabs( engUnits ) <= 0.0001 )
+    {
+        len = snprintf( buf, sizeof(buf), "%.10f", engUnits );
+
+        while( --len > 0 && buf[len] == '0' )
+            buf[len] = '\0';
+
+#ifndef EESCHEMA
+        if( buf[len] == '.' )
+            buf[len] = '\0';
+        else
+#endif
+            ++len;
+    }
+    else
+    {
+        len = snprintf( buf, sizeof(buf), "%.10g", engUnits );
+    }
+
+    return std::string( buf, len );
+}
+
+
+/**
+ * FormatAngle() as it was written with snprintf()
+ */
+static std::string printfAngle( double aAngle )
+{
+    char temp[50];
+    int  len = snprintf( temp, sizeof(temp), "%.10g", aAngle / 10.0 );
+
+    return std::string( temp, len );
+}
+
+
+/**
+ * Checks that ParseDouble() gives the same bits, end position and errno as strtod()
+ */
+static void checkParse( const std::string& aText )
+{
+    BOOST_TEST_CONTEXT( "Text: \"" << aText << "\"" )
+    {
+        char* expectedEnd;
+        char* end;
+
+        errno = 0;
+        double expected = strtod( aText.c_str(), &expectedEnd );
+        int    expectedErrno = errno;
+
+        errno = 0;
+        double value = ParseDouble( aText.c_str(), &end );
+
+        if( std::isnan( expected ) )
+            BOOST_CHECK( std::isnan( value ) );
+        else
+            BOOST_CHECK( memcmp( &value, &expected, sizeof( double ) ) == 0 );
+
+        BOOST_CHECK_EQUAL( end - aText.c_str(), expectedEnd - aText.c_str() );
+        BOOST_CHECK_EQUAL( errno, expectedErrno );
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE( NumberIO )
+
+
+/**
+ * FormatInternalUnits() writes what snprintf() wrote, and reads back to the same value
+ */
+BOOST_AUTO_TEST_CASE( InternalUnitsMatchPrintf )
+{
+    std::mt19937                       rng( 12 );
+    std::uniform_int_distribution<int> anyInt( INT_MIN, INT_MAX );
+    std::uniform_int_distribution<int> smallInt( -1000000, 1000000 );
+    std::vector<int>                   values = { 0, 1, -1, 9, 10, 99, 100, 101, -100, 1000,
+                                                  123456, -350000, 1000000, 2540000,
+                                                  INT_MAX, INT_MIN, INT_MIN + 1 };
+
+    for( int ii = 0; ii < 20000; ii++ )
+    {
+        values.push_back( anyInt( rng ) );
+        values.push_back( smallInt( rng ) );
+        values.push_back( smallInt( rng ) * 1000 );
+    }
+
+    for( int value : values )
+    {
+        BOOST_TEST_CONTEXT( "Value: " << value )
+        {
+            std::string text = FormatInternalUnits( value );
+
+            BOOST_CHECK_EQUAL( text, printfInternalUnits( value ) );
+
+#ifndef EESCHEMA
+            BOOST_CHECK_EQUAL( KiROUND( ParseDouble( text.c_str() ) * IU_PER_MM ), value );
+#else
+            BOOST_CHECK_EQUAL( ParseDouble( text.c_str() ), value );
+#endif
+            checkParse( text );
+        }
+    }
+}
+
+
+/**
+ * FormatAngle() writes what snprintf() wrote, for whole and fractional tenths of degree
+ */
+BOOST_AUTO_TEST_CASE( AngleMatchesPrintf )
+{
+    std::mt19937                           rng( 3 );
+    std::uniform_int_distribution<int>     tenths( -36000, 36000 );
+    std::uniform_real_distribution<double> anyAngle( -3600.0, 3600.0 );
+    std::vector<double>                    angles = { 0.0, -0.0, 1.0, -1.0, 5.0, 900.0,
+                                                      -2700.0, 3599.0, 0.5, 1e-7, 999999999.0,
+                                                      1e9, 1e12, -1e15 };
+
+    for( int ii = 0; ii < 20000; ii++ )
+    {
+        angles.push_back( tenths( rng ) );
+        angles.push_back( anyAngle( rng ) );
+    }
+
+    for( double angle : angles )
+    {
+        BOOST_TEST_CONTEXT( "Angle: " << angle )
+        {
+            std::string text = FormatAngle( angle );
+
+            BOOST_CHECK_EQUAL( text, printfAngle( angle ) );
+            checkParse( text );
+        }
+    }
+}
+
+
+/**
+ * ParseDouble() behaves as strtod(), on the numbers of the files and on the odd ones
+ */
+BOOST_AUTO_TEST_CASE( ParseMatchesStrtod )
+{
+    const std::vector<std::string> texts = {
+        "", " ", "-", "+", ".", "-.", "e5", "1e", "1e+", "1e-x", "1.", ".5", "-.5", "+3",
+        "0", "-0", "0.0", "-0.000", "00012.5000", "  \t12.7 ", "1.5)", "3.81 -2.54",
+        "1,5", "0x1p3", "0X10", "inf", "-infinity", "nan", "nan(123)", "1e22", "1e23",
+        "9007199254740992", "9007199254740993", "12345678901234567890",
+        "0.000000000000000000000001", "1e-22", "123.456e-20", "1e308", "1e309", "-1e400",
+        "1e-320", "1e-400", "2.2250738585072011e-308", "0.1", "0.2", "0.3", "9.2",
+        "1.222222222222", "179769313486231570000000000000000000000000000000000000000000000"
+    };
+
+    for( const std::string& text : texts )
+        checkParse( text );
+
+    std::mt19937                          rng( 5 );
+    std::uniform_int_distribution<int>    digitCount( 1, 20 );
+    std::uniform_int_distribution<int>    digit( 0, 9 );
+    std::uniform_int_distribution<int>    exponent( -30, 30 );
+    std::uniform_int_distribution<int>    coin( 0, 3 );
+
+    for( int ii = 0; ii < 50000; ii++ )
+    {
+        std::string text = coin( rng ) == 0 ? "-" : "";
+        int         intDigits = digitCount( rng ) - 1;
+        int         fracDigits = digitCount( rng ) - 1;
+
+        for( int jj = 0; jj < intDigits; jj++ )
+            text += '0' + digit( rng );
+
+        if( fracDigits )
+        {
+            text += '.';
+
+            for( int jj = 0; jj < fracDigits; jj++ )
+                text += '0' + digit( rng );
+        }
+
+        if( coin( rng ) == 0 )
+            text += "e" + std::to_string( exponent( rng ) );
+
+        checkParse( text );
+    }
+}
+
+
+/**
+ * The numbers are written and read with a '.' whatever the locale is
+ */
+BOOST_AUTO_TEST_CASE( LocaleIndependence )
+{
+    std::string previous = setlocale( LC_NUMERIC, NULL );
+    bool        found = false;
+
+    for( const char* locale : { "de_DE.UTF-8", "fr_FR.UTF-8", "de_DE", "fr_FR", "German" } )
+    {
+        if( setlocale( LC_NUMERIC, locale ) )
+        {
+            found = true;
+            break;
+        }
+    }
+
+    if( !found )
+    {
+        BOOST_TEST_MESSAGE( "No locale with a comma as decimal point, skipping" );
+        return;
+    }
+
+    char* end;
+    std::string text = "-12.75)";
+
+    BOOST_CHECK_EQUAL( ParseDouble( text.c_str(), &end ), -12.75 );
+    BOOST_CHECK_EQUAL( end - text.c_str(), 6 );
+
+    // Not converted directly
+    text = "1234567890123456789012.5 ";
+    BOOST_CHECK_EQUAL( ParseDouble( text.c_str(), &end ), 1234567890123456789012.5 );
+    BOOST_CHECK_EQUAL( end - text.c_str(), 24 );
+
+    BOOST_CHECK_EQUAL( FormatDouble( "%g", 1.25 ), "1.25" );
+    BOOST_CHECK_EQUAL( FormatDouble( "%f", -0.5 ), "-0.500000" );
+    BOOST_CHECK_EQUAL( Double2Str( 1.5 ), "1.5" );
+    BOOST_CHECK_EQUAL( FormatAngle( 1.5 ), "0.15" );
+
+    setlocale( LC_NUMERIC, previous.c_str() );
+}
+
+
+/**
+ * FormatFixedPoint() handles the whole range of its values
+ */
+BOOST_AUTO_TEST_CASE( FixedPoint )
+{
+    char buffer[64];
+
+    FormatFixedPoint( buffer, 0, 6 );
+    BOOST_CHECK_EQUAL( std::string( buffer ), "0" );
+    FormatFixedPoint( buffer, -5, 3 );
+    BOOST_CHECK_EQUAL( std::string( buffer ), "-0.005" );
+    FormatFixedPoint( buffer, 120, 1 );
+    BOOST_CHECK_EQUAL( std::string( buffer ), "12" );
+    FormatFixedPoint( buffer, LLONG_MIN, 18 );
+    BOOST_CHECK_EQUAL( std::string( buffer ), "-9.223372036854775808" );
+    BOOST_CHECK_EQUAL( FormatFixedPoint( buffer, LLONG_MAX, 0 ), 19 );
+    BOOST_CHECK_EQUAL( std::string( buffer ), "9223372036854775807" );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
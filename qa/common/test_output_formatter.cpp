@@ -0,0 +1,129 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for OUTPUTFORMATTER, which formats most of the writes itself and has to give
+ * exactly what printf() gives.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <richio.h>
+
+#include <climits>
+#include <cstdarg>
+#include <cstdio>
+
+
+/**
+ * What OUTPUTFORMATTER::Print() wrote before it had its own formatting
+ */
+static std::string printfText( int aNestLevel, const char* aFormat, ... )
+{
+    std::string text( aNestLevel * 2, ' ' );
+    char        buf[8192];
+    va_list     args;
+
+    va_start( args, aFormat );
+    vsnprintf( buf, sizeof( buf ), aFormat, args );
+    va_end( args );
+
+    return text + buf;
+}
+
+
+#define CHECK_PRINT( aNestLevel, ... )                                        \
+    do                                                                        \
+    {                                                                         \
+        STRING_FORMATTER formatter;                                           \
+        std::string      expected = printfText( aNestLevel, __VA_ARGS__ );    \
+        int              ret = formatter.Print( aNestLevel, __VA_ARGS__ );    \
+                                                                              \
+        BOOST_CHECK_EQUAL( formatter.GetString(), expected );                 \
+        BOOST_CHECK_EQUAL( ret, (int) expected.size() );                      \
+    } while( 0 )
+
+
+BOOST_AUTO_TEST_SUITE( OutputFormatter )
+
+
+/**
+ * The formats made of %s, %c, %d, %u, %x and %X
+ */
+BOOST_AUTO_TEST_CASE( SimpleFormats )
+{
+    CHECK_PRINT( 0, "(segment (start %s) (end %s) (width %s)", "1.5 2", "-3 4.25", "0.25" );
+    CHECK_PRINT( 3, " (net %d)", 0 );
+    CHECK_PRINT( 1, "%d %d %d", INT_MIN, INT_MAX, -7 );
+    CHECK_PRINT( 0, "%u %x %X", UINT_MAX, 0xabcdefu, 0xabcdefu );
+    CHECK_PRINT( 2, " (tstamp %lX)", (unsigned long) 0x5C0FFEE1ul );
+    CHECK_PRINT( 0, "%ld %lu %lx", LONG_MIN, ULONG_MAX, 255ul );
+    CHECK_PRINT( 0, "100%% %c%c", 'a', ')' );
+    CHECK_PRINT( 4, ")\n" );
+    CHECK_PRINT( 0, "" );
+    CHECK_PRINT( 7, "%s", "" );
+
+    // Longer than the initial buffer
+    std::string longText( 3000, 'x' );
+    CHECK_PRINT( 10, "(%s %s %d)", longText.c_str(), longText.c_str(), 42 );
+}
+
+
+/**
+ * The other formats still go through printf()
+ */
+BOOST_AUTO_TEST_CASE( OtherFormats )
+{
+    CHECK_PRINT( 0, "%g %.3f", 1.5, 2.0 );
+    CHECK_PRINT( 2, "%08X %5d %-4s|", 0x12u, 3, "ab" );
+    CHECK_PRINT( 1, "%*c", 2, ' ' );
+    CHECK_PRINT( 0, "%s %e", "mixed", 1e-7 );
+
+    std::string longText( 3000, 'y' );
+    CHECK_PRINT( 3, "%s %f", longText.c_str(), 0.5 );
+}
+
+
+/**
+ * Quotes() and Quotew() give the same quoted and escaped text
+ */
+BOOST_AUTO_TEST_CASE( Quoting )
+{
+    STRING_FORMATTER formatter;
+
+    BOOST_CHECK_EQUAL( formatter.Quotes( "F.Cu" ), "\"F.Cu\"" );
+    BOOST_CHECK_EQUAL( formatter.Quotes( "" ), "\"\"" );
+    BOOST_CHECK_EQUAL( formatter.Quotes( "a\"b\\c\nd\re" ), "\"a\\\"b\\\\c\\nd\\re\"" );
+
+    for( const wxString& text : { wxString( "F.SilkS" ), wxString( "" ),
+                                  wxString( "Net-(R1-Pad1)" ), wxString( "a \"quoted\" \\ text\n" ),
+                                  wxString::FromUTF8( "\xc2\xb5" "F \xe2\x84\xa6" ) } )
+    {
+        BOOST_CHECK_EQUAL( formatter.Quotew( text ),
+                           formatter.Quotes( (const char*) text.utf8_str() ) );
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
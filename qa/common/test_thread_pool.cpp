@@ -0,0 +1,192 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for THREAD_POOL
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+// Code under test
+#include <thread_pool.h>
+#include <widgets/progress_reporter.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+
+/**
+ * A reporter whose user clicks Cancel as soon as it is refreshed
+ */
+class CANCELLING_REPORTER : public PROGRESS_REPORTER
+{
+public:
+    CANCELLING_REPORTER() : PROGRESS_REPORTER( 1 )
+    {
+    }
+
+private:
+    bool updateUI() override
+    {
+        return false;
+    }
+};
+
+
+BOOST_AUTO_TEST_SUITE( ThreadPool )
+
+
+/**
+ * Every item of a parallel loop is visited exactly once, whatever the pool size
+ */
+BOOST_AUTO_TEST_CASE( ParallelForVisitsAll )
+{
+    for( size_t workers : { 1, 2, 8 } )
+    {
+        THREAD_POOL pool( workers );
+
+        for( size_t minItems : { 1, 8 } )
+        {
+            BOOST_TEST_CONTEXT( "Workers: " << workers << ", min items: " << minItems )
+            {
+                std::vector<std::atomic<int>> visits( 1000 );
+
+                for( auto& v : visits )
+                    v = 0;
+
+                pool.ParallelFor( visits.size(), [&]( size_t i ) { visits[i]++; }, nullptr,
+                                  minItems );
+
+                for( auto& v : visits )
+                    BOOST_CHECK_EQUAL( v.load(), 1 );
+            }
+        }
+    }
+}
+
+
+/**
+ * A loop run on the workers can itself run a parallel loop, even on a single worker
+ */
+BOOST_AUTO_TEST_CASE( NestedParallelFor )
+{
+    for( size_t workers : { 1, 3 } )
+    {
+        THREAD_POOL      pool( workers );
+        std::atomic<int> count( 0 );
+
+        pool.ParallelFor( 10,
+                [&]( size_t )
+                {
+                    pool.ParallelFor( 10, [&]( size_t ) { count++; } );
+                } );
+
+        BOOST_CHECK_EQUAL( count.load(), 100 );
+    }
+}
+
+
+/**
+ * The first exception thrown by an item is rethrown once the loop is over
+ */
+BOOST_AUTO_TEST_CASE( ParallelForException )
+{
+    THREAD_POOL      pool( 4 );
+    std::atomic<int> count( 0 );
+
+    BOOST_CHECK_THROW( pool.ParallelFor( 100,
+                                         [&]( size_t i )
+                                         {
+                                             count++;
+
+                                             if( i == 42 )
+                                                 throw std::runtime_error( "item 42" );
+                                         } ),
+                       std::runtime_error );
+
+    // The other items still run
+    BOOST_CHECK_EQUAL( count.load(), 100 );
+}
+
+
+/**
+ * Submitted tasks run on the workers and return their result through a future
+ */
+BOOST_AUTO_TEST_CASE( Submit )
+{
+    THREAD_POOL pool( 2 );
+
+    std::future<int>  result = pool.Submit( []() { return 6 * 7; } );
+    std::future<bool> onWorker = pool.Submit( [&]() { return pool.IsWorkerThread(); } );
+
+    BOOST_CHECK_EQUAL( result.get(), 42 );
+    BOOST_CHECK( onWorker.get() );
+    BOOST_CHECK( !pool.IsWorkerThread() );
+    BOOST_CHECK_EQUAL( pool.GetWorkerCount(), 2 );
+}
+
+
+/**
+ * No more items are started once the reporter is cancelled, and the loop still returns
+ */
+BOOST_AUTO_TEST_CASE( ParallelForCancel )
+{
+    THREAD_POOL         pool( 2 );
+    CANCELLING_REPORTER reporter;
+    std::atomic<int>    count( 0 );
+    const int           itemCount = 100000;
+
+    reporter.SetMaxProgress( itemCount );
+
+    pool.ParallelFor( itemCount,
+            [&]( size_t )
+            {
+                count++;
+                std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+            },
+            &reporter );
+
+    BOOST_CHECK( reporter.IsCancelled() );
+    BOOST_CHECK_LT( count.load(), itemCount );
+}
+
+
+/**
+ * The pool set by a starting kiface is the one returned to all the code of its library
+ */
+BOOST_AUTO_TEST_CASE( ProgramPool )
+{
+    THREAD_POOL& defaultPool = GetKiCadThreadPool();
+    THREAD_POOL  programPool( 2 );
+
+    SetKiCadThreadPool( &programPool );
+    BOOST_CHECK_EQUAL( &GetKiCadThreadPool(), &programPool );
+
+    SetKiCadThreadPool( nullptr );
+    BOOST_CHECK_EQUAL( &GetKiCadThreadPool(), &defaultPool );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -32,6 +32,7 @@
 #include <qa_utils/utility_registry.h>
 
 #include <common.h>
+#include <netlist_lexer.h>
 #include <profile.h>
 
 #include <wx/cmdline.h>
@@ -43,7 +44,7 @@
 class QA_SEXPR_PARSER
 {
 public:
-    QA_SEXPR_PARSER( bool aVerbose ) : m_verbose( aVerbose )
+    QA_SEXPR_PARSER( bool aVerbose, bool aLexer ) : m_verbose( aVerbose ), m_lexer( aLexer )
     {
     }
 
@@ -61,11 +62,46 @@ public:
         if( m_verbose )
             std::cout << "S-Expression Parsing took " << timer.msecs() << "ms" << std::endl;
 
+        if( m_lexer && !Lex( sexpr_str ) )
+            return false;
+
         return sexpr != nullptr;
     }
 
+    /**
+     * Tokenize the same text with a DSNLEXER, which looks up each symbol in the keywords
+     * of the netlist files (the lexers of the boards are not part of the common library).
+     */
+    bool Lex( const std::string& aText )
+    {
+        NETLIST_LEXER lexer( aText );
+        unsigned      tokens = 0;
+
+        PROF_COUNTER timer;
+
+        try
+        {
+            while( lexer.NextTok() != NL_T::T_EOF )
+                tokens++;
+        }
+        catch( const IO_ERROR& e )
+        {
+            std::cerr << e.What() << std::endl;
+            return false;
+        }
+
+        if( m_verbose )
+        {
+            std::cout << "DSN lexing of " << tokens << " tokens took " << timer.msecs() << "ms"
+                      << std::endl;
+        }
+
+        return true;
+    }
+
 private:
     bool          m_verbose;
+    bool          m_lexer;
     SEXPR::PARSER m_parser;
 };
 
@@ -84,6 +120,12 @@ static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
             "verbose",
             _( "print parsing information" ).mb_str(),
     },
+    {
+            wxCMD_LINE_SWITCH,
+            "l",
+            "lexer",
+            _( "also time the DSN lexer over the input" ).mb_str(),
+    },
     {
             wxCMD_LINE_PARAM,
             nullptr,
@@ -118,7 +160,7 @@ int sexpr_parser_func( int argc, char* argv[] )
     const auto file_count = cl_parser.GetParamCount();
     const bool verbose = cl_parser.Found( "verbose" );
 
-    QA_SEXPR_PARSER qa_parser( verbose );
+    QA_SEXPR_PARSER qa_parser( verbose, cl_parser.Found( "lexer" ) );
 
     bool ok = true;
 
@@ -0,0 +1,349 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the symbol library index of SCH_LEGACY_PLUGIN, which lists the symbols
+ * without reading their draw items.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <class_libentry.h>
+#include <class_library.h>
+#include <lib_pin.h>
+#include <properties.h>
+#include <sch_legacy_plugin.h>
+#include <symbol_lib_table.h>
+#include <wildcards_and_files_ext.h>
+
+#include <wx/datetime.h>
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#include <wx/utils.h>
+
+#include <algorithm>
+
+
+static const char s_library[] =
+        "EESchema-LIBRARY Version 2.4\n"
+        "#encoding utf-8\n"
+        "#\n"
+        "# R\n"
+        "#\n"
+        "DEF R R 0 0 N Y 1 F N\n"
+        "F0 \"R\" 80 0 50 V V C CNN\n"
+        "F1 \"R\" 0 0 50 V V C CNN\n"
+        "F2 \"Resistor_SMD:R_0603\" -70 0 50 V I C CNN\n"
+        "F3 \"\" 0 0 50 H I C CNN\n"
+        "ALIAS R_Small\n"
+        "DRAW\n"
+        "S -40 -100 40 100 0 1 10 N\n"
+        "X ~ 1 0 150 50 D 50 50 1 1 P\n"
+        "X ~ 2 0 -150 50 U 50 50 1 1 P\n"
+        "ENDDRAW\n"
+        "ENDDEF\n"
+        "#\n"
+        "# GND\n"
+        "#\n"
+        "DEF GND #PWR 0 0 Y Y 1 F P\n"
+        "F0 \"#PWR\" 0 -250 50 H I C CNN\n"
+        "F1 \"GND\" 0 -150 50 H V C CNN\n"
+        "DRAW\n"
+        "P 2 0 1 0 0 0 0 -50 N\n"
+        "X GND 1 0 0 0 D 50 50 1 1 W N\n"
+        "ENDDRAW\n"
+        "ENDDEF\n"
+        "#\n"
+        "# OPAMP\n"
+        "#\n"
+        "DEF OPAMP U 0 20 Y Y 2 L N\n"
+        "F0 \"U\" 0 200 50 H V L CNN\n"
+        "F1 \"OPAMP\" 0 -200 50 H V L CNN\n"
+        "DRAW\n"
+        "P 4 1 1 10 -200 200 200 0 -200 -200 -200 200 f\n"
+        "P 4 2 1 10 -200 200 200 0 -200 -200 -200 200 f\n"
+        "X + 3 -300 100 100 R 50 50 1 1 I\n"
+        "X + 5 -300 100 100 R 50 50 2 1 I\n"
+        "ENDDRAW\n"
+        "ENDDEF\n"
+        "#\n"
+        "#End Library\n";
+
+
+static std::string docText( const std::string& aResistorDescription )
+{
+    return "EESchema-DOCLIB  Version 2.0\n"
+           "#\n"
+           "$CMP R\n"
+           "D " + aResistorDescription + "\n"
+           "K R res resistor\n"
+           "$ENDCMP\n"
+           "#\n"
+           "$CMP R_Small\n"
+           "D Resistor, small symbol\n"
+           "K R res\n"
+           "$ENDCMP\n"
+           "#\n"
+           "#End Doc Library\n";
+}
+
+
+/**
+ * A symbol library and a configuration directory, for the index files, in temporary
+ * directories
+ */
+struct SYMBOL_LIB_INDEX_FIXTURE
+{
+    SYMBOL_LIB_INDEX_FIXTURE() :
+        m_date( 1, wxDateTime::Jan, 2019, 12, 0, 0 )
+    {
+        m_configPath = makeTempDir( wxT( "qa_sym_config" ) );
+        m_libDir = makeTempDir( wxT( "qa_sym_index" ) );
+        m_libPath = wxFileName( m_libDir, wxT( "test" ), SchematicLibraryFileExtension )
+                            .GetFullPath();
+
+        m_hadConfigHome = wxGetEnv( wxT( "KICAD_CONFIG_HOME" ), &m_oldConfigHome );
+        wxSetEnv( wxT( "KICAD_CONFIG_HOME" ), m_configPath );
+
+        m_indexOnly[ SYMBOL_LIB_TABLE::PropIndexOnly ] = "";
+
+        writeFile( m_libPath, s_library, m_date );
+        writeFile( docFileName(), docText( "Resistor" ), m_date );
+    }
+
+    ~SYMBOL_LIB_INDEX_FIXTURE()
+    {
+        if( m_hadConfigHome )
+            wxSetEnv( wxT( "KICAD_CONFIG_HOME" ), m_oldConfigHome );
+        else
+            wxUnsetEnv( wxT( "KICAD_CONFIG_HOME" ) );
+
+        wxFileName::Rmdir( m_libDir, wxPATH_RMDIR_RECURSIVE );
+        wxFileName::Rmdir( m_configPath, wxPATH_RMDIR_RECURSIVE );
+    }
+
+    static wxString makeTempDir( const wxString& aPrefix )
+    {
+        wxFileName fn( wxFileName::CreateTempFileName( aPrefix ) );
+
+        wxRemoveFile( fn.GetFullPath() );
+        BOOST_REQUIRE( wxFileName::Mkdir( fn.GetFullPath() ) );
+
+        return fn.GetFullPath();
+    }
+
+    static void writeFile( const wxString& aFileName, const std::string& aText,
+                           const wxDateTime& aDate )
+    {
+        wxFFile file( aFileName, wxT( "wb" ) );
+
+        BOOST_REQUIRE( file.IsOpened() );
+        BOOST_REQUIRE( file.Write( aText.data(), aText.size() ) == aText.size() );
+        file.Close();
+
+        BOOST_REQUIRE( wxFileName( aFileName ).SetTimes( &aDate, &aDate, NULL ) );
+    }
+
+    wxString docFileName() const
+    {
+        wxFileName fn( m_libPath );
+
+        fn.SetExt( DOC_EXT );
+
+        return fn.GetFullPath();
+    }
+
+    /**
+     * @return the number of draw items of aPart which are not fields
+     */
+    static size_t drawItemCount( LIB_PART* aPart )
+    {
+        LIB_ITEMS_CONTAINER& items = aPart->GetDrawItems();
+
+        return items.size() - items.size( LIB_FIELD_T );
+    }
+
+    /**
+     * @return the aliases listed by aPlugin, sorted by name
+     */
+    std::vector<LIB_ALIAS*> listAliases( SCH_PLUGIN& aPlugin, const PROPERTIES* aProperties )
+    {
+        std::vector<LIB_ALIAS*> aliases;
+
+        aPlugin.EnumerateSymbolLib( aliases, m_libPath, aProperties );
+
+        std::sort( aliases.begin(), aliases.end(),
+                   []( LIB_ALIAS* a, LIB_ALIAS* b ) { return a->GetName() < b->GetName(); } );
+
+        return aliases;
+    }
+
+    wxDateTime m_date;
+    PROPERTIES m_indexOnly;
+    wxString   m_configPath;
+    wxString   m_libDir;
+    wxString   m_libPath;
+    wxString   m_oldConfigHome;
+    bool       m_hadConfigHome;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( SchLegacyLibIndex, SYMBOL_LIB_INDEX_FIXTURE )
+
+
+/**
+ * The symbols listed for the index only have their names, documentation and units, their
+ * draw items are read when they are loaded
+ */
+BOOST_AUTO_TEST_CASE( IndexOnlyListing )
+{
+    SCH_LEGACY_PLUGIN       plugin;
+    std::vector<LIB_ALIAS*> aliases = listAliases( plugin, &m_indexOnly );
+
+    BOOST_REQUIRE_EQUAL( aliases.size(), 4 );
+    BOOST_CHECK( aliases[0]->GetName() == "GND" );
+    BOOST_CHECK( aliases[1]->GetName() == "OPAMP" );
+    BOOST_CHECK( aliases[2]->GetName() == "R" );
+    BOOST_CHECK( aliases[3]->GetName() == "R_Small" );
+
+    BOOST_CHECK( aliases[0]->GetPart()->IsPower() );
+    BOOST_CHECK_EQUAL( aliases[1]->GetUnitCount(), 2 );
+    BOOST_CHECK( aliases[2]->GetDescription() == "Resistor" );
+    BOOST_CHECK( aliases[3]->GetKeyWords() == "R res" );
+    BOOST_CHECK( aliases[3]->GetSearchText().Contains( "Resistor_SMD:R_0603" ) );
+    BOOST_CHECK( !aliases[3]->IsRoot() );
+
+    for( LIB_ALIAS* alias : aliases )
+        BOOST_CHECK_EQUAL( drawItemCount( alias->GetPart() ), 0 );
+
+    // The alias given back is the listed one, now with its draw items
+    LIB_ALIAS* alias = plugin.LoadSymbol( m_libPath, "R_Small" );
+
+    BOOST_REQUIRE( alias == aliases[3] );
+    BOOST_CHECK_EQUAL( drawItemCount( alias->GetPart() ), 3 );
+    BOOST_CHECK( alias->GetPart()->GetValueField().GetText() == "R" );
+    BOOST_CHECK( alias->GetPart()->GetFootprintField().GetText() == "Resistor_SMD:R_0603" );
+    BOOST_CHECK( alias->GetDescription() == "Resistor, small symbol" );
+    BOOST_CHECK( !alias->GetPart()->ShowPinNumbers() );
+
+    BOOST_CHECK_EQUAL( drawItemCount( aliases[1]->GetPart() ), 0 );
+
+    // Listing without the property reads the other symbols
+    listAliases( plugin, nullptr );
+    BOOST_CHECK_EQUAL( drawItemCount( aliases[1]->GetPart() ), 4 );
+    BOOST_CHECK( aliases[1]->GetPart()->UnitsLocked() );
+
+    wxDir    indexDir( wxFileName( m_configPath, wxT( "sym-info-index" ) ).GetFullPath() );
+    wxString indexFile;
+
+    BOOST_CHECK( indexDir.IsOpened() && indexDir.GetFirst( &indexFile ) );
+}
+
+
+/**
+ * A library is listed from its index while it and its documentation file are unchanged
+ */
+BOOST_AUTO_TEST_CASE( UnchangedLibrary )
+{
+    {
+        SCH_LEGACY_PLUGIN plugin;
+        BOOST_CHECK_EQUAL( listAliases( plugin, &m_indexOnly ).size(), 4 );
+    }
+
+    // Same date: the index written above is used
+    writeFile( docFileName(), docText( "Changed" ), m_date );
+
+    {
+        SCH_LEGACY_PLUGIN       plugin;
+        std::vector<LIB_ALIAS*> aliases = listAliases( plugin, &m_indexOnly );
+
+        BOOST_REQUIRE_EQUAL( aliases.size(), 4 );
+        BOOST_CHECK( aliases[2]->GetDescription() == "Resistor" );
+
+        // The symbols are found in the library file from the index
+        LIB_ALIAS* alias = plugin.LoadSymbol( m_libPath, "OPAMP" );
+
+        BOOST_REQUIRE( alias );
+        BOOST_CHECK_EQUAL( drawItemCount( alias->GetPart() ), 4 );
+        BOOST_CHECK_EQUAL( alias->GetPart()->GetPinNameOffset(), 20 );
+
+        LIB_PINS pins;
+        alias->GetPart()->GetPins( pins, 2 );
+        BOOST_CHECK_EQUAL( pins.size(), 1 );
+    }
+
+    writeFile( docFileName(), docText( "Changed" ), m_date + wxTimeSpan::Minutes( 1 ) );
+
+    {
+        SCH_LEGACY_PLUGIN       plugin;
+        std::vector<LIB_ALIAS*> aliases = listAliases( plugin, &m_indexOnly );
+
+        BOOST_REQUIRE_EQUAL( aliases.size(), 4 );
+        BOOST_CHECK( aliases[2]->GetDescription() == "Changed" );
+    }
+}
+
+
+/**
+ * The symbols of a library with CRLF line endings are found again at their file offsets
+ */
+BOOST_AUTO_TEST_CASE( CrlfLibrary )
+{
+    std::string crlf;
+
+    for( const char* c = s_library; *c; ++c )
+    {
+        if( *c == '\n' )
+            crlf += '\r';
+
+        crlf += *c;
+    }
+
+    writeFile( m_libPath, crlf, m_date );
+
+    // Listed once to write the index, once to read it
+    for( int pass = 0; pass < 2; ++pass )
+    {
+        BOOST_TEST_CONTEXT( "Pass " << pass )
+        {
+            SCH_LEGACY_PLUGIN       plugin;
+            std::vector<LIB_ALIAS*> aliases = listAliases( plugin, &m_indexOnly );
+
+            BOOST_REQUIRE_EQUAL( aliases.size(), 4 );
+
+            LIB_ALIAS* opamp = plugin.LoadSymbol( m_libPath, "OPAMP" );
+            LIB_ALIAS* gnd = plugin.LoadSymbol( m_libPath, "GND" );
+
+            BOOST_REQUIRE( opamp && gnd );
+            BOOST_CHECK_EQUAL( drawItemCount( opamp->GetPart() ), 4 );
+            BOOST_CHECK_EQUAL( opamp->GetPart()->GetPinNameOffset(), 20 );
+            BOOST_CHECK_EQUAL( drawItemCount( gnd->GetPart() ), 2 );
+            BOOST_CHECK( gnd->GetPart()->IsPower() );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
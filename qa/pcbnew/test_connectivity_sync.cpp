@@ -0,0 +1,284 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the incremental update of the connectivity, which has to give the same
+ * result as a full rebuild whatever was edited behind its back.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <connectivity/connectivity_data.h>
+#include <convert_to_biu.h>
+#include <kicad_plugin.h>
+#include <zone_filler.h>
+
+#include <map>
+#include <memory>
+#include <new>
+#include <set>
+
+
+static const char s_board[] =
+        "(kicad_pcb (version 20171130) (host pcbnew 5.1)\n"
+        "  (general (thickness 1.6))\n"
+        "  (page A4)\n"
+        "  (layers\n"
+        "    (0 F.Cu signal)\n"
+        "    (31 B.Cu signal)\n"
+        "    (44 Edge.Cuts user)\n"
+        "  )\n"
+        "  (net 0 \"\")\n"
+        "  (net 1 GND)\n"
+        "  (net 2 SIG)\n"
+        "  (module R_0805 (layer F.Cu) (tedit 0) (tstamp 5C000001)\n"
+        "    (at 10 10)\n"
+        "    (pad 1 smd rect (at -1.27 0) (size 1 1) (layers F.Cu) (net 2 SIG))\n"
+        "    (pad 2 smd rect (at 1.27 0) (size 1 1) (layers F.Cu) (net 1 GND))\n"
+        "  )\n"
+        "  (module R_0805 (layer F.Cu) (tedit 0) (tstamp 5C000002)\n"
+        "    (at 30 10)\n"
+        "    (pad 1 smd rect (at -1.27 0) (size 1 1) (layers F.Cu) (net 2 SIG))\n"
+        "    (pad 2 smd rect (at 1.27 0) (size 1 1) (layers F.Cu) (net 1 GND))\n"
+        "  )\n"
+        "  (segment (start 8.73 10) (end 8.73 20) (width 0.25) (layer F.Cu) (net 2))\n"
+        "  (segment (start 8.73 20) (end 28.73 20) (width 0.25) (layer F.Cu) (net 2))\n"
+        "  (segment (start 28.73 20) (end 28.73 10) (width 0.25) (layer F.Cu) (net 2))\n"
+        "  (via (at 20 5) (size 0.8) (drill 0.4) (layers F.Cu B.Cu) (net 1))\n"
+        "  (zone (net 1) (net_name GND) (layer F.Cu) (tstamp 0) (hatch edge 0.508)\n"
+        "    (connect_pads (clearance 0.3))\n"
+        "    (min_thickness 0.25)\n"
+        "    (fill yes (thermal_gap 0.3) (thermal_bridge_width 0.3))\n"
+        "    (polygon (pts (xy 0 0) (xy 40 0) (xy 40 15) (xy 0 15)))\n"
+        "  )\n"
+        ")\n";
+
+
+/**
+ * What the connectivity tells of a board: the items connected to each item, the number
+ * of nodes of each net and the number of missing connections
+ */
+struct CONNECTIONS
+{
+    std::map<const BOARD_CONNECTED_ITEM*, std::set<const BOARD_CONNECTED_ITEM*>> m_connected;
+    std::map<int, unsigned>                                                      m_nodeCounts;
+    unsigned                                                                     m_unconnected;
+};
+
+
+static CONNECTIONS connections( const CONNECTIVITY_DATA& aConnectivity, BOARD* aBoard )
+{
+    static const KICAD_T types[] = { PCB_TRACE_T, PCB_VIA_T, PCB_PAD_T, PCB_ZONE_AREA_T, EOT };
+
+    CONNECTIONS ret;
+    std::vector<const BOARD_CONNECTED_ITEM*> items;
+
+    for( auto track : aBoard->Tracks() )
+        items.push_back( track );
+
+    for( auto mod : aBoard->Modules() )
+    {
+        for( auto pad : mod->Pads() )
+            items.push_back( pad );
+    }
+
+    for( auto zone : aBoard->Zones() )
+        items.push_back( zone );
+
+    for( auto item : items )
+    {
+        auto& connected = ret.m_connected[item];
+
+        for( auto other : aConnectivity.GetConnectedItems( item, types ) )
+            connected.insert( other );
+
+        ret.m_nodeCounts[item->GetNetCode()] = aConnectivity.GetNodeCount( item->GetNetCode() );
+    }
+
+    ret.m_unconnected = aConnectivity.GetUnconnectedCount();
+
+    return ret;
+}
+
+
+/**
+ * A board whose connectivity is built once, then kept up to date with Synchronize()
+ */
+struct CONNECTIVITY_SYNC_FIXTURE
+{
+    CONNECTIVITY_SYNC_FIXTURE()
+    {
+        PCB_IO io;
+
+        m_board.reset( dynamic_cast<BOARD*>( io.Parse( s_board ) ) );
+
+        BOOST_REQUIRE( m_board );
+        BOOST_REQUIRE_EQUAL( m_board->Tracks().size(), 4u );
+
+        m_board->BuildConnectivity();
+    }
+
+    /**
+     * Checks that the connectivity synchronized with the board tells the same as one
+     * built from scratch
+     */
+    void checkAgainstBuild()
+    {
+        CONNECTIVITY_DATA built;
+        built.Build( m_board.get() );
+
+        CONNECTIONS expected = connections( built, m_board.get() );
+        CONNECTIONS synchronized = connections( *m_board->GetConnectivity(), m_board.get() );
+
+        BOOST_CHECK( synchronized.m_connected == expected.m_connected );
+        BOOST_CHECK( synchronized.m_nodeCounts == expected.m_nodeCounts );
+        BOOST_CHECK_EQUAL( synchronized.m_unconnected, expected.m_unconnected );
+    }
+
+    /// @return the first track of the given type
+    TRACK* track( KICAD_T aType ) const
+    {
+        for( auto track : m_board->Tracks() )
+        {
+            if( track->Type() == aType )
+                return track;
+        }
+
+        BOOST_FAIL( "no track of this type" );
+        return nullptr;
+    }
+
+    /// @return the first pad of the given net
+    D_PAD* pad( int aNetCode ) const
+    {
+        for( auto mod : m_board->Modules() )
+        {
+            for( auto pad : mod->Pads() )
+            {
+                if( pad->GetNetCode() == aNetCode )
+                    return pad;
+            }
+        }
+
+        BOOST_FAIL( "no pad on this net" );
+        return nullptr;
+    }
+
+    std::unique_ptr<BOARD> m_board;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ConnectivitySync, CONNECTIVITY_SYNC_FIXTURE )
+
+
+/**
+ * A track moved away from its pad breaks the SIG net in two
+ */
+BOOST_AUTO_TEST_CASE( MovedTrack )
+{
+    const unsigned unconnected = m_board->GetConnectivity()->GetUnconnectedCount();
+
+    TRACK* segment = track( PCB_TRACE_T );
+
+    segment->Move( wxPoint( -Millimeter2iu( 2 ), 0 ) );
+
+    BOOST_CHECK( m_board->GetConnectivity()->Synchronize( m_board.get() ) );
+    BOOST_CHECK_GT( m_board->GetConnectivity()->GetUnconnectedCount(), unconnected );
+    checkAgainstBuild();
+
+    // And moved back
+    segment->Move( wxPoint( Millimeter2iu( 2 ), 0 ) );
+
+    BOOST_CHECK( m_board->GetConnectivity()->Synchronize( m_board.get() ) );
+    BOOST_CHECK_EQUAL( m_board->GetConnectivity()->GetUnconnectedCount(), unconnected );
+    checkAgainstBuild();
+}
+
+
+/**
+ * A track deleted behind the back of the connectivity, and another one created at the same
+ * address on another net: the entry of the deleted one must not be taken for the new one
+ */
+BOOST_AUTO_TEST_CASE( ReusedAddress )
+{
+    TRACK* deleted = track( PCB_TRACE_T );
+
+    m_board->Remove( deleted );
+    deleted->~TRACK();
+
+    // The placement new gives the new track the address of the deleted one for sure
+    TRACK* added = new( deleted ) TRACK( m_board.get() );
+    added->SetStart( wxPoint( Millimeter2iu( 11.27 ), Millimeter2iu( 10 ) ) );
+    added->SetEnd( wxPoint( Millimeter2iu( 20 ), Millimeter2iu( 5 ) ) );
+    added->SetWidth( Millimeter2iu( 0.25 ) );
+    added->SetLayer( F_Cu );
+    added->SetNetCode( 1 );
+    m_board->Add( added );
+
+    BOOST_CHECK( m_board->GetConnectivity()->Synchronize( m_board.get() ) );
+    checkAgainstBuild();
+}
+
+
+/**
+ * A pad moved to another net leaves the tracks of its former net dangling
+ */
+BOOST_AUTO_TEST_CASE( PadNetChange )
+{
+    pad( 2 )->SetNetCode( 1 );
+
+    BOOST_CHECK( m_board->GetConnectivity()->Synchronize( m_board.get() ) );
+    checkAgainstBuild();
+}
+
+
+/**
+ * The zone connects the GND pads and via once filled
+ */
+BOOST_AUTO_TEST_CASE( RefilledZone )
+{
+    ZONE_FILLER filler( m_board.get() );
+
+    BOOST_REQUIRE( filler.Fill( m_board->Zones() ) );
+    BOOST_REQUIRE( m_board->Zones()[0]->IsFilled() );
+
+    m_board->GetConnectivity()->Synchronize( m_board.get() );
+    checkAgainstBuild();
+
+    // Refilled after the via moved out of the zone
+    track( PCB_VIA_T )->Move( wxPoint( 0, Millimeter2iu( 20 ) ) );
+
+    BOOST_REQUIRE( filler.Fill( m_board->Zones() ) );
+
+    m_board->GetConnectivity()->Synchronize( m_board.get() );
+    checkAgainstBuild();
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,181 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the footprint library cache of PCB_IO, which parses the footprints only
+ * when they are asked for and follows the changes of each file.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <class_module.h>
+#include <kicad_plugin.h>
+#include <wildcards_and_files_ext.h>
+
+#include <wx/datetime.h>
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <memory>
+
+
+static std::string footprintText( const std::string& aDescription )
+{
+    return "(module R_0603 (layer F.Cu) (tedit 0)\n"
+           "  (descr \"" + aDescription + "\")\n"
+           "  (fp_text reference REF** (at 0 -1.5) (layer F.SilkS)\n"
+           "    (effects (font (size 1 1) (thickness 0.15)))\n"
+           "  )\n"
+           "  (pad 1 smd rect (at -0.75 0) (size 0.8 0.8) (layers F.Cu))\n"
+           ")\n";
+}
+
+
+/**
+ * A footprint library in a temporary directory
+ */
+struct FOOTPRINT_CACHE_FIXTURE
+{
+    FOOTPRINT_CACHE_FIXTURE()
+    {
+        wxFileName fn( wxFileName::CreateTempFileName( wxT( "qa_fp_cache" ) ) );
+
+        wxRemoveFile( fn.GetFullPath() );
+        fn.SetExt( KiCadFootprintLibPathExtension );
+        m_libPath = fn.GetFullPath();
+
+        BOOST_REQUIRE( wxFileName::Mkdir( m_libPath ) );
+    }
+
+    ~FOOTPRINT_CACHE_FIXTURE()
+    {
+        wxFileName::Rmdir( m_libPath, wxPATH_RMDIR_RECURSIVE );
+    }
+
+    /**
+     * Writes a footprint file, dated aAge seconds in the past so each write is seen as a
+     * change whatever the time resolution of the file system is.
+     */
+    void writeFootprint( const wxString& aName, const std::string& aText, int aAge )
+    {
+        wxFileName fn( m_libPath, aName, KiCadFootprintFileExtension );
+        wxFFile    file( fn.GetFullPath(), wxT( "wb" ) );
+
+        BOOST_REQUIRE( file.IsOpened() );
+        BOOST_REQUIRE( file.Write( aText.data(), aText.size() ) == aText.size() );
+        file.Close();
+
+        wxDateTime date = wxDateTime::Now() - wxTimeSpan::Seconds( aAge );
+
+        fn.SetTimes( &date, &date, NULL );
+        touchLibrary( aAge );
+    }
+
+    void touchLibrary( int aAge )
+    {
+        wxFileName dir( m_libPath, wxEmptyString );
+        wxDateTime date = wxDateTime::Now() - wxTimeSpan::Seconds( aAge );
+
+        dir.SetTimes( &date, &date, NULL );
+    }
+
+    wxArrayString enumerate()
+    {
+        wxArrayString names;
+
+        m_io.FootprintEnumerate( names, m_libPath, false );
+        names.Sort();
+
+        return names;
+    }
+
+    wxString description( const wxString& aName )
+    {
+        std::unique_ptr<MODULE> footprint( m_io.FootprintLoad( m_libPath, aName ) );
+
+        return footprint ? footprint->GetDescription() : wxString( "<none>" );
+    }
+
+    PCB_IO   m_io;
+    wxString m_libPath;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( FootprintCache, FOOTPRINT_CACHE_FIXTURE )
+
+
+/**
+ * The footprint files are listed without being parsed, and a broken one only makes its own
+ * footprint fail
+ */
+BOOST_AUTO_TEST_CASE( LazyParsing )
+{
+    writeFootprint( "good", footprintText( "first" ), 100 );
+    writeFootprint( "broken", "(module broken (layer F.Cu) (bogus", 100 );
+
+    wxArrayString names = enumerate();
+
+    BOOST_REQUIRE_EQUAL( names.size(), 2 );
+    BOOST_CHECK( names[0] == "broken" );
+    BOOST_CHECK( names[1] == "good" );
+
+    BOOST_CHECK( description( "good" ) == "first" );
+    BOOST_CHECK( description( "missing" ) == "<none>" );
+    BOOST_CHECK_THROW( m_io.FootprintLoad( m_libPath, "broken" ), IO_ERROR );
+    BOOST_CHECK( m_io.GetEnumeratedFootprint( m_libPath, "broken" ) == nullptr );
+}
+
+
+/**
+ * A changed file is parsed again, an added or removed one is found
+ */
+BOOST_AUTO_TEST_CASE( FileChanges )
+{
+    writeFootprint( "first", footprintText( "one" ), 200 );
+    writeFootprint( "second", footprintText( "two" ), 200 );
+
+    BOOST_CHECK( description( "first" ) == "one" );
+    BOOST_CHECK( description( "second" ) == "two" );
+
+    writeFootprint( "first", footprintText( "one, changed" ), 100 );
+
+    BOOST_CHECK( description( "first" ) == "one, changed" );
+    BOOST_CHECK( description( "second" ) == "two" );
+
+    writeFootprint( "third", footprintText( "three" ), 50 );
+
+    BOOST_CHECK_EQUAL( enumerate().size(), 3 );
+    BOOST_CHECK( description( "third" ) == "three" );
+
+    wxRemoveFile( wxFileName( m_libPath, "second", KiCadFootprintFileExtension ).GetFullPath() );
+    touchLibrary( 10 );
+
+    BOOST_CHECK_EQUAL( enumerate().size(), 2 );
+    BOOST_CHECK( description( "second" ) == "<none>" );
+    BOOST_CHECK( description( "first" ) == "one, changed" );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,163 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the library index files of FOOTPRINT_LIST_IMPL, which spare parsing the
+ * libraries which did not change.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <footprint_info_impl.h>
+#include <fp_lib_table.h>
+#include <wildcards_and_files_ext.h>
+
+#include <wx/datetime.h>
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#include <wx/utils.h>
+
+
+/**
+ * A footprint library and a configuration directory, for the index files, in temporary
+ * directories
+ */
+struct FOOTPRINT_LIST_INDEX_FIXTURE
+{
+    FOOTPRINT_LIST_INDEX_FIXTURE()
+    {
+        m_configPath = makeTempDir( wxT( "qa_fp_config" ), wxEmptyString );
+        m_libPath = makeTempDir( wxT( "qa_fp_index" ), KiCadFootprintLibPathExtension );
+
+        m_hadConfigHome = wxGetEnv( wxT( "KICAD_CONFIG_HOME" ), &m_oldConfigHome );
+        wxSetEnv( wxT( "KICAD_CONFIG_HOME" ), m_configPath );
+
+        m_table.InsertRow( new FP_LIB_TABLE_ROW( wxT( "Lib" ), m_libPath, wxT( "KiCad" ),
+                                                 wxEmptyString ) );
+    }
+
+    ~FOOTPRINT_LIST_INDEX_FIXTURE()
+    {
+        if( m_hadConfigHome )
+            wxSetEnv( wxT( "KICAD_CONFIG_HOME" ), m_oldConfigHome );
+        else
+            wxUnsetEnv( wxT( "KICAD_CONFIG_HOME" ) );
+
+        wxFileName::Rmdir( m_libPath, wxPATH_RMDIR_RECURSIVE );
+        wxFileName::Rmdir( m_configPath, wxPATH_RMDIR_RECURSIVE );
+    }
+
+    static wxString makeTempDir( const wxString& aPrefix, const wxString& aExtension )
+    {
+        wxFileName fn( wxFileName::CreateTempFileName( aPrefix ) );
+
+        wxRemoveFile( fn.GetFullPath() );
+        fn.SetExt( aExtension );
+        BOOST_REQUIRE( wxFileName::Mkdir( fn.GetFullPath() ) );
+
+        return fn.GetFullPath();
+    }
+
+    /**
+     * Writes a footprint file dated aDate, which gives the library timestamp
+     */
+    void writeFootprint( const wxString& aName, const std::string& aDescription,
+                         const wxDateTime& aDate )
+    {
+        std::string text = "(module " + aName.ToStdString() + " (layer F.Cu) (tedit 0)\n"
+                           "  (descr \"" + aDescription + "\")\n"
+                           "  (tags \"R res\")\n"
+                           "  (pad 1 smd rect (at -0.75 0) (size 0.8 0.8) (layers F.Cu))\n"
+                           "  (pad 2 smd rect (at 0.75 0) (size 0.8 0.8) (layers F.Cu))\n"
+                           ")\n";
+
+        wxFileName fn( m_libPath, aName, KiCadFootprintFileExtension );
+        wxFFile    file( fn.GetFullPath(), wxT( "wb" ) );
+
+        BOOST_REQUIRE( file.IsOpened() );
+        BOOST_REQUIRE( file.Write( text.data(), text.size() ) == text.size() );
+        file.Close();
+
+        BOOST_REQUIRE( fn.SetTimes( &aDate, &aDate, NULL ) );
+    }
+
+    /**
+     * @return the description of aName read by a new footprint list
+     */
+    wxString readDescription( const wxString& aName )
+    {
+        FOOTPRINT_LIST_IMPL list;
+
+        BOOST_CHECK( list.ReadFootprintFiles( &m_table ) );
+        BOOST_REQUIRE_EQUAL( list.GetCount(), 2 );
+
+        FOOTPRINT_INFO* info = list.GetModuleInfo( wxT( "Lib:" ) + aName );
+
+        BOOST_REQUIRE( info );
+        BOOST_CHECK_EQUAL( info->GetPadCount(), 2 );
+        BOOST_CHECK( info->GetKeywords() == "R res" );
+
+        return info->GetDescription();
+    }
+
+    FP_LIB_TABLE m_table;
+    wxString     m_configPath;
+    wxString     m_libPath;
+    wxString     m_oldConfigHome;
+    bool         m_hadConfigHome;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( FootprintListIndex, FOOTPRINT_LIST_INDEX_FIXTURE )
+
+
+/**
+ * A library is read from its index while it is unchanged, and parsed again once it changed
+ */
+BOOST_AUTO_TEST_CASE( UnchangedLibrary )
+{
+    wxDateTime date( 1, wxDateTime::Jan, 2019, 12, 0, 0 );
+
+    writeFootprint( wxT( "R_0603" ), "first", date );
+    writeFootprint( wxT( "R_0805" ), "second", date );
+
+    BOOST_CHECK( readDescription( wxT( "R_0603" ) ) == "first" );
+
+    wxDir indexDir( wxFileName( m_configPath, wxT( "fp-info-index" ) ).GetFullPath() );
+    wxString indexFile;
+
+    BOOST_CHECK( indexDir.IsOpened() && indexDir.GetFirst( &indexFile ) );
+
+    // Same timestamp: the index written above is used, not the file
+    writeFootprint( wxT( "R_0603" ), "changed", date );
+    BOOST_CHECK( readDescription( wxT( "R_0603" ) ) == "first" );
+
+    writeFootprint( wxT( "R_0603" ), "changed", date + wxTimeSpan::Minutes( 1 ) );
+    BOOST_CHECK( readDescription( wxT( "R_0603" ) ) == "changed" );
+    BOOST_CHECK( readDescription( wxT( "R_0805" ) ) == "second" );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
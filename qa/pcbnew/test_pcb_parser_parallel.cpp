@@ -0,0 +1,199 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the parsing of the board items on the thread pool, which has to give the
+ * same board as the parsing on a single thread.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <class_board.h>
+#include <kicad_plugin.h>
+#include <pcb_parser.h>
+#include <richio.h>
+
+#include <memory>
+
+
+static const char s_boardHeader[] =
+        "(kicad_pcb (version 20171130) (host pcbnew 5.1)\n"
+        "  (general (thickness 1.6))\n"
+        "  (page A4)\n"
+        "  (layers\n"
+        "    (0 F.Cu signal)\n"
+        "    (31 B.Cu signal)\n"
+        "    (37 F.SilkS user)\n"
+        "    (44 Edge.Cuts user)\n"
+        "  )\n"
+        "  (net 0 \"\")\n"
+        "  (net 1 GND)\n"
+        "  (net 2 \"Net-(R1-Pad1)\")\n";
+
+
+static const char s_boardItems[] =
+        "  (module R_0603 (layer F.Cu) (tedit 0) (tstamp 5C000001)\n"
+        "    (at 10 10)\n"
+        "    (fp_text reference R1 (at 0 -1.5) (layer F.SilkS)\n"
+        "      (effects (font (size 1 1) (thickness 0.15)))\n"
+        "    )\n"
+        "    (fp_text value \"10k (1%)\" (at 0 1.5) (layer F.SilkS)\n"
+        "      (effects (font (size 1 1) (thickness 0.15)))\n"
+        "    )\n"
+        "    (pad 1 smd rect (at -0.75 0) (size 0.8 0.8) (layers F.Cu)\n"
+        "      (net 2 \"Net-(R1-Pad1)\"))\n"
+        "    (pad 2 smd rect (at 0.75 0) (size 0.8 0.8) (layers F.Cu) (net 1 GND))\n"
+        "  )\n"
+        "# A comment line with a ( parenthesis\n"
+        "  (gr_text \"a (b) \\\"c)\\\" d\" (at 5 5) (layer F.SilkS)\n"
+        "    (effects (font (size 1 1) (thickness 0.15)))\n"
+        "  )\n"
+        "  (gr_line (start 0 0) (end 50 0) (layer Edge.Cuts) (width 0.1))\n"
+        "  (gr_line (start 50 0) (end 50 40) (layer Edge.Cuts) (width 0.1))\n"
+        "  (via (at 20 20) (size 0.6) (drill 0.3) (layers F.Cu B.Cu) (net 1))\n"
+        "  (zone (net 1) (net_name GND) (layer F.Cu) (tstamp 0) (hatch edge 0.508)\n"
+        "    (connect_pads (clearance 0.508))\n"
+        "    (min_thickness 0.254)\n"
+        "    (fill (arc_segments 32) (thermal_gap 0.508) (thermal_bridge_width 0.508))\n"
+        "    (polygon (pts (xy 0 0) (xy 10 0) (xy 10 10) (xy 0 10)))\n"
+        "  )\n"
+        "  (zone (net 0) (net_name VCC) (layer B.Cu) (tstamp 0) (hatch edge 0.508)\n"
+        "    (connect_pads (clearance 0.508))\n"
+        "    (min_thickness 0.254)\n"
+        "    (fill (arc_segments 32) (thermal_gap 0.508) (thermal_bridge_width 0.508))\n"
+        "    (polygon (pts (xy 20 0) (xy 30 0) (xy 30 10) (xy 20 10)))\n"
+        "  )\n";
+
+
+/**
+ * Builds a board with all kinds of items, followed by enough tracks to be split between
+ * several tasks.
+ */
+static std::string makeBoard( int aTrackCount, const std::string& aTail = ")\n" )
+{
+    std::string board = std::string( s_boardHeader ) + s_boardItems;
+
+    for( int ii = 0; ii < aTrackCount; ++ii )
+    {
+        board += "  (segment (start " + std::to_string( ii ) + " 0) (end " + std::to_string( ii )
+                 + " 10) (width 0.25) (layer " + ( ii % 2 ? "B.Cu" : "F.Cu" ) + ") (net "
+                 + std::to_string( ii % 3 ) + "))\n";
+    }
+
+    return board + aTail;
+}
+
+
+static std::unique_ptr<BOARD> parseBoard( const std::string& aText, bool aParallel )
+{
+    STRING_LINE_READER reader( aText, "test board" );
+    PCB_PARSER         parser;
+
+    parser.SetLineReader( &reader );
+    parser.SetParallelLoad( aParallel );
+
+    return std::unique_ptr<BOARD>( static_cast<BOARD*>( parser.Parse() ) );
+}
+
+
+static std::string formatBoard( BOARD& aBoard )
+{
+    PCB_IO io;
+
+    io.Format( &aBoard );
+
+    return io.GetStringOutput( true );
+}
+
+
+BOOST_AUTO_TEST_SUITE( PcbParserParallel )
+
+
+/**
+ * The board parsed in parallel is written as the board parsed serially
+ */
+BOOST_AUTO_TEST_CASE( SameBoard )
+{
+    for( int trackCount : { 0, 1, 63, 64, 1000 } )
+    {
+        BOOST_TEST_CONTEXT( "Tracks: " << trackCount )
+        {
+            std::string text = makeBoard( trackCount );
+
+            std::unique_ptr<BOARD> serial = parseBoard( text, false );
+            std::unique_ptr<BOARD> parallel = parseBoard( text, true );
+
+            BOOST_CHECK_EQUAL( parallel->GetNetCount(), serial->GetNetCount() );
+            BOOST_CHECK_EQUAL( parallel->Tracks().size(), serial->Tracks().size() );
+            BOOST_CHECK_EQUAL( parallel->Zones().size(), serial->Zones().size() );
+            BOOST_CHECK( formatBoard( *parallel ) == formatBoard( *serial ) );
+        }
+    }
+}
+
+
+/**
+ * A syntax error is reported at the same place by both parsers
+ */
+BOOST_AUTO_TEST_CASE( SameError )
+{
+    const std::vector<std::string> tails = {
+        "  (segment (start 0 0) (end 1 1) (width 0.25) (layer F.Cu) (bogus 1))\n)\n",
+        "  (via (at 20 20) (size 0.6) (drill 0.3) (layers F.Cu B.Cu) (net 1)\n",
+        "  (gr_line (start 0 0) (end 50 0) (layer Edge.Cuts) (width 0.1))\n  (bogus)\n)\n"
+    };
+
+    for( const std::string& tail : tails )
+    {
+        BOOST_TEST_CONTEXT( "Tail: " << tail )
+        {
+            std::string text = makeBoard( 200, tail );
+            std::string serialError, parallelError;
+
+            try
+            {
+                parseBoard( text, false );
+            }
+            catch( const IO_ERROR& e )
+            {
+                serialError = e.What().ToStdString();
+            }
+
+            try
+            {
+                parseBoard( text, true );
+            }
+            catch( const IO_ERROR& e )
+            {
+                parallelError = e.What().ToStdString();
+            }
+
+            BOOST_CHECK( !serialError.empty() );
+            BOOST_CHECK_EQUAL( parallelError, serialError );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,115 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the routing events saved by PNS::LOGGER and read back for their replay.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <router/pns_logger.h>
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <wx/filename.h>
+
+
+BOOST_AUTO_TEST_SUITE( PnsLogger )
+
+
+/**
+ * The saved events are read back unchanged, among the other records of the log
+ */
+BOOST_AUTO_TEST_CASE( EventsRoundTrip )
+{
+    PNS::LOGGER::EVENT_ENTRY start;
+
+    start.m_type = PNS::LOGGER::EVT_START_ROUTE;
+    start.m_p = VECTOR2I( 1000, -2500 );
+    start.m_layer = 31;
+    start.m_net = 7;
+    start.m_mode = 2;
+    start.m_trackWidth = 250000;
+    start.m_viaDiameter = 600000;
+    start.m_viaDrill = 300000;
+    start.m_diffPairWidth = 200000;
+    start.m_diffPairGap = 150000;
+
+    PNS::LOGGER::EVENT_ENTRY move;
+    move.m_p = VECTOR2I( 5000, 6000 );
+
+    PNS::LOGGER logger;
+    logger.Log( start );
+    logger.NewGroup( "on-colliding-line", 1 );
+    logger.EndGroup();
+    logger.Log( move );
+
+    const wxString fileName = wxFileName::CreateTempFileName( wxT( "pns_events" ) );
+    logger.Save( fileName.ToStdString() );
+
+    std::vector<PNS::LOGGER::EVENT_ENTRY> events;
+    std::ifstream                         stream( fileName.ToStdString() );
+
+    BOOST_CHECK( PNS::LOGGER::ParseEvents( stream, events ) );
+    wxRemoveFile( fileName );
+
+    BOOST_REQUIRE_EQUAL( events.size(), 2u );
+
+    BOOST_CHECK_EQUAL( events[0].m_type, PNS::LOGGER::EVT_START_ROUTE );
+    BOOST_CHECK_EQUAL( events[0].m_p, start.m_p );
+    BOOST_CHECK_EQUAL( events[0].m_layer, 31 );
+    BOOST_CHECK_EQUAL( events[0].m_net, 7 );
+    BOOST_CHECK_EQUAL( events[0].m_mode, 2 );
+    BOOST_CHECK_EQUAL( events[0].m_trackWidth, 250000 );
+    BOOST_CHECK_EQUAL( events[0].m_viaDiameter, 600000 );
+    BOOST_CHECK_EQUAL( events[0].m_viaDrill, 300000 );
+    BOOST_CHECK_EQUAL( events[0].m_diffPairWidth, 200000 );
+    BOOST_CHECK_EQUAL( events[0].m_diffPairGap, 150000 );
+
+    BOOST_CHECK_EQUAL( events[1].m_type, PNS::LOGGER::EVT_MOVE );
+    BOOST_CHECK_EQUAL( events[1].m_p, move.m_p );
+    BOOST_CHECK_EQUAL( events[1].m_net, -1 );
+}
+
+
+/**
+ * Truncated events and unknown event types are rejected
+ */
+BOOST_AUTO_TEST_CASE( MalformedEvents )
+{
+    std::vector<PNS::LOGGER::EVENT_ENTRY> events;
+
+    std::istringstream unknown( "event 9 1 2 3 4 5 6 7 8 9 10\n" );
+    BOOST_CHECK( !PNS::LOGGER::ParseEvents( unknown, events ) );
+
+    std::istringstream truncated( "event 2 1 2\n" );
+    BOOST_CHECK( !PNS::LOGGER::ParseEvents( truncated, events ) );
+
+    BOOST_CHECK( events.empty() );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
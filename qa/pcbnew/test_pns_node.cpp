@@ -0,0 +1,191 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the branches of the router world, which share the index of their parent
+ * and must each see their own changes only.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <router/pns_node.h>
+#include <router/pns_segment.h>
+
+#include <memory>
+#include <set>
+
+
+/**
+ * A root node holding a row of tracks, 10 mm apart
+ */
+struct PNS_NODE_FIXTURE
+{
+    PNS_NODE_FIXTURE()
+    {
+        for( int i = 0; i < 50; i++ )
+            m_tracks.push_back( addTrack( &m_world, i ) );
+    }
+
+    ~PNS_NODE_FIXTURE()
+    {
+        m_world.KillChildren();
+    }
+
+    PNS::SEGMENT* addTrack( PNS::NODE* aNode, int aIndex )
+    {
+        VECTOR2I start( aIndex * 10000000, 0 );
+        std::unique_ptr<PNS::SEGMENT> track( new PNS::SEGMENT(
+                SEG( start, start + VECTOR2I( 0, 5000000 ) ), aIndex + 1 ) );
+
+        track->SetLayer( F_Cu );
+        track->SetWidth( 250000 );
+
+        PNS::SEGMENT* added = track.get();
+        BOOST_REQUIRE( aNode->Add( std::move( track ), true ) );
+
+        return added;
+    }
+
+    /// Items colliding with a short track of another net around the track aIndex
+    std::set<PNS::ITEM*> colliding( PNS::NODE* aNode, int aIndex )
+    {
+        VECTOR2I          p( aIndex * 10000000 - 200000, 1000000 );
+        PNS::SEGMENT      probe( SEG( p, p + VECTOR2I( 400000, 0 ) ), 1000 );
+        PNS::NODE::OBSTACLES obstacles;
+
+        probe.SetLayer( F_Cu );
+        aNode->QueryColliding( &probe, obstacles );
+
+        std::set<PNS::ITEM*> items;
+
+        for( const PNS::OBSTACLE& obs : obstacles )
+            items.insert( obs.m_item );
+
+        return items;
+    }
+
+    PNS::NODE                  m_world;
+    std::vector<PNS::SEGMENT*> m_tracks;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PnsNode, PNS_NODE_FIXTURE )
+
+
+/**
+ * The branches, however deep, see the items of the root
+ */
+BOOST_AUTO_TEST_CASE( BranchSharesItems )
+{
+    PNS::NODE* branch = m_world.Branch();
+    PNS::NODE* deep = branch->Branch()->Branch();
+
+    BOOST_CHECK_EQUAL( deep->Depth(), 3 );
+
+    for( int i = 0; i < (int) m_tracks.size(); i++ )
+    {
+        const std::set<PNS::ITEM*> expected = { m_tracks[i] };
+
+        BOOST_CHECK( colliding( &m_world, i ) == expected );
+        BOOST_CHECK( colliding( branch, i ) == expected );
+        BOOST_CHECK( colliding( deep, i ) == expected );
+    }
+}
+
+
+/**
+ * The changes of a branch are seen by its own branches only
+ */
+BOOST_AUTO_TEST_CASE( BranchChanges )
+{
+    PNS::NODE* branch = m_world.Branch();
+    PNS::NODE* sibling = m_world.Branch();
+
+    branch->Remove( m_tracks[3] );
+    PNS::SEGMENT* added = addTrack( branch, 60 );
+
+    PNS::NODE* child = branch->Branch();
+    child->Remove( m_tracks[4] );
+
+    BOOST_CHECK( colliding( branch, 3 ).empty() );
+    BOOST_CHECK( colliding( child, 3 ).empty() );
+    BOOST_CHECK_EQUAL( colliding( &m_world, 3 ).size(), 1 );
+    BOOST_CHECK_EQUAL( colliding( sibling, 3 ).size(), 1 );
+
+    BOOST_CHECK_EQUAL( colliding( branch, 60 ).size(), 1 );
+    BOOST_CHECK_EQUAL( colliding( child, 60 ).size(), 1 );
+    BOOST_CHECK( colliding( &m_world, 60 ).empty() );
+    BOOST_CHECK( colliding( sibling, 60 ).empty() );
+
+    BOOST_CHECK_EQUAL( colliding( branch, 4 ).size(), 1 );
+    BOOST_CHECK( colliding( child, 4 ).empty() );
+
+    BOOST_CHECK( branch->Overrides( m_tracks[3] ) );
+    BOOST_CHECK( !branch->Overrides( m_tracks[4] ) );
+    BOOST_CHECK( child->Overrides( m_tracks[4] ) );
+    BOOST_CHECK( !sibling->Overrides( m_tracks[3] ) );
+
+    PNS::NODE::ITEM_VECTOR removed, addedItems;
+    child->GetUpdatedItems( removed, addedItems );
+
+    BOOST_CHECK( removed == PNS::NODE::ITEM_VECTOR( { m_tracks[3], m_tracks[4] } ) );
+    BOOST_CHECK( addedItems == PNS::NODE::ITEM_VECTOR( { added } ) );
+
+    std::set<PNS::ITEM*> net;
+    child->AllItemsInNet( 61, net );
+    BOOST_CHECK_EQUAL( net.size(), 1 );
+
+    net.clear();
+    child->AllItemsInNet( 4, net );
+    BOOST_CHECK( net.empty() );
+}
+
+
+/**
+ * Committing a branch applies its changes to the root
+ */
+BOOST_AUTO_TEST_CASE( Commit )
+{
+    PNS::NODE* branch = m_world.Branch()->Branch();
+
+    branch->Remove( m_tracks[7] );
+    PNS::SEGMENT* added = addTrack( branch, 70 );
+
+    m_world.Commit( branch );
+
+    BOOST_CHECK( !m_world.HasChildren() );
+    BOOST_CHECK( colliding( &m_world, 7 ).empty() );
+    BOOST_CHECK( colliding( &m_world, 70 ) == std::set<PNS::ITEM*>( { added } ) );
+    BOOST_CHECK( added->BelongsTo( &m_world ) );
+
+    // the committed world branches as any other
+    PNS::NODE* next = m_world.Branch();
+    next->Remove( added );
+
+    BOOST_CHECK( colliding( next, 70 ).empty() );
+    BOOST_CHECK_EQUAL( colliding( &m_world, 70 ).size(), 1 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
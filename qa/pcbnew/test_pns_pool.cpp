@@ -0,0 +1,127 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the POOL recycling the memory of the router objects.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <router/pns_pool.h>
+#include <router/pns_segment.h>
+
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+
+BOOST_AUTO_TEST_SUITE( PnsPool )
+
+
+/**
+ * A released block is handed out again to the next allocation of the same size class
+ */
+BOOST_AUTO_TEST_CASE( Recycling )
+{
+    void* block = PNS::POOL::Allocate( 40 );
+    PNS::POOL::Release( block, 40 );
+
+    BOOST_CHECK_EQUAL( PNS::POOL::Allocate( 48 ), block );
+    PNS::POOL::Release( block, 48 );
+
+    PNS::SEGMENT* seg = new PNS::SEGMENT( SEG( VECTOR2I( 0, 0 ), VECTOR2I( 10, 0 ) ), 1 );
+    void*         segBlock = seg;
+    delete seg;
+
+    seg = new PNS::SEGMENT( SEG( VECTOR2I( 0, 0 ), VECTOR2I( 0, 10 ) ), 2 );
+    BOOST_CHECK_EQUAL( (void*) seg, segBlock );
+    BOOST_CHECK_EQUAL( seg->Net(), 2 );
+    delete seg;
+}
+
+
+/**
+ * The blocks in use are aligned and never overlap, whatever their size
+ */
+BOOST_AUTO_TEST_CASE( Blocks )
+{
+    std::vector<std::pair<char*, size_t>> blocks;
+
+    for( size_t i = 0; i < 20000; i++ )
+    {
+        size_t size = 1 + ( i * 37 ) % ( PNS::POOL::MAX_BLOCK_SIZE + 200 );
+        char*  block = static_cast<char*>( PNS::POOL::Allocate( size ) );
+
+        BOOST_REQUIRE_EQUAL( reinterpret_cast<uintptr_t>( block ) % alignof( double ), 0 );
+        memset( block, (int) ( i & 0xff ), size );
+        blocks.emplace_back( block, size );
+
+        // free some blocks along the way, so that they are reused
+        if( i % 3 == 0 )
+        {
+            PNS::POOL::Release( blocks[i / 2].first, blocks[i / 2].second );
+            blocks[i / 2].first = nullptr;
+        }
+    }
+
+    for( size_t i = 0; i < blocks.size(); i++ )
+    {
+        if( !blocks[i].first )
+            continue;
+
+        bool intact = true;
+
+        for( size_t j = 0; j < blocks[i].second; j++ )
+            intact &= blocks[i].first[j] == (char) ( i & 0xff );
+
+        BOOST_CHECK_MESSAGE( intact, "Block " << i << " was overwritten" );
+        PNS::POOL::Release( blocks[i].first, blocks[i].second );
+    }
+}
+
+
+/**
+ * The containers work the same with the POOL_ALLOCATOR
+ */
+BOOST_AUTO_TEST_CASE( Allocator )
+{
+    typedef std::pair<const int, int> VALUE;
+
+    std::unordered_multimap<int, int, std::hash<int>, std::equal_to<int>,
+                            PNS::POOL_ALLOCATOR<VALUE>> map;
+
+    for( int i = 0; i < 5000; i++ )
+        map.emplace( i % 50, i );
+
+    auto copy = map;
+    map.clear();
+
+    BOOST_CHECK_EQUAL( copy.size(), 5000 );
+    BOOST_CHECK_EQUAL( copy.count( 7 ), 100 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
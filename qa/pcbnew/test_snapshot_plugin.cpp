@@ -0,0 +1,280 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the binary board snapshots, which have to give back the board they were
+ * written from.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <class_board.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <kicad_plugin.h>
+#include <properties.h>
+#include <snapshot_plugin.h>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <memory>
+#include <vector>
+
+
+static const char s_board[] =
+        "(kicad_pcb (version 20171130) (host pcbnew 5.1)\n"
+        "  (general (thickness 1.6))\n"
+        "  (page A4)\n"
+        "  (layers\n"
+        "    (0 F.Cu signal)\n"
+        "    (31 B.Cu signal)\n"
+        "    (37 F.SilkS user)\n"
+        "    (44 Edge.Cuts user)\n"
+        "  )\n"
+        "  (net 0 \"\")\n"
+        "  (net 1 GND)\n"
+        "  (net 2 \"Net-(R1-Pad1)\")\n"
+        "  (module R_0603 (layer F.Cu) (tedit 0) (tstamp 5C000001)\n"
+        "    (at 10 10)\n"
+        "    (fp_text reference R1 (at 0 -1.5) (layer F.SilkS)\n"
+        "      (effects (font (size 1 1) (thickness 0.15)))\n"
+        "    )\n"
+        "    (pad 1 smd rect (at -0.75 0) (size 0.8 0.8) (layers F.Cu)\n"
+        "      (net 2 \"Net-(R1-Pad1)\"))\n"
+        "    (pad 2 smd rect (at 0.75 0) (size 0.8 0.8) (layers F.Cu) (net 1 GND))\n"
+        "  )\n"
+        "  (gr_line (start 0 0) (end 50 0) (layer Edge.Cuts) (width 0.1))\n"
+        "  (segment (start 9.25 10) (end 5 10) (width 0.25) (layer F.Cu) (net 2) (tstamp 1A))\n"
+        "  (segment (start 5 10) (end 5 20) (width 0.25) (layer B.Cu) (net 2))\n"
+        "  (via blind (at 5 10) (size 0.6) (drill 0.3) (layers F.Cu B.Cu) (net 2))\n"
+        "  (via (at 20 20) (size 0.8) (layers F.Cu B.Cu) (net 1) (status 40000))\n"
+        "  (zone (net 1) (net_name GND) (layer F.Cu) (tstamp 0) (hatch edge 0.508)\n"
+        "    (connect_pads (clearance 0.508))\n"
+        "    (min_thickness 0.254)\n"
+        "    (fill yes (thermal_gap 0.508) (thermal_bridge_width 0.508))\n"
+        "    (polygon (pts (xy 0 0) (xy 40 0) (xy 40 40) (xy 0 40)))\n"
+        "    (filled_polygon (pts (xy 1 1) (xy 39 1) (xy 39 39) (xy 20 30) (xy 1 39)))\n"
+        "    (filled_polygon (pts (xy 45 1) (xy 49 1) (xy 49 5)))\n"
+        "  )\n"
+        "  (zone (net 0) (net_name \"\") (layer B.Cu) (tstamp 0) (hatch edge 0.508)\n"
+        "    (connect_pads (clearance 0.508))\n"
+        "    (min_thickness 0.254)\n"
+        "    (keepout (tracks not_allowed) (vias allowed) (copperpour not_allowed))\n"
+        "    (fill (thermal_gap 0.508) (thermal_bridge_width 0.508))\n"
+        "    (polygon (pts (xy 60 0) (xy 70 0) (xy 70 10)))\n"
+        "  )\n"
+        ")\n";
+
+
+/**
+ * Writes a board file and removes it, and its snapshot, at the end of the test
+ */
+struct SNAPSHOT_FIXTURE
+{
+    SNAPSHOT_FIXTURE()
+    {
+        m_boardFileName = wxFileName::CreateTempFileName( wxT( "qa_snapshot" ) );
+        wxRemoveFile( m_boardFileName );
+
+        wxFileName fn( m_boardFileName );
+        fn.SetExt( KiCadPcbFileExtension );
+        m_boardFileName = fn.GetFullPath();
+        m_snapshotFileName = SNAPSHOT_PLUGIN::SnapshotFileName( m_boardFileName );
+
+        writeFile( m_boardFileName, s_board );
+    }
+
+    ~SNAPSHOT_FIXTURE()
+    {
+        wxRemoveFile( m_boardFileName );
+        wxRemoveFile( m_snapshotFileName );
+    }
+
+    static void writeFile( const wxString& aFileName, const std::string& aText )
+    {
+        wxFFile file( aFileName, wxT( "wb" ) );
+
+        BOOST_REQUIRE( file.IsOpened() );
+        BOOST_REQUIRE( file.Write( aText.data(), aText.size() ) == aText.size() );
+    }
+
+    static std::string formatBoard( BOARD& aBoard )
+    {
+        PCB_IO io;
+
+        io.Format( &aBoard );
+
+        return io.GetStringOutput( true );
+    }
+
+    ///> The types and ends of the tracks of aBoard, in the order of the board
+    static std::vector<wxString> trackOrder( BOARD& aBoard )
+    {
+        std::vector<wxString> order;
+
+        for( TRACK* track : aBoard.Tracks() )
+        {
+            order.push_back( wxString::Format( wxT( "%d %d,%d %d,%d" ), track->Type(),
+                                               track->GetStart().x, track->GetStart().y,
+                                               track->GetEnd().x, track->GetEnd().y ) );
+        }
+
+        return order;
+    }
+
+    wxString m_boardFileName;
+    wxString m_snapshotFileName;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( SnapshotPlugin, SNAPSHOT_FIXTURE )
+
+
+/**
+ * The board loaded from a snapshot is the same as the one it was written from, zone fills
+ * and their triangulation included.
+ */
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+    PCB_IO                 io;
+    SNAPSHOT_PLUGIN        snapshotIo;
+    std::unique_ptr<BOARD> board( io.Load( m_boardFileName, NULL ) );
+
+    BOOST_REQUIRE_EQUAL( board->GetAreaCount(), 2 );
+    board->GetArea( 0 )->CacheTriangulation();
+
+    snapshotIo.Save( m_snapshotFileName, board.get() );
+    BOOST_CHECK( SNAPSHOT_PLUGIN::IsUpToDate( m_snapshotFileName, m_boardFileName ) );
+
+    std::unique_ptr<BOARD> loaded( snapshotIo.Load( m_snapshotFileName, NULL ) );
+
+    BOOST_CHECK( loaded->GetFileName() == m_boardFileName );
+    BOOST_CHECK_EQUAL( loaded->Tracks().size(), 4 );
+    BOOST_CHECK( formatBoard( *loaded ) == formatBoard( *board ) );
+
+    const SHAPE_POLY_SET& fill = loaded->GetArea( 0 )->GetFilledPolysList();
+
+    BOOST_CHECK_EQUAL( fill.OutlineCount(), 2 );
+    BOOST_CHECK( fill.IsTriangulationUpToDate() );
+    BOOST_CHECK_EQUAL( fill.TriangulatedPolyCount(),
+                       board->GetArea( 0 )->GetFilledPolysList().TriangulatedPolyCount() );
+}
+
+
+/**
+ * The tracks of a board loaded from its snapshot are in the order of the board loaded from
+ * the board file, whether the snapshot was written after loading or after saving the board.
+ */
+BOOST_AUTO_TEST_CASE( TrackOrder )
+{
+    PCB_IO                 io;
+    SNAPSHOT_PLUGIN        snapshotIo;
+    std::unique_ptr<BOARD> board( io.Load( m_boardFileName, NULL ) );
+
+    snapshotIo.Save( m_snapshotFileName, board.get() );
+
+    std::unique_ptr<BOARD> loaded( snapshotIo.Load( m_snapshotFileName, NULL ) );
+
+    BOOST_CHECK( trackOrder( *loaded ) == trackOrder( *board ) );
+
+    // As PCB_EDIT_FRAME::SavePcbFile() does
+    PROPERTIES props;
+
+    props["saved_board"] = "";
+    io.Save( m_boardFileName, board.get() );
+    snapshotIo.Save( m_snapshotFileName, board.get(), &props );
+    BOOST_REQUIRE( SNAPSHOT_PLUGIN::IsUpToDate( m_snapshotFileName, m_boardFileName ) );
+
+    std::unique_ptr<BOARD> reloaded( io.Load( m_boardFileName, NULL ) );
+
+    loaded.reset( snapshotIo.Load( m_snapshotFileName, NULL ) );
+
+    BOOST_CHECK_EQUAL( loaded->Tracks().size(), 4 );
+    BOOST_CHECK( trackOrder( *loaded ) == trackOrder( *reloaded ) );
+}
+
+
+/**
+ * A snapshot is no longer used once its board file changed, and a damaged one is refused
+ */
+BOOST_AUTO_TEST_CASE( OutOfDate )
+{
+    PCB_IO                 io;
+    SNAPSHOT_PLUGIN        snapshotIo;
+    std::unique_ptr<BOARD> board( io.Load( m_boardFileName, NULL ) );
+
+    BOOST_CHECK( !SNAPSHOT_PLUGIN::IsUpToDate( m_snapshotFileName, m_boardFileName ) );
+
+    snapshotIo.Save( m_snapshotFileName, board.get() );
+    BOOST_CHECK( SNAPSHOT_PLUGIN::IsUpToDate( m_snapshotFileName, m_boardFileName ) );
+
+    // Same size, other contents
+    std::string changed = s_board;
+    changed[ changed.find( "9.25" ) ] = '8';
+    writeFile( m_boardFileName, changed );
+    BOOST_CHECK( !SNAPSHOT_PLUGIN::IsUpToDate( m_snapshotFileName, m_boardFileName ) );
+
+    // Truncated
+    wxFFile file( m_snapshotFileName, wxT( "rb" ) );
+    std::string data( file.Length(), '\0' );
+    file.Read( &data[0], data.size() );
+    file.Close();
+
+    writeFile( m_snapshotFileName, data.substr( 0, data.size() - 10 ) );
+    BOOST_CHECK_THROW( snapshotIo.Load( m_snapshotFileName, NULL ), IO_ERROR );
+}
+
+
+/**
+ * A snapshot written by another build, here one with other pointers, is refused
+ */
+BOOST_AUTO_TEST_CASE( OtherBuild )
+{
+    PCB_IO                 io;
+    SNAPSHOT_PLUGIN        snapshotIo;
+    std::unique_ptr<BOARD> board( io.Load( m_boardFileName, NULL ) );
+
+    snapshotIo.Save( m_snapshotFileName, board.get() );
+    BOOST_REQUIRE( SNAPSHOT_PLUGIN::IsUpToDate( m_snapshotFileName, m_boardFileName ) );
+
+    wxFFile file( m_snapshotFileName, wxT( "rb" ) );
+    std::string data( file.Length(), '\0' );
+    file.Read( &data[0], data.size() );
+    file.Close();
+
+    const std::string thisBuild = sizeof( void* ) == 8 ? "64 bit" : "32 bit";
+    const std::string otherBuild = sizeof( void* ) == 8 ? "32 bit" : "64 bit";
+    size_t            pos = data.find( thisBuild );
+
+    BOOST_REQUIRE( pos != std::string::npos );
+    data.replace( pos, thisBuild.size(), otherBuild );
+    writeFile( m_snapshotFileName, data );
+
+    BOOST_CHECK( !SNAPSHOT_PLUGIN::IsUpToDate( m_snapshotFileName, m_boardFileName ) );
+    BOOST_CHECK_THROW( snapshotIo.Load( m_snapshotFileName, NULL ), IO_ERROR );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,457 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for ZONE_FILLER: skipping the zones whose fill inputs did not change, filling
+ * the large zones in tiles and finding the clearance holes with its item index.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <convert_to_biu.h>
+#include <kicad_plugin.h>
+#include <zone_filler.h>
+
+#include <memory>
+#include <sstream>
+
+
+static const char s_board[] =
+        "(kicad_pcb (version 20171130) (host pcbnew 5.1)\n"
+        "  (general (thickness 1.6))\n"
+        "  (page A4)\n"
+        "  (layers\n"
+        "    (0 F.Cu signal)\n"
+        "    (31 B.Cu signal)\n"
+        "    (37 F.SilkS user)\n"
+        "    (44 Edge.Cuts user)\n"
+        "  )\n"
+        "  (net 0 \"\")\n"
+        "  (net 1 GND)\n"
+        "  (net 2 SIG)\n"
+        "  (module R_0603 (layer F.Cu) (tedit 0) (tstamp 5C000001)\n"
+        "    (at 10 10)\n"
+        "    (fp_text reference R1 (at 0 -1.5) (layer F.SilkS)\n"
+        "      (effects (font (size 1 1) (thickness 0.15)))\n"
+        "    )\n"
+        "    (pad 1 smd rect (at -0.75 0) (size 0.8 0.8) (layers F.Cu) (net 2 SIG))\n"
+        "    (pad 2 smd rect (at 0.75 0) (size 0.8 0.8) (layers F.Cu) (net 1 GND))\n"
+        "  )\n"
+        "  (via (at 25 25) (size 0.8) (drill 0.4) (layers F.Cu B.Cu) (net 2))\n"
+        "  (zone (net 1) (net_name GND) (layer F.Cu) (tstamp 0) (hatch edge 0.508)\n"
+        "    (connect_pads (clearance 0.508))\n"
+        "    (min_thickness 0.254)\n"
+        "    (fill yes (thermal_gap 0.508) (thermal_bridge_width 0.508))\n"
+        "    (polygon (pts (xy 0 0) (xy 40 0) (xy 40 40) (xy 0 40)))\n"
+        "  )\n"
+        ")\n";
+
+
+/**
+ * A board with a zone around a footprint and a via, filled once
+ */
+struct ZONE_FILLER_FIXTURE
+{
+    ZONE_FILLER_FIXTURE()
+    {
+        PCB_IO io;
+
+        m_board.reset( dynamic_cast<BOARD*>( io.Parse( s_board ) ) );
+
+        BOOST_REQUIRE( m_board );
+        BOOST_REQUIRE_EQUAL( m_board->Zones().size(), 1u );
+
+        m_board->BuildConnectivity();
+        fill();
+
+        BOOST_REQUIRE( zone()->IsFilled() );
+    }
+
+    ZONE_CONTAINER* zone() const
+    {
+        return m_board->Zones()[0];
+    }
+
+    /// @return the fill input digest of the zone after the fill
+    std::string fill()
+    {
+        ZONE_FILLER filler( m_board.get() );
+
+        BOOST_REQUIRE( filler.Fill( m_board->Zones() ) );
+
+        return zone()->GetFillInputHash();
+    }
+
+    std::unique_ptr<BOARD> m_board;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ZoneFiller, ZONE_FILLER_FIXTURE )
+
+
+/**
+ * An unchanged board keeps its fill and its hash
+ */
+BOOST_AUTO_TEST_CASE( Unchanged )
+{
+    const std::string hash = zone()->GetFillInputHash();
+
+    BOOST_CHECK_EQUAL( hash.size(), 32u );
+    BOOST_CHECK_EQUAL( fill(), hash );
+}
+
+
+/**
+ * The fill of a zone whose inputs did not change is kept as it is, and it is recomputed
+ * once an item it depends on moved
+ */
+BOOST_AUTO_TEST_CASE( KeptUntilEdited )
+{
+    // A fill the filler would never compute, to tell a kept fill from a new one
+    SHAPE_POLY_SET marker;
+    marker.NewOutline();
+    marker.Append( 0, 0 );
+    marker.Append( 100, 0 );
+    marker.Append( 100, 100 );
+
+    const MD5_HASH markerHash = marker.GetHash();
+
+    zone()->SetFilledPolysList( marker );
+
+    fill();
+    BOOST_CHECK( zone()->GetFilledPolysList().GetHash() == markerHash );
+
+    m_board->Tracks().front()->Move( wxPoint( Millimeter2iu( 2 ), 0 ) );
+
+    fill();
+    BOOST_CHECK( zone()->GetFilledPolysList().GetHash() != markerHash );
+    BOOST_CHECK( zone()->IsFilled() );
+}
+
+
+/**
+ * The digest is saved as a fixed width field, and a board read back is not refilled
+ */
+BOOST_AUTO_TEST_CASE( SavedDigest )
+{
+    const std::string hash = zone()->GetFillInputHash();
+    PCB_IO            io;
+
+    io.Format( m_board.get() );
+    const std::string saved = io.GetStringOutput( true );
+
+    BOOST_CHECK_NE( saved.find( "(input_hash " + hash + ")" ), std::string::npos );
+
+    m_board.reset( dynamic_cast<BOARD*>( io.Parse( saved ) ) );
+    BOOST_REQUIRE( m_board );
+    BOOST_CHECK_EQUAL( zone()->GetFillInputHash(), hash );
+
+    m_board->BuildConnectivity();
+    BOOST_CHECK_EQUAL( fill(), hash );
+}
+
+
+/**
+ * Footprints and vias moved diagonally, the usual 45 degree edit, are filled around again
+ */
+BOOST_AUTO_TEST_CASE( DiagonalMoves )
+{
+    const wxPoint diagonal( Millimeter2iu( 2 ), -Millimeter2iu( 2 ) );
+
+    const std::string hash = zone()->GetFillInputHash();
+
+    // The pads keep their position in the footprint
+    m_board->Modules().front()->Move( diagonal );
+
+    const std::string movedModuleHash = fill();
+    BOOST_CHECK_NE( movedModuleHash, hash );
+
+    m_board->Tracks().front()->Move( diagonal );
+
+    const std::string movedViaHash = fill();
+    BOOST_CHECK_NE( movedViaHash, movedModuleHash );
+
+    // Moved back, the inputs are the ones of the first fill
+    m_board->Modules().front()->Move( -diagonal );
+    m_board->Tracks().front()->Move( -diagonal );
+
+    BOOST_CHECK_EQUAL( fill(), hash );
+}
+
+
+/**
+ * A footprint turned in place moves its pads and its texts
+ */
+BOOST_AUTO_TEST_CASE( RotatedFootprint )
+{
+    const std::string hash = zone()->GetFillInputHash();
+    MODULE*           module = m_board->Modules().front();
+
+    module->Rotate( module->GetPosition(), 900 );
+
+    BOOST_CHECK_NE( fill(), hash );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+/**
+ * @return a board with a GND zone over a grid of pads, every other one on GND with thermal
+ * spokes, and SIG tracks crossing the zone, so that the tile edges cut through spokes and
+ * clearance holes whatever the tile grid.
+ */
+static std::string tiledFillBoard()
+{
+    std::ostringstream board;
+
+    board << "(kicad_pcb (version 20171130) (host pcbnew 5.1)\n"
+             "  (general (thickness 1.6))\n"
+             "  (page A4)\n"
+             "  (layers (0 F.Cu signal) (31 B.Cu signal) (44 Edge.Cuts user))\n"
+             "  (net 0 \"\")\n"
+             "  (net 1 GND)\n"
+             "  (net 2 SIG)\n"
+             "  (module GRID (layer F.Cu) (tedit 0) (tstamp 5C000001)\n"
+             "    (at 0 0)\n";
+
+    int padNum = 1;
+
+    for( int ix = 1; ix < 16; ix++ )
+    {
+        for( int iy = 1; iy < 16; iy++ )
+        {
+            bool gnd = ( ix + iy ) % 2 == 0;
+
+            board << "    (pad " << padNum++ << " smd " << ( ( ix % 4 ) ? "rect" : "circle" )
+                  << " (at " << ix * 2.5 << " " << iy * 2.5 << ") (size 1 1) (layers F.Cu) "
+                  << ( gnd ? "(net 1 GND))\n" : "(net 2 SIG))\n" );
+        }
+    }
+
+    board << "  )\n"
+             "  (gr_line (start 0 0) (end 40 0) (layer Edge.Cuts) (width 0.1))\n"
+             "  (gr_line (start 40 0) (end 40 40) (layer Edge.Cuts) (width 0.1))\n"
+             "  (gr_line (start 40 40) (end 0 40) (layer Edge.Cuts) (width 0.1))\n"
+             "  (gr_line (start 0 40) (end 0 0) (layer Edge.Cuts) (width 0.1))\n"
+             "  (segment (start 1 39) (end 39 1) (width 0.25) (layer F.Cu) (net 2))\n"
+             "  (segment (start 1 13.4) (end 39 13.6) (width 0.25) (layer F.Cu) (net 2))\n"
+             "  (segment (start 26.6 1) (end 26.8 39) (width 0.25) (layer F.Cu) (net 2))\n"
+             "  (zone (net 1) (net_name GND) (layer F.Cu) (tstamp 0) (hatch edge 0.508)\n"
+             "    (connect_pads (clearance 0.508))\n"
+             "    (min_thickness 0.254)\n"
+             "    (fill yes (thermal_gap 0.508) (thermal_bridge_width 0.508))\n"
+             "    (polygon (pts (xy 0.5 0.5) (xy 39.5 0.5) (xy 39.5 39.5) (xy 0.5 39.5)))\n"
+             "  )\n"
+             ")\n";
+
+    return board.str();
+}
+
+
+/**
+ * @return the fill of the zone of the board tiledFillBoard(), in tiles if aGridSize > 1
+ */
+static SHAPE_POLY_SET fillTiledBoard( int aGridSize, int& aMaxError )
+{
+    PCB_IO                 io;
+    std::unique_ptr<BOARD> board( dynamic_cast<BOARD*>( io.Parse( tiledFillBoard() ) ) );
+
+    BOOST_REQUIRE( board );
+    BOOST_REQUIRE_EQUAL( board->Zones().size(), 1u );
+
+    board->BuildConnectivity();
+
+    ZONE_FILLER filler( board.get() );
+
+    if( aGridSize > 1 )
+        filler.SetTiledFill( 0, aGridSize );
+
+    BOOST_REQUIRE( filler.Fill( board->Zones() ) );
+
+    aMaxError = board->GetDesignSettings().m_MaxError;
+
+    return board->Zones()[0]->GetFilledPolysList();
+}
+
+
+/**
+ * @return the number of outlines left of the differences between two fills once deflated
+ * by the max error, i.e. the number of real differences
+ */
+static int fillDifferences( const SHAPE_POLY_SET& aFill, const SHAPE_POLY_SET& aOther,
+                            int aMaxError )
+{
+    SHAPE_POLY_SET onlyFill, onlyOther;
+
+    onlyFill.BooleanSubtract( aFill, aOther, SHAPE_POLY_SET::PM_FAST );
+    onlyOther.BooleanSubtract( aOther, aFill, SHAPE_POLY_SET::PM_FAST );
+
+    SHAPE_POLY_SET diff;
+
+    diff.BooleanAdd( onlyFill, onlyOther, SHAPE_POLY_SET::PM_FAST );
+    diff.Deflate( aMaxError, 16 );
+
+    return diff.OutlineCount();
+}
+
+
+BOOST_AUTO_TEST_SUITE( ZoneFillerTiles )
+
+
+/**
+ * A zone filled in tiles is the same as when filled in one piece, thermal spokes and
+ * clearance holes crossing the tile edges included
+ */
+BOOST_AUTO_TEST_CASE( TiledFillMatchesPlainFill )
+{
+    int            maxError = 0;
+    SHAPE_POLY_SET plain = fillTiledBoard( 1, maxError );
+
+    BOOST_REQUIRE_GT( plain.OutlineCount(), 0 );
+
+    for( int gridSize : { 2, 3, 4, 7 } )
+    {
+        BOOST_TEST_CONTEXT( "Grid size " << gridSize )
+        {
+            SHAPE_POLY_SET tiled = fillTiledBoard( gridSize, maxError );
+
+            BOOST_CHECK_EQUAL( fillDifferences( plain, tiled, maxError ), 0 );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+/**
+ * A GND zone on F.Cu with, around it, the items whose clearance area is not their own
+ * bounding box: the holes of B.Cu pads, pads of a net class with a large clearance outside
+ * the zone, and Edge.Cuts graphics of the board and of a footprint.
+ */
+static const char s_indexBoard[] =
+        "(kicad_pcb (version 20171130) (host pcbnew 5.1)\n"
+        "  (general (thickness 1.6))\n"
+        "  (page A4)\n"
+        "  (layers (0 F.Cu signal) (31 B.Cu signal) (44 Edge.Cuts user))\n"
+        "  (net 0 \"\")\n"
+        "  (net 1 GND)\n"
+        "  (net 2 SIG)\n"
+        "  (net 3 WIDE)\n"
+        "  (net_class Default \"\" (clearance 0.2) (trace_width 0.25) (via_dia 0.8)\n"
+        "    (via_drill 0.4) (uvia_dia 0.3) (uvia_drill 0.1) (add_net GND) (add_net SIG))\n"
+        "  (net_class HV \"\" (clearance 2) (trace_width 0.25) (via_dia 0.8)\n"
+        "    (via_drill 0.4) (uvia_dia 0.3) (uvia_drill 0.1) (add_net WIDE))\n"
+        "  (module BACK (layer B.Cu) (tedit 0) (tstamp 5C000001)\n"
+        "    (at 10 10)\n"
+        "    (pad 1 thru_hole circle (at 0 0) (size 1.5 1.5) (drill 0.8) (layers B.Cu)\n"
+        "      (net 2 SIG))\n"
+        "    (pad 2 thru_hole oval (at 5 0) (size 2 3) (drill oval 1 2) (layers B.Cu)\n"
+        "      (net 1 GND))\n"
+        "    (pad 3 thru_hole circle (at 31 10) (size 1.5 1.5) (drill 1) (layers B.Cu)\n"
+        "      (net 3 WIDE))\n"
+        "    (fp_line (start 10 15) (end 15 15) (layer Edge.Cuts) (width 0.1))\n"
+        "  )\n"
+        "  (module HV (layer F.Cu) (tedit 0) (tstamp 5C000002)\n"
+        "    (at 41.5 30)\n"
+        "    (pad 1 smd rect (at 0 0) (size 1 1) (layers F.Cu) (net 3 WIDE))\n"
+        "    (pad 2 smd rect (at -31.5 -10) (size 1 1) (layers F.Cu) (net 3 WIDE))\n"
+        "  )\n"
+        "  (gr_line (start -5 -5) (end 45 -5) (layer Edge.Cuts) (width 0.1))\n"
+        "  (gr_line (start 45 -5) (end 45 45) (layer Edge.Cuts) (width 0.1))\n"
+        "  (gr_line (start 45 45) (end -5 45) (layer Edge.Cuts) (width 0.1))\n"
+        "  (gr_line (start -5 45) (end -5 -5) (layer Edge.Cuts) (width 0.1))\n"
+        "  (gr_circle (center 30 30) (end 32 30) (layer Edge.Cuts) (width 0.1))\n"
+        "  (gr_line (start 5 35) (end 15 35) (layer Edge.Cuts) (width 0.1))\n"
+        "  (segment (start 1 39) (end 39 1) (width 0.25) (layer F.Cu) (net 2))\n"
+        "  (zone (net 1) (net_name GND) (layer F.Cu) (tstamp 0) (hatch edge 0.508)\n"
+        "    (connect_pads (clearance 0.3))\n"
+        "    (min_thickness 0.254)\n"
+        "    (fill yes (thermal_gap 0.508) (thermal_bridge_width 0.508))\n"
+        "    (polygon (pts (xy 0 0) (xy 40 0) (xy 40 40) (xy 0 40)))\n"
+        "  )\n"
+        ")\n";
+
+
+/**
+ * @return the fill of the zone of s_indexBoard, with the clearance holes gathered from the
+ * item index or by walking the whole board
+ */
+static SHAPE_POLY_SET fillIndexBoard( bool aWalkWholeBoard, int& aMaxError )
+{
+    PCB_IO                 io;
+    std::unique_ptr<BOARD> board( dynamic_cast<BOARD*>( io.Parse( s_indexBoard ) ) );
+
+    BOOST_REQUIRE( board );
+    BOOST_REQUIRE_EQUAL( board->Zones().size(), 1u );
+
+    board->BuildConnectivity();
+
+    ZONE_FILLER filler( board.get() );
+    filler.SetWalkWholeBoard( aWalkWholeBoard );
+
+    BOOST_REQUIRE( filler.Fill( board->Zones() ) );
+
+    aMaxError = board->GetDesignSettings().m_MaxError;
+
+    return board->Zones()[0]->GetFilledPolysList();
+}
+
+
+BOOST_AUTO_TEST_SUITE( ZoneFillerIndex )
+
+
+/**
+ * The item index gives the zone the clearance holes the walk of the whole board gives
+ */
+BOOST_AUTO_TEST_CASE( IndexMatchesBoardWalk )
+{
+    int            maxError = 0;
+    SHAPE_POLY_SET indexed = fillIndexBoard( false, maxError );
+    SHAPE_POLY_SET walked = fillIndexBoard( true, maxError );
+
+    BOOST_REQUIRE_GT( walked.OutlineCount(), 0 );
+    BOOST_CHECK_EQUAL( fillDifferences( indexed, walked, maxError ), 0 );
+
+    // The items outside the zone reach into it
+    auto filled = [&]( double aX, double aY )
+    {
+        return walked.Contains( VECTOR2I( Millimeter2iu( aX ), Millimeter2iu( aY ) ) );
+    };
+
+    BOOST_CHECK( filled( 39.5, 25 ) );
+    BOOST_CHECK( !filled( 39.5, 30 ) );     // HV pad clearance
+    BOOST_CHECK( !filled( 39.5, 20 ) );     // B.Cu HV pad hole and its clearance
+    BOOST_CHECK( !filled( 10, 10 ) );       // B.Cu SIG pad hole
+    BOOST_CHECK( !filled( 30, 32 ) );       // Edge.Cuts circle
+    BOOST_CHECK( !filled( 22, 25 ) );       // footprint Edge.Cuts line
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -22,18 +22,26 @@
  */
 
 #include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
 #include <string>
 
 #include <common.h>
+#include <convert_to_biu.h>
 #include <profile.h>
 
 #include <wx/cmdline.h>
 
 #include <pcbnew_utils/board_file_utils.h>
 
+// For board loading
+#include <kicad_plugin.h>
+
 // DRC
 #include <drc/courtyard_overlap.h>
 #include <drc/drc_marker_factory.h>
+#include <tools/drc.h>
 
 #include <qa_utils/stdstream_line_reader.h>
 #include <qa_utils/utility_registry.h>
@@ -207,6 +215,176 @@ private:
 };
 
 
+/**
+ * Runs the full DRC test suite (the tests run by the DRC dialog) on a board without any
+ * editor frame or dialog, and reports the violations and the time taken by each test stage.
+ *
+ * The report can be written as JSON, for use in CI to track violations and DRC performance
+ * over board revisions.
+ */
+class DRC_FULL_RUNNER
+{
+public:
+    DRC_FULL_RUNNER( const DRC_RUNNER::EXECUTION_CONTEXT& aExecCtx, bool aTestZones,
+                     bool aRefillZones ) :
+            m_exec_context( aExecCtx ),
+            m_test_zones( aTestZones ),
+            m_refill_zones( aRefillZones ),
+            m_total_msecs( 0.0 )
+    {
+    }
+
+    void Execute( BOARD& aBoard )
+    {
+        if( m_exec_context.m_verbose )
+            std::cout << "Running DRC check: Full test suite" << std::endl;
+
+        aBoard.BuildConnectivity();
+
+        m_drc.SetTestTracksAgainstZones( m_test_zones );
+        m_drc.SetRefillZones( m_refill_zones );
+
+        auto marker_handler = [&]( MARKER_PCB* aMarker ) {
+            m_markers.push_back( std::unique_ptr<MARKER_PCB>( aMarker ) );
+        };
+
+        PROF_COUNTER timer;
+        m_drc.RunTestsHeadless( &aBoard, marker_handler );
+        m_total_msecs = timer.msecs();
+
+        if( m_exec_context.m_print_times )
+        {
+            for( const DRC_STAGE_TIME& stage : m_drc.GetStageTimes() )
+                std::cout << stage.m_name << ": " << stage.m_msecs << "ms" << std::endl;
+
+            std::cout << "Took: " << m_total_msecs << "ms" << std::endl;
+        }
+
+        if( m_exec_context.m_print_markers )
+        {
+            std::cout << "DRC markers: " << m_markers.size() << std::endl;
+
+            int index = 0;
+
+            for( const auto& m : m_markers )
+                std::cout << index++ << ": " << m->GetReporter().ShowReport( MILLIMETRES );
+
+            std::cout << "Unconnected items: " << m_drc.GetUnconnectedItems().size() << std::endl;
+        }
+    }
+
+    /**
+     * Write the violations, unconnected items and stage timings of the last run as JSON.
+     */
+    void WriteJson( std::ostream& aStream, const std::string& aBoardName ) const
+    {
+        aStream << "{\n";
+        aStream << "  \"board\": " << quoted( aBoardName ) << ",\n";
+        aStream << "  \"total_ms\": " << m_total_msecs << ",\n";
+        aStream << "  \"stages\": [";
+
+        const char* sep = "\n";
+
+        for( const DRC_STAGE_TIME& stage : m_drc.GetStageTimes() )
+        {
+            aStream << sep << "    { \"name\": " << quoted( stage.m_name )
+                    << ", \"ms\": " << stage.m_msecs << " }";
+            sep = ",\n";
+        }
+
+        aStream << "\n  ],\n";
+        aStream << "  \"violations\": [";
+
+        sep = "\n";
+
+        for( const auto& m : m_markers )
+        {
+            aStream << sep;
+            writeItem( aStream, m->GetReporter() );
+            sep = ",\n";
+        }
+
+        aStream << "\n  ],\n";
+        aStream << "  \"unconnected\": [";
+
+        sep = "\n";
+
+        for( const DRC_ITEM* item : m_drc.GetUnconnectedItems() )
+        {
+            aStream << sep;
+            writeItem( aStream, *item );
+            sep = ",\n";
+        }
+
+        aStream << "\n  ]\n";
+        aStream << "}" << std::endl;
+    }
+
+private:
+    static std::string quoted( const std::string& aStr )
+    {
+        std::ostringstream out;
+
+        out << '"';
+
+        for( unsigned char c : aStr )
+        {
+            switch( c )
+            {
+            case '"':  out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if( c < 0x20 )
+                    out << "\\u" << std::hex << std::setw( 4 ) << std::setfill( '0' ) << (int) c
+                        << std::dec;
+                else
+                    out << c;
+            }
+        }
+
+        out << '"';
+
+        return out.str();
+    }
+
+    static void writePosition( std::ostream& aStream, const wxPoint& aPos )
+    {
+        aStream << "\"x_mm\": " << Iu2Millimeter( aPos.x )
+                << ", \"y_mm\": " << Iu2Millimeter( aPos.y );
+    }
+
+    static void writeItem( std::ostream& aStream, const DRC_ITEM& aItem )
+    {
+        aStream << "    { \"code\": " << aItem.GetErrorCode()
+                << ", \"description\": " << quoted( TO_UTF8( aItem.GetErrorText() ) )
+                << ", \"main\": { \"item\": " << quoted( TO_UTF8( aItem.GetMainText() ) )
+                << ", ";
+        writePosition( aStream, aItem.GetPointA() );
+        aStream << " }";
+
+        if( aItem.HasSecondItem() )
+        {
+            aStream << ", \"auxiliary\": { \"item\": "
+                    << quoted( TO_UTF8( aItem.GetAuxiliaryText() ) ) << ", ";
+            writePosition( aStream, aItem.GetPointB() );
+            aStream << " }";
+        }
+
+        aStream << " }";
+    }
+
+    const DRC_RUNNER::EXECUTION_CONTEXT      m_exec_context;
+    bool                                     m_test_zones;
+    bool                                     m_refill_zones;
+    DRC                                      m_drc;
+    std::vector<std::unique_ptr<MARKER_PCB>> m_markers;
+    double                                   m_total_msecs;
+};
+
+
 static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
     {
             wxCMD_LINE_SWITCH,
@@ -252,6 +430,32 @@ static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
             "courtyard-missing",
             _( "perform courtyard-missing checking" ).mb_str(),
     },
+    {
+            wxCMD_LINE_SWITCH,
+            "f",
+            "full",
+            _( "perform the full DRC test suite, as run by the DRC dialog" ).mb_str(),
+    },
+    {
+            wxCMD_LINE_SWITCH,
+            "z",
+            "track-zone-clearance",
+            _( "with --full, also test track clearances to copper zones" ).mb_str(),
+    },
+    {
+            wxCMD_LINE_SWITCH,
+            "r",
+            "refill-zones",
+            _( "with --full, refill all zones before testing" ).mb_str(),
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "j",
+            "json",
+            _( "with --full, write the violations and stage timings as JSON to the given file" )
+                    .mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
     {
             wxCMD_LINE_PARAM,
             nullptr,
@@ -301,7 +505,25 @@ int drc_main_func( int argc, char** argv )
         filename = cl_parser.GetParam( 0 ).ToStdString();
     }
 
-    std::unique_ptr<BOARD> board = KI_TEST::ReadBoardFromFileOrStream( filename );
+    std::unique_ptr<BOARD> board;
+
+    if( !filename.empty() )
+    {
+        // Load the board the same way the editor does
+        try
+        {
+            PCB_IO io;
+            board.reset( io.Load( filename, nullptr ) );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            std::cerr << ioe.What() << std::endl;
+        }
+    }
+    else
+    {
+        board = KI_TEST::ReadBoardFromFileOrStream( filename );
+    }
 
     if( !board )
         return PARSER_RET_CODES::PARSE_FAILED;
@@ -327,6 +549,28 @@ int drc_main_func( int argc, char** argv )
         runner.Execute( *board );
     }
 
+    if( cl_parser.Found( "full" ) )
+    {
+        DRC_FULL_RUNNER runner( exec_context, cl_parser.Found( "track-zone-clearance" ),
+                                cl_parser.Found( "refill-zones" ) );
+        runner.Execute( *board );
+
+        wxString jsonFile;
+
+        if( cl_parser.Found( "json", &jsonFile ) )
+        {
+            std::ofstream out( jsonFile.ToStdString() );
+
+            if( !out )
+            {
+                std::cerr << "Could not write " << jsonFile << std::endl;
+                return KI_TEST::RET_CODES::BAD_CMDLINE;
+            }
+
+            runner.WriteJson( out, filename.empty() ? "-" : filename );
+        }
+    }
+
     return KI_TEST::RET_CODES::OK;
 }
 
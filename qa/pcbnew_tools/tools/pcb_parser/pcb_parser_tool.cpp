@@ -33,6 +33,7 @@
 
 #include <class_board_item.h>
 #include <kicad_plugin.h>
+#include <pcb_lexer.h>
 #include <pcb_parser.h>
 #include <richio.h>
 
@@ -87,10 +88,61 @@ bool parse( std::istream& aStream, bool aVerbose )
 }
 
 
+/**
+ * Only tokenize a PCB or footprint file from the given input stream, which times the lexer
+ * and its keyword lookup without building the board items
+ *
+ * @param aStream the input stream to read from
+ * @return success
+ */
+bool lex( std::istream& aStream, bool aVerbose )
+{
+    STDISTREAM_LINE_READER reader;
+    reader.SetStream( aStream );
+
+    PCB_LEXER lexer( &reader );
+
+    unsigned tokens = 0;
+    unsigned keywords = 0;
+
+    PARSE_DURATION duration{};
+
+    try
+    {
+        PROF_COUNTER timer;
+
+        for( PCB_KEYS_T::T tok = lexer.NextTok(); tok != PCB_KEYS_T::T_EOF; tok = lexer.NextTok() )
+        {
+            tokens++;
+
+            if( tok >= 0 )
+                keywords++;
+        }
+
+        duration = timer.SinceStart<PARSE_DURATION>();
+    }
+    catch( const IO_ERROR& parse_error )
+    {
+        std::cerr << parse_error.Problem() << std::endl;
+        std::cerr << parse_error.Where() << std::endl;
+        return false;
+    }
+
+    if( aVerbose )
+    {
+        std::cout << "Lexed " << tokens << " tokens (" << keywords << " keywords), took: "
+                  << duration.count() << "us" << std::endl;
+    }
+
+    return true;
+}
+
+
 static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
     { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
             wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
     { wxCMD_LINE_SWITCH, "v", "verbose", _( "print parsing information" ).mb_str() },
+    { wxCMD_LINE_SWITCH, "l", "lex", _( "only run the lexer over the input" ).mb_str() },
     { wxCMD_LINE_PARAM, nullptr, nullptr, _( "input file" ).mb_str(), wxCMD_LINE_VAL_STRING,
             wxCMD_LINE_PARAM_OPTIONAL | wxCMD_LINE_PARAM_MULTIPLE },
     { wxCMD_LINE_NONE }
@@ -125,6 +177,7 @@ int pcb_parser_main_func( int argc, char** argv )
     }
 
     const bool verbose = cl_parser.Found( "verbose" );
+    const bool lexOnly = cl_parser.Found( "lex" );
 
     bool ok = true;
 
@@ -136,7 +189,7 @@ int pcb_parser_main_func( int argc, char** argv )
         // program
         // while (__AFL_LOOP(2))
         {
-            ok = parse( std::cin, verbose );
+            ok = lexOnly ? lex( std::cin, verbose ) : parse( std::cin, verbose );
         }
     }
     else
@@ -154,7 +207,7 @@ int pcb_parser_main_func( int argc, char** argv )
             std::ifstream fin;
             fin.open( filename );
 
-            ok = ok && parse( fin, verbose );
+            ok = ok && ( lexOnly ? lex( fin, verbose ) : parse( fin, verbose ) );
         }
     }
 
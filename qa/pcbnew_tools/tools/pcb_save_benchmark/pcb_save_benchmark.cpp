@@ -0,0 +1,151 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pcb_save_benchmark.cpp
+ * Times the writing of a board in the s-expression format, in memory and to a file, to
+ * follow the cost of PCB_IO::Format() on large boards.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+#include <wx/filename.h>
+
+#include <class_board.h>
+#include <kicad_plugin.h>
+#include <profile.h>
+#include <richio.h>
+
+#include <qa_utils/utility_registry.h>
+
+
+using SAVE_DURATION = std::chrono::microseconds;
+
+
+enum SAVE_BENCHMARK_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    SAVE_FAILED,
+};
+
+
+static void printReport( const char* aName, int aReps, size_t aBytes, SAVE_DURATION aDuration )
+{
+    double perSaveMs = aDuration.count() / 1000.0 / aReps;
+    double mbPerSecond = aDuration.count() ? aBytes * (double) aReps / aDuration.count() : 0.0;
+
+    std::cout << aName << ": " << aReps << " x " << aBytes << " bytes, " << perSaveMs
+              << " ms per save, " << mbPerSecond << " MB/s" << std::endl;
+}
+
+
+int pcb_save_benchmark_func( int argc, char** argv )
+{
+    if( argc < 3 )
+    {
+        std::cout << "Usage: " << argv[0] << " <BOARD FILE> <REPS> [OUTPUT FILE]\n\n"
+                  << "Formats the board REPS times in memory, then saves it REPS times to\n"
+                  << "OUTPUT FILE, or to a temporary file which is removed afterwards.\n";
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    wxString inFile = wxString::FromUTF8( argv[1] );
+    long     reps = 0;
+
+    if( !wxString( argv[2] ).ToLong( &reps ) || reps < 1 )
+    {
+        std::cerr << "REPS must be a positive number" << std::endl;
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    bool     tempOutput = argc < 4;
+    wxString outFile = tempOutput ? wxFileName::CreateTempFileName( wxT( "pcb_save" ) )
+                                  : wxString::FromUTF8( argv[3] );
+
+    std::unique_ptr<BOARD> board;
+    PCB_IO                 io;
+
+    try
+    {
+        PROF_COUNTER timer;
+        board.reset( io.Load( inFile, NULL ) );
+
+        std::cout << "Loaded in " << timer.SinceStart<SAVE_DURATION>().count() / 1000.0
+                  << " ms: " << board->Tracks().size() << " tracks, " << board->Modules().size()
+                  << " footprints, " << board->GetAreaCount() << " zones" << std::endl;
+    }
+    catch( const IO_ERROR& e )
+    {
+        std::cerr << e.What() << std::endl;
+        return LOAD_FAILED;
+    }
+
+    try
+    {
+        size_t bytes = 0;
+
+        {
+            PROF_COUNTER timer;
+
+            for( long i = 0; i < reps; ++i )
+            {
+                PCB_IO formatter;
+
+                formatter.Format( board.get() );
+                bytes = formatter.GetStringOutput( true ).size();
+            }
+
+            printReport( "In memory", reps, bytes, timer.SinceStart<SAVE_DURATION>() );
+        }
+
+        {
+            PROF_COUNTER timer;
+
+            for( long i = 0; i < reps; ++i )
+                io.Save( outFile, board.get() );
+
+            printReport( "To file", reps, wxFileName( outFile ).GetSize().GetValue(),
+                         timer.SinceStart<SAVE_DURATION>() );
+        }
+    }
+    catch( const IO_ERROR& e )
+    {
+        std::cerr << e.What() << std::endl;
+
+        if( tempOutput )
+            wxRemoveFile( outFile );
+
+        return SAVE_FAILED;
+    }
+
+    if( tempOutput )
+        wxRemoveFile( outFile );
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( { "pcb_save_benchmark",
+        "Time the saving of a KiCad PCB file", pcb_save_benchmark_func } );
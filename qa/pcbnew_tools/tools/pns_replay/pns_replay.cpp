@@ -0,0 +1,461 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pns_replay.cpp
+ * Replays the routing events recorded by PNS::ROUTER on a board, without any editor frame or
+ * view, and reports the time taken by each kind of event and the routed geometry.  Router
+ * changes can then be measured against a fixed set of boards and event logs.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include <wx/cmdline.h>
+
+#include <common.h>
+#include <class_board.h>
+#include <class_track.h>
+#include <kicad_plugin.h>
+#include <profile.h>
+
+#include <router/pns_kicad_iface.h>
+#include <router/pns_logger.h>
+#include <router/pns_router.h>
+
+#include <qa_utils/utility_registry.h>
+
+
+using EVENT = PNS::LOGGER::EVENT_ENTRY;
+
+
+enum PNS_REPLAY_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    BAD_EVENT_LOG,
+    SAVE_FAILED,
+};
+
+
+static const char* eventName( PNS::LOGGER::EVENT_TYPE aType )
+{
+    switch( aType )
+    {
+    case PNS::LOGGER::EVT_START_ROUTE: return "start";
+    case PNS::LOGGER::EVT_START_DRAG:  return "drag";
+    case PNS::LOGGER::EVT_MOVE:        return "move";
+    case PNS::LOGGER::EVT_FIX:         return "fix";
+    }
+
+    return "?";
+}
+
+
+/**
+ * Finds the item an event was recorded on, with the priorities of the router tool: the vias
+ * and pads nearest to the event first, then the segments, on the event layer first.
+ */
+static PNS::ITEM* pickItem( PNS::ROUTER& aRouter, const EVENT& aEvent )
+{
+    if( aEvent.m_net < 0 )
+        return nullptr;
+
+    PNS::ITEM*  prioritized[4] = { nullptr, nullptr, nullptr, nullptr };
+    SEG::ecoord dist[2] = { VECTOR2I::ECOORD_MAX, VECTOR2I::ECOORD_MAX };
+
+    PNS::ITEM_SET candidates = aRouter.QueryHoverItems( aEvent.m_p );
+
+    for( PNS::ITEM* item : candidates.Items() )
+    {
+        if( !item->IsRoutable() || item->Net() != aEvent.m_net )
+            continue;
+
+        bool onLayer = aEvent.m_layer < 0 || item->Layers().Overlaps( aEvent.m_layer );
+
+        if( item->OfKind( PNS::ITEM::VIA_T | PNS::ITEM::SOLID_T ) )
+        {
+            SEG::ecoord d = ( item->Shape()->Centre() - aEvent.m_p ).SquaredEuclideanNorm();
+            int         slot = onLayer ? 0 : 2;
+
+            if( d < dist[slot / 2] )
+            {
+                prioritized[slot] = item;
+                dist[slot / 2] = d;
+            }
+        }
+        else if( onLayer )
+        {
+            prioritized[1] = item;
+        }
+        else if( !prioritized[3] )
+        {
+            prioritized[3] = item;
+        }
+    }
+
+    for( PNS::ITEM* item : prioritized )
+    {
+        if( item )
+            return item;
+    }
+
+    return nullptr;
+}
+
+
+/**
+ * The times of the events of one kind
+ */
+class LATENCIES
+{
+public:
+    void Add( double aMsecs )
+    {
+        m_msecs.push_back( aMsecs );
+    }
+
+    void Print( std::ostream& aStream, const std::string& aName )
+    {
+        aStream << std::left << std::setw( 8 ) << aName << std::right << std::setw( 8 )
+                << m_msecs.size();
+
+        std::sort( m_msecs.begin(), m_msecs.end() );
+
+        for( double p : { 0.5, 0.9, 0.99, 1.0 } )
+            aStream << std::setw( 11 ) << percentile( p );
+
+        aStream << std::endl;
+    }
+
+private:
+    /// Nearest rank percentile of the sorted times
+    double percentile( double aP ) const
+    {
+        if( m_msecs.empty() )
+            return 0.0;
+
+        size_t rank = std::max<size_t>( std::ceil( aP * m_msecs.size() ), 1 );
+
+        return m_msecs[rank - 1];
+    }
+
+    std::vector<double> m_msecs;
+};
+
+
+/**
+ * Writes the tracks and vias of the board, one per line and sorted, so that the results of two
+ * replays can be compared with diff.
+ */
+static void writeGeometry( std::ostream& aStream, const BOARD& aBoard )
+{
+    std::vector<std::string> lines;
+
+    for( TRACK* track : aBoard.Tracks() )
+    {
+        std::ostringstream line;
+
+        if( track->Type() == PCB_VIA_T )
+        {
+            VIA*         via = static_cast<VIA*>( track );
+            PCB_LAYER_ID top, bottom;
+
+            via->LayerPair( &top, &bottom );
+            line << "via " << via->GetNetname().ToStdString() << " " << via->GetPosition().x
+                 << " " << via->GetPosition().y << " " << via->GetWidth() << " "
+                 << via->GetDrillValue() << " " << top << " " << bottom;
+        }
+        else
+        {
+            line << "track " << track->GetNetname().ToStdString() << " " << track->GetLayer()
+                 << " " << track->GetStart().x << " " << track->GetStart().y << " "
+                 << track->GetEnd().x << " " << track->GetEnd().y << " " << track->GetWidth();
+        }
+
+        lines.push_back( line.str() );
+    }
+
+    std::sort( lines.begin(), lines.end() );
+
+    for( const std::string& line : lines )
+        aStream << line << "\n";
+}
+
+
+static void printSummary( std::ostream& aStream, const BOARD& aBoard )
+{
+    int    tracks = 0;
+    int    vias = 0;
+    double length = 0.0;
+
+    for( TRACK* track : aBoard.Tracks() )
+    {
+        if( track->Type() == PCB_VIA_T )
+        {
+            vias++;
+        }
+        else
+        {
+            tracks++;
+            length += track->GetLength();
+        }
+    }
+
+    aStream << "Routed board: " << tracks << " tracks, " << vias << " vias, total track length "
+            << std::fixed << std::setprecision( 0 ) << length << " nm" << std::endl;
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    {
+            wxCMD_LINE_SWITCH,
+            "h",
+            "help",
+            _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE,
+            wxCMD_LINE_OPTION_HELP,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "m",
+            "mode",
+            _( "collision mode: walkaround (the default), shove or mark" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "g",
+            "geometry",
+            _( "write the tracks and vias of the routed board to the given file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "o",
+            "output",
+            _( "save the routed board to the given file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_PARAM,
+            nullptr,
+            nullptr,
+            _( "board file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_PARAM,
+            nullptr,
+            nullptr,
+            _( "event log" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    { wxCMD_LINE_NONE }
+};
+
+
+int pns_replay_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText(
+            _( "This program replays on a board the routing events saved by the router with "
+               "the debug key of the router tool.  The board must be the one the recording "
+               "started on." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    PNS::ROUTING_SETTINGS settings;
+    wxString              mode;
+
+    if( cl_parser.Found( "mode", &mode ) )
+    {
+        if( mode == "walkaround" )
+            settings.SetMode( PNS::RM_Walkaround );
+        else if( mode == "shove" )
+            settings.SetMode( PNS::RM_Shove );
+        else if( mode == "mark" )
+            settings.SetMode( PNS::RM_MarkObstacles );
+        else
+        {
+            std::cerr << "Unknown collision mode " << mode.ToStdString() << std::endl;
+            return KI_TEST::RET_CODES::BAD_CMDLINE;
+        }
+    }
+
+    std::vector<EVENT> events;
+    std::ifstream      eventStream( cl_parser.GetParam( 1 ).ToStdString() );
+
+    if( !eventStream || !PNS::LOGGER::ParseEvents( eventStream, events ) )
+    {
+        std::cerr << "Cannot read the events of " << cl_parser.GetParam( 1 ).ToStdString()
+                  << std::endl;
+        return BAD_EVENT_LOG;
+    }
+
+    std::unique_ptr<BOARD> board;
+
+    try
+    {
+        PCB_IO io;
+        board.reset( io.Load( cl_parser.GetParam( 0 ), nullptr ) );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        std::cerr << ioe.What() << std::endl;
+        return LOAD_FAILED;
+    }
+
+    // Set up the board as the editor does after loading it
+    board->SynchronizeNetsAndNetClasses();
+    board->BuildConnectivity();
+
+    PNS_KICAD_IFACE iface;
+    PNS::ROUTER     router;
+    PROF_COUNTER    syncTimer;
+
+    iface.SetBoard( board.get() );
+    router.SetInterface( &iface );
+    router.ClearWorld();
+    router.SyncWorld();
+    router.LoadSettings( settings );
+
+    std::cout << "Synchronized the router world in " << syncTimer.msecs() << " ms, replaying "
+              << events.size() << " events" << std::endl;
+
+    LATENCIES latencies[PNS::LOGGER::EVT_FIX + 1];
+    LATENCIES allLatencies;
+    double    totalMsecs = 0.0;
+
+    for( const EVENT& evt : events )
+    {
+        PNS::ITEM* item = pickItem( router, evt );
+
+        if( evt.m_type == PNS::LOGGER::EVT_START_ROUTE )
+        {
+            PNS::SIZES_SETTINGS sizes( router.Sizes() );
+
+            sizes.Init( board.get(), item, evt.m_net );
+            sizes.SetTrackWidth( evt.m_trackWidth );
+            sizes.SetViaDiameter( evt.m_viaDiameter );
+            sizes.SetViaDrill( evt.m_viaDrill );
+            sizes.SetDiffPairWidth( evt.m_diffPairWidth );
+            sizes.SetDiffPairGap( evt.m_diffPairGap );
+
+            router.SetMode( (PNS::ROUTER_MODE) evt.m_mode );
+            router.UpdateSizes( sizes );
+        }
+
+        PROF_COUNTER timer;
+
+        switch( evt.m_type )
+        {
+        case PNS::LOGGER::EVT_START_ROUTE:
+            router.StartRouting( evt.m_p, item, evt.m_layer );
+            break;
+
+        case PNS::LOGGER::EVT_START_DRAG:
+            router.StartDragging( evt.m_p, item, evt.m_mode );
+            break;
+
+        case PNS::LOGGER::EVT_MOVE:
+            router.Move( evt.m_p, item );
+            break;
+
+        case PNS::LOGGER::EVT_FIX:
+            router.FixRoute( evt.m_p, item, evt.m_mode != 0 );
+            break;
+        }
+
+        double msecs = timer.msecs();
+
+        latencies[evt.m_type].Add( msecs );
+        allLatencies.Add( msecs );
+        totalMsecs += msecs;
+    }
+
+    if( router.RoutingInProgress() )
+        router.StopRouting();
+
+    std::cout << "Replayed in " << totalMsecs << " ms\n\n"
+              << std::fixed << std::setprecision( 3 )
+              << "event      count   p50 (ms)   p90 (ms)   p99 (ms)   max (ms)" << std::endl;
+
+    for( int type = PNS::LOGGER::EVT_START_ROUTE; type <= PNS::LOGGER::EVT_FIX; type++ )
+        latencies[type].Print( std::cout, eventName( (PNS::LOGGER::EVENT_TYPE) type ) );
+
+    allLatencies.Print( std::cout, "all" );
+    std::cout << std::endl;
+
+    printSummary( std::cout, *board );
+
+    wxString geometryFile;
+
+    if( cl_parser.Found( "geometry", &geometryFile ) )
+    {
+        std::ofstream geometryStream( geometryFile.ToStdString() );
+        writeGeometry( geometryStream, *board );
+
+        if( !geometryStream )
+        {
+            std::cerr << "Cannot write the geometry to " << geometryFile.ToStdString()
+                      << std::endl;
+            return SAVE_FAILED;
+        }
+    }
+
+    wxString outputFile;
+
+    if( cl_parser.Found( "output", &outputFile ) )
+    {
+        try
+        {
+            PCB_IO io;
+            io.Save( outputFile, board.get() );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            std::cerr << ioe.What() << std::endl;
+            return SAVE_FAILED;
+        }
+    }
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( { "pns_replay",
+        "Replay recorded router events on a PCB file and time them", pns_replay_main_func } );